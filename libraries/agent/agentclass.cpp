@@ -38,6 +38,9 @@
 //#include "support/jsondef.h"
 #include "support/socketlib.h"
 #include "support/elapsedtime.h"
+#if !defined(COSMOS_WIN_OS)
+#include <poll.h>
+#endif
 #if defined (COSMOS_MAC_OS)
 #include <net/if.h>
 #include <net/if_dl.h>
@@ -64,6 +67,23 @@ namespace Support
 //! \defgroup agentclass_functions Agent Server and Client functions
 //! @{
 
+//! Token of a request: its first word, of at most ::COSMOS_MAX_NAME characters
+static string request_token(const string &bufferin)
+{
+    size_t i = 0;
+    while (i < bufferin.size() && i < COSMOS_MAX_NAME && bufferin[i] != ' ' && bufferin[i] != 0)
+    {
+        ++i;
+    }
+    return bufferin.substr(0, i);
+}
+
+//! Leading line of every request response: time stamps and the request itself
+static string request_header(const string &bufferin)
+{
+    return to_unsigned(centisec(), 10) + " " + mjd2iso8601(currentmjd()) + " " + bufferin.c_str() + "\n";
+}
+
 //! Creates a skeleton agent with no setup
 //! \param placeholder Does nothing but provide a different function signature for overloading
 Agent::Agent(uint8_t placeholder) {}
@@ -294,8 +314,8 @@ Agent::Agent(string realm_name,
     }
 
     //! Set up initial requests
-    add_request("help",req_help,"","list of available requests for this agent");
-    add_request("help_json",req_help_json,"","list of available requests for this agent (but in json)");
+    add_request("help",req_help,"","list of available requests for this agent", true);
+    add_request("help_json",req_help_json,"","list of available requests for this agent (but in json)", true);
     add_request("shutdown",req_shutdown,"","request to shutdown this agent");
     add_request("idle",req_idle,"","request to transition this agent to idle state");
     add_request("init",req_init,"","request to transition this agent to init state");
@@ -331,7 +351,7 @@ Agent::Agent(string realm_name,
     add_request("aliasesjson",req_aliasesjson,"","return description JSON for Aliases");
     add_request("heartbeat",req_heartbeat,"","Post a hearbeat");
     add_request("postsoh",req_postsoh,"","Post a SOH");
-    add_request("utc",req_utc,"","Get UTC as both Modified Julian Day and Unix Time");
+    add_request("utc",req_utc,"","Get UTC as both Modified Julian Day and Unix Time", true);
     add_request("soh",req_soh,"","Get Limited SOH string");
     add_request("fullsoh",req_fullsoh,"","Get Full SOH string");
     add_request("jsondump",req_jsondump,"","Dump JSON ini files to node folder");
@@ -373,11 +393,12 @@ Agent::Agent(string realm_name,
                 "    ExecAddCommand json_event_string\n"
                 "");
     add_request("list_channels", req_list_channels, "", "List current channels");
-    add_request("run_command", req_run_command, "command parameters", "Run external command for immediate response");
+    add_request("run_command", req_run_command, "command parameters", "Run external command for immediate response", true);
     add_request("add_task", req_add_task, "command parameters", "Start external command as Task for output to file");
     add_request("test_channel", req_test_channel, "channel radio dest start step count bytes", "Run channel performance test");
     add_request("channel_enable", req_channel_enable, "channel state", "Set channel enabled state to the specified value");
     add_request("channel_touch", req_channel_touch, "channel [seconds]", "Reset channel age");
+    add_request("request_latency", req_request_latency, "[token]", "Latency percentiles, in msec, for each request", true);
     // Set up Full SOH string
     //            set_fullsohstring(json_list_of_fullsoh(cinfo));
 
@@ -427,9 +448,14 @@ Agent::~Agent() { Agent::shutdown(); }
     \param function The user supplied function to parse the specified request.
     \param description A brief description of the function performed.
     \param synopsis A usage synopsis for the request.
+    \param concurrent If true, the function is safe to run alongside other requests, and requests
+    arriving on the request channel are run in a pool of worker threads. Otherwise requests are
+    run one at a time.
+    \param deadline For concurrent requests, the number of seconds a request may wait for a worker
+    before it is refused with ::GENERAL_ERROR_TIMEOUT. Zero for no limit.
     \return Error, if any, otherwise zero.
 */
-int32_t Agent::add_request(string token, Agent::external_request_function function, string synopsis, string description)
+int32_t Agent::add_request(string token, Agent::external_request_function function, string synopsis, string description, bool concurrent, double deadline)
 {
     if (reqs.size() > AGENTMAXREQUESTCOUNT) return (AGENT_ERROR_REQ_COUNT);
 
@@ -439,10 +465,45 @@ int32_t Agent::add_request(string token, Agent::external_request_function functi
     tentry.efunction = function;
     tentry.synopsis = synopsis;
     tentry.description = description;
+    tentry.concurrent = concurrent;
+    tentry.deadline = deadline;
     reqs[token] = tentry;
     return 0;
 }
 
+//! Set size of concurrent request pool
+/*! Sets the number of worker threads used to run requests added as concurrent. Takes effect
+ * when the pool is started, on the first concurrent request.
+    \param count Number of threads.
+    \return Number of threads, otherwise negative error.
+*/
+int32_t Agent::set_request_threads(uint16_t count)
+{
+    if (!count)
+    {
+        return GENERAL_ERROR_ARGS;
+    }
+    request_thread_count = count;
+    return count;
+}
+
+//! Set depth of concurrent request queue
+/*! Sets the number of concurrent requests that may wait for a worker. Requests arriving while
+ * the queue is full are refused with ::GENERAL_ERROR_BUSY.
+    \param count Number of requests.
+    \return Number of requests, otherwise negative error.
+*/
+int32_t Agent::set_request_queue(uint32_t count)
+{
+    if (!count)
+    {
+        return GENERAL_ERROR_ARGS;
+    }
+    std::lock_guard<mutex> lock(request_jobs_mutex);
+    request_queue_size = count;
+    return count;
+}
+
 
 //! Start Agent Request and Heartbeat loops
 /*!	Starts the request and heartbeat threads for an Agent server initialized with
@@ -476,6 +537,13 @@ int32_t Agent::finish_active_loop() {
     return sleepsec*1000000;
 }
 
+//! End of active loop
+//! Time at which the current active loop, begun with ::start_active_loop, should finish.
+//! \return Time in MJD.
+double Agent::get_activeTimeout() {
+    return activeTimeout;
+}
+
 //! Shutdown agent gracefully
 /*! Waits for threads to stop running if we are a server, then releases everything.
  * \return 0 or negative error.
@@ -779,6 +847,7 @@ vector<beatstruc> Agent::find_agents(double waitsec) {
 int32_t Agent::set_sohstring(string list) {
     if (!sohtable.empty()) { sohtable.clear(); }
     json_table_of_list(sohtable, list, cinfo);
+    json_compile_table(sohtemplate, sohtable, cinfo);
     return 0;
 }
 
@@ -815,6 +884,7 @@ int32_t Agent::set_sohstring2(vector<string> list) {
 int32_t Agent::set_fullsohstring(string list) {
     if (!fullsohtable.empty()) { fullsohtable.clear(); }
     json_table_of_list(fullsohtable, list, cinfo);
+    json_compile_table(fullsohtemplate, fullsohtable, cinfo);
     return 0;
 }
 
@@ -900,45 +970,181 @@ void Agent::request_loop() noexcept {
         {
             string bufferout;
             bufferin.resize(iretn);
-            process_request(bufferin, bufferout);
+            map<string, request_entry>::iterator it = reqs.find(request_token(bufferin));
+            if (it == reqs.end() || !it->second.concurrent)
+            {
+                process_request(bufferin, bufferout);
+                continue;
+            }
+
+            // Hand concurrent requests to the worker pool
+            std::unique_lock<mutex> lock(request_jobs_mutex);
+            if (request_workers.empty())
+            {
+                request_workers_stop = false;
+                for (uint16_t i=0; i<request_thread_count; ++i)
+                {
+                    request_workers.push_back(thread([=] { request_worker(); }));
+                }
+            }
+            if (request_jobs.size() < request_queue_size)
+            {
+                request_jobs.resize(request_jobs.size() + 1);
+                request_jobs.back().bufferin.swap(bufferin);
+                request_jobs.back().caddr = cinfo->agent0.req.caddr;
+                request_jobs.back().deadline = it->second.deadline;
+                lock.unlock();
+                request_jobs_cv.notify_one();
+            }
+            else
+            {
+                lock.unlock();
+                bufferout = request_header(bufferin) + "[NOK] " + std::to_string(GENERAL_ERROR_BUSY) + "\n";
+                sendto(cinfo->agent0.req.cudp, bufferout.data(), bufferout.size(), 0, (struct sockaddr *)&cinfo->agent0.req.caddr, sizeof(struct sockaddr_in));
+            }
         }
     }
+
+    // Stop the worker pool
+    {
+        std::lock_guard<mutex> lock(request_jobs_mutex);
+        request_workers_stop = true;
+    }
+    request_jobs_cv.notify_all();
+    for (thread &worker : request_workers)
+    {
+        if (worker.joinable()) { worker.join(); }
+    }
+    request_workers.clear();
+
+    // Refuse whatever the pool did not get to, so no requester is left waiting
+    deque<request_job> jobs;
+    {
+        std::lock_guard<mutex> lock(request_jobs_mutex);
+        jobs.swap(request_jobs);
+    }
+    for (request_job &job : jobs)
+    {
+        string bufferout = request_header(job.bufferin) + "[NOK] " + std::to_string(GENERAL_ERROR_NOTREADY) + "\n";
+        sendto(cinfo->agent0.req.cudp, bufferout.data(), bufferout.size(), 0, (struct sockaddr *)&job.caddr, sizeof(struct sockaddr_in));
+    }
     return;
 }
 
+//! Concurrent request worker
+//! Run queued concurrent requests until the pool is stopped, responding to each requester in turn.
+//! Requests that have waited past their deadline are refused rather than run.
+void Agent::request_worker()
+{
+    std::unique_lock<mutex> lock(request_jobs_mutex);
+    while (true)
+    {
+        while (!request_workers_stop && request_jobs.empty())
+        {
+            request_jobs_cv.wait(lock);
+        }
+        if (request_workers_stop)
+        {
+            return;
+        }
+        request_job job = std::move(request_jobs.front());
+        request_jobs.pop_front();
+        lock.unlock();
+
+        string bufferout;
+        if (job.deadline > 0. && job.received.split() > job.deadline)
+        {
+            bufferout = request_header(job.bufferin) + "[NOK] " + std::to_string(GENERAL_ERROR_TIMEOUT) + "\n";
+        }
+        else
+        {
+            execute_request(job.bufferin, bufferout, job.received);
+        }
+        int32_t iretn = sendto(cinfo->agent0.req.cudp, bufferout.data(), bufferout.size(), 0, (struct sockaddr *)&job.caddr, sizeof(struct sockaddr_in));
+        if (debug_level)
+        {
+            debug_log.Printf("Response: [%d:%x:%d] %s\n", cinfo->agent0.req.cudp, ntohl(job.caddr.sin_addr.s_addr), iretn, &bufferout[0]);
+        }
+
+        lock.lock();
+    }
+}
+
+//! Process request
+/*! Run a request and optionally send the response back to the requester. Requests not added as
+ * concurrent are run one at a time.
+    \param bufferin Text of request.
+    \param bufferout Text of response.
+    \param send_response If true, send the response back over the request channel.
+    \return Zero or positive if successful, otherwise negative error.
+*/
 int32_t Agent::process_request(string &bufferin, string &bufferout, bool send_response)
 {
-    size_t i;
     int32_t iretn = 0;
+    ElapsedTime received;
+
+    map<string, request_entry>::iterator it = reqs.find(request_token(bufferin));
+    bool concurrent = it != reqs.end() && it->second.concurrent;
+    if (!concurrent)
+    {
+        process_mutex.lock();
+    }
+
+    iretn = execute_request(bufferin, bufferout, received);
+
+    if (send_response)
+    {
+        iretn = sendto(cinfo->agent0.req.cudp, bufferout.data(), bufferout.size(), 0, (struct sockaddr *)&cinfo->agent0.req.caddr, sizeof(struct sockaddr_in));
+        if (iretn < 0)
+        {
+            iretn = -errno;
+        }
+        debug_log.Printf("Response: [%d:%s:%x:%u:%d] %s\n", cinfo->agent0.req.cudp, cinfo->agent0.req.address, ntohl(cinfo->agent0.req.caddr.sin_addr.s_addr), cinfo->agent0.req.cport, iretn, &bufferout[0]);
+    }
+    else
+    {
+        debug_log.Printf("Response: [%d] %s\n", iretn, &bufferout[0]);
+    }
+
+    if (!concurrent)
+    {
+        process_mutex.unlock();
+    }
+
+    return iretn;
+}
 
-    process_mutex.lock();
+//! Execute request
+/*! Look up the request token and call its function, forming the response. Latency, from when the
+ * request was received to when its response is ready, is recorded for known tokens.
+    \param bufferin Text of request.
+    \param bufferout Text of response.
+    \param received Timer started when the request was received.
+    \return Value returned by the request function, otherwise negative error.
+*/
+int32_t Agent::execute_request(string &bufferin, string &bufferout, ElapsedTime &received)
+{
+    int32_t iretn = 0;
 
     if (debug_level) {
         debug_log.Printf("Request: [%lu] %s\n",bufferin.size(), &bufferin[0]);
         fflush(stdout);
     }
 
-    string variable;
-    string request;
-    request.resize(AGENTMAXBUFFER+1);
-    for (i=0; i<COSMOS_MAX_NAME; i++) {
-        if (bufferin[i] == ' ' || bufferin[i] == 0)	{
-            break;
-        }
-        request[i] = bufferin[i];
-    }
-    //request[i] = 0;
-    request.resize(i);
+    string request = request_token(bufferin);
+    string token = request;
 
-    bufferout = to_unsigned(centisec(), 10) + " " + mjd2iso8601(currentmjd()) + " " + &bufferin[0] + "\n";
-    if(reqs.find(request) == reqs.end())
+    bufferout = request_header(bufferin);
+    map<string, request_entry>::iterator it = reqs.find(request);
+    if(it == reqs.end())
     {
         iretn = AGENT_ERROR_NULL;
         bufferout += "[NOK] " + std::to_string(iretn);
+        return iretn;
     }
     else
     {
-        request_entry &rentry = reqs[request];
+        request_entry &rentry = it->second;
         iretn = -1;
         if (rentry.efunction != nullptr)
         {
@@ -959,23 +1165,27 @@ int32_t Agent::process_request(string &bufferin, string &bufferout, bool send_re
         }
     }
 
-    if (send_response)
+    record_latency(token, received.split());
+    return iretn;
+}
+
+//! Record request latency
+//! Keep the most recent ::AGENT_LATENCY_SAMPLES latencies for each request token.
+//! \param token Request token.
+//! \param seconds Latency in seconds.
+void Agent::record_latency(const string &token, double seconds)
+{
+    std::lock_guard<mutex> lock(latencies_mutex);
+    request_latency &latency = latencies[token];
+    if (latency.samples.size() < AGENT_LATENCY_SAMPLES)
     {
-        iretn = sendto(cinfo->agent0.req.cudp, bufferout.data(), bufferout.size(), 0, (struct sockaddr *)&cinfo->agent0.req.caddr, sizeof(struct sockaddr_in));
-        if (iretn < 0)
-        {
-            iretn = -errno;
-        }
-        debug_log.Printf("Response: [%d:%s:%x:%u:%d] %s\n", cinfo->agent0.req.cudp, cinfo->agent0.req.address, ntohl(cinfo->agent0.req.caddr.sin_addr.s_addr), cinfo->agent0.req.cport, iretn, &bufferout[0]);
+        latency.samples.push_back(seconds);
     }
     else
     {
-        debug_log.Printf("Response: [%d] %s\n", iretn, &bufferout[0]);
+        latency.samples[latency.count % AGENT_LATENCY_SAMPLES] = seconds;
     }
-
-    process_mutex.unlock();
-
-    return iretn;
+    ++latency.count;
 }
 
 //! Start listening for incoming messages over COSMOS Agent channel.
@@ -983,13 +1193,23 @@ int32_t Agent::process_request(string &bufferin, string &bufferout, bool send_re
 //! Add messages to message ring.
 //! Perform and broadcast requests.
 void Agent::message_loop() {
-    messstruc mess;
+    vector<messstruc> messes;
     int32_t iretn = 0;
     // Initialize things
     //            message_ring.resize(MESSAGE_RING_SIZE);
     while (Agent::running()) {
-        iretn = Agent::poll(mess, AgentMessage::ALL, 0.);
-        if (iretn > 0)
+        // Block until traffic arrives, waking periodically to check running()
+        iretn = Agent::poll(messes, AgentMessage::ALL, AGENTRCVTIMEO / 1e6);
+        if (iretn <= 0)
+        {
+            if (iretn < 0)
+            {
+                secondsleep(AGENTRCVTIMEO / 1e6);
+            }
+            continue;
+        }
+
+        for (messstruc &mess : messes)
         {
             // Don't process if both proc and adata are empty
             if (!mess.meta.beat.proc.compare("") && mess.adata.empty())
@@ -999,30 +1219,13 @@ void Agent::message_loop() {
 
             if (mess.meta.beat.port)
             {
-                bool agent_found = false;
-
-                for (beatstruc &i : agent_list)
-                {
-                    // Have we already seen this realm:node:agent?
-                    if (!i.realm.compare(mess.meta.beat.realm) && !i.node.compare(mess.meta.beat.node) && !i.proc.compare(mess.meta.beat.proc))
-                    {
-                        agent_found = true;
-                        // update all information for the last contact with given (node, agent)...
-                        i = mess.meta.beat;
-                        break;
-                    }
-                }
-
-                if (!agent_found)
-                {
-                    agent_list.push_back(mess.meta.beat);
-                }
+                update_agent(mess.meta.beat);
             }
 
             if (mess.meta.type == AgentMessage::REQUEST && cinfo->agent0.beat.proc.compare(""))
             {
                 string response;
-                process_request(mess.adata, response);
+                process_request(mess.adata, response, false);
                 Agent::post(AgentMessage::RESPONSE, response);
             }
             else if (mess.meta.type == AgentMessage::COMM)
@@ -1047,6 +1250,28 @@ void Agent::message_loop() {
     }
 }
 
+//! Update agent directory
+/*! Record the latest heartbeat of an Agent in Cosmos::Agent::agent_list, adding it if this is the
+ * first time its realm:node:agent has been seen. Lookups go through a hash of the three names, so
+ * the cost does not grow with the number of Agents heard.
+\param beat Heartbeat of the Agent.
+\return Index of the Agent in Cosmos::Agent::agent_list.
+*/
+size_t Agent::update_agent(const beatstruc &beat)
+{
+    string key = beat.realm + ':' + beat.node + ':' + beat.proc;
+    unordered_map<string, size_t>::iterator it = agent_index.find(key);
+    if (it != agent_index.end() && it->second < agent_list.size())
+    {
+        // update all information for the last contact with given (node, agent)...
+        agent_list[it->second] = beat;
+        return it->second;
+    }
+    agent_index[key] = agent_list.size();
+    agent_list.push_back(beat);
+    return agent_list.size() - 1;
+}
+
 //! Built-in Forward request
 /*! Resends the received request, less count bytes, to all Publication channels of the Agent.
  * \param request Text of request.
@@ -1953,7 +2178,7 @@ int32_t Agent::req_soh(string &, string &response, Agent *agent) {
     // Return Namespace 1.0 soh
     if(!agent->sohtable.empty()) {
         string rjstring;
-        response = json_of_table(rjstring, agent->sohtable, agent->cinfo);
+        response = json_of_template(rjstring, agent->sohtemplate, agent->cinfo);
     }
     // Return Namespace 2.0 soh
     else {
@@ -1980,7 +2205,7 @@ int32_t Agent::req_soh(string &, string &response, Agent *agent) {
 
 int32_t Agent::req_fullsoh(string &, string &response, Agent *agent) {
     string rjstring;
-    response = json_of_table(rjstring, agent->fullsohtable, agent->cinfo);
+    response = json_of_template(rjstring, agent->fullsohtemplate, agent->cinfo);
     return 0;
 }
 
@@ -2086,7 +2311,7 @@ int32_t Agent::req_command(string &request, string &response, Agent *agent)
         response = type;
         return GENERAL_ERROR_OUTOFRANGE;
     }
-    packet.header.type = packet.StringType[type];
+    packet.header.type = packet.StringType.at(type);
     packet.header.nodeorig = agent->nodeId;
     packet.header.nodedest = lookup_node_id(agent->cinfo, dest);
     packet.header.chanin = inchannel;
@@ -2944,6 +3169,41 @@ int32_t Agent::req_channel_touch(string &request, string &response, Agent *agent
     return 0;
 }
 
+//! Request latency percentiles
+/*! Report, for each request token or just the one requested, how many times it has been
+ * requested, and the 50th, 90th and 99th percentile and maximum of its most recent latencies.
+ * Latency runs from when the request is received to when its response is ready, so it
+ * includes any time spent waiting behind other requests.
+ * \param request Text of request.
+ * \param response JSON object of latencies in milliseconds, keyed by token.
+ * \param agent Pointer to Cosmos::Agent to use.
+ * \return 0, or negative error.
+ */
+int32_t Agent::req_request_latency(string &request, string &response, Agent *agent)
+{
+    vector<string> args = string_split(request);
+    json11::Json::object jobject;
+    std::lock_guard<mutex> lock(agent->latencies_mutex);
+    for (const auto &latency : agent->latencies)
+    {
+        if (args.size() > 1 && args[1] != latency.first)
+        {
+            continue;
+        }
+        vector<float> samples = latency.second.samples;
+        std::sort(samples.begin(), samples.end());
+        jobject[latency.first] = json11::Json::object {
+            {"count", static_cast<double>(latency.second.count)},
+            {"p50", 1e3 * samples[(samples.size() * 50) / 100]},
+            {"p90", 1e3 * samples[(samples.size() * 90) / 100]},
+            {"p99", 1e3 * samples[(samples.size() * 99) / 100]},
+            {"max", 1e3 * samples.back()},
+        };
+    }
+    response = json11::Json(jobject).dump();
+    return 0;
+}
+
 //! Open COSMOS output channel
 /*! Establish a multicast socket for publishing COSMOS messages using the specified address and
  * port.
@@ -3437,12 +3697,9 @@ int32_t Agent::post(messstruc mess) {
 \param message A NULL terminated JSON text string to post.
 \return 0, otherwise negative error.
 */
-int32_t Agent::post(AgentMessage type, string message)
+int32_t Agent::post(AgentMessage type, const string &message)
 {
-    int32_t iretn = 0;
-    vector<uint8_t> bytes(message.begin(), message.end());
-    iretn = post(type, bytes);
-    return iretn;
+    return post(type, (const uint8_t *)message.data(), message.size());
 }
 
 //! Post a binary message
@@ -3451,7 +3708,19 @@ int32_t Agent::post(AgentMessage type, string message)
 \param message An array of bytes to post.
 \return 0, otherwise negative error.
 */
-int32_t Agent::post(AgentMessage type, vector <uint8_t> message)
+int32_t Agent::post(AgentMessage type, const vector <uint8_t> &message)
+{
+    return post(type, message.data(), message.size());
+}
+
+//! Post a message buffer
+/*! Post bytes directly from the caller's buffer, without copying them first, on the previously opened publication channel.
+\param type A byte indicating the type of message.
+\param message Pointer to the bytes to post.
+\param size Number of bytes to post.
+\return 0, otherwise negative error.
+*/
+int32_t Agent::post(AgentMessage type, const uint8_t *message, size_t size)
 {
     size_t nbytes;
     int32_t iretn=0;
@@ -3482,17 +3751,17 @@ int32_t Agent::post(AgentMessage type, vector <uint8_t> message)
         post[2] = hlength / 256;
         nbytes = hlength + 3;
 
-        if (message.size())
+        if (size)
         {
-            if (nbytes+message.size() > AGENTMAXBUFFER)
+            if (nbytes+size > AGENTMAXBUFFER)
                 return (AGENT_ERROR_BUFLEN);
-            memcpy(&post[nbytes], &message[0], message.size());
+            memcpy(&post[nbytes], message, size);
         }
         if (cinfo->agent0.pub[i].flags & IFF_POINTOPOINT)
         {
             iretn = sendto(cinfo->agent0.pub[i].cudp,       // socket
                            (const char *)post,                         // buffer to send
-                           nbytes+message.size(),                      // size of buffer
+                           nbytes+size,                      // size of buffer
                            0,                                          // flags
                            (struct sockaddr *)&cinfo->agent0.pub[i].caddr, // socket address
                            sizeof(struct sockaddr_in)                  // size of address to socket pointer
@@ -3505,7 +3774,7 @@ int32_t Agent::post(AgentMessage type, vector <uint8_t> message)
             {
                 iretn = sendto(cinfo->agent0.pub[i].cudp,       // socket
                                (const char *)post,                         // buffer to send
-                               nbytes+message.size(),                      // size of buffer
+                               nbytes+size,                      // size of buffer
                                0,                                          // flags
                                (struct sockaddr *)&cinfo->agent0.pub[i].caddr, // socket address
                                sizeof(struct sockaddr_in)                  // size of address to socket pointer
@@ -3517,7 +3786,7 @@ int32_t Agent::post(AgentMessage type, vector <uint8_t> message)
         {
             iretn = sendto(cinfo->agent0.pub[i].cudp,       // socket
                            (const char *)post,                         // buffer to send
-                           nbytes+message.size(),                      // size of buffer
+                           nbytes+size,                      // size of buffer
                            0,                                          // flags
                            (struct sockaddr *)&cinfo->agent0.pub[i].baddr, // socket address
                            sizeof(struct sockaddr_in)                  // size of address to socket pointer
@@ -3566,7 +3835,8 @@ int32_t Agent::post_beat()
 int32_t Agent::post_soh() {
     int32_t iretn = 0;
     cinfo->agent0.beat.utc = currentmjd(0.);
-    iretn = post(AgentMessage::SOH, json_of_table(hbjstring, sohtable, (cosmosstruc *)cinfo));
+    json_of_template(hbjstring, sohtemplate, cinfo);
+    iretn = post(AgentMessage::SOH, hbjstring);
     return iretn;
 }
 
@@ -3636,6 +3906,7 @@ int32_t Agent::unsubscribe() {
 int32_t Agent::poll(messstruc &mess, AgentMessage type, float waitsec)
 {
     int nbytes;
+    int32_t iretn;
     uint8_t input[AGENTMAXBUFFER+1];
 
     if (cinfo == nullptr) {
@@ -3646,24 +3917,6 @@ int32_t Agent::poll(messstruc &mess, AgentMessage type, float waitsec)
         return (AGENT_ERROR_CHANNEL);
     }
 
-    // Clear out message
-    mess.meta.beat.addr[0] = 0;
-    mess.meta.beat.bprd = 0;
-    mess.meta.beat.bsz = 0;
-    mess.meta.beat.cpu = 0;
-    mess.meta.beat.exists = false;
-    mess.meta.beat.jitter = 0;
-    mess.meta.beat.dcycle = 0;
-    mess.meta.beat.memory = 0;
-    mess.meta.beat.ntype = NetworkType::BROADCAST;
-    mess.meta.beat.port = 0;
-    mess.meta.beat.user[0] = 0;
-    mess.meta.beat.utc = 0;
-    mess.meta.beat.node.clear();
-    mess.meta.beat.proc.clear();
-
-    //        memset(&mess.meta.beat, 0, COSMOS_SIZEOF(beatstruc));
-
     ElapsedTime ep;
     ep.start();
     do
@@ -3685,21 +3938,12 @@ int32_t Agent::poll(messstruc &mess, AgentMessage type, float waitsec)
             if (cinfo->agent0.sub.addrlen == sizeof(cinfo->agent0.sub.caddr))
             {
                 inet_ntop(cinfo->agent0.sub.caddr.sin_family,&(cinfo->agent0.sub.caddr.sin_addr),cinfo->agent0.sub.address,sizeof(cinfo->agent0.sub.address));
-                //                            debug_log.Printf("RECVFROM: [%s %u] %u %d \n", cinfo->agent0.sub.address, htons(cinfo->agent0.sub.caddr.sin_port), input[0], nbytes);
             }
-            //                        else
-            //                        {
-            //                            debug_log.Printf("RECVFROM: [Unknown 0] %u %d \n", input[0], nbytes);
-            //                        }
 
             // Return if port and address are our own
-            for (uint16_t i=1; i<cinfo->agent0.ifcnt; ++i)
+            if (own_address(cinfo->agent0.sub.caddr))
             {
-                if (cinfo->agent0.sub.caddr.sin_port == ntohs(cinfo->agent0.pub[i].cport) &&
-                    cinfo->agent0.sub.caddr.sin_addr.s_addr == cinfo->agent0.pub[i].caddr.sin_addr.s_addr)
-                {
-                    return 0;
-                }
+                return 0;
             }
         }
         break;
@@ -3707,117 +3951,307 @@ int32_t Agent::poll(messstruc &mess, AgentMessage type, float waitsec)
             break;
         }
 
-        if (nbytes > 0)
+        if ((iretn = unpack_message(mess, input, nbytes, type)) > 0)
+        {
+            return iretn;
+        }
+        else if (iretn == JSON_ERROR_NOENTRY)
+        {
+            // Not a heartbeat carrying message, so go straight on to the next datagram
+            continue;
+        }
+        if (ep.split() >= waitsec) {
+            nbytes = 0;
+        } else {
+            secondsleep(.1);
+        }
+    } while (nbytes != 0);
+
+    return 0;
+}
+
+//! Listen for a batch of messages
+/*! Block on the subscription channel for up to the requested amount of time, then drain every
+ * datagram already queued on it, up to ::AGENT_POLL_BATCH at a time. Unlike the single message
+ * version, this never spins: an idle channel costs one sleeping system call per timeout.
+ * Under Linux the queue is drained with a single recvmmsg() call.
+\param messes Vector of Cosmos::Agent::messstruc, resized to the number of messages received.
+\param type Type of message to look for, taken from Cosmos::Agent::AgentMessage.
+\param waitsec Maximum number of seconds to wait for the first message.
+\return Number of messages received, otherwise negative error.
+*/
+int32_t Agent::poll(vector<messstruc> &messes, AgentMessage type, float waitsec)
+{
+    int32_t iretn;
+
+    if (cinfo == nullptr) {
+        return AGENT_ERROR_NULL;
+    }
+
+    if (!cinfo->agent0.sub.cport) {
+        return (AGENT_ERROR_CHANNEL);
+    }
+
+    messes.resize(AGENT_POLL_BATCH);
+    size_t count = 0;
+    switch (cinfo->agent0.sub.type)
+    {
+    case NetworkType::MULTICAST:
+    case NetworkType::UDP:
+#if !defined(COSMOS_WIN_OS)
+    {
+        // Sleep in the kernel until something arrives
+        struct pollfd pfd;
+        pfd.fd = cinfo->agent0.sub.cudp;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        iretn = ::poll(&pfd, 1, static_cast<int>(1000. * waitsec));
+        if (iretn < 0)
         {
-            if (type == Agent::AgentMessage::ALL || type == (AgentMessage)input[0])
+            messes.clear();
+            return errno == EINTR ? 0 : -errno;
+        }
+        if (iretn == 0)
+        {
+            break;
+        }
+#if defined(COSMOS_LINUX_OS)
+        if (poll_buffer.size() < AGENT_POLL_BATCH * (AGENTMAXBUFFER + 1))
+        {
+            poll_buffer.resize(AGENT_POLL_BATCH * (AGENTMAXBUFFER + 1));
+        }
+        struct mmsghdr msgs[AGENT_POLL_BATCH];
+        struct iovec iovecs[AGENT_POLL_BATCH];
+        struct sockaddr_in addrs[AGENT_POLL_BATCH];
+        memset(msgs, 0, sizeof(msgs));
+        for (size_t i=0; i<AGENT_POLL_BATCH; ++i)
+        {
+            iovecs[i].iov_base = &poll_buffer[i * (AGENTMAXBUFFER + 1)];
+            iovecs[i].iov_len = AGENTMAXBUFFER;
+            msgs[i].msg_hdr.msg_iov = &iovecs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+            msgs[i].msg_hdr.msg_name = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+        }
+        iretn = recvmmsg(cinfo->agent0.sub.cudp, msgs, AGENT_POLL_BATCH, MSG_DONTWAIT, nullptr);
+        if (iretn < 0)
+        {
+            messes.clear();
+            return (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0 : -errno;
+        }
+        for (int32_t i=0; i<iretn; ++i)
+        {
+            if (msgs[i].msg_hdr.msg_namelen == sizeof(addrs[i]))
             {
-                // Determine if old or new message
-                uint8_t start_byte;
-                if (input[1] == '{')
-                {
-                    start_byte = 1;
-                }
-                else
-                {
-                    start_byte = 3;
-                }
-                // Provide support for older messages that did not include jlength
-                if (start_byte > 1)
-                {
-                    mess.meta.type = (AgentMessage)input[0];
-                    mess.meta.jlength = input[1] + 256 * input[2];
-                }
-                else
+                cinfo->agent0.sub.caddr = addrs[i];
+                inet_ntop(addrs[i].sin_family, &(addrs[i].sin_addr), cinfo->agent0.sub.address, sizeof(cinfo->agent0.sub.address));
+                if (own_address(addrs[i]))
                 {
-                    mess.meta.type = (AgentMessage)(input[0] + 1);
-                    mess.meta.jlength = nbytes;
+                    continue;
                 }
+            }
+            if (unpack_message(messes[count], &poll_buffer[i * (AGENTMAXBUFFER + 1)], msgs[i].msg_len, type) > 0)
+            {
+                ++count;
+            }
+        }
+#else
+        // Drain without blocking once the socket is known to be readable
+        for (size_t i=0; i<AGENT_POLL_BATCH; ++i)
+        {
+            pfd.revents = 0;
+            if (i && ::poll(&pfd, 1, 0) <= 0)
+            {
+                break;
+            }
+            if ((iretn = poll(messes[count], type, 0.)) < 0)
+            {
+                break;
+            }
+            if (iretn > 0)
+            {
+                ++count;
+            }
+        }
+#endif
+    }
+    break;
+#endif
+    default:
+        if ((iretn = poll(messes[0], type, waitsec)) < 0)
+        {
+            messes.clear();
+            return iretn;
+        }
+        if (iretn > 0)
+        {
+            ++count;
+        }
+        break;
+    }
 
-                // Copy message parts to ring, placing in appropriate buffers.
-                // First: JSON header
-                mess.jdata.assign((const char *)&input[start_byte], mess.meta.jlength);
+    messes.resize(count);
+    return count;
+}
 
-                // Next: ASCII or BINARY message, depending on message type.
-                if (mess.meta.type < Agent::AgentMessage::BINARY)
-                {
-                    mess.adata.clear();
-                    mess.adata.assign((const char *)&input[start_byte+mess.meta.jlength], nbytes - (start_byte + mess.meta.jlength));
-                }
-                else
-                {
-                    mess.bdata.resize(nbytes - (start_byte + mess.meta.jlength));
-                    memcpy(mess.bdata.data(), &input[start_byte + mess.meta.jlength], nbytes - (start_byte + mess.meta.jlength));
-                }
+//! Is this our own message
+/*! Check whether a datagram came from one of this Agent's own publication ports.
+\param addr Source address of the datagram.
+\return True if the address and port are one of our own publication channels.
+*/
+bool Agent::own_address(const struct sockaddr_in &addr)
+{
+    for (uint16_t i=1; i<cinfo->agent0.ifcnt; ++i)
+    {
+        if (addr.sin_port == ntohs(cinfo->agent0.pub[i].cport) &&
+            addr.sin_addr.s_addr == cinfo->agent0.pub[i].caddr.sin_addr.s_addr)
+        {
+            return true;
+        }
+    }
+    return false;
+}
 
-                // Extract meta data
-                if (mess.jdata.find("}{") == string::npos)
-                {
-                    string estring;
-                    json11::Json jargs = json11::Json::parse(mess.jdata, estring);
-                    if (!jargs["agent_utc"].is_null())
-                    {
-                        mess.meta.beat.utc = jargs["agent_utc"].number_value();
-                    }
-                    else
-                    {
-                        continue;
-                    }
-                    if (!jargs["agent_realm"].is_null())
-                    {
-                        string realm = jargs["agent_realm"].string_value();
-                        if (!realm.empty())
-                        {
-                            mess.meta.beat.realm = realm;
-                        }
-                    }
-                    if (!jargs["agent_node"].is_null())
-                    {
-                        string node = jargs["agent_node"].string_value();
-                        if (!node.empty())
-                        {
-                            mess.meta.beat.node = node;
-                        }
-                    }
-                    if (!jargs["agent_proc"].is_null())
-                    {
-                        string proc = jargs["agent_proc"].string_value();
-                        if (!proc.empty())
-                        {
-                            mess.meta.beat.proc = proc;
-                        }
-                    }
-                    if (!jargs["agent_addr"].is_null())
-                    {
-                        string addr = jargs["agent_addr"].string_value();
-                        if (!addr.empty())
-                        {
-                            strncpy(mess.meta.beat.addr, addr.c_str(), 17);
-                        }
-                    }
-                    if (!jargs["agent_port"].is_null())
-                    {
-                        mess.meta.beat.port = jargs["agent_port"].number_value();
-                    }
-                    if (!jargs["agent_bprd"].is_null())
-                    {
-                        mess.meta.beat.bprd = jargs["agent_bprd"].number_value();
-                    }
-                    if (!jargs["agent_bsz"].is_null())
-                    {
-                        mess.meta.beat.bsz = jargs["agent_bsz"].number_value();
-                    }
-                    if (!jargs["agent_cpu"].is_null())
-                    {
-                        mess.meta.beat.cpu = jargs["agent_cpu"].number_value();
-                    }
-                    if (!jargs["agent_memory"].is_null())
-                    {
-                        mess.meta.beat.memory = jargs["agent_memory"].number_value();
-                    }
-                    if (!jargs["agent_jitter"].is_null())
-                    {
-                        mess.meta.beat.jitter = jargs["agent_jitter"].number_value();
-                    }
+//! Unpack message
+/*! Decode a single datagram from the subscription channel into its header, JSON metadata and data
+ * parts.
+\param mess Cosmos::Agent::messstruc for storing the decoded message.
+\param input Raw datagram.
+\param nbytes Size of datagram.
+\param type Type of message to look for, taken from Cosmos::Agent::AgentMessage.
+\return The message type if it is of the requested type and not from this Agent,
+::JSON_ERROR_NOENTRY if its JSON metadata carries no agent_utc, otherwise zero.
+*/
+int32_t Agent::unpack_message(messstruc &mess, const uint8_t *input, int32_t nbytes, AgentMessage type)
+{
+    if (nbytes <= 0 || !(type == Agent::AgentMessage::ALL || type == (AgentMessage)input[0]))
+    {
+        return 0;
+    }
+
+    // Clear out message
+    mess.meta.beat.addr[0] = 0;
+    mess.meta.beat.bprd = 0;
+    mess.meta.beat.bsz = 0;
+    mess.meta.beat.cpu = 0;
+    mess.meta.beat.exists = false;
+    mess.meta.beat.jitter = 0;
+    mess.meta.beat.dcycle = 0;
+    mess.meta.beat.memory = 0;
+    mess.meta.beat.ntype = NetworkType::BROADCAST;
+    mess.meta.beat.port = 0;
+    mess.meta.beat.user[0] = 0;
+    mess.meta.beat.utc = 0;
+    mess.meta.beat.node.clear();
+    mess.meta.beat.proc.clear();
+
+    // Determine if old or new message
+    uint8_t start_byte;
+    if (input[1] == '{')
+    {
+        start_byte = 1;
+    }
+    else
+    {
+        start_byte = 3;
+    }
+    // Provide support for older messages that did not include jlength
+    if (start_byte > 1)
+    {
+        mess.meta.type = (AgentMessage)input[0];
+        mess.meta.jlength = input[1] + 256 * input[2];
+    }
+    else
+    {
+        mess.meta.type = (AgentMessage)(input[0] + 1);
+        mess.meta.jlength = nbytes;
+    }
+
+    // Copy message parts to ring, placing in appropriate buffers.
+    // First: JSON header
+    mess.jdata.assign((const char *)&input[start_byte], mess.meta.jlength);
+
+    // Next: ASCII or BINARY message, depending on message type.
+    if (mess.meta.type < Agent::AgentMessage::BINARY)
+    {
+        mess.adata.clear();
+        mess.adata.assign((const char *)&input[start_byte+mess.meta.jlength], nbytes - (start_byte + mess.meta.jlength));
+    }
+    else
+    {
+        mess.bdata.resize(nbytes - (start_byte + mess.meta.jlength));
+        memcpy(mess.bdata.data(), &input[start_byte + mess.meta.jlength], nbytes - (start_byte + mess.meta.jlength));
+    }
+
+    // Extract meta data
+    if (mess.jdata.find("}{") == string::npos)
+    {
+        string estring;
+        json11::Json jargs = json11::Json::parse(mess.jdata, estring);
+        if (!jargs["agent_utc"].is_null())
+        {
+            mess.meta.beat.utc = jargs["agent_utc"].number_value();
+        }
+        else
+        {
+            return JSON_ERROR_NOENTRY;
+        }
+        if (!jargs["agent_realm"].is_null())
+        {
+            string realm = jargs["agent_realm"].string_value();
+            if (!realm.empty())
+            {
+                mess.meta.beat.realm = realm;
+            }
+        }
+        if (!jargs["agent_node"].is_null())
+        {
+            string node = jargs["agent_node"].string_value();
+            if (!node.empty())
+            {
+                mess.meta.beat.node = node;
+            }
+        }
+        if (!jargs["agent_proc"].is_null())
+        {
+            string proc = jargs["agent_proc"].string_value();
+            if (!proc.empty())
+            {
+                mess.meta.beat.proc = proc;
+            }
+        }
+        if (!jargs["agent_addr"].is_null())
+        {
+            string addr = jargs["agent_addr"].string_value();
+            if (!addr.empty())
+            {
+                strncpy(mess.meta.beat.addr, addr.c_str(), 17);
+            }
+        }
+        if (!jargs["agent_port"].is_null())
+        {
+            mess.meta.beat.port = jargs["agent_port"].number_value();
+        }
+        if (!jargs["agent_bprd"].is_null())
+        {
+            mess.meta.beat.bprd = jargs["agent_bprd"].number_value();
+        }
+        if (!jargs["agent_bsz"].is_null())
+        {
+            mess.meta.beat.bsz = jargs["agent_bsz"].number_value();
+        }
+        if (!jargs["agent_cpu"].is_null())
+        {
+            mess.meta.beat.cpu = jargs["agent_cpu"].number_value();
+        }
+        if (!jargs["agent_memory"].is_null())
+        {
+            mess.meta.beat.memory = jargs["agent_memory"].number_value();
+        }
+        if (!jargs["agent_jitter"].is_null())
+        {
+            mess.meta.beat.jitter = jargs["agent_jitter"].number_value();
+        }
 //                    char node[COSMOS_MAX_NAME+1] = {};
 //                    char proc[COSMOS_MAX_NAME+1] = {};
 //                    sscanf((const char *)mess.jdata.data(), "{\"agent_utc\":%lg,\"agent_node\":\"%40[^\"]\",\"agent_proc\":\"%40[^\"]\",\"agent_addr\":\"%17[^\"]\",\"agent_port\":%hu,\"agent_bprd\":%lf,\"agent_bsz\":%u,\"agent_cpu\":%f,\"agent_memory\":%f,\"agent_jitter\":%lf}",
@@ -3839,67 +4273,58 @@ int32_t Agent::poll(messstruc &mess, AgentMessage type, float waitsec)
 //                    {
 //                        mess.meta.beat.proc = proc;
 //                    }
-                }
-                else if (mess.jdata.find("agent_bprd") == string::npos)
-                {
-                    char node[COSMOS_MAX_NAME+1] = {};
-                    char proc[COSMOS_MAX_NAME+1] = {};
-                    sscanf((const char *)mess.jdata.data(), "{\"agent_utc\":%lg}{\"agent_node\":\"%40[^\"]\"}{\"agent_proc\":\"%40[^\"]\"}{\"agent_addr\":\"%17[^\"]\"}{\"agent_port\":%hu}{\"agent_bsz\":%u}{\"agent_cpu\":%f}{\"agent_memory\":%f}{\"agent_jitter\":%lf}",
-                           &mess.meta.beat.utc,
-                           node,
-                           proc,
-                           mess.meta.beat.addr,
-                           &mess.meta.beat.port,
-                           &mess.meta.beat.bsz,
-                           &mess.meta.beat.cpu,
-                           &mess.meta.beat.memory,
-                           &mess.meta.beat.jitter);
-                    if(node[0] != '\0')
-                    {
-                        mess.meta.beat.node = node;
-                    }
-                    if(proc[0] != '\0')
-                    {
-                        mess.meta.beat.proc = proc;
-                    }
-                }
-                else
-                {
-                    char node[COSMOS_MAX_NAME+1] = {};
-                    char proc[COSMOS_MAX_NAME+1] = {};
-                    sscanf((const char *)mess.jdata.data(), "{\"agent_utc\":%lg}{\"agent_node\":\"%40[^\"]\"}{\"agent_proc\":\"%40[^\"]\"}{\"agent_addr\":\"%17[^\"]\"}{\"agent_port\":%hu}{\"agent_bprd\":%lf}{\"agent_bsz\":%u}{\"agent_cpu\":%f}{\"agent_memory\":%f}{\"agent_jitter\":%lf}",
-                           &mess.meta.beat.utc,
-                           node,
-                           proc,
-                           mess.meta.beat.addr,
-                           &mess.meta.beat.port,
-                           &mess.meta.beat.bprd,
-                           &mess.meta.beat.bsz,
-                           &mess.meta.beat.cpu,
-                           &mess.meta.beat.memory,
-                           &mess.meta.beat.jitter);
-                    if(node[0] != '\0')
-                    {
-                        mess.meta.beat.node = node;
-                    }
-                    if(proc[0] != '\0')
-                    {
-                        mess.meta.beat.proc = proc;
-                    }
-                }
-                if (mess.meta.beat.node.compare(cinfo->agent0.beat.node) || mess.meta.beat.proc.compare(cinfo->agent0.beat.proc))
-                {
-                    return ((int)mess.meta.type);
-                }
-            }
+    }
+    else if (mess.jdata.find("agent_bprd") == string::npos)
+    {
+        char node[COSMOS_MAX_NAME+1] = {};
+        char proc[COSMOS_MAX_NAME+1] = {};
+        sscanf((const char *)mess.jdata.data(), "{\"agent_utc\":%lg}{\"agent_node\":\"%40[^\"]\"}{\"agent_proc\":\"%40[^\"]\"}{\"agent_addr\":\"%17[^\"]\"}{\"agent_port\":%hu}{\"agent_bsz\":%u}{\"agent_cpu\":%f}{\"agent_memory\":%f}{\"agent_jitter\":%lf}",
+               &mess.meta.beat.utc,
+               node,
+               proc,
+               mess.meta.beat.addr,
+               &mess.meta.beat.port,
+               &mess.meta.beat.bsz,
+               &mess.meta.beat.cpu,
+               &mess.meta.beat.memory,
+               &mess.meta.beat.jitter);
+        if(node[0] != '\0')
+        {
+            mess.meta.beat.node = node;
         }
-        if (ep.split() >= waitsec) {
-            nbytes = 0;
-        } else {
-            secondsleep(.1);
+        if(proc[0] != '\0')
+        {
+            mess.meta.beat.proc = proc;
         }
-    } while (nbytes != 0);
-
+    }
+    else
+    {
+        char node[COSMOS_MAX_NAME+1] = {};
+        char proc[COSMOS_MAX_NAME+1] = {};
+        sscanf((const char *)mess.jdata.data(), "{\"agent_utc\":%lg}{\"agent_node\":\"%40[^\"]\"}{\"agent_proc\":\"%40[^\"]\"}{\"agent_addr\":\"%17[^\"]\"}{\"agent_port\":%hu}{\"agent_bprd\":%lf}{\"agent_bsz\":%u}{\"agent_cpu\":%f}{\"agent_memory\":%f}{\"agent_jitter\":%lf}",
+               &mess.meta.beat.utc,
+               node,
+               proc,
+               mess.meta.beat.addr,
+               &mess.meta.beat.port,
+               &mess.meta.beat.bprd,
+               &mess.meta.beat.bsz,
+               &mess.meta.beat.cpu,
+               &mess.meta.beat.memory,
+               &mess.meta.beat.jitter);
+        if(node[0] != '\0')
+        {
+            mess.meta.beat.node = node;
+        }
+        if(proc[0] != '\0')
+        {
+            mess.meta.beat.proc = proc;
+        }
+    }
+    if (mess.meta.beat.node.compare(cinfo->agent0.beat.node) || mess.meta.beat.proc.compare(cinfo->agent0.beat.proc))
+    {
+        return ((int)mess.meta.type);
+    }
     return 0;
 }
 
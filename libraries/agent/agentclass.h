@@ -161,6 +161,9 @@ namespace Cosmos
             //! State of Health element vector
             vector<jsonentry*> sohtable;
             vector<jsonentry*> fullsohtable;
+            //! State of Health tables compiled for output
+            jsontemplate sohtemplate;
+            jsontemplate fullsohtemplate;
 			vector<string> sohstring;
 
             enum class State : uint16_t {
@@ -221,6 +224,18 @@ namespace Cosmos
             //! Default size of message ring buffer
 #define MESSAGE_RING_SIZE 10000
 
+            //! Maximum number of datagrams drained from the subscription channel in one batch
+#define AGENT_POLL_BATCH 32
+
+            //! Default number of worker threads for concurrent requests
+#define AGENT_REQUEST_THREADS 4
+
+            //! Default maximum number of concurrent requests waiting for a worker
+#define AGENT_REQUEST_QUEUE 1000
+
+            //! Number of latency samples kept for each request token
+#define AGENT_LATENCY_SAMPLES 1000
+
             //! Type of Agent Message. Types > 127 are binary.
             enum class AgentMessage : uint8_t {
                 //! All Message types
@@ -305,7 +320,10 @@ namespace Cosmos
             int32_t start();
             int32_t start_active_loop();
             int32_t finish_active_loop();
-            int32_t add_request(string token, external_request_function function, string synopsis="", string description="");
+            double get_activeTimeout();
+            int32_t add_request(string token, external_request_function function, string synopsis="", string description="", bool concurrent=false, double deadline=0.);
+            int32_t set_request_threads(uint16_t count);
+            int32_t set_request_queue(uint32_t count);
 //            int32_t add_request(string token, simple_request_function function, string synopsis="", string description="");
 //            int32_t add_request(string token, no_arg_request_function function, string synopsis="", string description="");
             int32_t send_request(beatstruc cbeat, string request, string &output, float waitsec=5., double delay_send = 0.0, double delay_receive = 0.0);
@@ -326,8 +344,8 @@ namespace Cosmos
             void get_ip_list(uint16_t port);
             int32_t unpublish();
             int32_t post(messstruc mess);
-            int32_t post(AgentMessage type, string message="");
-            int32_t post(AgentMessage type, vector <uint8_t> message);
+            int32_t post(AgentMessage type, const string &message="");
+            int32_t post(AgentMessage type, const vector <uint8_t> &message);
             int32_t post_beat();
             int32_t post_soh();
             int32_t publish(NetworkType type, uint16_t port);
@@ -337,6 +355,7 @@ namespace Cosmos
             //    int32_t poll(pollstruc &meta, string &message, uint8_t type, float waitsec = 1.);
             //    int32_t poll(pollstruc &meta, vector <uint8_t> &message, uint8_t type, float waitsec = 1.);
             int32_t poll(messstruc &mess, AgentMessage type, float waitsec = 1.);
+            int32_t poll(vector<messstruc> &messes, AgentMessage type, float waitsec = 1.);
             int32_t readring(messstruc &message, AgentMessage type = Agent::AgentMessage::ALL, float waitsec = 1., Where where=Where::TAIL, string proc="", string node="");
             int32_t readring(messstruc &message, string realm="", string node="", AgentMessage type = Agent::AgentMessage::ALL, float waitsec = 1., Where where=Where::TAIL);
             int32_t readring(messstruc &message, vector<string> realm, AgentMessage type = Agent::AgentMessage::ALL, float waitsec = 1., Where where=Where::TAIL);
@@ -522,6 +541,7 @@ namespace Cosmos
             bool logTime = true; // by default
             double timeStart; // UTC starting time for this agent in MJD
             string hbjstring;
+            int32_t post(AgentMessage type, const uint8_t *message, size_t size);
             //! Handle for request thread
             thread cthread;
             //! Handle for heartbeat thread
@@ -550,13 +570,56 @@ namespace Cosmos
 //                no_arg_request_function nafunction;
                 string synopsis;
                 string description;
+                //! Safe to run alongside other requests, in the worker pool
+                bool concurrent = false;
+                //! Seconds a concurrent request may wait for a worker before being refused, or 0 for no limit
+                double deadline = 0.;
+            };
+
+            //! Concurrent request waiting for a worker
+            struct request_job
+            {
+                string bufferin;
+                struct sockaddr_in caddr;
+                ElapsedTime received;
+                double deadline;
+            };
+
+            //! Recent latencies for one request token
+            struct request_latency
+            {
+                uint64_t count = 0;
+                vector<float> samples;
             };
 
             map<string, request_entry> reqs;
 
             void heartbeat_loop();
             void request_loop() noexcept;
+            void request_worker();
+            int32_t execute_request(string &bufferin, string &bufferout, ElapsedTime &received);
+            void record_latency(const string &token, double seconds);
+
+            //! Concurrent request worker pool
+            vector<thread> request_workers;
+            uint16_t request_thread_count = AGENT_REQUEST_THREADS;
+            uint32_t request_queue_size = AGENT_REQUEST_QUEUE;
+            deque<request_job> request_jobs;
+            mutex request_jobs_mutex;
+            std::condition_variable request_jobs_cv;
+            bool request_workers_stop = false;
+            //! Request latencies, keyed by token
+            map<string, request_latency> latencies;
+            mutex latencies_mutex;
             void message_loop();
+            size_t update_agent(const beatstruc &beat);
+            bool own_address(const struct sockaddr_in &addr);
+            int32_t unpack_message(messstruc &mess, const uint8_t *input, int32_t nbytes, AgentMessage type);
+
+            //! Index into agent_list, keyed by realm:node:agent
+            unordered_map<string, size_t> agent_index;
+            //! Receive buffers for batched poll(), used only by the message thread
+            vector<uint8_t> poll_buffer;
 
             char* parse_request(char *input);
             DeviceCpu deviceCpu_;
@@ -610,6 +673,7 @@ namespace Cosmos
             static int32_t req_test_channel(string &, string &response, Agent *agent);
             static int32_t req_channel_enable(string &, string &response, Agent *agent);
             static int32_t req_channel_touch(string &, string &response, Agent *agent);
+            static int32_t req_request_latency(string &request, string &response, Agent *agent);
         };
     } // end of namespace Support
 } // end of namespace Cosmos
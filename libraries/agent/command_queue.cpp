@@ -123,12 +123,14 @@ namespace Cosmos
             return 0;
         }
 
-        //!	Traverse the entire queue of Events, and run those which qualify.
+        //!	Run the Events in the queue which qualify.
         /*!
 
         An %Event only qualifies to run if the current time is greater than or equal to
         the execution time of the %Event.  Further, if the %Event is conditional, then the
-        %Event condition must be true.
+        %Event condition must be true. The clock is read once, and only the Events that are
+        due are looked at. Every due %Event without a condition is run, then conditions are
+        tested in order, and the first that is true is run.
 
             \param	agent	Pointer to Agent object (for call to condition_true(..))
             \param	nodename	Name of the node
@@ -136,114 +138,161 @@ namespace Cosmos
         */
         int32_t CommandQueue::run_commands(Agent *agent, string node_name, double logdate_exec)
         {
-            for(std::list<Event>::iterator ii = commands.begin(); ii != commands.end(); ++ii)
+            vector<Event> due;
             {
-                // if command is not solo
-                if (!ii->is_solo() && !queue_blocked)
+                std::lock_guard<std::recursive_mutex> lock(mtx);
+                double mjd = currentmjd(0.);
+
+                // Events whose time has come are run, or held for their condition
+                while (!commands.empty() && commands.begin()->first <= mjd)
                 {
-                    if (ii->is_solo())
+                    Event &cmd = commands.begin()->second;
+                    if (cmd.is_conditional() || cmd.is_solo())
                     {
-                        queue_blocked = true;
+                        std::list<Event>::iterator ii = conditions.end();
+                        while (ii != conditions.begin() && std::prev(ii)->mjd > cmd.mjd)
+                        {
+                            --ii;
+                        }
+                        conditions.insert(ii, cmd);
                     }
                     else
                     {
-                        queue_blocked = false;
+                        due.push_back(cmd);
+                    }
+                    erase_command(commands.begin());
+                }
+
+                // Solo Events are held, but nothing runs them yet
+                cosmosstruc *cinfo = agent != nullptr ? agent->cinfo : nullptr;
+                for (std::list<Event>::iterator ii = conditions.begin(); ii != conditions.end(); ++ii)
+                {
+                    if (ii->is_solo())
+                    {
+                        continue;
                     }
-                    // if command is ready
-                    if (ii->is_ready())
+                    // if command condition is true
+                    if (ii->condition_true(cinfo))
                     {
-                        // if command is conditional
-                        if (ii->is_conditional())
+                        // if command is repeatable
+                        if (ii->is_repeat())
                         {
-                            // if command condition is true
-                            if(ii->condition_true(agent->cinfo))
+                            // if command has not already run
+                            if (!ii->is_alreadyrun())
                             {
-                                // if command is repeatable
-                                if(ii->is_repeat())
-                                {
-                                    // if command has not already run
-                                    //                                    if(!ii->already_ran)
-                                    if (!ii->is_alreadyrun())
-                                    {
-                                        //                                        strncpy(agent->cinfo->node.lastevent, ii->name.c_str(), COSMOS_MAX_NAME);
-                                        agent->cinfo->node.lastevent = ii->name;
-                                        agent->cinfo->node.lasteventutc = currentmjd();
-                                        if (ii->type == EVENT_TYPE_COMMAND)
-                                        {
-                                            run_command(agent, *ii, node_name, logdate_exec);
-                                            logdate_exec += 1./864000.;
-                                        }
-                                        else if (ii->type == EVENT_TYPE_REQUEST)
-                                        {
-                                            run_request(agent, *ii, node_name, logdate_exec);
-                                            logdate_exec += 1./864000.;
-                                        }
-                                        ii->set_alreadyrun(true);
-                                        events.push_back(*ii);
-                                        if (events.size() > 10)
-                                        {
-                                            events.pop_front();
-                                        }
-                                        //                                        ii->already_ran = true;
-                                        break;
-                                    }
-                                }
-                                // else command is non-repeatable
-                                else
-                                {
-                                    if (ii->type == EVENT_TYPE_COMMAND)
-                                    {
-                                        run_command(agent, *ii, node_name, logdate_exec);
-                                        logdate_exec += 1./864000.;
-                                    }
-                                    else if (ii->type == EVENT_TYPE_REQUEST)
-                                    {
-                                        run_request(agent, *ii, node_name, logdate_exec);
-                                        logdate_exec += 1./864000.;
-                                    }
-                                    events.push_back(*ii);
-                                    if (events.size() > 10)
-                                    {
-                                        events.pop_front();
-                                    }
-                                    commands.erase(ii--);
-                                    break;
-                                }
-                            }
-                            // else command condition is false
-                            else
-                            {
-                                ii->set_alreadyrun(false);
+                                cinfo->node.lastevent = ii->name;
+                                cinfo->node.lasteventutc = currentmjd();
+                                ii->set_alreadyrun(true);
+                                due.push_back(*ii);
+                                break;
                             }
                         }
-                        // else command is non-conditional
+                        // else command is non-repeatable
                         else
                         {
-                            if (ii->type == EVENT_TYPE_COMMAND)
-                            {
-                                run_command(agent, *ii, node_name, logdate_exec);
-                                logdate_exec += 1./864000.;
-                            }
-                            else if (ii->type == EVENT_TYPE_REQUEST)
-                            {
-                                run_request(agent, *ii, node_name, logdate_exec);
-                                logdate_exec += 1./864000.;
-                            }
-                            events.push_back(*ii);
-                            if (events.size() > 10)
-                            {
-                                events.pop_front();
-                            }
-                            commands.erase(ii--);
+                            due.push_back(*ii);
+                            conditions.erase(ii);
+                            break;
                         }
                     }
+                    // else command condition is false
+                    else
+                    {
+                        ii->set_alreadyrun(false);
+                    }
                 }
-                else
+            }
+
+            // Run them without holding the queue, as a request may add or remove Events
+            for (Event &cmd : due)
+            {
+                if (cmd.type == EVENT_TYPE_COMMAND)
+                {
+                    run_command(agent, cmd, node_name, logdate_exec);
+                    logdate_exec += 1./864000.;
+                }
+                else if (cmd.type == EVENT_TYPE_REQUEST)
+                {
+                    run_request(agent, cmd, node_name, logdate_exec);
+                    logdate_exec += 1./864000.;
+                }
+                record_event(cmd);
+            }
+            return static_cast<int32_t>(get_command_size());
+        }
+
+        //!	Time the next Event falls due
+        /*!
+            \return	Event::mjd of the first Event waiting for its time, or 0. if there are none
+        */
+        double CommandQueue::get_next_mjd()
+        {
+            std::lock_guard<std::recursive_mutex> lock(mtx);
+            return commands.empty() ? 0. : commands.begin()->first;
+        }
+
+        //!	Wait for the next Event to fall due
+        /*!
+            Sleeps until the first Event waiting for its time is due, an Event is added, or
+            the given time, whichever is first.
+
+            \param	until	Latest time to wait until (Modified Julian Date)
+            \return	True if an Event is due, otherwise false
+        */
+        bool CommandQueue::wait_commands(double until)
+        {
+            std::unique_lock<std::recursive_mutex> lock(mtx);
+            double mjd;
+            while ((mjd = currentmjd(0.)) < until)
+            {
+                if (!commands.empty() && commands.begin()->first <= mjd)
                 {
-                    ;//cout<<"This command is *NOT* ready to run! ";
+                    return true;
                 }
+                double next = commands.empty() ? until : std::min(until, commands.begin()->first);
+                if (added.wait_for(lock, std::chrono::microseconds(static_cast<int64_t>(ceil((next - mjd) * 86400e6)))) == std::cv_status::no_timeout)
+                {
+                    // Something was added, so look again
+                    return !commands.empty() && commands.begin()->first <= currentmjd(0.);
+                }
+            }
+            return !commands.empty() && commands.begin()->first <= currentmjd(0.);
+        }
+
+        //!	Retrieve an Event by its position in the queue, with the queue held
+        Event &CommandQueue::command_at(size_t i)
+        {
+            if (i < conditions.size())
+            {
+                std::list<Event>::iterator ii = conditions.begin();
+                std::advance(ii, i);
+                return *ii;
+            }
+            std::multimap<double, Event>::iterator ii = commands.begin();
+            std::advance(ii, i - conditions.size());
+            return ii->second;
+        }
+
+        //!	Remove an Event waiting for its time, and its name
+        void CommandQueue::erase_command(std::multimap<double, Event>::iterator ii)
+        {
+            std::unordered_map<string, std::multimap<double, Event>::iterator>::iterator jj = names.find(ii->second.name);
+            if (jj != names.end() && jj->second == ii)
+            {
+                names.erase(jj);
+            }
+            commands.erase(ii);
+        }
+
+        //!	Keep the last 10 Events that have run
+        void CommandQueue::record_event(const Event &event)
+        {
+            std::lock_guard<std::recursive_mutex> lock(mtx);
+            events.push_back(event);
+            if (events.size() > 10)
+            {
+                events.pop_front();
             }
-            return static_cast<int32_t>(commands.size());
         }
 
         //!	Save the queue of Events to a file
@@ -256,6 +305,7 @@ namespace Cosmos
         */
         int32_t CommandQueue::save_commands(string temp_dir, string name)
         {
+            std::lock_guard<std::recursive_mutex> lock(mtx);
             if (!queue_changed)
             {
                 return 0;
@@ -269,13 +319,17 @@ namespace Cosmos
             FILE *fd = fopen((temp_dir+name).c_str(), "w");
             if (fd != nullptr)
             {
-                for (Event cmd: commands)
+                for (Event &cmd: conditions)
                 {
                     fprintf(fd, "%s\n", cmd.get_event_string().c_str());
                 }
+                for (std::pair<const double, Event> &cmd: commands)
+                {
+                    fprintf(fd, "%s\n", cmd.second.get_event_string().c_str());
+                }
                 fclose(fd);
             }
-            return static_cast<int32_t>(commands.size());
+            return static_cast<int32_t>(get_command_size());
         }
 
         //!	Restore the queue of Events from a file
@@ -311,14 +365,14 @@ namespace Cosmos
                 }
                 infile.close();
             }
-            return static_cast<int32_t>(commands.size());
+            return static_cast<int32_t>(get_command_size());
         }
 
 
         //!	Loads new commands from *.command files located in the incoming directory
         /*!
         // Commands are loaded into the global CommandQueue object (cmd_queue),
-        // *.command files are removed, and the command list is sorted by utc.
+        // and *.command files are removed.
             \param	incoming_dir	Directory where the .command files will be read from
         */
         int32_t CommandQueue::load_commands(string incoming_dir)
@@ -376,8 +430,6 @@ namespace Cosmos
                 }
             }
 
-            sort();
-
             closedir(dir);
 
             return 0;
@@ -391,17 +443,24 @@ namespace Cosmos
         */
         int32_t CommandQueue::del_command(Event& c)
         {
-            size_t prev_sz = commands.size();
-            for (std::list<Event>::iterator ii = commands.begin();
-                 ii != commands.end();
-                 ++ii) {
-                if (c == *ii) {
-                    commands.erase(ii--);
+            std::lock_guard<std::recursive_mutex> lock(mtx);
+            size_t prev_sz = get_command_size();
+            conditions.remove(c);
+            std::pair<std::multimap<double, Event>::iterator, std::multimap<double, Event>::iterator> range = commands.equal_range(c.mjd);
+            for (std::multimap<double, Event>::iterator ii = range.first; ii != range.second; )
+            {
+                if (c == ii->second)
+                {
+                    erase_command(ii++);
+                }
+                else
+                {
+                    ++ii;
                 }
             }
 
             queue_changed = true;
-            return static_cast<int32_t>(prev_sz - commands.size());
+            return static_cast<int32_t>(prev_sz - get_command_size());
 
         }
 
@@ -414,29 +473,56 @@ namespace Cosmos
         */
         int32_t CommandQueue::del_command(int pos)
         {
-            size_t prev_sz = commands.size();
-            std::list<Event>::iterator b = commands.begin();
-
-            std::advance(b, pos);
-            commands.erase(b);
+            std::lock_guard<std::recursive_mutex> lock(mtx);
+            if (pos < 0 || static_cast<size_t>(pos) >= get_command_size())
+            {
+                return 0;
+            }
+            if (static_cast<size_t>(pos) < conditions.size())
+            {
+                std::list<Event>::iterator b = conditions.begin();
+                std::advance(b, pos);
+                conditions.erase(b);
+            }
+            else
+            {
+                std::multimap<double, Event>::iterator b = commands.begin();
+                std::advance(b, pos - conditions.size());
+                erase_command(b);
+            }
             queue_changed = true;
-            return static_cast<int32_t>(prev_sz - commands.size());
+            return 1;
         }
 
         int32_t CommandQueue::add_command(Event& c)
         {
+            std::lock_guard<std::recursive_mutex> lock(mtx);
+            int32_t iretn = 1;
+
             // Replace if it matches an existing command, otherwise add to queue
-            for (std::list<Event>::iterator ii = commands.begin(); ii != commands.end(); ++ii) {
-                if (c.get_name() == ii->get_name()) {
-                    *ii = c;
-                    queue_changed = true;
-                    return 0;
+            std::unordered_map<string, std::multimap<double, Event>::iterator>::iterator jj = names.find(c.name);
+            if (jj != names.end())
+            {
+                erase_command(jj->second);
+                iretn = 0;
+            }
+            else
+            {
+                for (std::list<Event>::iterator ii = conditions.begin(); ii != conditions.end(); ++ii)
+                {
+                    if (c.name == ii->name)
+                    {
+                        conditions.erase(ii);
+                        iretn = 0;
+                        break;
+                    }
                 }
             }
 
-            commands.push_back(c);
+            names[c.name] = commands.insert(std::make_pair(c.mjd, c));
             queue_changed = true;
-            return 1;
+            added.notify_all();
+            return iretn;
         }
 
         //!	Extraction operator
@@ -450,8 +536,11 @@ namespace Cosmos
         */
         ::std::ostream& operator<<(::std::ostream& out, CommandQueue& cmdq)
         {
-            for(std::list<Event>::iterator ii = cmdq.commands.begin(); ii != cmdq.commands.end(); ++ii)
+            std::lock_guard<std::recursive_mutex> lock(cmdq.mtx);
+            for(std::list<Event>::iterator ii = cmdq.conditions.begin(); ii != cmdq.conditions.end(); ++ii)
                 out << *ii << std::endl;
+            for(std::multimap<double, Event>::iterator ii = cmdq.commands.begin(); ii != cmdq.commands.end(); ++ii)
+                out << ii->second << std::endl;
             return out;
         }
     } // end namespace Support
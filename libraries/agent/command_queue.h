@@ -45,17 +45,31 @@
 #include "agentclass.h"
 #include "task.h"
 #include "event.h"
+#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
 
 namespace Cosmos
 {
     namespace Support
     {
         //! Class to manage information about a queue of Events
+        /*! Events waiting for their time are kept in order of Event::mjd, so each call to
+            run_commands() reads the clock once and only looks at the Events that are due.
+            Due Events that wait on a condition move to a separate, much shorter list that
+            is tested every call. All access is guarded by a mutex, so Events can be added
+            and removed from request threads while the queue runs.
+        */
         class CommandQueue
         {
         private:
-            /**	An std::list of members of the Event class to be run	*/
-            std::list<Event> commands;
+            /**	Events waiting for their time, in order of Event::mjd	*/
+            std::multimap<double, Event> commands;
+            /**	Where to find each Event in commands by its name	*/
+            std::unordered_map<string, std::multimap<double, Event>::iterator> names;
+            /**	Events whose time has come, but which wait on a condition, in order of Event::mjd	*/
+            std::list<Event> conditions;
             /**	An std::queue of members of the Event class that have run	*/
             std::deque<Event> events;
             /** A vector of all threads spawned to run events  */
@@ -65,15 +79,24 @@ namespace Cosmos
 
             bool queue_blocked = false;
 
+            /** Guards everything above	*/
+            std::recursive_mutex mtx;
+            /** Signalled when an Event is added	*/
+            std::condition_variable_any added;
+
+            Event &command_at(size_t i);
+            void erase_command(std::multimap<double, Event>::iterator ii);
+            void record_event(const Event &event);
+
         public:
             //! Ensure all threads are joined before destruction.
-            ~CommandQueue();
+            virtual ~CommandQueue();
 
             //!	Retrieve the size of the queue
             /*!
                 \return	The size of the queue
             */
-            size_t get_event_size() { return events.size(); }
+            size_t get_event_size() { std::lock_guard<std::recursive_mutex> lock(mtx); return events.size(); }
 
             //!	Retrieve an Event by its position in the queue
             /*!
@@ -82,6 +105,7 @@ namespace Cosmos
             */
             Event& get_event(int i)
             {
+                std::lock_guard<std::recursive_mutex> lock(mtx);
                 std::deque<Event>::iterator ii = events.begin();
                 std::advance(ii,i);
                 return *ii;
@@ -91,19 +115,33 @@ namespace Cosmos
             /*!
                 \return	The size of the queue
             */
-            size_t get_command_size() { return commands.size(); }
+            size_t get_command_size() { std::lock_guard<std::recursive_mutex> lock(mtx); return conditions.size() + commands.size(); }
 
             //!	Retrieve an Event by its position in the queue
             /*!
                 \param	i	Integer representing the position in the queue
                 \return	Reference to the ith Event
+
+                Events waiting on a condition come first, then those waiting for their time.
             */
-            Event& get_command(int i)
-            {
-                std::list<Event>::iterator ii = commands.begin();
-                std::advance(ii,i);
-                return *ii;
-            }
+            Event& get_command(int i) { std::lock_guard<std::recursive_mutex> lock(mtx); return command_at(i); }
+
+            //!	Time the next Event falls due
+            /*!
+                \return	Event::mjd of the first Event waiting for its time, or 0. if there are none
+            */
+            double get_next_mjd();
+
+            //!	Wait for the next Event to fall due
+            /*!
+                Sleeps until the first Event waiting for its time is due, an Event is added, or
+                the given time, whichever is first. Events waiting on a condition are not
+                waited for; they are tested on every call to run_commands().
+
+                \param	until	Latest time to wait until (Modified Julian Date)
+                \return	True if an Event is due, otherwise false
+            */
+            bool wait_commands(double until);
 
             //!	Load queue of Events from a file
             /*!
@@ -143,7 +181,7 @@ namespace Cosmos
                 \param	nodename	Name of node
                 \param	logdate_exec	Time of execution (for logging purposes)
             */
-            int32_t run_request(Agent *agent, Event &cmd, string nodename, double logdate_exec);
+            virtual int32_t run_request(Agent *agent, Event &cmd, string nodename, double logdate_exec);
 
             //! Run the given Command Event
             /*!
@@ -156,7 +194,7 @@ namespace Cosmos
                 \param	nodename	Name of node
                 \param	logdate_exec	Time of execution (for logging purposes)
             */
-            int32_t run_command(Agent* agent, Event &cmd, string nodename, double logdate_exec);
+            virtual int32_t run_command(Agent* agent, Event &cmd, string nodename, double logdate_exec);
 
             //!	Traverse the entire queue of Events, clearing those that have finished.
             /*!
@@ -170,12 +208,13 @@ namespace Cosmos
             */
 //            int32_t flush_commands();
 
-            //!	Traverse the entire queue of Events, and run those which qualify.
+            //!	Run the Events in the queue which qualify.
             /*!
 
             An %Event only qualifies to run if the current time is greater than or equal to
             the execution time of the %Event.  Further, if the %Event is conditional, then the
-            %Event condition must be true.
+            %Event condition must be true. Every due %Event without a condition is run, then
+            conditions are tested in order, and the first that is true is run.
 
                 \param	agent	Pointer to Agent object (for call to condition_true(..))
                 \param	nodename	Name of the node
@@ -183,12 +222,10 @@ namespace Cosmos
             */
             int32_t run_commands(Agent *agent, string nodename, double logdate_exec);
 
-            //!	Remove **all** matching Event from the queue
+            //!	Add an Event to the queue
             /*!
-                \param	c	Event to remove
-                \return	The number of Events removed
-
-                JIMNOTE:	this only adds given Event to the queue if the Event has flag for EVENT_TYPE_COMMAND set to true
+                \param	c	Event to add
+                \return	0 if it replaced an Event of the same name, otherwise 1
             */
             int32_t add_command(Event& c);
 
@@ -212,9 +249,9 @@ namespace Cosmos
 
             //!	Sort the Events in the queue by Event exectution time
             /*!
-                This function is called after new Events are loaded.
+                The queue is kept in order as Events are added, so there is nothing left to do.
             */
-            void sort()	{ commands.sort([](Event & c1, Event & c2) { return c1.getTime() < c2.getTime(); });	}
+            void sort()	{ }
             //!	Extraction operator
             /*!
                 \param	out	Reference to ostream
@@ -155,12 +155,25 @@ string Event::get_event_string()
     return jobj.to_json_string();
 }
 
-bool Event::condition_true(cosmosstruc *cinfo)
+int32_t Event::compile_condition(cosmosstruc *cinfo)
 {
     const char *cp = condition.c_str();
+    condition_cinfo = cinfo;
+    int32_t iretn = json_equation_compile(cp, cinfo, condition_program);
+    // Remember what was compiled even when it failed, so a bad condition is not compiled again
+    condition_program.text = condition;
+    return iretn;
+}
+
+bool Event::condition_true(cosmosstruc *cinfo)
+{
     if (cinfo != nullptr)
     { // Note: an equation must be enclosed by parentheses.
-        double r =  json_equation(cp, cinfo);
+        if (cinfo != condition_cinfo || condition != condition_program.text)
+        {
+            compile_condition(cinfo);
+        }
+        double r = json_equation(condition_program, cinfo);
         if (fabs(r - 1.0) < std::numeric_limits<double>::epsilon())
         {
             ++true_count;
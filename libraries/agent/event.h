@@ -82,6 +82,9 @@ namespace Cosmos
             uint32_t true_count=0;
             /** %Event information stored as a JSON string */
             string		event_string;
+            /** %Event condition, compiled for the ::cosmosstruc it is tested against */
+            jsonprogram	condition_program;
+            cosmosstruc	*condition_cinfo=nullptr;
 
         public:
 
@@ -196,6 +199,16 @@ namespace Cosmos
 
             string generator(eventstruc event);
 
+            ///	Compiles Event::condition
+            /**
+        \param	cinfo	Pointer to ::cosmosstruc the condition will be tested against
+        \return	Number of steps in the compiled condition, otherwise negative error
+
+        The condition is parsed and its names looked up once, so that condition_true() need only
+        calculate it. condition_true() calls this itself whenever the condition or ::cosmosstruc changes.
+    */
+            int32_t compile_condition(cosmosstruc *cinfo);
+
             // JIMNOTE: this function (condition_true)  needs a look at....
             // OLDNOTE: seems to return nan from json_equation...  how to use?
             bool condition_true(cosmosstruc *cinfo);
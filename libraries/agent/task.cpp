@@ -24,6 +24,7 @@ namespace Cosmos {
                 return;
             }
             state = 2;
+            wake.notify_one();
             ElapsedTime et;
             while (et.split() < 5. && state != 3)
             {
@@ -44,9 +45,10 @@ namespace Cosmos {
         void Task::Runner()
         {
             state = 1;
+            std::unique_lock<mutex> lock(mtx);
             while (state != 2)
             {
-                mtx.lock();
+                bool pending = false;
                 for(auto iter=tasks.begin(); iter!=tasks.end();)
                 {
                     if ((*iter).state == 0)
@@ -65,10 +67,18 @@ namespace Cosmos {
                             log_move_file((*iter).path, string_replace((*iter).path, "/temp/", "/outgoing/"), true);
                         }
                     }
+                    pending |= (*iter).state == 1;
                     ++iter;
                 }
-                mtx.unlock();
-                std::this_thread::yield();
+                // Sleep until a task is added, checking running tasks every 10 msec
+                if (pending)
+                {
+                    wake.wait_for(lock, std::chrono::milliseconds(10));
+                }
+                else
+                {
+                    wake.wait_for(lock, std::chrono::milliseconds(1000));
+                }
             }
             state = 3;
             return;
@@ -91,6 +101,7 @@ namespace Cosmos {
                 tasks.back().path = data_base_path(node, "temp", AgentName, data_name(tasks.back().startmjd, "task", NodeName, AgentName));
             }
             mtx.unlock();
+            wake.notify_one();
             return tasks.size();
         }
 
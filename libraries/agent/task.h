@@ -87,6 +87,7 @@ namespace Cosmos
             string AgentName;
             vector<Running> tasks;
             mutex mtx;
+            std::condition_variable wake;
             uint8_t state = 0;
             thread mythread;
         };
@@ -1,5 +1,237 @@
 #include "crclib.h"
 
+#include <array>
+#include <mutex>
+#if defined(__x86_64__) && defined(__GNUC__)
+#define CRC16_CLMUL
+#include <immintrin.h>
+#endif
+
+//! Tables and constants for one polynomial
+/*! slice[k][b] is the remainder of byte b followed by k zero bytes, so slice[0] is the usual
+ * lookup table. fold holds x^192 and x^128 modulo the polynomial for folding 16 byte blocks,
+ * most significant bit first, or x^191 and x^127 with their bits reversed, least significant
+ * bit first. fold4 holds the same for folding 64 bytes at a time, x^576 and x^512.
+*/
+struct crc16_tables
+{
+    uint16_t slice[8][256];
+    uint64_t fold[2];
+    uint64_t fold4[2];
+};
+
+//! x^power modulo a polynomial, most significant bit first
+static uint64_t crc16_xpow(uint32_t power, uint16_t polynomial)
+{
+    uint32_t remainder = 1;
+    for (uint32_t i=0; i<power; ++i)
+    {
+        remainder <<= 1;
+        if (remainder & 0x10000)
+        {
+            remainder ^= 0x10000 | polynomial;
+        }
+    }
+    return remainder;
+}
+
+//! Reverse the bits of a 64 bit word
+static uint64_t crc16_reflect(uint64_t value)
+{
+    uint64_t result = 0;
+    for (uint16_t i=0; i<64; ++i)
+    {
+        result = (result << 1) | ((value >> i) & 1);
+    }
+    return result;
+}
+
+//! Tables for a polynomial
+/*! Tables are calculated the first time each polynomial is asked for, and kept for every CRC16
+ * that uses the same one, so making and copying a CRC16 costs no more than its settings.
+    \param polynomial CRC polynomial.
+    \param lsbfirst True if least significant bit first.
+    \return Pointer to the tables, valid for the life of the program.
+*/
+static const crc16_tables *crc16_table(uint16_t polynomial, bool lsbfirst)
+{
+    static std::mutex table_mutex;
+    static std::map<uint32_t, crc16_tables> tables;
+
+    std::lock_guard<std::mutex> lock(table_mutex);
+    uint32_t key = (static_cast<uint32_t>(lsbfirst) << 16) | polynomial;
+    auto it = tables.find(key);
+    if (it == tables.end())
+    {
+        crc16_tables &table = tables[key];
+        // Compute the remainder of each possible dividend.
+        for (int32_t dividend = 0; dividend < 256; ++dividend)
+        {
+            uint8_t byte = dividend;
+            table.slice[0][dividend] = calc_crc16(&byte, 1, polynomial, 0, 0, lsbfirst);
+        }
+        // Then of each followed by zeros
+        for (uint16_t k=1; k<8; ++k)
+        {
+            for (uint16_t dividend = 0; dividend < 256; ++dividend)
+            {
+                uint16_t remainder = table.slice[k-1][dividend];
+                if (lsbfirst)
+                {
+                    table.slice[k][dividend] = table.slice[0][remainder & 0xff] ^ (remainder >> 8);
+                }
+                else
+                {
+                    table.slice[k][dividend] = table.slice[0][remainder >> 8] ^ static_cast<uint16_t>(remainder << 8);
+                }
+            }
+        }
+        if (lsbfirst)
+        {
+            table.fold[0] = crc16_reflect(crc16_xpow(191, polynomial));
+            table.fold[1] = crc16_reflect(crc16_xpow(127, polynomial));
+            table.fold4[0] = crc16_reflect(crc16_xpow(575, polynomial));
+            table.fold4[1] = crc16_reflect(crc16_xpow(511, polynomial));
+        }
+        else
+        {
+            table.fold[0] = crc16_xpow(192, polynomial);
+            table.fold[1] = crc16_xpow(128, polynomial);
+            table.fold4[0] = crc16_xpow(576, polynomial);
+            table.fold4[1] = crc16_xpow(512, polynomial);
+        }
+        return &table;
+    }
+    return &it->second;
+}
+
+//! Divide a message by the polynomial a byte at a time
+static uint16_t crc16_bytewise(const crc16_tables *tables, bool lsbfirst, uint16_t remainder, const uint8_t *message, size_t size)
+{
+    const uint16_t *lookup = tables->slice[0];
+    uint8_t data;
+    for (size_t byte = 0; byte < size; ++byte)
+    {
+        if (lsbfirst)
+        {
+            data = message[byte] ^ (remainder & 0xff);
+            remainder = lookup[data] ^ (remainder >> 8);
+        }
+        else
+        {
+            data = message[byte] ^ (remainder >> (8));
+            remainder = lookup[data] ^ (remainder << 8);
+        }
+    }
+    return remainder;
+}
+
+//! Divide a message by the polynomial eight bytes at a time
+/*! The remainder is folded into the first two bytes of each eight, then each byte is looked up in
+ * the table for as many zero bytes as follow it.
+*/
+static uint16_t crc16_slicing8(const crc16_tables *tables, bool lsbfirst, uint16_t remainder, const uint8_t *message, size_t size)
+{
+    const uint16_t (*slice)[256] = tables->slice;
+    while (size >= 8)
+    {
+        uint8_t first, second;
+        if (lsbfirst)
+        {
+            first = message[0] ^ (remainder & 0xff);
+            second = message[1] ^ (remainder >> 8);
+        }
+        else
+        {
+            first = message[0] ^ (remainder >> 8);
+            second = message[1] ^ (remainder & 0xff);
+        }
+        remainder = slice[7][first] ^ slice[6][second] ^ slice[5][message[2]] ^ slice[4][message[3]] ^ slice[3][message[4]] ^ slice[2][message[5]] ^ slice[1][message[6]] ^ slice[0][message[7]];
+        message += 8;
+        size -= 8;
+    }
+    return crc16_bytewise(tables, lsbfirst, remainder, message, size);
+}
+
+#ifdef CRC16_CLMUL
+//! Load 16 bytes as a polynomial, most significant coefficient in the top bit
+__attribute__((always_inline, target("pclmul,ssse3")))
+static inline __m128i crc16_load(const uint8_t *message, bool lsbfirst)
+{
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(message));
+    if (!lsbfirst)
+    {
+        block = _mm_shuffle_epi8(block, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+    }
+    return block;
+}
+
+//! Multiply the halves of folded by constants, and add next
+__attribute__((always_inline, target("pclmul,ssse3")))
+static inline __m128i crc16_fold(__m128i folded, __m128i constants, __m128i next)
+{
+    return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(folded, constants, 0x11), _mm_clmulepi64_si128(folded, constants, 0x00)), next);
+}
+
+//! Divide a message by the polynomial sixteen bytes at a time
+/*! The message is folded into 128 bits that leave the same remainder: the upper and lower 64
+ * bits of what has been folded so far are multiplied by x^192 and x^128 (modulo the polynomial)
+ * and added to the next 16 bytes. Four blocks are folded side by side, 64 bytes apart, and
+ * then into each other, so that the multiplies overlap. The folded 16 bytes, and what is left
+ * over, then go through the tables. Least significant bit first works the same on bit reversed
+ * values. Messages of at least 64 bytes only.
+*/
+__attribute__((target("pclmul,ssse3")))
+static uint16_t crc16_clmul(const crc16_tables *tables, bool lsbfirst, uint16_t remainder, const uint8_t *message, size_t size)
+{
+    uint8_t block[16];
+    memcpy(block, message, 16);
+    __m128i constants, constants4;
+    if (lsbfirst)
+    {
+        block[0] ^= remainder & 0xff;
+        block[1] ^= remainder >> 8;
+        constants = _mm_set_epi64x(tables->fold[1], tables->fold[0]);
+        constants4 = _mm_set_epi64x(tables->fold4[1], tables->fold4[0]);
+    }
+    else
+    {
+        block[0] ^= remainder >> 8;
+        block[1] ^= remainder & 0xff;
+        constants = _mm_set_epi64x(tables->fold[0], tables->fold[1]);
+        constants4 = _mm_set_epi64x(tables->fold4[0], tables->fold4[1]);
+    }
+
+    __m128i folded0 = crc16_load(block, lsbfirst);
+    __m128i folded1 = crc16_load(message + 16, lsbfirst);
+    __m128i folded2 = crc16_load(message + 32, lsbfirst);
+    __m128i folded3 = crc16_load(message + 48, lsbfirst);
+    size_t offset = 64;
+    for (; offset+64<=size; offset+=64)
+    {
+        folded0 = crc16_fold(folded0, constants4, crc16_load(message + offset, lsbfirst));
+        folded1 = crc16_fold(folded1, constants4, crc16_load(message + offset + 16, lsbfirst));
+        folded2 = crc16_fold(folded2, constants4, crc16_load(message + offset + 32, lsbfirst));
+        folded3 = crc16_fold(folded3, constants4, crc16_load(message + offset + 48, lsbfirst));
+    }
+    folded0 = crc16_fold(folded0, constants, folded1);
+    folded0 = crc16_fold(folded0, constants, folded2);
+    folded0 = crc16_fold(folded0, constants, folded3);
+    for (; offset+16<=size; offset+=16)
+    {
+        folded0 = crc16_fold(folded0, constants, crc16_load(message + offset, lsbfirst));
+    }
+    if (!lsbfirst)
+    {
+        folded0 = _mm_shuffle_epi8(folded0, _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(block), folded0);
+
+    remainder = crc16_slicing8(tables, lsbfirst, 0, block, 16);
+    return crc16_slicing8(tables, lsbfirst, remainder, message + offset, size - offset);
+}
+#endif
+
 //! Calculate CRC-16
 /*! Calculate 16-bit CRC for the indicated type, buffer and number of bytes.
 */
@@ -7,23 +239,33 @@
 //CRC16::CRC16(uint16_t polynomial, uint16_t initial, uint16_t xorout, bool lsbfirst)
 CRC16::CRC16()
 {
-    types[string("ccitt-false")] = {false, 0x1021, 0xffff, 0x0000, 0x29b1};
-    types[string("xmodem")] = {false, 0x1021, 0x0000, 0x0000, 0x31c3};
-    types[string("hdlc")] = {true, 0x1021, 0xffff, 0xffff, 0x906e};
-    types[string("kermit")] = {true, 0x1021, 0x0000, 0x0000, 0x2189};
-    types[string("maxim")] = {true, 0x8005, 0x0000, 0xffff, 0x44c2};
-    types[string("usb")] = {true, 0x8005, 0xffff, 0xffff, 0xb4c8};
+    // ccitt-false
+    set(0x1021, 0xffff, 0x0000, false);
+    test = 0x29b1;
+}
 
-    set("ccitt-false");
+//! Known kinds of CRC-16
+const std::map<string, CRC16::crcset>& CRC16::types()
+{
+    static const std::map<string, crcset> types = {
+        {"ccitt-false", {false, 0x1021, 0xffff, 0x0000, 0x29b1}},
+        {"xmodem", {false, 0x1021, 0x0000, 0x0000, 0x31c3}},
+        {"hdlc", {true, 0x1021, 0xffff, 0xffff, 0x906e}},
+        {"kermit", {true, 0x1021, 0x0000, 0x0000, 0x2189}},
+        {"maxim", {true, 0x8005, 0x0000, 0xffff, 0x44c2}},
+        {"usb", {true, 0x8005, 0xffff, 0xffff, 0xb4c8}},
+    };
+    return types;
 }
 
 uint16_t CRC16::set(string type)
 {
-    if (types.find(type) != types.end())
+    auto it = types().find(type);
+    if (it != types().end())
     {
         this->type = type;
-        this->test = types[type].test;
-        return set(types[type].polynomial, types[type].initialcrc, types[type].xorout, types[type].lsbfirst);
+        this->test = it->second.test;
+        return set(it->second.polynomial, it->second.initialcrc, it->second.xorout, it->second.lsbfirst);
     }
     else
     {
@@ -37,44 +279,85 @@ uint16_t CRC16::set(uint16_t polynomial, uint16_t initialcrc, uint16_t xorout, b
     this->initial = initialcrc;
     this->xorout = xorout;
     this->polynomial = polynomial;
+    tables = crc16_table(polynomial, lsbfirst);
+    lookup = tables->slice[0];
+    kernel = best_kernel();
+    return 0;
+}
+
+//! Whether this processor can fold with carry-less multiplies
+static bool crc16_has_clmul()
+{
+#ifdef CRC16_CLMUL
+    static const bool clmul = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3");
+    return clmul;
+#else
+    return false;
+#endif
+}
 
-// Compute the remainder of each possible dividend.
-    for (int32_t dividend = 0; dividend < 256; ++dividend)
+//! Fastest kernel on this processor
+/*! Unoptimized, the intrinsics are calls of their own, and slicing by eight is faster.
+*/
+CRC16::Kernel CRC16::best_kernel()
+{
+#ifdef __OPTIMIZE__
+    if (crc16_has_clmul())
     {
-        uint8_t byte = dividend;
-        lookup[dividend] = calc_crc16(&byte, 1, this->polynomial, 0, 0, this->lsbfirst);
+        return Kernel::Clmul;
     }
+#endif
+    return Kernel::Slicing8;
+}
+
+//! Choose how to divide messages by the polynomial
+/*! The fastest available is chosen by set(), so this is for comparing them.
+    \param kernel Kernel to use.
+    \return 0 on success, or negative error if the processor does not have it.
+*/
+int32_t CRC16::set_kernel(Kernel kernel)
+{
+    if (kernel == Kernel::Clmul && !crc16_has_clmul())
+    {
+        return COSMOS_GENERAL_ERROR_UNDEFINED;
+    }
+    this->kernel = kernel;
     return 0;
 }
 
+CRC16::Kernel CRC16::get_kernel()
+{
+    return kernel;
+}
+
 //uint16_t CRC16::calc(uint8_t *buf, uint16_t size)
 //{
 //    vector<uint8_t> vbuf(buf, buf+(size));
 //    return calc(vbuf);
 //}
 
-uint16_t CRC16::calc(string message, uint16_t size)
+uint16_t CRC16::calc(const string& message, uint16_t size)
 {
 //    vector<uint8_t> vmessage(&message[0], &message[size]);
 //    return calc(vmessage);
     if (size <= message.length())
     {
-        return calc((uint8_t *)message.c_str(), size);
+        return calc((const uint8_t *)message.c_str(), size);
     }
     else
     {
-        return calc((uint8_t *)message.c_str(), message.length());
+        return calc((const uint8_t *)message.c_str(), message.length());
     }
 }
 
-uint16_t CRC16::calc(string message)
+uint16_t CRC16::calc(const string& message)
 {
 //    vector<uint8_t> vmessage(&message[0], &message[message.size()]);
 //    return calc(vmessage);
-    return calc((uint8_t *)message.c_str(), message.length());
+    return calc((const uint8_t *)message.c_str(), message.length());
 }
 
-uint16_t CRC16::calc(vector<uint8_t> message, uint16_t size)
+uint16_t CRC16::calc(const vector<uint8_t>& message, uint16_t size)
 {
 //    vector<uint8_t> vmessage(&message[0], &message[size]);
 //    return calc(vmessage);
@@ -88,92 +371,126 @@ uint16_t CRC16::calc(vector<uint8_t> message, uint16_t size)
     }
 }
 
-uint16_t CRC16::calc(vector<uint8_t> message)
+uint16_t CRC16::calc(const vector<uint8_t>& message)
 {
     return calc(message.data(), message.size());
 }
 
-uint16_t CRC16::calc(uint8_t *message, uint16_t size)
+uint16_t CRC16::calc(const uint8_t *message, size_t size)
 {
-    // std::lock_guard<mutex> lock(*mtx);
-    uint8_t data;
-    uint16_t remainder = initial;
-
     /*
-     * Divide the message by the polynomial, a byte at a time.
+     * The final remainder is the CRC.
      */
-    for (size_t byte = 0; byte < size; ++byte)
+    return (update(initial, message, size) ^ xorout);
+}
+
+//! Continue a CRC-16
+/*! Calculate the CRC of a message made of an earlier message followed by the indicated bytes,
+ * from the CRC of the earlier message alone.
+    \param crc CRC of the earlier message.
+    \param message Bytes that follow it.
+    \param size Number of bytes.
+    \return CRC of the whole.
+*/
+uint16_t CRC16::extend(uint16_t crc, const uint8_t *message, size_t size)
+{
+    return (update(crc ^ xorout, message, size) ^ xorout);
+}
+
+//! Combine two CRC-16
+/*! Calculate the CRC of two messages placed one after the other, from the CRC of each and the
+ * length of the second, without the messages themselves. As zlib's crc32_combine(), this runs
+ * the first CRC through as many zero bytes as the second message has, squaring the operator
+ * for one zero byte to skip ahead in powers of two.
+    \param crc1 CRC of the first message.
+    \param crc2 CRC of the second message.
+    \param size2 Number of bytes in the second message.
+    \return CRC of the first message followed by the second.
+*/
+uint16_t CRC16::combine(uint16_t crc1, uint16_t crc2, size_t size2)
+{
+    // Columns of the operator for one zero byte
+    uint16_t op[16];
+    for (uint16_t i=0; i<16; ++i)
     {
-        if (lsbfirst)
+        op[i] = shift(1 << i);
+    }
+
+    // The initial remainder is already in crc2, so only the difference from it is carried
+    uint16_t remainder = crc1 ^ xorout ^ initial;
+    while (size2)
+    {
+        if (size2 & 1)
         {
-            data = message[byte] ^ (remainder & 0xff);
-            remainder = lookup[data] ^ (remainder >> 8);
+            uint16_t next = 0;
+            for (uint16_t i=0; i<16; ++i)
+            {
+                if (remainder & (1 << i))
+                {
+                    next ^= op[i];
+                }
+            }
+            remainder = next;
         }
-        else
+        size2 >>= 1;
+        if (size2)
         {
-            data = message[byte] ^ (remainder >> (8));
-            remainder = lookup[data] ^ (remainder << 8);
+            uint16_t square[16];
+            for (uint16_t i=0; i<16; ++i)
+            {
+                square[i] = 0;
+                for (uint16_t j=0; j<16; ++j)
+                {
+                    if (op[i] & (1 << j))
+                    {
+                        square[i] ^= op[j];
+                    }
+                }
+            }
+            memcpy(op, square, sizeof(op));
         }
     }
-
-    /*
-     * The final remainder is the CRC.
-     */
-    return (remainder ^ xorout);
+    return (remainder ^ crc2);
 }
 
-/**
- * @brief Read file data into a buffer, using a pre-read buffer to minimize I/O.
- * 
- * @param file File to read from
- * @param dest Destination buffer to read data into
- * @param offset Offset into the file to read from
- * @param size Number of bytes to read from the file
- * @return Number of bytes read or negative on error.
- */
-static int32_t buffered_read(FILE* file, uint8_t* dest, size_t offset, size_t size)
-{
-    static constexpr size_t READ_BUFFER_SIZE = 2*4096; // modify as needed for best performance and memory usage
-    static uint8_t read_buffer[READ_BUFFER_SIZE];
-    // Index of the start of the read buffer in the file. Used to determine if a buffered read request can be fulfilled by the pre-read buffered data.
-    static size_t start_of_buffer_fseek_index = std::numeric_limits<size_t>::max();
-    // Keep track of the current file that is being read from
-    static FILE* current_file = nullptr;
-    // The amount of data in the read buffer, which could be smaller than READ_BUFFER_SIZE if the file is smaller than the buffer size or if the end of the file was reached. 
-    static size_t buffer_size = 0;
-    if (file != current_file                    // If a different file is requested
-    || offset < start_of_buffer_fseek_index     // If the requested offset is before the start of the buffered read
-    || start_of_buffer_fseek_index + buffer_size <= offset + size) // If the requested read is larger than the buffered read
-    {
-        // Read a new buffer
-        if (file == nullptr || fseek(file, offset, SEEK_SET) != 0)
-        {
-            return COSMOS_GENERAL_ERROR_BAD_FD;
-        }
-        start_of_buffer_fseek_index = offset;
-        current_file = file;
-        buffer_size = fread(read_buffer, 1, READ_BUFFER_SIZE, file);
-        if (buffer_size == 0)
-        {
-            return 0;
-        }
-        else if (buffer_size < READ_BUFFER_SIZE && !feof(file))
+//! Divide a message by the polynomial, with the chosen kernel
+uint16_t CRC16::update(uint16_t remainder, const uint8_t *message, size_t size)
+{
+    switch (kernel)
+    {
+#ifdef CRC16_CLMUL
+    case Kernel::Clmul:
+        if (size >= 128)
         {
-            return COSMOS_GENERAL_ERROR_BAD_FD;
+            return crc16_clmul(tables, lsbfirst, remainder, message, size);
         }
+        return crc16_slicing8(tables, lsbfirst, remainder, message, size);
+#endif
+    case Kernel::Slicing8:
+        return crc16_slicing8(tables, lsbfirst, remainder, message, size);
+    default:
+        return crc16_bytewise(tables, lsbfirst, remainder, message, size);
+    }
+}
+
+//! Divide a remainder by the polynomial for one zero byte
+uint16_t CRC16::shift(uint16_t remainder)
+{
+    if (lsbfirst)
+    {
+        return lookup[remainder & 0xff] ^ (remainder >> 8);
+    }
+    else
+    {
+        return lookup[remainder >> 8] ^ (remainder << 8);
     }
-    // Read from the buffer
-    memcpy(dest, read_buffer + (offset - start_of_buffer_fseek_index), size);
-    return size;
 }
 
 // Modified for calculating the crc of a file
 // Returns non-negative uint16_t crc on success, negative on error
 int32_t CRC16::calc_file(string file_path)
 {
-    uint8_t data;
     uint16_t remainder = initial;
-    int32_t iretn = 0;
 
     // Check file validity
     FILE* fp = fopen(file_path.c_str(), "rb");
@@ -182,67 +499,80 @@ int32_t CRC16::calc_file(string file_path)
         return COSMOS_TRANSFER_ERROR_FILENAME;
     }
 
-    // Divide message by the polynomial a byte at a time until EOF
-    char byte;
-    size_t offset = 0;
-    while ((iretn = buffered_read(fp, reinterpret_cast<uint8_t*>(&byte), offset, sizeof(byte))) > 0)
+    // Divide message by the polynomial a block at a time until EOF
+    vector<uint8_t> buffer(65536);
+    size_t count;
+    while ((count = fread(buffer.data(), 1, buffer.size(), fp)) > 0)
     {
-        ++offset;
-        if (lsbfirst)
-        {
-            // Note, char is signed
-            data = static_cast<uint8_t>(byte) ^ (remainder & 0xff);
-            remainder = lookup[data] ^ (remainder >> 8);
-        }
-        else
-        {
-            // Note, char is signed
-            data = static_cast<uint8_t>(byte) ^ (remainder >> (8));
-            remainder = lookup[data] ^ (remainder << 8);
-        }
+        remainder = update(remainder, buffer.data(), count);
     }
-    if (iretn < 0)
+    if (ferror(fp))
     {
         fclose(fp);
-        return iretn;
+        return COSMOS_GENERAL_ERROR_BAD_FD;
     }
-
-    iretn = (remainder ^ xorout);
     fclose(fp);
 
     /*
      * The final remainder is the CRC.
      */
-    return iretn;
+    return (remainder ^ xorout);
+}
+
+//! Calculate the CRC-16 of part of a file
+/*! Read the indicated bytes of an open file and calculate their CRC.
+    \param fp Open file.
+    \param offset Offset of the first byte.
+    \param size Number of bytes.
+    \return Non-negative uint16_t CRC on success, negative on error, including a file shorter
+    than the bytes asked for.
+*/
+int32_t CRC16::calc_file(FILE *fp, size_t offset, size_t size)
+{
+    if (fp == nullptr || fseek(fp, offset, SEEK_SET) != 0)
+    {
+        return COSMOS_GENERAL_ERROR_BAD_FD;
+    }
+
+    uint16_t remainder = initial;
+    vector<uint8_t> buffer(std::min(size, static_cast<size_t>(65536)));
+    while (size)
+    {
+        size_t count = fread(buffer.data(), 1, std::min(size, buffer.size()), fp);
+        if (count == 0)
+        {
+            return COSMOS_GENERAL_ERROR_BAD_FD;
+        }
+        remainder = update(remainder, buffer.data(), count);
+        size -= count;
+    }
+    return (remainder ^ xorout);
+}
+
+//! CCITT CRC16s for the free functions
+/*! The remainder passed in is the initial value, and there is no final xor, so extend() of
+ * either gives the same result as the bit at a time loops these replace.
+*/
+static CRC16 &crc16ccitt(bool lsbfirst)
+{
+    static CRC16 lsb = []() { CRC16 crc; crc.set(CRC16CCITTMSB, 0x0000, 0x0000, true); return crc; }();
+    static CRC16 msb = []() { CRC16 crc; crc.set(CRC16CCITTMSB, 0x0000, 0x0000, false); return crc; }();
+    return lsbfirst ? lsb : msb;
 }
 
 uint16_t calc_crc16ccitt_lsb(string buf, uint16_t crc, uint16_t skip)
 {
-    vector<uint8_t> vbuf(buf.begin(), buf.end()-skip);
-    return calc_crc16ccitt_lsb(vbuf, crc);
+    return crc16ccitt(true).extend(crc, reinterpret_cast<const uint8_t *>(buf.data()), buf.size() > skip ? buf.size() - skip : 0);
 }
 
 uint16_t calc_crc16ccitt_lsb(uint8_t* buf, uint16_t size, uint16_t crc)
 {
-    vector<uint8_t> vbuf(buf, buf+(size));
-    return calc_crc16ccitt_lsb(vbuf, crc);
+    return crc16ccitt(true).extend(crc, buf, size);
 }
 
 uint16_t calc_crc16ccitt_lsb(vector<uint8_t> &buf, uint16_t crc, uint16_t skip)
 {
-    uint8_t ch;
-
-    for (uint16_t i=0; i<buf.size()-skip; i++)
-    {
-        ch = buf[i];
-        for (uint16_t j=0; j<8; j++)
-        {
-            crc = (crc >> 1) ^ (((ch^crc)&0x01)?CRC16CCITTLSB:0);
-            ch >>= 1;
-
-        }
-    }
-    return (crc);
+    return crc16ccitt(true).extend(crc, buf.data(), buf.size() > skip ? buf.size() - skip : 0);
 }
 
 uint16_t calc_crc16_lsb(uint8_t* buf, uint16_t size, uint16_t poly, uint16_t crc, uint16_t xorout)
@@ -270,35 +600,17 @@ uint16_t calc_crc16_lsb(vector<uint8_t> &buf, uint16_t poly, uint16_t crc, uint1
 
 uint16_t calc_crc16ccitt_msb(string buf, uint16_t crc, uint16_t skip)
 {
-    vector<uint8_t> vbuf(buf.begin(), buf.end()-skip);
-    return calc_crc16ccitt_msb(vbuf, crc);
+    return crc16ccitt(false).extend(crc, reinterpret_cast<const uint8_t *>(buf.data()), buf.size() > skip ? buf.size() - skip : 0);
 }
 
 uint16_t calc_crc16ccitt_msb(uint8_t* buf, uint16_t size, uint16_t crc)
 {
-    vector<uint8_t> vbuf(buf, buf+(size));
-    return calc_crc16ccitt_msb(vbuf, crc);
+    return crc16ccitt(false).extend(crc, buf, size);
 }
 
 uint16_t calc_crc16ccitt_msb(vector<uint8_t> &buf, uint16_t crc, uint16_t skip)
 {
-    //    uint16_t crc;
-    uint8_t ch;
-
-    //        crc = 0;
-
-    for (uint16_t i=0; i<buf.size()-skip; i++)
-    {
-        ch = buf[i];
-        for (uint16_t j=0; j<8; j++)
-        {
-
-            crc = (crc << 1) ^ (((ch&0x80)^((crc&0x8000)>>8))?CRC16CCITTMSB:0);
-            ch <<= 1;
-
-        }
-    }
-    return (crc);
+    return crc16ccitt(false).extend(crc, buf.data(), buf.size() > skip ? buf.size() - skip : 0);
 }
 
 uint16_t calc_crc16_msb(uint8_t* buf, uint16_t size, uint16_t poly, uint16_t crc, uint16_t xorout)
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <map>
+#include <cstdio>
 #include <fstream>
 using std::ifstream;
 #include <string>
@@ -52,11 +53,24 @@ uint16_t calc_crc16_msb(vector<uint8_t> &buf, uint16_t poly=CRC16CCITTMSB, uint1
 
 uint16_t calc_crc16ibm(uint8_t *buf, int size, bool lsb=true);
 
+struct crc16_tables;
+
 class CRC16
 {
 
 public:
-    uint16_t lookup[256];
+    //! Lookup table for the polynomial, shared by every CRC16 of the same kind
+    const uint16_t *lookup;
+    //! Ways of dividing a message by the polynomial
+    enum class Kernel : uint8_t
+    {
+        //! A byte at a time, through one table
+        Bytewise,
+        //! Eight bytes at a time, through eight tables
+        Slicing8,
+        //! Sixteen bytes at a time, folded with carry-less multiplies (x86 PCLMULQDQ)
+        Clmul
+    };
     struct crcset
     {
         bool lsbfirst;
@@ -66,21 +80,32 @@ public:
         uint16_t test;
     };
 
-    std::map<string, crcset> types;
+    static const std::map<string, crcset>& types();
 //    CRC16(uint16_t polynomial=0x1021, uint16_t initial=0xffff, uint16_t xorout=0x0, bool lsbfirst=false);
     CRC16();
     uint16_t set(string type);
     uint16_t set(uint16_t polynomial=0x1021, uint16_t initialcrc=0xffff, uint16_t xorout=0x0, bool lsbfirst=false);
-    uint16_t calc(vector<uint8_t> message);
-    uint16_t calc(vector<uint8_t> message, uint16_t size);
-    uint16_t calc(string message, uint16_t size);
-    uint16_t calc(string message);
-    uint16_t calc(uint8_t *message, uint16_t size);
+    uint16_t calc(const vector<uint8_t>& message);
+    uint16_t calc(const vector<uint8_t>& message, uint16_t size);
+    uint16_t calc(const string& message, uint16_t size);
+    uint16_t calc(const string& message);
+    uint16_t calc(const uint8_t *message, size_t size);
+    uint16_t extend(uint16_t crc, const uint8_t *message, size_t size);
+    uint16_t combine(uint16_t crc1, uint16_t crc2, size_t size2);
     int32_t calc_file(string file_path);
+    int32_t calc_file(FILE *fp, size_t offset, size_t size);
+    int32_t set_kernel(Kernel kernel);
+    Kernel get_kernel();
+    static Kernel best_kernel();
 
     uint16_t test;
 
 private:
+    uint16_t update(uint16_t remainder, const uint8_t *message, size_t size);
+    uint16_t shift(uint16_t remainder);
+
+    const crc16_tables *tables;
+    Kernel kernel;
     string type = "ccitt-false";
     uint16_t initial;
     uint16_t polynomial;
@@ -0,0 +1,536 @@
+/********************************************************************
+* Copyright (C) 2015 by Interstel Technologies, Inc.
+*   and Hawaii Space Flight Laboratory.
+*
+* This file is part of the COSMOS/core that is the central
+* module for COSMOS. For more information on COSMOS go to
+* <http://cosmos-project.com>
+*
+* The COSMOS/core software is licenced under the
+* GNU Lesser General Public License (LGPL) version 3 licence.
+*
+* You should have received a copy of the
+* GNU Lesser General Public License
+* If not, go to <http://www.gnu.org/licenses/>
+*
+* COSMOS/core is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License
+* as published by the Free Software Foundation, either version 3 of
+* the License, or (at your option) any later version.
+*
+* COSMOS/core is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* Refer to the "licences" folder for further information on the
+* condititons and terms to use this software.
+********************************************************************/
+
+#include "physics/contactlib.h"
+#include <algorithm>
+#include <atomic>
+
+//! Seconds between stored Earth orientations
+#define CONTACT_FRAME_STEP 600.
+//! Seconds between samples while a satellite is near a station
+#define CONTACT_SAMPLE_STEP 20.
+//! Seconds to which AOS and LOS are found
+#define CONTACT_EDGE_TOLERANCE .001
+//! Seconds to which TCA is found
+#define CONTACT_PEAK_TOLERANCE .01
+//! Earth rotation rate (radians/second)
+#define CONTACT_EARTH_RATE 7.2921158553e-5
+
+namespace Cosmos
+{
+    namespace Physics
+    {
+        // Interpolate an ephemeris at the requested time from the positions and velocities either side
+        static Convert::cartpos ephemeris_state(const vector<Convert::cartpos> &ephemeris, double utc)
+        {
+            Convert::cartpos state;
+            auto next = std::upper_bound(ephemeris.begin(), ephemeris.end(), utc, [](double t, const Convert::cartpos &pos) { return t < pos.utc; });
+            if (next == ephemeris.begin())
+            {
+                ++next;
+            }
+            if (next == ephemeris.end())
+            {
+                --next;
+            }
+            const Convert::cartpos &p0 = *(next - 1);
+            const Convert::cartpos &p1 = *next;
+            double h = 86400. * (p1.utc - p0.utc);
+            double tau = 86400. * (utc - p0.utc) / h;
+            double tau2 = tau * tau;
+            double tau3 = tau2 * tau;
+            double h00 = 2. * tau3 - 3. * tau2 + 1.;
+            double h10 = tau3 - 2. * tau2 + tau;
+            double h01 = -2. * tau3 + 3. * tau2;
+            double h11 = tau3 - tau2;
+            double d00 = (6. * tau2 - 6. * tau) / h;
+            double d10 = 3. * tau2 - 4. * tau + 1.;
+            double d01 = (-6. * tau2 + 6. * tau) / h;
+            double d11 = 3. * tau2 - 2. * tau;
+            for (uint16_t i=0; i<3; ++i)
+            {
+                state.s.col[i] = h00 * p0.s.col[i] + h10 * h * p0.v.col[i] + h01 * p1.s.col[i] + h11 * h * p1.v.col[i];
+                state.v.col[i] = d00 * p0.s.col[i] + d10 * p0.v.col[i] + d01 * p1.s.col[i] + d11 * p1.v.col[i];
+            }
+            state.utc = utc;
+            return state;
+        }
+
+        //! Add TLE satellite
+        /*! Add a satellite to be propagated from a Two Line Element.
+            \param tle Two Line Element.
+            \return Index of the satellite, otherwise negative error.
+        */
+        int32_t ContactPredictor::AddSatellite(const Convert::tlestruc &tle)
+        {
+            int32_t iretn;
+            satellite sat;
+            if ((iretn = sat.sgp4.Init(tle)) < 0)
+            {
+                return iretn;
+            }
+
+            // Bound the orbit from its mean elements, allowing for the periodic terms
+            double n = tle.mm;
+            double a = pow(GM / (n * n), 1./3.);
+            double e = std::min(tle.e, .99);
+            sat.rmax = 1.05 * a * (1. + e) + 100000.;
+            sat.latmax = std::min(tle.i, DPI - tle.i) + .01;
+            sat.rate = 1.1 * n * (1. + e) * (1. + e) / pow(1. - e * e, 1.5) + CONTACT_EARTH_RATE;
+            satellites.push_back(sat);
+            return satellites.size() - 1;
+        }
+
+        //! Add ephemeris satellite
+        /*! Add a satellite whose positions are interpolated from a list of ECI states. Contacts
+         * are only searched for over the time covered by the list.
+            \param ephemeris ECI states, in time order, with both position and velocity.
+            \return Index of the satellite, otherwise negative error.
+        */
+        int32_t ContactPredictor::AddSatellite(const vector<Convert::cartpos> &ephemeris)
+        {
+            if (ephemeris.size() < 2)
+            {
+                return GENERAL_ERROR_TOO_LOW;
+            }
+
+            satellite sat;
+            sat.ephemeris = ephemeris;
+            for (const Convert::cartpos &pos : ephemeris)
+            {
+                double r = length_rv(pos.s);
+                if (r <= 0.)
+                {
+                    return GENERAL_ERROR_OUTOFRANGE;
+                }
+                sat.rmax = std::max(sat.rmax, 1.01 * r);
+                sat.rate = std::max(sat.rate, length_rv(pos.v) / r);
+            }
+            sat.rate = 1.1 * sat.rate + CONTACT_EARTH_RATE;
+            satellites.push_back(sat);
+            return satellites.size() - 1;
+        }
+
+        //! Add ground station
+        /*! Add a ground station.
+            \param geod Geodetic location of the station.
+            \param horizon Elevation above which the satellite is in contact (radians).
+            \param minpeak Lowest peak elevation for a contact to be reported (radians).
+            \return Index of the station, otherwise negative error.
+        */
+        int32_t ContactPredictor::AddStation(gvector geod, double horizon, double minpeak)
+        {
+            station sta;
+            sta.geod = geod;
+            sta.horizon = horizon;
+            sta.minpeak = std::max(horizon, minpeak);
+
+            // As in ::Cosmos::Convert::geoc2topo
+            double clon = cos(geod.lon);
+            double slon = sin(geod.lon);
+            double clat = cos(geod.lat);
+            double slat = sin(geod.lat);
+            sta.g2t.row[0] = rvector(-slon, clon, 0.);
+            sta.g2t.row[1] = rvector(-slat * clon, -slat * slon, clat);
+            sta.g2t.row[2] = rvector(clat * clon, clat * slon, slat);
+            double c = 1. / sqrt(clat * clat + FRATIO2 * slat * slat);
+            double s = FRATIO2 * c;
+            double r = (REARTHM * c + geod.h) * clat;
+            sta.geoc = rvector(r * clon, r * slon, (REARTHM * s + geod.h) * slat);
+            sta.up = rv_normal(sta.geoc);
+            stations.push_back(sta);
+            return stations.size() - 1;
+        }
+
+        //! Set thread count
+        /*! Set the number of threads that satellites are shared out across in ::Predict.
+            \param count Number of threads. Zero is taken as one.
+            \return Number of threads.
+        */
+        int32_t ContactPredictor::SetThreads(uint16_t count)
+        {
+            threadcount = count ? count : 1;
+            return threadcount;
+        }
+
+        //! Remove all satellites and stations
+        void ContactPredictor::Clear()
+        {
+            satellites.clear();
+            stations.clear();
+            frames.clear();
+        }
+
+        //! Predict contacts
+        /*! Find every contact between every satellite and every station over the requested period.
+            \param utcstart Start of period (MJD).
+            \param utcend End of period (MJD).
+            \param contacts Contacts found, in order of AOS.
+            \return Number of contacts, otherwise negative error.
+        */
+        int32_t ContactPredictor::Predict(double utcstart, double utcend, vector<contactstruc> &contacts)
+        {
+            contacts.clear();
+            if (!(utcend > utcstart))
+            {
+                return GENERAL_ERROR_OUTOFRANGE;
+            }
+            if (satellites.empty() || stations.empty())
+            {
+                return 0;
+            }
+
+            // Earth orientation over the period, rotated on between entries in Itrs()
+            frames.clear();
+            framestart = utcstart;
+            for (double utc=utcstart; utc<utcend+CONTACT_FRAME_STEP/86400.; utc+=CONTACT_FRAME_STEP/86400.)
+            {
+                frame fr;
+                rmatrix sm, nm, pm, bm, rnp, drm, ddrm;
+                Convert::teme2true(utc, &sm);
+                Convert::true2mean(utc, &nm);
+                Convert::mean2j2000(utc, &pm);
+                Convert::j20002gcrf(&bm);
+                Convert::gcrf2itrs(utc, &rnp, &fr.gcrf, &drm, &ddrm);
+                fr.teme = rm_mmult(fr.gcrf, rm_mmult(bm, rm_mmult(pm, rm_mmult(nm, sm))));
+                frames.push_back(fr);
+            }
+
+            std::atomic<uint32_t> next(0);
+            std::mutex contacts_mutex;
+            auto worker = [&]()
+            {
+                vector<contactstruc> found;
+                uint32_t index;
+                while ((index = next++) < satellites.size())
+                {
+                    Track(index, utcstart, utcend, found);
+                }
+                std::lock_guard<std::mutex> lock(contacts_mutex);
+                contacts.insert(contacts.end(), found.begin(), found.end());
+            };
+
+            vector<std::thread> threads;
+            for (uint16_t i=1; i<threadcount && i<satellites.size(); ++i)
+            {
+                threads.push_back(std::thread(worker));
+            }
+            worker();
+            for (std::thread &thread : threads)
+            {
+                thread.join();
+            }
+
+            std::sort(contacts.begin(), contacts.end(), [](const contactstruc &a, const contactstruc &b)
+            {
+                if (a.aos != b.aos)
+                {
+                    return a.aos < b.aos;
+                }
+                if (a.satellite != b.satellite)
+                {
+                    return a.satellite < b.satellite;
+                }
+                return a.station < b.station;
+            });
+            return contacts.size();
+        }
+
+        //! Satellite position
+        /*! Calculate the ECI state of a satellite at the requested time.
+            \param satellite Index of the satellite.
+            \param utc Time (MJD).
+            \param eci ECI state.
+            \return 0, otherwise negative error.
+        */
+        int32_t ContactPredictor::Position(uint32_t satellite, double utc, Convert::cartpos &eci)
+        {
+            if (satellite >= satellites.size())
+            {
+                return GENERAL_ERROR_OUTOFRANGE;
+            }
+            const ContactPredictor::satellite &sat = satellites[satellite];
+            if (sat.ephemeris.empty())
+            {
+                int32_t iretn;
+                if ((iretn = sat.sgp4.Propagate(utc, eci)) < 0)
+                {
+                    return iretn;
+                }
+                return Convert::teme2eci(utc, eci);
+            }
+            eci = ephemeris_state(sat.ephemeris, utc);
+            return 0;
+        }
+
+        // Geocentric position from the nearest stored Earth orientation, turned by the Earth rotation since
+        rvector ContactPredictor::Itrs(const satellite &sat, double utc) const
+        {
+            double seconds = 86400. * (utc - framestart);
+            size_t index = seconds > 0. ? static_cast<size_t>(seconds / CONTACT_FRAME_STEP) : 0;
+            if (index >= frames.size())
+            {
+                index = frames.size() - 1;
+            }
+            rvector geoc;
+            if (sat.ephemeris.empty())
+            {
+                Convert::cartpos teme;
+                sat.sgp4.Propagate(utc, teme);
+                geoc = rv_mmult(frames[index].teme, teme.s);
+            }
+            else
+            {
+                geoc = rv_mmult(frames[index].gcrf, ephemeris_state(sat.ephemeris, utc).s);
+            }
+
+            double theta = CONTACT_EARTH_RATE * (seconds - index * CONTACT_FRAME_STEP);
+            double ct = cos(theta);
+            double st = sin(theta);
+            double x = geoc.col[0];
+            geoc.col[0] = ct * x + st * geoc.col[1];
+            geoc.col[1] = ct * geoc.col[1] - st * x;
+            return geoc;
+        }
+
+        // Elevation, and optionally azimuth and angle from the sub-satellite point, of the satellite from the station
+        double ContactPredictor::Elevation(const pair &pr, double utc, float *az, double *angle) const
+        {
+            rvector geoc = Itrs(*pr.sat, utc);
+            rvector topo = rv_mmult(pr.sta->g2t, rv_sub(geoc, pr.sta->geoc));
+            if (az != nullptr)
+            {
+                *az = static_cast<float>(atan2(topo.col[0], topo.col[1]));
+            }
+            if (angle != nullptr)
+            {
+                double c = dot_rv(pr.sta->up, geoc) / length_rv(geoc);
+                *angle = acos(std::max(-1., std::min(1., c)));
+            }
+            return atan2(topo.col[2], sqrt(topo.col[0] * topo.col[0] + topo.col[1] * topo.col[1]));
+        }
+
+        // Find the contacts of one satellite with every station
+        void ContactPredictor::Track(uint32_t index, double utcstart, double utcend, vector<contactstruc> &contacts) const
+        {
+            const satellite &sat = satellites[index];
+            if (!sat.ephemeris.empty())
+            {
+                utcstart = std::max(utcstart, sat.ephemeris.front().utc);
+                utcend = std::min(utcend, sat.ephemeris.back().utc);
+                if (!(utcend > utcstart))
+                {
+                    return;
+                }
+            }
+            const double step = CONTACT_SAMPLE_STEP / 86400.;
+
+            for (uint32_t sindex=0; sindex<stations.size(); ++sindex)
+            {
+                const station &sta = stations[sindex];
+                pair pr;
+                pr.sat = &sat;
+                pr.sta = &sta;
+
+                // Widest angle from the station at which the satellite can be above the horizon,
+                // allowing for the difference between geodetic and geocentric vertical
+                double horizon = sta.horizon - RADOF(3.);
+                double rs = length_rv(sta.geoc);
+                if (rs * cos(horizon) >= sat.rmax)
+                {
+                    continue;
+                }
+                pr.reach = acos(rs * cos(horizon) / sat.rmax) - horizon + RADOF(2.);
+                if (fabs(asin(sta.up.col[2])) - sat.latmax > pr.reach)
+                {
+                    continue;
+                }
+
+                // Last three samples, newest last, and the last earlier one below the horizon
+                struct sample
+                {
+                    double utc;
+                    double el;
+                    double angle;
+                };
+                sample samples[3];
+                size_t count = 0;
+                double belowold = -1.;
+                auto push = [&](double utc)
+                {
+                    sample smp;
+                    smp.utc = utc;
+                    smp.el = Elevation(pr, utc, nullptr, &smp.angle);
+                    if (count >= 3 && samples[0].el < sta.horizon)
+                    {
+                        belowold = samples[0].utc;
+                    }
+                    samples[0] = samples[1];
+                    samples[1] = samples[2];
+                    samples[2] = smp;
+                    ++count;
+                };
+
+                // Find the crossing of the horizon between a time below and a time above
+                auto edge = [&](double below, double above) -> double
+                {
+                    while (86400. * fabs(above - below) > CONTACT_EDGE_TOLERANCE)
+                    {
+                        double middle = (below + above) / 2.;
+                        if (Elevation(pr, middle) < sta.horizon)
+                        {
+                            below = middle;
+                        }
+                        else
+                        {
+                            above = middle;
+                        }
+                    }
+                    return (below + above) / 2.;
+                };
+
+                // Check a possible peak between two times, and record the contact if there is one
+                auto peak = [&](double lo, double hi)
+                {
+                    const double gr = (sqrt(5.) - 1.) / 2.;
+                    double x1 = hi - gr * (hi - lo);
+                    double x2 = lo + gr * (hi - lo);
+                    double f1 = Elevation(pr, x1);
+                    double f2 = Elevation(pr, x2);
+                    while (86400. * (hi - lo) > CONTACT_PEAK_TOLERANCE)
+                    {
+                        if (f1 < f2)
+                        {
+                            lo = x1;
+                            x1 = x2;
+                            f1 = f2;
+                            x2 = lo + gr * (hi - lo);
+                            f2 = Elevation(pr, x2);
+                        }
+                        else
+                        {
+                            hi = x2;
+                            x2 = x1;
+                            f2 = f1;
+                            x1 = hi - gr * (hi - lo);
+                            f1 = Elevation(pr, x1);
+                        }
+                    }
+
+                    contactstruc contact;
+                    contact.satellite = index;
+                    contact.station = sindex;
+                    contact.tca = (lo + hi) / 2.;
+                    contact.tcael = static_cast<float>(Elevation(pr, contact.tca, &contact.tcaaz));
+                    if (contact.tcael < sta.horizon)
+                    {
+                        return;
+                    }
+
+                    // AOS from the latest sample below the horizon before the peak
+                    double below = belowold;
+                    for (size_t i=std::min(count, static_cast<size_t>(3)); i>0; --i)
+                    {
+                        const sample &smp = samples[3 - i];
+                        if (smp.utc < contact.tca && smp.el < sta.horizon)
+                        {
+                            below = smp.utc;
+                        }
+                    }
+                    if (below < 0.)
+                    {
+                        contact.aos = utcstart;
+                        contact.clipped = true;
+                    }
+                    else
+                    {
+                        contact.aos = edge(below, contact.tca);
+                    }
+                    Elevation(pr, contact.aos, &contact.aosaz);
+
+                    // LOS from the first sample below the horizon after the peak
+                    while (!(samples[2].el < sta.horizon) && samples[2].utc < utcend)
+                    {
+                        push(std::min(samples[2].utc + step, utcend));
+                    }
+                    double after = samples[2].utc;
+                    for (size_t i=std::min(count, static_cast<size_t>(3)); i>0; --i)
+                    {
+                        const sample &smp = samples[3 - i];
+                        if (smp.utc > contact.tca && smp.el < sta.horizon)
+                        {
+                            after = std::min(after, smp.utc);
+                        }
+                    }
+                    if (Elevation(pr, after) < sta.horizon)
+                    {
+                        contact.los = edge(after, contact.tca);
+                    }
+                    else
+                    {
+                        contact.los = utcend;
+                        contact.clipped = true;
+                    }
+                    Elevation(pr, contact.los, &contact.losaz);
+
+                    if (contact.tcael >= sta.minpeak)
+                    {
+                        contacts.push_back(contact);
+                    }
+                };
+
+                double utc = utcstart;
+                while (true)
+                {
+                    push(utc);
+                    const sample &a = samples[0];
+                    const sample &b = samples[1];
+                    const sample &c = samples[2];
+                    if (count >= 2 && b.angle <= pr.reach && c.el < b.el && (count == 2 || a.el <= b.el))
+                    {
+                        peak(count == 2 ? b.utc : std::max(a.utc, b.utc - step), c.utc);
+                    }
+                    else if (count >= 2 && c.utc >= utcend && c.angle <= pr.reach && c.el > b.el)
+                    {
+                        peak(std::max(b.utc, c.utc - step), c.utc);
+                    }
+                    if (samples[2].utc >= utcend)
+                    {
+                        break;
+                    }
+
+                    // Skip ahead by at least as long as it takes to come back within reach
+                    double angle = samples[2].angle;
+                    double skip = angle > pr.reach ? std::max(step, (angle - pr.reach) / sat.rate / 86400.) : step;
+                    utc = std::min(samples[2].utc + skip, utcend);
+                }
+            }
+        }
+    }
+}
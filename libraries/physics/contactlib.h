@@ -0,0 +1,144 @@
+/********************************************************************
+* Copyright (C) 2015 by Interstel Technologies, Inc.
+*   and Hawaii Space Flight Laboratory.
+*
+* This file is part of the COSMOS/core that is the central
+* module for COSMOS. For more information on COSMOS go to
+* <http://cosmos-project.com>
+*
+* The COSMOS/core software is licenced under the
+* GNU Lesser General Public License (LGPL) version 3 licence.
+*
+* You should have received a copy of the
+* GNU Lesser General Public License
+* If not, go to <http://www.gnu.org/licenses/>
+*
+* COSMOS/core is free software: you can redistribute it and/or
+* modify it under the terms of the GNU Lesser General Public License
+* as published by the Free Software Foundation, either version 3 of
+* the License, or (at your option) any later version.
+*
+* COSMOS/core is distributed in the hope that it will be useful, but
+* WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+* Lesser General Public License for more details.
+*
+* Refer to the "licences" folder for further information on the
+* condititons and terms to use this software.
+********************************************************************/
+
+#ifndef CONTACTLIB_H
+#define CONTACTLIB_H
+
+#include "support/configCosmos.h"
+#include "support/convertlib.h"
+#include "physics/physicsdef.h"
+
+namespace Cosmos
+{
+    namespace Physics
+    {
+        //! Satellite to ground station contact
+        struct contactstruc
+        {
+            //! Index of satellite, in the order added
+            uint32_t satellite = 0;
+            //! Index of station, in the order added
+            uint32_t station = 0;
+            //! Acquisition of signal (MJD) and azimuth (radians)
+            double aos = 0.;
+            float aosaz = 0.;
+            //! Time of closest approach (MJD), azimuth and elevation (radians)
+            double tca = 0.;
+            float tcaaz = 0.;
+            float tcael = 0.;
+            //! Loss of signal (MJD) and azimuth (radians)
+            double los = 0.;
+            float losaz = 0.;
+            //! Contact was already in progress at the start, or still in progress at the end
+            bool clipped = false;
+        };
+
+        //! Contact predictor
+        /*! Finds every contact between a set of satellites and a set of ground stations over a
+         * period, giving the same results as stepping through the period a second at a time, but
+         * without visiting every second. Stations that a satellite's orbit can never rise above
+         * are dropped up front. Otherwise the satellite is skipped ahead by as long as it must
+         * take to come within sight of the station, then sampled coarsely while nearby, with
+         * AOS, TCA and LOS found by root finding between samples. Satellites are shared out
+         * across threads.
+         *
+         * Satellites are either a TLE, propagated with ::Cosmos::Convert::Sgp4, or an
+         * ephemeris of ECI states, interpolated from their positions and velocities.
+         */
+        class ContactPredictor
+        {
+        public:
+            int32_t AddSatellite(const Convert::tlestruc &tle);
+            int32_t AddSatellite(const vector<Convert::cartpos> &ephemeris);
+            int32_t AddStation(gvector geod, double horizon=0., double minpeak=0.);
+            int32_t SetThreads(uint16_t count);
+            int32_t Predict(double utcstart, double utcend, vector<contactstruc> &contacts);
+            int32_t Position(uint32_t satellite, double utc, Convert::cartpos &eci);
+            void Clear();
+
+        private:
+            struct satellite
+            {
+                //! TLE propagator, if there is no ephemeris
+                Convert::Sgp4 sgp4;
+                //! ECI states, in time order
+                vector<Convert::cartpos> ephemeris;
+                //! Largest geocentric radius (m)
+                double rmax = 0.;
+                //! Largest sub-satellite latitude (radians)
+                double latmax = DPI2;
+                //! Largest rate of motion of the sub-satellite point (radians/second)
+                double rate = 0.;
+            };
+
+            struct station
+            {
+                gvector geod;
+                //! Geocentric position (m)
+                rvector geoc;
+                //! Geocentric unit vector
+                rvector up;
+                //! Geocentric to topocentric rotation
+                rmatrix g2t;
+                //! Elevation for AOS and LOS (radians)
+                double horizon;
+                //! Lowest peak elevation to report (radians)
+                double minpeak;
+            };
+
+            //! TEME and GCRF to ITRS rotations at one time
+            struct frame
+            {
+                rmatrix teme;
+                rmatrix gcrf;
+            };
+
+            //! Working state of one satellite and station pair
+            struct pair
+            {
+                const satellite *sat;
+                const station *sta;
+                //! Angular radius about the station beyond which the satellite is below the horizon (radians)
+                double reach;
+            };
+
+            rvector Itrs(const satellite &sat, double utc) const;
+            double Elevation(const pair &pr, double utc, float *az=nullptr, double *angle=nullptr) const;
+            void Track(uint32_t index, double utcstart, double utcend, vector<contactstruc> &contacts) const;
+
+            vector<satellite> satellites;
+            vector<station> stations;
+            vector<frame> frames;
+            double framestart = 0.;
+            uint16_t threadcount = 1;
+        };
+    }
+}
+
+#endif // CONTACTLIB_H
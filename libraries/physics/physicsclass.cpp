@@ -1,5 +1,6 @@
 #include "physicsclass.h"
 #include "support/enumlib.h"
+#include <atomic>
 
 namespace Cosmos
 {
@@ -22,7 +23,7 @@ int32_t PhysCalc(locstruc* loc, physicsstruc* phys)
     if (loc->pos.geod.s.h < 10000. || std::isnan(loc->pos.geod.s.h))
         density = 1.225;
     else
-        density = 1000. * Msis00Density(loc->pos, 150., 150., 3.);
+        density = 1000. * Msis00Density(loc->pos, 150., 150., 3., phys);
     double adrag = density * 1.1 * speed * speed;
 
     // External panel effects
@@ -205,11 +206,6 @@ int32_t AttAccel(locstruc *loc, physicsstruc *phys)
     return 0;
 }
 
-static const uint8_t GravityPGM2000A = 1;
-static const uint8_t GravityEGM2008 = 2;
-static const uint8_t GravityPGM2000A_NORM = 3;
-static const uint8_t GravityEGM2008_NORM = 4;
-
 //! Position acceleration
 /*! Calculate the linear forces on the specified sattelite at the specified location/
             \param phys Pointer to structure specifying satellite.
@@ -239,7 +235,18 @@ int32_t PosAccel(locstruc* loc, physicsstruc* phys)
     {
         // Start with gravity vector in ITRS
 
-        da = GravityAccel(loc->pos,GravityEGM2008_NORM,12);
+        // Only remembered once loaded, so a missing coefficient file is looked for again
+        static std::atomic<const GravityModel *> egm2008{nullptr};
+        const GravityModel *gravity = egm2008.load();
+        if (gravity == nullptr)
+        {
+            gravity = &GravityShared(GravityEGM2008_NORM);
+            if (gravity->status >= 0)
+            {
+                egm2008.store(gravity);
+            }
+        }
+        da = gravity->Accel(loc->pos.geoc.s, 12);
 
         // Correct for earth rotation, polar motion, precession, nutation
 
@@ -349,14 +356,16 @@ int32_t PosAccel(locstruc* loc, physicsstruc* phys)
 
 //! Calculate atmospheric density
 /*! Calculate atmospheric density at indicated Latitute/Longitude/Altitude using the
-         * NRLMSISE-00 atmospheric model.
+         * NRLMSISE-00 atmospheric model. Between full evaluations the density is extrapolated
+         * from the values saved in the supplied ::physicsstruc, so each node keeps its own history.
             \param pos Structure indicating position
             \param f107avg Average 10.7 cm solar flux
             \param f107 Current 10.7 cm solar flux
             \param magidx Ap daily geomagnetic index
+            \param phys Pointer to ::physicsstruc holding the last evaluation
             \return Density in kg/m3
         */
-double Msis00Density(posstruc pos, float f107avg, float f107, float magidx)
+double Msis00Density(posstruc pos, float f107avg, float f107, float magidx, physicsstruc *phys)
 {
     struct nrlmsise_output output;
     struct nrlmsise_input input;
@@ -366,15 +375,12 @@ double Msis00Density(posstruc pos, float f107avg, float f107, float magidx)
                                    {0.,0.,0.,0.,0.,0.,0.,0.,0.,0.,0.,0.,0.,0.,0.,0.,0.,0.,0.,0.,0.,0.,0.,0.}};
     int year, month;
     double day, doy;
-    static double lastmjd = 0.;
-    static double lastdensity = 0.;
-    static double lastperiod = 0.;
 
-    if (lastperiod != 0.)
+    if (phys->density_period != 0.)
     {
-        if (fabs(lastperiod) > (pos.extra.utc-lastmjd))
+        if (fabs(phys->density_period) > (pos.extra.utc-phys->density_utc))
         {
-            return (lastdensity*(1.+(.001*(pos.extra.utc-lastmjd)/lastperiod)));
+            return (phys->density*(1.+(.001*(pos.extra.utc-phys->density_utc)/phys->density_period)));
         }
     }
 
@@ -390,102 +396,214 @@ double Msis00Density(posstruc pos, float f107avg, float f107, float magidx)
     input.ap = magidx;
     gtd7d(&input,&flags,&output);
 
-    if (lastdensity != 0. && lastdensity != output.d[5])
-        lastperiod = (pos.extra.utc-lastmjd)*.001*output.d[5]/(output.d[5]-lastdensity);
-    lastmjd = pos.extra.utc;
-    lastdensity = output.d[5];
+    if (phys->density != 0. && phys->density != output.d[5])
+        phys->density_period = (pos.extra.utc-phys->density_utc)*.001*output.d[5]/(output.d[5]-phys->density);
+    phys->density_utc = pos.extra.utc;
+    phys->density = output.d[5];
     return((double)output.d[5]);
 }
 
+//! Calculate atmospheric density
+/*! Calculate atmospheric density at indicated Latitute/Longitude/Altitude using the
+         * NRLMSISE-00 atmospheric model.
+            \param pos Structure indicating position
+            \param f107avg Average 10.7 cm solar flux
+            \param f107 Current 10.7 cm solar flux
+            \param magidx Ap daily geomagnetic index
+            \return Density in kg/m3
+        */
+double Msis00Density(posstruc pos, float f107avg, float f107, float magidx)
+{
+    static thread_local physicsstruc last;
+    return Msis00Density(pos, f107avg, f107, magidx, &last);
+}
+
 //! Data structures for spherical harmonic expansion
-/*! Coefficients for real and imaginary components of expansion. Of order and rank maxdegree
+/*! Largest degree of any of the supported models
         */
 static const uint16_t maxdegree = 360;
-static double vc[maxdegree+1][maxdegree+1], wc[maxdegree+1][maxdegree+1];
-static double coef[maxdegree+1][maxdegree+1][2];
-static double ftl[2*maxdegree+1];
 static double spmm[maxdegree+1];
 
-//! Spherical harmonic  gravitational vector
-/*!
-        * Calculates a spherical harmonic expansion of the chosen model of indicated order and
-        * degree for the requested position.
-        * The result is returned as a geocentric vector calculated at the epoch.
-            \param pos a ::posstruc providing the position at the epoch
+GravityModel::GravityModel(uint16_t model, uint32_t degree)
+{
+    Load(model, degree);
+}
+
+//! Load gravity model
+/*! Read and normalize the coefficients of the requested model, up to the requested degree.
+ * If the coefficient file can not be read, the field reduces to a point mass.
             \param model Model to use for coefficients
             \param degree Order and degree to calculate
+            \return Zero, or negative error.
+        */
+int32_t GravityModel::Load(uint16_t imodel, uint32_t idegree)
+{
+    uint32_t filedegree;
+    string fname;
+    switch (imodel)
+    {
+    case GravityEGM2008:
+    case GravityEGM2008_NORM:
+        filedegree = 100;
+        fname = "/general/egm2008_coef.txt";
+        break;
+    case GravityPGM2000A:
+    case GravityPGM2000A_NORM:
+    default:
+        filedegree = maxdegree;
+        fname = "/general/pgm2000a_coef.txt";
+        break;
+    }
+
+    model = imodel;
+    degree = idegree < filedegree ? idegree : filedegree;
+    ccoef.assign(((degree+1)*(degree+2))/2, 0.);
+    scoef.assign(((degree+1)*(degree+2))/2, 0.);
+    ccoef[0] = 1.;
+
+    // Factorials, beyond which normalization is done in log space
+    static const uint32_t maxftl = 170;
+    double ftl[maxftl+1];
+    ftl[0] = 1.;
+    for (uint32_t il=1; il<=maxftl; il++)
+    {
+        ftl[il] = il * ftl[il-1];
+    }
+
+    string path;
+    status = get_cosmosresources(path);
+    if (status < 0)
+    {
+        return status;
+    }
+    fname = path + fname;
+    FILE *fi = fopen(fname.c_str(),"r");
+    if (fi == nullptr)
+    {
+        status = -errno;
+        return status;
+    }
+
+    uint32_t dil, dim;
+    double cval, sval, dummy1, dummy2;
+    for (uint32_t il=2; il<=degree; il++)
+    {
+        for (uint32_t im=0; im<= il; im++)
+        {
+            int32_t iretn;
+            if (filedegree == 100)
+            {
+                iretn = fscanf(fi,"%u %u %lf %lf\n",&dil,&dim,&cval,&sval);
+            }
+            else
+            {
+                iretn = fscanf(fi,"%u %u %lf %lf %lf %lf\n",&dil,&dim,&cval,&sval,&dummy1,&dummy2);
+            }
+            if (iretn < 4)
+            {
+                fclose(fi);
+                status = GENERAL_ERROR_BAD_SIZE;
+                return status;
+            }
+            if (model == GravityEGM2008_NORM || model == GravityPGM2000A_NORM)
+            {
+                // Each file has its own convention for the sectoral terms
+                double delta = model == GravityEGM2008_NORM ? (im==0?1:0) : (il==im?1:0);
+                double norm;
+                if (il+im <= maxftl)
+                {
+                    norm = sqrt(ftl[il+im]/((2-delta)*(2*il+1)*ftl[il-im]));
+                }
+                else
+                {
+                    norm = exp(.5 * (lgamma(il+im+1.) - lgamma(il-im+1.) - log((2-delta)*(2*il+1))));
+                }
+                cval /= norm;
+                sval /= norm;
+            }
+            ccoef[(il*(il+1))/2+im] = cval;
+            scoef[(il*(il+1))/2+im] = sval;
+        }
+    }
+    fclose(fi);
+    status = 0;
+    return status;
+}
+
+//! Spherical harmonic gravitational vector
+/*!
+        * Calculates a spherical harmonic expansion of the loaded model for the requested position.
+        * The result is returned as a geocentric vector calculated at the epoch.
+            \param geoc Geocentric position in meters
+            \param idegree Order and degree to calculate, no more than that loaded
+            \param vc Real Legendre terms, (idegree+2)^2 scratch
+            \param wc Imaginary Legendre terms, (idegree+2)^2 scratch
             \return A ::Vector pointing toward the earth
-            \see pgm2000a_coef.txt
         */
-Vector GravityAccel(posstruc pos, uint16_t model, uint32_t degree)
+Vector GravityModel::Evaluate(const rvector &geoc, uint32_t idegree, double *vc, double *wc) const
 {
-    uint32_t il, im;
-    double tmult;
+    const uint32_t stride = idegree + 2;
     double ratio, rratio, xratio, yratio, zratio;
     Vector accel;
-    double fr;
-
-    // Zero out vc and wc
-    memset(vc,0,sizeof(vc));
-    memset(wc,0,sizeof(wc));
-
-    // Load Params
-    GravityParams(model);
 
     // Calculate cartesian Legendre terms
-    vc[0][0] = REARTHM/pos.geos.s.r;
-    wc[0][0] = 0.;
-    ratio = vc[0][0] / pos.geos.s.r;
+    double r = sqrt(geoc.col[0]*geoc.col[0] + geoc.col[1]*geoc.col[1] + geoc.col[2]*geoc.col[2]);
+    vc[0] = REARTHM/r;
+    wc[0] = 0.;
+    ratio = vc[0] / r;
     rratio = REARTHM * ratio;
-    xratio = pos.geoc.s.col[0] * ratio;
-    yratio = pos.geoc.s.col[1] * ratio;
-    zratio = pos.geoc.s.col[2] * ratio;
-    vc[1][0] = zratio * vc[0][0];
-    wc[1][0] = 0.;
-    for (il=2; il<=degree+1; il++)
+    xratio = geoc.col[0] * ratio;
+    yratio = geoc.col[1] * ratio;
+    zratio = geoc.col[2] * ratio;
+    vc[stride] = zratio * vc[0];
+    wc[stride] = 0.;
+    for (uint32_t il=2; il<=idegree+1; il++)
     {
-        vc[il][0] = (2*il-1)*zratio * vc[il-1][0] / il - (il-1) * rratio * vc[il-2][0] / il;
-        wc[il][0] = 0.;
+        vc[il*stride] = (2*il-1)*zratio * vc[(il-1)*stride] / il - (il-1) * rratio * vc[(il-2)*stride] / il;
+        wc[il*stride] = 0.;
     }
-    for (im=1; im<=degree+1; im++)
+    for (uint32_t im=1; im<=idegree+1; im++)
     {
-        vc[im][im] = (2*im-1) * (xratio * vc[im-1][im-1] - yratio * wc[im-1][im-1]);
-        wc[im][im] = (2*im-1) * (xratio * wc[im-1][im-1] + yratio * vc[im-1][im-1]);
-        if (im <= degree)
+        vc[im*stride+im] = (2*im-1) * (xratio * vc[(im-1)*stride+im-1] - yratio * wc[(im-1)*stride+im-1]);
+        wc[im*stride+im] = (2*im-1) * (xratio * wc[(im-1)*stride+im-1] + yratio * vc[(im-1)*stride+im-1]);
+        if (im <= idegree)
         {
-            vc[im+1][im] = (2*im+1) * zratio * vc[im][im];
-            wc[im+1][im] = (2*im+1) * zratio * wc[im][im];
+            vc[(im+1)*stride+im] = (2*im+1) * zratio * vc[im*stride+im];
+            wc[(im+1)*stride+im] = (2*im+1) * zratio * wc[im*stride+im];
         }
-        for (il=im+2; il<=degree+1; il++)
+        for (uint32_t il=im+2; il<=idegree+1; il++)
         {
-            vc[il][im] = (2*il-1) * zratio * vc[il-1][im] / (il-im) - (il+im-1) * rratio * vc[il-2][im] / (il-im);
-            wc[il][im] = (2*il-1) * zratio * wc[il-1][im] / (il-im) - (il+im-1) * rratio * wc[il-2][im] / (il-im);
+            vc[il*stride+im] = (2*il-1) * zratio * vc[(il-1)*stride+im] / (il-im) - (il+im-1) * rratio * vc[(il-2)*stride+im] / (il-im);
+            wc[il*stride+im] = (2*il-1) * zratio * wc[(il-1)*stride+im] / (il-im) - (il+im-1) * rratio * wc[(il-2)*stride+im] / (il-im);
         }
     }
 
-    //	dr = dlon = dlat = 0.;
-
     accel.clear();
-    for (im=0; im<=degree; im++)
+    for (uint32_t im=0; im<=idegree; im++)
     {
-        for (il=im; il<=degree; il++)
+        for (uint32_t il=im; il<=idegree; il++)
         {
+            double cc = ccoef[(il*(il+1))/2+im];
+            double sc = scoef[(il*(il+1))/2+im];
+            const double *vl = &vc[(il+1)*stride];
+            const double *wl = &wc[(il+1)*stride];
             if (im == 0)
             {
-                accel[0] -= coef[il][0][0] * vc[il+1][1];
-                accel[1] -= coef[il][0][0] * wc[il+1][1];
-                accel[2] -= (il+1) * (coef[il][0][0] * vc[il+1][0]);
+                accel[0] -= cc * vl[1];
+                accel[1] -= cc * wl[1];
+                accel[2] -= (il+1) * (cc * vl[0]);
             }
             else
             {
-                fr = ftl[il-im+2] / ftl[il-im];
-                accel[0] -= .5 * (coef[il][im][0] * vc[il+1][im+1] + coef[il][im][1] * wc[il+1][im+1] - fr * (coef[il][im][0] * vc[il+1][im-1] + coef[il][im][1] * wc[il+1][im-1]));
-                accel[1] -= .5 * (coef[il][im][0] * wc[il+1][im+1] - coef[il][im][1] * vc[il+1][im+1] + fr * (coef[il][im][0] * wc[il+1][im-1] - coef[il][im][1] * vc[il+1][im-1]));
-                accel[2] -= (il-im+1) * (coef[il][im][0] * vc[il+1][im] + coef[il][im][1] * wc[il+1][im]);
+                // ftl[il-im+2] / ftl[il-im]
+                double fr = (il-im+1.) * (il-im+2.);
+                accel[0] -= .5 * (cc * vl[im+1] + sc * wl[im+1] - fr * (cc * vl[im-1] + sc * wl[im-1]));
+                accel[1] -= .5 * (cc * wl[im+1] - sc * vl[im+1] + fr * (cc * wl[im-1] - sc * vl[im-1]));
+                accel[2] -= (il-im+1) * (cc * vl[im] + sc * wl[im]);
             }
         }
     }
-    tmult = GM / (REARTHM*REARTHM);
+    double tmult = GM / (REARTHM*REARTHM);
     accel[0] *= tmult;
     accel[2] *= tmult;
     accel[1] *= tmult;
@@ -493,98 +611,154 @@ Vector GravityAccel(posstruc pos, uint16_t model, uint32_t degree)
     return (accel);
 }
 
-int32_t GravityParams(int16_t model)
+//! Per thread scratch space for the Legendre recursion, grown to the largest degree used
+static double *GravityScratch(uint32_t degree)
 {
-    static int16_t cmodel = -1;
+    static thread_local vector<double> scratch;
+    size_t size = 2 * (degree+2) * (degree+2);
+    if (scratch.size() < size)
+    {
+        scratch.resize(size);
+    }
+    return scratch.data();
+}
 
-    int32_t iretn = 0;
-    uint32_t il, im;
-    double norm;
-    uint32_t dil, dim;
-    double dummy1, dummy2;
+//! Spherical harmonic gravitational vector
+/*! \param geoc Geocentric position in meters
+            \return A ::Vector pointing toward the earth
+        */
+Vector GravityModel::Accel(const rvector &geoc) const
+{
+    return Accel(geoc, degree);
+}
+
+//! Spherical harmonic gravitational vector, truncated
+/*! \param geoc Geocentric position in meters
+            \param idegree Order and degree to calculate, limited to that loaded
+            \return A ::Vector pointing toward the earth
+        */
+Vector GravityModel::Accel(const rvector &geoc, uint32_t idegree) const
+{
+    idegree = idegree < degree ? idegree : degree;
+    double *vc = GravityScratch(idegree);
+    return Evaluate(geoc, idegree, vc, vc + (idegree+2)*(idegree+2));
+}
+
+//! Spherical harmonic gravitational vector
+/*! \param pos a ::posstruc providing the geocentric position at the epoch
+            \return A ::Vector pointing toward the earth
+        */
+Vector GravityModel::Accel(const posstruc &pos) const
+{
+    return Accel(pos.geoc.s);
+}
+
+//! Spherical harmonic gravitational vectors for a set of positions
+/*! Evaluates the field for many positions, such as every member of a constellation at
+ * one step, sharing a single scratch area.
+            \param geoc Array of geocentric positions in meters
+            \param accel Array to receive the geocentric accelerations
+            \param count Number of positions
+            \return Number of accelerations calculated
+        */
+int32_t GravityModel::Accel(const rvector *geoc, Vector *accel, size_t count) const
+{
+    return Accel(geoc, accel, count, degree);
+}
 
-    // Calculate factorial
-    if (ftl[0] == 0.)
+//! Spherical harmonic gravitational vectors for a set of positions, truncated
+/*! \param geoc Array of geocentric positions in meters
+            \param accel Array to receive the geocentric accelerations
+            \param count Number of positions
+            \param idegree Order and degree to calculate, limited to that loaded
+            \return Number of accelerations calculated
+        */
+int32_t GravityModel::Accel(const rvector *geoc, Vector *accel, size_t count, uint32_t idegree) const
+{
+    idegree = idegree < degree ? idegree : degree;
+    double *vc = GravityScratch(idegree);
+    double *wc = vc + (idegree+2)*(idegree+2);
+    for (size_t i=0; i<count; ++i)
     {
-        ftl[0] = 1.;
-        for (il=1; il<2*maxdegree+1; il++)
-        {
-            ftl[il] = il * ftl[il-1];
-        }
+        accel[i] = Evaluate(geoc[i], idegree, vc, wc);
     }
+    return count;
+}
 
-    // Load Coefficients
-    if (cmodel != model)
-    {
-        coef[0][0][0] = 1.;
-        coef[0][0][1] = 0.;
-        coef[1][0][0] = coef[1][0][1] = 0.;
-        coef[1][1][0] = coef[1][1][1] = 0.;
-        string fname;
-        FILE *fi;
-        switch (model)
-        {
-        case GravityEGM2008:
-        case GravityEGM2008_NORM:
-            fname = get_cosmosresources();
-            if (fname.empty())
-            {
-                return GENERAL_ERROR_EMPTY;
-            }
-            fname += "/general/egm2008_coef.txt";
-            fi = fopen(fname.c_str(),"r");
+int32_t GravityModel::Accel(const vector<rvector> &geoc, vector<Vector> &accel) const
+{
+    return Accel(geoc, accel, degree);
+}
 
-            if (fi==nullptr)
-            {
-                cout << "could not load file " << fname << endl;
-                return iretn;
-            }
+int32_t GravityModel::Accel(const vector<rvector> &geoc, vector<Vector> &accel, uint32_t idegree) const
+{
+    accel.resize(geoc.size());
+    return Accel(geoc.data(), accel.data(), geoc.size(), idegree);
+}
 
-            for (il=2; il<101; il++)
-            {
-                for (im=0; im<= il; im++)
-                {
-                    iretn = fscanf(fi,"%u %u %lf %lf\n",&dil,&dim,&coef[il][im][0],&coef[il][im][1]);
-                    if (iretn && model == GravityEGM2008_NORM)
-                    {
-                        norm = sqrt(ftl[il+im]/((2-(im==0?1:0))*(2*il+1)*ftl[il-im]));
-                        coef[il][im][0] /= norm;
-                        coef[il][im][1] /= norm;
-                    }
-                }
-            }
-            fclose(fi);
-            cmodel = model;
-            break;
-        case GravityPGM2000A:
-        case GravityPGM2000A_NORM:
-        default:
-            iretn = get_cosmosresources(fname);
-            if (iretn < 0)
+//! Shared gravity model
+/*! Return the process wide instance of the requested model, loading every coefficient in its
+ * file on first use. Callers choose the degree when they evaluate it. The instance remains
+ * valid for the life of the program. A model that fails to load is not kept: the next call
+ * tries again, and until one succeeds the failed instance, which only has the central term,
+ * is returned with its negative ::GravityModel::status.
+            \param model Model to use for coefficients
+            \return Reference to ::GravityModel
+        */
+const GravityModel &GravityShared(uint16_t model)
+{
+    static std::mutex models_mutex;
+    static map<uint16_t, GravityModel*> models;
+    // One failed instance per model, still valid for any caller holding it
+    static map<uint16_t, GravityModel*> failed;
+
+    std::lock_guard<std::mutex> lock(models_mutex);
+    GravityModel *&shared = models[model];
+    if (shared == nullptr)
+    {
+        GravityModel *loaded = new GravityModel(model, maxdegree);
+        if (loaded->status < 0)
+        {
+            GravityModel *&last = failed[model];
+            if (last == nullptr)
             {
-                return iretn;
+                last = loaded;
             }
-            fname += "/general/pgm2000a_coef.txt";
-            fi = fopen(fname.c_str(),"r");
-            for (il=2; il<361; il++)
+            else
             {
-                for (im=0; im<= il; im++)
-                {
-                    iretn = fscanf(fi,"%u %u %lf %lf %lf %lf\n",&dil,&dim,&coef[il][im][0],&coef[il][im][1],&dummy1,&dummy2);
-                    if (iretn && model == GravityPGM2000A_NORM)
-                    {
-                        norm = sqrt(ftl[il+im]/((2-(il==im?1:0))*(2*il+1)*ftl[il-im]));
-                        coef[il][im][0] /= norm;
-                        coef[il][im][1] /= norm;
-                    }
-                }
+                delete loaded;
             }
-            fclose(fi);
-            cmodel = model;
-            break;
+            return *last;
         }
+        shared = loaded;
     }
-    return 0;
+    return *shared;
+}
+
+//! Spherical harmonic  gravitational vector
+/*!
+        * Calculates a spherical harmonic expansion of the chosen model of indicated order and
+        * degree for the requested position.
+        * The result is returned as a geocentric vector calculated at the epoch.
+            \param pos a ::posstruc providing the position at the epoch
+            \param model Model to use for coefficients
+            \param degree Order and degree to calculate
+            \return A ::Vector pointing toward the earth
+            \see pgm2000a_coef.txt
+        */
+Vector GravityAccel(posstruc pos, uint16_t model, uint32_t degree)
+{
+    return GravityShared(model).Accel(pos.geoc.s, degree);
+}
+
+//! Load gravity model
+/*! Preload the shared instance of the requested model.
+            \param model Model to use for coefficients
+            \return Zero, or negative error.
+        */
+int32_t GravityParams(int16_t model)
+{
+    return GravityShared(model).status;
 }
 
 double Nplgndr(uint32_t l, uint32_t m, double x)
@@ -2959,12 +3133,17 @@ int32_t MetricGenerator::Propagate(double nextutc)
     if (coverage.size() != currentinfo->target.size())
     {
         coverage.resize(currentinfo->target.size());
-        for (uint16_t i=0; i<currentinfo->target.size(); ++i)
+        for (size_t i=0; i<currentinfo->target.size(); ++i)
         {
             coverage[i].resize(currentinfo->devspec.cam.size());
         }
     }
 
+    // Only the targets update_target() just visited can be in view, if it has indexed them
+    const targetindex &index = currentinfo->target_index;
+    bool indexed = index.count == currentinfo->target.size() && index.base == currentinfo->target.data();
+    size_t visits = indexed ? index.updated.size() : currentinfo->target.size();
+
     //    bool printed = false;
     for (uint16_t id=0; id<currentinfo->devspec.cam.size(); ++id)
     {
@@ -2975,8 +3154,9 @@ int32_t MetricGenerator::Propagate(double nextutc)
         // sat2geoc(currentinfo->devspec.cam[id].los, currentinfo->node.loc, cpointing.s);
         // geoidpos gpointing;
         // geoc2geod(cpointing, gpointing);
-        for (uint16_t it=0; it<currentinfo->target.size(); ++it)
+        for (size_t iv=0; iv<visits; ++iv)
         {
+            size_t it = indexed ? index.updated[iv] : iv;
             // Must be at least 5 degrees
             currentinfo->target[it].cover[id].area = 0.;
             currentinfo->target[it].cover[id].percent = 0.;
@@ -3844,6 +4024,7 @@ int32_t TlePositionPropagator::Init()
 {
     //    eci2tle(currentutc, currentinfo->node.loc.pos.eci, tle);
     //    PosAccel(currentinfo->node.loc, currentinfo->node.phys);
+    sgp4.Init(currentinfo->node.loc.tle);
 
     return 0;
 }
@@ -3866,7 +4047,12 @@ int32_t TlePositionPropagator::Propagate(double nextutc)
     while ((nextutc - currentutc) > dtj / 2.)
     {
         currentutc += dtj;
-        tle2eci(currentutc, currentinfo->node.loc.tle, currentinfo->node.loc.pos.eci);
+        if (!sgp4.Matches(currentinfo->node.loc.tle))
+        {
+            sgp4.Init(currentinfo->node.loc.tle);
+        }
+        sgp4.Propagate(currentutc, currentinfo->node.loc.pos.eci);
+        teme2eci(currentutc, currentinfo->node.loc.pos.eci);
         currentinfo->node.loc.pos.eci.pass++;
         pos_eci(currentinfo->node.loc);
         PosAccel(currentinfo->node.loc, currentinfo->node.phys);
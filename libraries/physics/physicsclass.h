@@ -224,6 +224,8 @@ namespace Cosmos
             int32_t Reset(double nextutc=0.);
 
         private:
+            //! SGP4 for the current TLE
+            Sgp4 sgp4;
         };
 
         class GaussJacksonPositionPropagator : public Propagator
@@ -624,8 +626,48 @@ namespace Cosmos
         };
 
 
+        static const uint8_t GravityPGM2000A = 1;
+        static const uint8_t GravityEGM2008 = 2;
+        static const uint8_t GravityPGM2000A_NORM = 3;
+        static const uint8_t GravityEGM2008_NORM = 4;
+
+        //! Spherical harmonic gravity field
+        //! Coefficients for one model are loaded and normalized once, truncated to the requested
+        //! degree. Evaluation only reads the object, so a single instance can be shared by any
+        //! number of propagation threads. The Legendre recursion uses scratch space sized to the
+        //! degree rather than the full 360x360 tables.
+        class GravityModel
+        {
+        public:
+            GravityModel(uint16_t model=GravityEGM2008_NORM, uint32_t degree=12);
+
+            int32_t Load(uint16_t model, uint32_t degree);
+            Vector Accel(const rvector &geoc) const;
+            Vector Accel(const rvector &geoc, uint32_t degree) const;
+            Vector Accel(const posstruc &pos) const;
+            int32_t Accel(const rvector *geoc, Vector *accel, size_t count) const;
+            int32_t Accel(const rvector *geoc, Vector *accel, size_t count, uint32_t degree) const;
+            int32_t Accel(const vector<rvector> &geoc, vector<Vector> &accel) const;
+            int32_t Accel(const vector<rvector> &geoc, vector<Vector> &accel, uint32_t degree) const;
+
+            uint16_t model = 0;
+            uint32_t degree = 0;
+            //! Result of the last ::Load, zero or negative error
+            int32_t status = 0;
+
+        private:
+            //! Cosine and sine coefficients, packed by degree at [il*(il+1)/2+im]
+            vector<double> ccoef;
+            vector<double> scoef;
+
+            Vector Evaluate(const rvector &geoc, uint32_t degree, double *vc, double *wc) const;
+        };
+
+        const GravityModel &GravityShared(uint16_t model);
+
 //        double Rearth(double lat);
         double Msis00Density(posstruc pos,float f107avg,float f107,float magidx);
+        double Msis00Density(posstruc pos,float f107avg,float f107,float magidx, physicsstruc *phys);
         Vector GravityAccel(posstruc pos, uint16_t model, uint32_t degree);
         int32_t GravityParams(int16_t model);
         double Nplgndr(uint32_t l, uint32_t m, double x);
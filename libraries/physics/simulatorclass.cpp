@@ -1,11 +1,432 @@
 #include "simulatorclass.h"
 #include "support/jsonclass.h"
 #include "support/stringlib.h"
+#include <fstream>
+#if !defined(COSMOS_WIN_OS)
+#include <sys/mman.h>
+#include <fcntl.h>
+#endif
 
 namespace Cosmos
 {
 namespace Physics
 {
+//! Plain data types that may be captured, with their sizes
+template <class T> constexpr size_t capture_size()
+{
+    static_assert(std::is_trivially_copyable<T>::value, "Captured types must be plain data");
+    return sizeof(T);
+}
+
+static size_t capture_type_size(const string &type)
+{
+    static const map<string, size_t> sizes = {
+        {"double", capture_size<double>()},
+        {"float", capture_size<float>()},
+        {"int", capture_size<int>()},
+        {"bool", capture_size<bool>()},
+        {"size_t", capture_size<size_t>()},
+        {"uint32_t", capture_size<uint32_t>()},
+        {"int32_t", capture_size<int32_t>()},
+        {"uint16_t", capture_size<uint16_t>()},
+        {"int16_t", capture_size<int16_t>()},
+        {"uint8_t", capture_size<uint8_t>()},
+        {"int8_t", capture_size<int8_t>()},
+        {"rvector", capture_size<rvector>()},
+        {"rmatrix", capture_size<rmatrix>()},
+        {"cvector", capture_size<cvector>()},
+        {"gvector", capture_size<gvector>()},
+        {"svector", capture_size<svector>()},
+        {"quaternion", capture_size<quaternion>()},
+        {"Vector", capture_size<Vector>()},
+        {"cartpos", capture_size<cartpos>()},
+        {"qatt", capture_size<qatt>()},
+        {"geoidpos", capture_size<geoidpos>()},
+        {"spherpos", capture_size<spherpos>()},
+    };
+    auto it = sizes.find(type);
+    return it == sizes.end() ? 0 : it->second;
+}
+
+Capture::~Capture()
+{
+    Close();
+}
+
+//! Add a name to be captured
+/*! Must be called before ::Init.
+    \param name Namespace 2.0 name of a plain data value, such as node.loc.pos.eci
+    \return Number of columns, or negative error.
+*/
+int32_t Capture::AddField(string name)
+{
+    if (storage != nullptr)
+    {
+        return GENERAL_ERROR_BUSY;
+    }
+    column col;
+    col.name = name;
+    columns.push_back(col);
+    return columns.size();
+}
+
+//! Index of a captured name
+/*! \param name Namespace 2.0 name
+    \return Column index, or negative error.
+*/
+int32_t Capture::Column(string name)
+{
+    for (size_t i=0; i<columns.size(); ++i)
+    {
+        if (columns[i].name == name)
+        {
+            return i;
+        }
+    }
+    return GENERAL_ERROR_NAME;
+}
+
+//! Prepare capture storage
+/*! Resolve each name against every node and allocate storage for the requested number of steps.
+    \param cnodes Nodes to capture, in the order they will be stored
+    \param nrows Number of steps to allocate
+    \param npath File to map the storage to, or empty for memory only
+    \return Zero, or negative error.
+*/
+int32_t Capture::Init(const vector<Physics::State*> &cnodes, uint32_t nrows, string npath)
+{
+    if (storage != nullptr)
+    {
+        return GENERAL_ERROR_BUSY;
+    }
+    if (!nrows || cnodes.empty())
+    {
+        return GENERAL_ERROR_ZEROSIZE;
+    }
+
+    nodes.clear();
+    for (Physics::State *state : cnodes)
+    {
+        nodes.push_back(state->currentinfo.node.name);
+    }
+
+    size_t offset = nrows * sizeof(double);
+    for (column &col : columns)
+    {
+        col.type = cnodes[0]->currentinfo.get_type(col.name);
+        col.size = capture_type_size(col.type);
+        if (!col.size)
+        {
+            return GENERAL_ERROR_NAME;
+        }
+        col.sources.clear();
+        for (Physics::State *state : cnodes)
+        {
+            uint8_t *source = static_cast<uint8_t *>(state->currentinfo.get_pointer(col.name));
+            if (source == nullptr)
+            {
+                return GENERAL_ERROR_NAME;
+            }
+            col.sources.push_back(source);
+        }
+        col.offset = offset;
+        offset += nrows * cnodes.size() * col.size;
+    }
+
+    rows = nrows;
+    count = 0;
+    storagesize = offset;
+    path = npath;
+    int32_t iretn = Allocate();
+    if (iretn < 0)
+    {
+        rows = 0;
+        storagesize = 0;
+    }
+    return iretn;
+}
+
+int32_t Capture::Allocate()
+{
+    if (path.empty())
+    {
+        storage = new (std::nothrow) uint8_t[storagesize];
+        if (storage == nullptr)
+        {
+            return GENERAL_ERROR_MEMORY;
+        }
+        return 0;
+    }
+
+#if defined(COSMOS_WIN_OS)
+    // Without mmap the capture is kept in memory and written to the file by ::Close
+    storage = new (std::nothrow) uint8_t[storagesize];
+    if (storage == nullptr)
+    {
+        return GENERAL_ERROR_MEMORY;
+    }
+    int32_t iretn = WriteHeader();
+    if (iretn < 0)
+    {
+        delete [] storage;
+        storage = nullptr;
+    }
+    return iretn;
+#else
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        return -errno;
+    }
+    if (ftruncate(fd, storagesize) < 0)
+    {
+        int32_t iretn = -errno;
+        ::close(fd);
+        fd = -1;
+        return iretn;
+    }
+    void *map = mmap(nullptr, storagesize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+    {
+        int32_t iretn = -errno;
+        ::close(fd);
+        fd = -1;
+        return iretn;
+    }
+    storage = static_cast<uint8_t *>(map);
+    int32_t iretn = WriteHeader();
+    if (iretn < 0)
+    {
+        munmap(map, storagesize);
+        storage = nullptr;
+        ::close(fd);
+        fd = -1;
+    }
+    return iretn;
+#endif
+}
+
+//! Describe a mapped capture in its JSON sidecar
+int32_t Capture::WriteHeader()
+{
+    json11::Json::array jcolumns;
+    for (const column &col : columns)
+    {
+        jcolumns.push_back(json11::Json::object {
+                               {"name", col.name},
+                               {"type", col.type},
+                               {"size", static_cast<int>(col.size)},
+                               {"offset", static_cast<double>(col.offset)}
+                           });
+    }
+    json11::Json jheader = json11::Json::object {
+        {"rows", static_cast<int>(rows)},
+        {"count", static_cast<int>(count)},
+        {"nodes", nodes},
+        {"columns", jcolumns}
+    };
+
+    FILE *fp = fopen((path + ".json").c_str(), "w");
+    if (fp == nullptr)
+    {
+        return -errno;
+    }
+    fputs(jheader.dump().c_str(), fp);
+    fclose(fp);
+    return 0;
+}
+
+//! Reopen a mapped capture
+/*! Map a capture written by a previous run, read only, using its JSON sidecar.
+    \param npath File the capture was mapped to
+    \return Number of captured steps, or negative error.
+*/
+int32_t Capture::Open(string npath)
+{
+    if (storage != nullptr)
+    {
+        return GENERAL_ERROR_BUSY;
+    }
+
+    std::ifstream hfile(npath + ".json");
+    if (!hfile.is_open())
+    {
+        return -errno;
+    }
+    string contents((std::istreambuf_iterator<char>(hfile)), std::istreambuf_iterator<char>());
+    int32_t iretn;
+    string error;
+    json11::Json jheader = json11::Json::parse(contents, error);
+    if (!error.empty())
+    {
+        return GENERAL_ERROR_INPUT;
+    }
+
+    rows = jheader["rows"].int_value();
+    count = jheader["count"].int_value();
+    nodes.clear();
+    for (const json11::Json &jnode : jheader["nodes"].array_items())
+    {
+        nodes.push_back(jnode.string_value());
+    }
+    columns.clear();
+    for (const json11::Json &jcol : jheader["columns"].array_items())
+    {
+        column col;
+        col.name = jcol["name"].string_value();
+        col.type = jcol["type"].string_value();
+        col.size = jcol["size"].int_value();
+        col.offset = jcol["offset"].number_value();
+        columns.push_back(col);
+    }
+
+#if defined(COSMOS_WIN_OS)
+    FILE *fp = fopen(npath.c_str(), "rb");
+    if (fp == nullptr)
+    {
+        iretn = -errno;
+        Close();
+        return iretn;
+    }
+    fseek(fp, 0, SEEK_END);
+    storagesize = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    storage = new (std::nothrow) uint8_t[storagesize];
+    if (storage == nullptr)
+    {
+        fclose(fp);
+        Close();
+        return GENERAL_ERROR_MEMORY;
+    }
+    storagesize = fread(storage, 1, storagesize, fp);
+    fclose(fp);
+#else
+    fd = ::open(npath.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        iretn = -errno;
+        Close();
+        return iretn;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0)
+    {
+        iretn = -errno;
+        Close();
+        return iretn;
+    }
+    storagesize = st.st_size;
+    void *map = mmap(nullptr, storagesize, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+    {
+        iretn = -errno;
+        Close();
+        return iretn;
+    }
+    storage = static_cast<uint8_t *>(map);
+#endif
+    path.clear();
+    readonly = true;
+    return count;
+}
+
+//! Capture the current state of every node
+/*! \param utc Time of this step
+    \return Number of captured steps, or negative error.
+*/
+int32_t Capture::Append(double utc)
+{
+    if (storage == nullptr)
+    {
+        return GENERAL_ERROR_NOTSTARTED;
+    }
+    if (ReadOnly())
+    {
+        return GENERAL_ERROR_BAD_FD;
+    }
+    if (count >= rows)
+    {
+        return GENERAL_ERROR_OVERSIZE;
+    }
+
+    reinterpret_cast<double *>(storage)[count] = utc;
+    size_t row = static_cast<size_t>(count) * nodes.size();
+    for (const column &col : columns)
+    {
+        uint8_t *dest = storage + col.offset + row * col.size;
+        for (uint8_t *source : col.sources)
+        {
+            memcpy(dest, source, col.size);
+            dest += col.size;
+        }
+    }
+    return ++count;
+}
+
+//! Release capture storage
+/*! A mapped capture has its sidecar updated with the final step count. The capture is left
+ * empty, with no names, ready for ::AddField and ::Init or ::Open.
+    \return Zero, or negative error.
+*/
+int32_t Capture::Close()
+{
+    int32_t iretn = 0;
+    if (storage != nullptr)
+    {
+        if (fd < 0)
+        {
+            if (!path.empty())
+            {
+                // Capture to a file without mmap, written out now
+                FILE *fp = fopen(path.c_str(), "wb");
+                if (fp == nullptr)
+                {
+                    iretn = -errno;
+                }
+                else
+                {
+                    if (fwrite(storage, 1, storagesize, fp) != storagesize)
+                    {
+                        iretn = -errno;
+                    }
+                    fclose(fp);
+                    if (iretn == 0)
+                    {
+                        iretn = WriteHeader();
+                    }
+                }
+            }
+            delete [] storage;
+        }
+#if !defined(COSMOS_WIN_OS)
+        else
+        {
+            if (!path.empty())
+            {
+                iretn = WriteHeader();
+            }
+            munmap(storage, storagesize);
+        }
+#endif
+    }
+#if !defined(COSMOS_WIN_OS)
+    if (fd >= 0)
+    {
+        ::close(fd);
+        fd = -1;
+    }
+#endif
+    storage = nullptr;
+    storagesize = 0;
+    path.clear();
+    readonly = false;
+    rows = 0;
+    count = 0;
+    nodes.clear();
+    columns.clear();
+    return iretn;
+}
+
 int32_t Simulator::Init(double idt, string realm, double iutc)
 {
     realmname = realm;
@@ -1223,6 +1644,14 @@ int32_t Simulator::Reset()
     return error;
 }
 
+//! Propagate all nodes to the next time step
+/*! Nodes are stepped in groups of equal ::State::propagation_priority, lowest first. When
+ * ::SetThreads has been given more than one thread, the nodes within a group are shared out
+ * across the pool, and each group completes before the next begins, so LVLH followers in a
+ * later group always see the updated mothership.
+    \param nextutc Time to propagate to, or zero to advance by one time step.
+    \return Result of the last node, or negative error.
+*/
 int32_t Simulator::Propagate(double nextutc)
 {
     int iretn = 0;
@@ -1233,25 +1662,151 @@ int32_t Simulator::Propagate(double nextutc)
     else {
         currentutc = nextutc;
     }
-    for (auto &state : cnodes)
+
+    if (workers.empty())
     {
-        switch(state->ptype)
+        for (size_t i=0; i<cnodes.size(); ++i)
         {
-        case Physics::Propagator::Type::PositionInertial:
-        case Physics::Propagator::Type::PositionIterative:
-        case Physics::Propagator::Type::PositionGaussJackson:
-        case Physics::Propagator::Type::PositionGeo:
-        case Physics::Propagator::Type::PositionTle:
-            iretn = state->Propagate(currentutc);
-            break;
-        case Physics::Propagator::Type::PositionLvlh:
-            iretn = state->Propagate(cnodes[0]->currentinfo.node.loc);
-            break;
-        default:
-            break;
+            iretn = PropagateNode(i);
         }
+        return iretn;
     }
-    return iretn;
+
+    work_iretn.assign(cnodes.size(), 0);
+    size_t begin = 0;
+    while (begin < cnodes.size())
+    {
+        size_t end = begin + 1;
+        bool lvlh = cnodes[begin]->ptype == Physics::Propagator::Type::PositionLvlh;
+        while (end < cnodes.size() && cnodes[end]->propagation_priority == cnodes[begin]->propagation_priority)
+        {
+            lvlh = lvlh || cnodes[end]->ptype == Physics::Propagator::Type::PositionLvlh;
+            ++end;
+        }
+
+        // LVLH followers sharing a group with the mothership must wait for it
+        if (begin == 0 && lvlh)
+        {
+            work_iretn[0] = PropagateNode(0);
+            PropagateGroup(1, end);
+        }
+        else
+        {
+            PropagateGroup(begin, end);
+        }
+        begin = end;
+    }
+    return work_iretn.empty() ? 0 : work_iretn.back();
+}
+
+//! Propagate one node to ::currentutc
+int32_t Simulator::PropagateNode(size_t idx)
+{
+    Physics::State *state = cnodes[idx];
+    switch(state->ptype)
+    {
+    case Physics::Propagator::Type::PositionInertial:
+    case Physics::Propagator::Type::PositionIterative:
+    case Physics::Propagator::Type::PositionGaussJackson:
+    case Physics::Propagator::Type::PositionGeo:
+    case Physics::Propagator::Type::PositionTle:
+        return state->Propagate(currentutc);
+    case Physics::Propagator::Type::PositionLvlh:
+        return state->Propagate(cnodes[0]->currentinfo.node.loc);
+    default:
+        return 0;
+    }
+}
+
+//! Propagate a range of nodes across the thread pool, returning once all are done
+int32_t Simulator::PropagateGroup(size_t begin, size_t end)
+{
+    if (end - begin < 2)
+    {
+        for (size_t i=begin; i<end; ++i)
+        {
+            work_iretn[i] = PropagateNode(i);
+        }
+        return 0;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(work_mutex);
+        work_next = begin;
+        work_end = end;
+        work_busy = workers.size() + 1;
+        ++work_generation;
+    }
+    work_start.notify_all();
+    WorkerRun();
+
+    std::unique_lock<std::mutex> lock(work_mutex);
+    work_done.wait(lock, [this]{ return work_busy == 0; });
+    return 0;
+}
+
+//! Step nodes from the current group until none are left
+void Simulator::WorkerRun()
+{
+    size_t idx;
+    while ((idx = work_next.fetch_add(1)) < work_end)
+    {
+        work_iretn[idx] = PropagateNode(idx);
+    }
+
+    std::lock_guard<std::mutex> lock(work_mutex);
+    if (--work_busy == 0)
+    {
+        work_done.notify_one();
+    }
+}
+
+void Simulator::WorkerLoop(uint32_t generation)
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(work_mutex);
+            work_start.wait(lock, [&]{ return work_shutdown || work_generation != generation; });
+            if (work_shutdown)
+            {
+                return;
+            }
+            generation = work_generation;
+        }
+        WorkerRun();
+    }
+}
+
+//! Set number of propagation threads
+/*! Nodes within a propagation priority are stepped in parallel by this many threads,
+ * including the caller. A count of one restores serial stepping.
+    \param count Number of threads.
+    \return Number of threads in use.
+*/
+int32_t Simulator::SetThreads(uint16_t count)
+{
+    if (!workers.empty())
+    {
+        {
+            std::lock_guard<std::mutex> lock(work_mutex);
+            work_shutdown = true;
+        }
+        work_start.notify_all();
+        for (std::thread &worker : workers)
+        {
+            worker.join();
+        }
+        workers.clear();
+        work_shutdown = false;
+    }
+
+    threadcount = count ? count : 1;
+    for (uint16_t i=1; i<threadcount; ++i)
+    {
+        workers.push_back(std::thread(&Simulator::WorkerLoop, this, work_generation));
+    }
+    return threadcount;
 }
 
 int32_t Simulator::Propagate(vector<vector<cosmosstruc> > &results, uint32_t runcount)
@@ -1284,6 +1839,49 @@ int32_t Simulator::Propagate(vector<vector<cosmosstruc> > &results, uint32_t run
     return results.size();
 }
 
+//! Propagate, capturing selected values
+/*! Capture the current state, then propagate runcount steps capturing each one. If the
+ * capture has not been initialized, storage is allocated in memory for exactly this run.
+ * Nothing is propagated unless the capture has room for every step.
+    \param capture ::Capture with the names of interest added
+    \param runcount Number of steps to propagate
+    \return Number of captured steps, or negative error.
+*/
+int32_t Simulator::Propagate(Capture &capture, uint32_t runcount)
+{
+    int32_t iretn;
+    if (capture.ReadOnly())
+    {
+        return GENERAL_ERROR_BAD_FD;
+    }
+    if (!capture.rows)
+    {
+        iretn = capture.Init(cnodes, runcount + 1);
+        if (iretn < 0)
+        {
+            return iretn;
+        }
+    }
+    else if (static_cast<uint64_t>(capture.count) + runcount >= capture.rows)
+    {
+        return GENERAL_ERROR_OVERSIZE;
+    }
+
+    for (uint16_t i=0; i<cnodes.size(); ++i)
+    {
+        update_metrics(&cnodes[i]->currentinfo);
+    }
+    iretn = capture.Append(currentutc);
+    uint32_t runtotal = 0;
+    while (iretn >= 0 && runtotal++ < runcount)
+    {
+        Propagate(0.);
+        iretn = capture.Append(currentutc);
+    }
+
+    return iretn;
+}
+
 int32_t Simulator::Target(map<uint32_t, vector<pointing_info> > &pschedule)
 {
     if (pschedule.size() > 1 && pschedule.begin()->second.size() >= cnodes.size())
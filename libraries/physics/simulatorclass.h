@@ -6,6 +6,7 @@
 #include "support/convertlib.h"
 #include "physics/physicsclass.h"
 #include "physics/controllib.h"
+#include <atomic>
 
 #define SIMULATOR_PORT_OUT 10030
 #define CLIENT_PORT_OUT 10031
@@ -14,6 +15,82 @@ namespace Cosmos
 {
     namespace Physics
     {
+        //! Columnar capture of simulation results
+        /*! Records selected Namespace 2.0 names for every node at every step. Each name becomes
+         * one column of raw values laid out [step][node], with an extra column of step times.
+         * All storage is allocated up front for a fixed number of steps, either on the heap or in
+         * a memory mapped file, so long runs stay bounded in memory. A mapped capture is described
+         * by a JSON sidecar file so it can be reopened with ::Open without re-parsing any text.
+         * Where mmap is not available, a file capture is held on the heap and written out by
+         * ::Close, and ::Open reads the file back whole.
+         */
+        class Capture
+        {
+        public:
+            struct column
+            {
+                //! Namespace 2.0 name
+                string name;
+                //! Namespace 2.0 type
+                string type;
+                //! Bytes per value
+                size_t size = 0;
+                //! Offset of column within the capture storage
+                size_t offset = 0;
+                //! Location of the value within each node, while capturing
+                vector<uint8_t *> sources;
+            };
+
+            Capture() {}
+            ~Capture();
+            Capture(const Capture&) = delete;
+            Capture &operator=(const Capture&) = delete;
+
+            int32_t AddField(string name);
+            int32_t Init(const vector<Physics::State*> &nodes, uint32_t rows, string path="");
+            int32_t Open(string path);
+            int32_t Append(double utc);
+            int32_t Close();
+            int32_t Column(string name);
+
+            //! Opened from a previous run with ::Open, so it can not be appended to
+            bool ReadOnly() const
+            {
+                return readonly;
+            }
+
+            //! Time of a captured step
+            double Utc(uint32_t row) const
+            {
+                return reinterpret_cast<const double *>(storage)[row];
+            }
+
+            //! Value of a column for one node at one step
+            template<class T>
+            const T &Value(size_t col, uint32_t row, uint16_t node) const
+            {
+                return *reinterpret_cast<const T *>(storage + columns[col].offset + (static_cast<size_t>(row) * nodes.size() + node) * columns[col].size);
+            }
+
+            vector<column> columns;
+            //! Names of the captured nodes, in column order
+            vector<string> nodes;
+            //! Number of steps allocated
+            uint32_t rows = 0;
+            //! Number of steps captured
+            uint32_t count = 0;
+
+        private:
+            uint8_t *storage = nullptr;
+            size_t storagesize = 0;
+            string path;
+            int fd = -1;
+            bool readonly = false;
+
+            int32_t Allocate();
+            int32_t WriteHeader();
+        };
+
         class Simulator
         {
         public:
@@ -25,6 +102,10 @@ namespace Cosmos
                 error = 0;
             }
 
+            ~Simulator() {
+                SetThreads(1);
+            }
+
             enum State {
                 Halted =0,
                 Paused,
@@ -66,6 +147,8 @@ namespace Cosmos
             int32_t GetError();
             int32_t Propagate(double nextutc=0.);
             int32_t Propagate(vector<vector<cosmosstruc> > &results, uint32_t runcount);
+            int32_t Propagate(Capture &capture, uint32_t runcount);
+            int32_t SetThreads(uint16_t count);
             int32_t Target(map<uint32_t, vector<pointing_info> > &pschedule);
             int32_t Target();
             int32_t Target(vector<vector<cosmosstruc> > &results);
@@ -101,11 +184,31 @@ namespace Cosmos
             double dt;
             double dtj;
             bool fastcalc = true;
+            //! Number of threads stepping the nodes within each propagation priority, 1 for serial
+            uint16_t threadcount = 1;
 
         private:
             bool server;
             int32_t error;
 
+            int32_t PropagateNode(size_t idx);
+            int32_t PropagateGroup(size_t begin, size_t end);
+            void WorkerLoop(uint32_t generation);
+            void WorkerRun();
+
+            //! Pool of threads, shared out nodes from a single priority group at a time
+            vector<std::thread> workers;
+            std::mutex work_mutex;
+            std::condition_variable work_start;
+            std::condition_variable work_done;
+            uint32_t work_generation = 0;
+            bool work_shutdown = false;
+            std::atomic<size_t> work_next{0};
+            size_t work_end = 0;
+            uint16_t work_busy = 0;
+            //! Result of each node for the step in progress
+            vector<int32_t> work_iretn;
+
             State RunState = State::Halted;
             //    socket_channel data_channel;
 
@@ -16,6 +16,8 @@ namespace Cosmos {
             {
                 delete chan.mtx;
                 chan.mtx = nullptr;
+                delete chan.ring;
+                chan.ring = nullptr;
             }
         }
 
@@ -146,6 +148,12 @@ namespace Cosmos {
                 if (maximum)
                 {
                     channel[iretn].maximum = maximum;
+                    if (channel[iretn].ring != nullptr && channel[iretn].ring->Capacity() != maximum)
+                    {
+                        // Rebuild the ring at its new size
+                        LockFree(iretn, false);
+                        LockFree(iretn, true);
+                    }
                 }
             }
             return iretn;
@@ -170,6 +178,12 @@ namespace Cosmos {
                 if (maximum)
                 {
                     channel[number].maximum = maximum;
+                    if (channel[number].ring != nullptr && channel[number].ring->Capacity() != maximum)
+                    {
+                        // Rebuild the ring at its new size
+                        LockFree(number, false);
+                        LockFree(number, true);
+                    }
                 }
                 return number;
             }
@@ -238,6 +252,10 @@ namespace Cosmos {
             {
                 return -999999.;
             }
+            if (channel[number].ring != nullptr)
+            {
+                return (std::chrono::steady_clock::now().time_since_epoch().count() - channel[number].ring->touched) * 1e-9;
+            }
             channel[number].mtx->lock();
             double age = channel[number].age_timer.split();
             channel[number].mtx->unlock();
@@ -299,6 +317,10 @@ namespace Cosmos {
             {
                 return 0;
             }
+            if (channel[number].ring != nullptr)
+            {
+                return channel[number].ring->bytes;
+            }
             return channel[number].bytes;
         }
 
@@ -326,6 +348,10 @@ namespace Cosmos {
             {
                 return 0;
             }
+            if (channel[number].ring != nullptr)
+            {
+                return channel[number].ring->level;
+            }
             return channel[number].level;
         }
 
@@ -380,6 +406,10 @@ namespace Cosmos {
             {
                 return 0;
             }
+            if (channel[number].ring != nullptr)
+            {
+                return channel[number].ring->packets;
+            }
             return channel[number].packets;
         }
 
@@ -407,6 +437,12 @@ namespace Cosmos {
             {
                 return -999999.;
             }
+            if (channel[number].ring != nullptr)
+            {
+                int64_t now = std::chrono::steady_clock::now().time_since_epoch().count();
+                double age = (now - channel[number].ring->touched.exchange(now - static_cast<int64_t>(1e9 * seconds))) * 1e-9;
+                return age;
+            }
             channel[number].mtx->lock();
             double age = channel[number].age_timer.split();
             channel[number].age_timer.start(seconds);
@@ -442,6 +478,12 @@ namespace Cosmos {
             {
                 return GENERAL_ERROR_OUTOFRANGE;
             }
+            if (channel[number].ring != nullptr)
+            {
+                channel[number].ring->bytes += byte_count;
+                channel[number].ring->packets += packet_count;
+                return channel[number].ring->level;
+            }
             channel[number].mtx->lock();
             channel[number].bytes += byte_count;
             channel[number].packets += packet_count;
@@ -476,6 +518,36 @@ namespace Cosmos {
         //! \param packet ::Cosmos::Support::PacketComm packet.
         //! \return New ::Cosmos::Support::Channel::channelstruc::quu size or negative error.
         int32_t Channel::Push(uint8_t number, PacketComm &packet)
+        {
+            return Push(number, packet, false);
+        }
+
+        //! \brief Hand packet over to ::Cosmos::Support::Channel::channelstruc::quu by name.
+        //! As for ::Push, but the contents of the packet are moved rather than copied.
+        //! \param name Name of channel.
+        //! \param packet ::Cosmos::Support::PacketComm packet.
+        //! \return New ::Cosmos::Support::Channel::channelstruc::quu size or negative error.
+        int32_t Channel::Push(string name, PacketComm &&packet)
+        {
+            int32_t iretn = Find(name);
+            if (iretn >= 0)
+            {
+                return Push(iretn, packet, true);
+            }
+            return GENERAL_ERROR_OUTOFRANGE;
+        }
+
+        //! \brief Hand packet over to ::Cosmos::Support::Channel::channelstruc::quu by number.
+        //! As for ::Push, but the contents of the packet are moved rather than copied.
+        //! \param number Number of channel.
+        //! \param packet ::Cosmos::Support::PacketComm packet.
+        //! \return New ::Cosmos::Support::Channel::channelstruc::quu size or negative error.
+        int32_t Channel::Push(uint8_t number, PacketComm &&packet)
+        {
+            return Push(number, packet, true);
+        }
+
+        int32_t Channel::Push(uint8_t number, PacketComm &packet, bool handover)
         {
             int32_t iretn = 0;
             if (number >= channel.size())
@@ -485,26 +557,51 @@ namespace Cosmos {
             else
             {
                 packet.Wrap();
-                channel[number].mtx->lock();
-                channel[number].quu.push(packet);
-                channel[number].level += packet.wrapped.size();
-                Increment(number, packet.wrapped.size());
-                Touch(number);
-                if (channel[number].quu.size() > channel[number].maximum)
+                size_t wrapped_size = packet.wrapped.size();
+                if (channel[number].ring != nullptr)
                 {
-                    if (channel[number].level > channel[number].quu.front().wrapped.size())
+                    // Lock-free: when full, make room by dropping the oldest packet
+                    PacketRing *ring = channel[number].ring;
+                    while (!ring->Push(packet, handover))
                     {
-                        channel[number].level -= channel[number].quu.front().wrapped.size();
+                        static thread_local PacketComm dropped;
+                        ring->Pull(dropped);
+                    }
+                    ring->bytes += wrapped_size;
+                    ++ring->packets;
+                    ring->touched = std::chrono::steady_clock::now().time_since_epoch().count();
+                    iretn = ring->Size();
+                }
+                else
+                {
+                    channel[number].mtx->lock();
+                    if (handover)
+                    {
+                        channel[number].quu.push(std::move(packet));
                     }
                     else
                     {
-                        channel[number].level = 0;
+                        channel[number].quu.push(packet);
                     }
-                    channel[number].quu.pop();
+                    channel[number].level += wrapped_size;
+                    Increment(number, wrapped_size);
+                    Touch(number);
+                    if (channel[number].quu.size() > channel[number].maximum)
+                    {
+                        if (channel[number].level > channel[number].quu.front().wrapped.size())
+                        {
+                            channel[number].level -= channel[number].quu.front().wrapped.size();
+                        }
+                        else
+                        {
+                            channel[number].level = 0;
+                        }
+                        channel[number].quu.pop();
+                    }
+                    iretn = channel[number].quu.size();
+                    channel[number].mtx->unlock();
                 }
-                iretn = channel[number].quu.size();
-                channel[number].mtx->unlock();
-                double throttle_time = packet.wrapped.size() / channel[number].byte_rate;
+                double throttle_time = wrapped_size / channel[number].byte_rate;
                 if (throttle_time > 1e-3)
                 {
                     // Throttle based on channel byte rate, but only if the sleep
@@ -548,6 +645,17 @@ namespace Cosmos {
             {
                 iretn = GENERAL_ERROR_OUTOFRANGE;
             }
+            else if (channel[number].ring != nullptr)
+            {
+                if (channel[number].ring->Pull(packet))
+                {
+                    iretn = packet.Unwrap();
+                    if (iretn >= 0)
+                    {
+                        iretn = 1;
+                    }
+                }
+            }
             else
             {
                 channel[number].mtx->lock();
@@ -600,6 +708,10 @@ namespace Cosmos {
             {
                 return GENERAL_ERROR_OUTOFRANGE;
             }
+            if (channel[number].ring != nullptr)
+            {
+                return channel[number].ring->Size();
+            }
             channel[number].mtx->lock();
             int32_t size = channel[number].quu.size();
             channel[number].mtx->unlock();
@@ -628,6 +740,12 @@ namespace Cosmos {
             {
                 return GENERAL_ERROR_OUTOFRANGE;
             }
+            if (channel[number].ring != nullptr)
+            {
+                PacketComm packet;
+                while (channel[number].ring->Pull(packet));
+                return number;
+            }
             channel[number].mtx->lock();
             std::queue<PacketComm>().swap(channel[number].quu);
             channel[number].mtx->unlock();
@@ -958,5 +1076,199 @@ namespace Cosmos {
             return channel[number].testcount;
         }
 
+        //! \brief Switch channel to or from lock-free queueing by name.
+        //! \param name Channel name
+        //! \param value True to use a lock-free ::Cosmos::Support::Channel::PacketRing, false to use
+        //! ::Cosmos::Support::Channel::channelstruc::quu.
+        //! \return Previous state, or negative error.
+        int32_t Channel::LockFree(string name, bool value)
+        {
+            int32_t iretn = Find(name);
+            if (iretn >= 0)
+            {
+                return LockFree(iretn, value);
+            }
+            return GENERAL_ERROR_OUTOFRANGE;
+        }
+
+        //! \brief Switch channel to or from lock-free queueing by number.
+        //! Packets already queued are carried across. The lock-free ring holds ::maximum packets,
+        //! dropping the oldest when full. Switching is not itself thread safe, and should be done
+        //! before other threads start using the channel.
+        //! \param number Channel number
+        //! \param value True to use a lock-free ::Cosmos::Support::Channel::PacketRing, false to use
+        //! ::Cosmos::Support::Channel::channelstruc::quu.
+        //! \return Previous state, or negative error.
+        int32_t Channel::LockFree(uint8_t number, bool value)
+        {
+            if (number >= channel.size())
+            {
+                return GENERAL_ERROR_OUTOFRANGE;
+            }
+            int32_t iretn = channel[number].ring != nullptr;
+            if (value == static_cast<bool>(iretn))
+            {
+                return iretn;
+            }
+
+            channel[number].mtx->lock();
+            if (value)
+            {
+                PacketRing *ring = new PacketRing(std::max(channel[number].maximum, static_cast<uint16_t>(1)));
+                while (channel[number].quu.size())
+                {
+                    ring->Push(channel[number].quu.front(), true);
+                    channel[number].quu.pop();
+                }
+                ring->bytes = channel[number].bytes;
+                ring->packets = channel[number].packets;
+                ring->touched = std::chrono::steady_clock::now().time_since_epoch().count() - static_cast<int64_t>(1e9 * channel[number].age_timer.split());
+                channel[number].ring = ring;
+            }
+            else
+            {
+                PacketRing *ring = channel[number].ring;
+                channel[number].ring = nullptr;
+                PacketComm packet;
+                while (ring->Pull(packet))
+                {
+                    channel[number].quu.push(std::move(packet));
+                }
+                channel[number].level = ring->level;
+                channel[number].bytes = ring->bytes;
+                channel[number].packets = ring->packets;
+                channel[number].age_timer.start((std::chrono::steady_clock::now().time_since_epoch().count() - ring->touched) * 1e-9);
+                delete ring;
+            }
+            channel[number].mtx->unlock();
+            return iretn;
+        }
+
+        //! \brief Construct a lock-free ring.
+        //! \param capacity Maximum number of packets held.
+        Channel::PacketRing::PacketRing(size_t capacity) : level(0), bytes(0), packets(0), touched(0), capacity(capacity), slots(new slot[capacity]), tail(0), head(0)
+        {
+            for (size_t i=0; i<capacity; ++i)
+            {
+                slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        //! \brief Add packet to the ring.
+        //! Claim the next free slot, then copy the packet into it, or swap it in if it is being
+        //! handed over.
+        //! \param packet ::Cosmos::Support::PacketComm packet, already wrapped.
+        //! \param handover If true, the packet is left holding recycled buffers of no particular content.
+        //! \return True if added, false if the ring is full.
+        bool Channel::PacketRing::Push(PacketComm &packet, bool handover)
+        {
+            size_t pos = tail.load(std::memory_order_relaxed);
+            slot *cell;
+            for (;;)
+            {
+                cell = &slots[pos % capacity];
+                size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                intptr_t dif = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+                if (dif == 0)
+                {
+                    if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (dif < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = tail.load(std::memory_order_relaxed);
+                }
+            }
+
+            size_t wrapped_size = packet.wrapped.size();
+            PacketComm &dest = cell->packet;
+            dest.header = packet.header;
+            dest.response_id = packet.response_id;
+            dest.ccsds_header = packet.ccsds_header;
+            dest.crc = packet.crc;
+            dest.style = packet.style;
+            if (handover)
+            {
+                dest.packetized.swap(packet.packetized);
+                dest.wrapped.swap(packet.wrapped);
+                dest.data.swap(packet.data);
+            }
+            else
+            {
+                // Assignment reuses the capacity left by earlier packets
+                dest.packetized = packet.packetized;
+                dest.wrapped = packet.wrapped;
+                dest.data = packet.data;
+            }
+            level += wrapped_size;
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        //! \brief Remove oldest packet from the ring.
+        //! The packet's buffers are swapped with those of the slot, so they are recycled by the
+        //! next ::Push.
+        //! \param packet ::Cosmos::Support::PacketComm packet, still wrapped.
+        //! \return True if a packet was removed, false if the ring is empty.
+        bool Channel::PacketRing::Pull(PacketComm &packet)
+        {
+            size_t pos = head.load(std::memory_order_relaxed);
+            slot *cell;
+            for (;;)
+            {
+                cell = &slots[pos % capacity];
+                size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                intptr_t dif = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+                if (dif == 0)
+                {
+                    if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (dif < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = head.load(std::memory_order_relaxed);
+                }
+            }
+
+            PacketComm &source = cell->packet;
+            packet.header = source.header;
+            packet.response_id = source.response_id;
+            packet.ccsds_header = source.ccsds_header;
+            packet.crc = source.crc;
+            packet.style = source.style;
+            packet.packetized.swap(source.packetized);
+            packet.wrapped.swap(source.wrapped);
+            packet.data.swap(source.data);
+            level -= packet.wrapped.size();
+            cell->sequence.store(pos + capacity, std::memory_order_release);
+            return true;
+        }
+
+        //! \brief Number of packets in the ring.
+        //! Exact when the ring is quiet, otherwise a snapshot.
+        size_t Channel::PacketRing::Size()
+        {
+            size_t in = tail.load(std::memory_order_acquire);
+            size_t out = head.load(std::memory_order_acquire);
+            return in > out ? in - out : 0;
+        }
+
+        //! \brief Maximum number of packets in the ring.
+        size_t Channel::PacketRing::Capacity()
+        {
+            return capacity;
+        }
     }
 }
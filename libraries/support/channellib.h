@@ -5,6 +5,8 @@
 * \brief Channel Support
 */
 
+#include <atomic>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include "support/configCosmos.h"
@@ -20,7 +22,8 @@ namespace Cosmos {
         //! support standard sub-agents by the same name. Channels are then extended using ::Add.
         //! Each channel has a queue of Cosmos::Support::PacketComm packets of ::maximum length.
         //! Packets are added using ::Push, until ::maximum is reached, at which older packets are removed
-        //! from the queue. Packets are extracted from the queue using ::Pull.
+        //! from the queue. Packets are extracted from the queue using ::Pull. A channel can optionally be
+        //! switched, using ::LockFree, to a fixed capacity lock-free ring of ::maximum length.
         class Channel
         {
         public:
@@ -33,6 +36,45 @@ namespace Cosmos {
             static constexpr uint16_t PACKETCOMM_WRAPPED_SIZE = PACKETCOMM_PACKETIZED_SIZE;
             static constexpr uint16_t PACKETCOMM_DATA_SIZE = PACKETCOMM_WRAPPED_SIZE - (COSMOS_SIZEOF(PacketComm::Header)+2);
 
+            //! \class PacketRing channellib.h "support/channellib.h"
+            //! Bounded, lock-free, multi-producer multi-consumer queue of Cosmos::Support::PacketComm.
+            //! Each slot owns a packet whose buffers are kept between uses, so the ring doubles as the
+            //! packet pool: once warmed up, ::Push copies into existing storage (or swaps, for packets
+            //! being handed over) and ::Pull swaps the slot with the caller's packet, so neither allocates.
+            class PacketRing
+            {
+            public:
+                PacketRing(size_t capacity);
+                bool Push(PacketComm &packet, bool handover=false);
+                bool Pull(PacketComm &packet);
+                size_t Size();
+                size_t Capacity();
+
+                //! Bytes of wrapped packets currently queued
+                std::atomic<size_t> level;
+                //! Bytes passed through the ring
+                std::atomic<size_t> bytes;
+                //! Packets passed through the ring
+                std::atomic<uint32_t> packets;
+                //! Steady clock time, in nanoseconds, of the last ::Push or ::Touch
+                std::atomic<int64_t> touched;
+
+            private:
+                struct slot
+                {
+                    std::atomic<size_t> sequence;
+                    PacketComm packet;
+                };
+                size_t capacity;
+                std::unique_ptr<slot[]> slots;
+                // Keep producer and consumer positions on separate cache lines
+                char pad0[64];
+                std::atomic<size_t> tail;
+                char pad1[64];
+                std::atomic<size_t> head;
+                char pad2[64];
+            };
+
             struct channelstruc
             {
                 channelstruc() {age_timer.start(get_unix_time());}
@@ -43,6 +85,7 @@ namespace Cosmos {
                 string name = "";
                 queue<PacketComm> quu;
                 std::recursive_mutex* mtx = nullptr;
+                PacketRing* ring = nullptr;
                 uint16_t datasize = PACKETCOMM_DATA_SIZE;
                 uint16_t rawsize = PACKETCOMM_PACKETIZED_SIZE;
                 uint16_t maximum = 100;
@@ -75,6 +118,8 @@ namespace Cosmos {
             string Find(uint8_t number);
             int32_t Push(string name, PacketComm &packet);
             int32_t Push(uint8_t number, PacketComm &packet);
+            int32_t Push(string name, PacketComm &&packet);
+            int32_t Push(uint8_t number, PacketComm &&packet);
             int32_t Pull(string name, PacketComm &packet);
             int32_t Pull(uint8_t number, PacketComm &packet);
             int32_t Size(string name="");
@@ -85,6 +130,8 @@ namespace Cosmos {
             int32_t Enable(uint8_t number, int8_t value);
             int32_t Enabled(string name);
             int32_t Enabled(uint8_t number);
+            int32_t LockFree(string name, bool value);
+            int32_t LockFree(uint8_t number, bool value);
             double Age(string name);
             double Age(uint8_t number);
             double WakeupTimer(string name, double value = 0.);
@@ -114,6 +161,7 @@ namespace Cosmos {
             uint32_t verification = 0x352e;
 
         private:
+            int32_t Push(uint8_t number, PacketComm &packet, bool handover);
         };
     }
 }
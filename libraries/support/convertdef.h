@@ -121,6 +121,7 @@ namespace Cosmos {
 #define JPL_SUN_BARY 12
 #define JPL_EARTH_BARY 13
 #define JPL_NUTATIONS 14
+#define JPL_LIBRATIONS 15
 
         // Two Line Element
 #define MAXTLE 5000
@@ -42,24 +42,15 @@
 #endif // UNUSED_VARIABLE_LOCALDEF
 
 #include <iostream>
+#include <atomic>
 
 namespace Cosmos
 {
 namespace Convert
 {
 
-struct iersstruc
-{
-    uint32_t mjd;
-    double pmx;
-    double pmy;
-    double dutc;
-    uint32_t ls;
-};
-
 static uint16_t tlecount;
-static vector<iersstruc> iers;
-static uint32_t iersbase = 0;
+static std::atomic<const IersTable *> iers_context(nullptr);
 
 //! \addtogroup convertlib_functions
 //! @{
@@ -124,6 +115,54 @@ int32_t pos_extra(double utc, locstruc *loc)
     return pos_extra(utc, *loc);
 }
 
+//! Epoch keyed cache of the time dependent part of ::Cosmos::Convert::extrapos
+/*! Shared by every ::Cosmos::Convert::locstruc, so that locations at the same time only
+ * calculate the Earth orientation and Sun and Moon positions once. Entries are replaced
+ * least recently used first.
+ */
+struct extracachestruc
+{
+    struct entry
+    {
+        extrapos extra;
+        size_t used = 0;
+    };
+    vector<entry> entries = vector<entry>(16);
+    size_t clock = 0;
+    size_t hits = 0;
+    size_t misses = 0;
+    mutex cache_mutex;
+};
+
+static extracachestruc extracache;
+
+// Copy the members of extrapos that depend only on time
+static void pos_extra_copy(const extrapos &source, extrapos &target)
+{
+    target.utc = source.utc;
+    target.tt = source.tt;
+    target.ut = source.ut;
+    target.tdb = source.tdb;
+    target.j2e = source.j2e;
+    target.dj2e = source.dj2e;
+    target.ddj2e = source.ddj2e;
+    target.e2j = source.e2j;
+    target.de2j = source.de2j;
+    target.dde2j = source.dde2j;
+    target.j2t = source.j2t;
+    target.j2s = source.j2s;
+    target.t2j = source.t2j;
+    target.s2j = source.s2j;
+    target.s2t = source.s2t;
+    target.ds2t = source.ds2t;
+    target.t2s = source.t2s;
+    target.dt2s = source.dt2s;
+    target.sun2earth = source.sun2earth;
+    target.sungeo = source.sungeo;
+    target.sun2moon = source.sun2moon;
+    target.moongeo = source.moongeo;
+}
+
 int32_t pos_extra(double utc, locstruc &loc)
 {
     // Check time
@@ -138,49 +177,132 @@ int32_t pos_extra(double utc, locstruc &loc)
         return 0;
     }
 
+    // Or if another location has already been to this time
+    {
+        std::lock_guard<mutex> lock(extracache.cache_mutex);
+        for (extracachestruc::entry &entry : extracache.entries)
+        {
+            if (entry.used && entry.extra.utc == utc)
+            {
+                entry.used = ++extracache.clock;
+                ++extracache.hits;
+                pos_extra_copy(entry.extra, loc.pos.extra);
+                return 0;
+            }
+        }
+        ++extracache.misses;
+    }
+
+    extrapos extra;
     double tt = utc2tt(utc);
     if (tt <= 0.)
     {
         return static_cast<int32_t>(tt);
     }
-    loc.pos.extra.tt = tt;
+    extra.tt = tt;
 
-    loc.pos.extra.utc = utc;
-    loc.pos.extra.tdb = utc2tdb(utc);
-    loc.pos.extra.ut = utc2ut1(utc);
+    extra.utc = utc;
+    extra.tdb = utc2tdb(utc);
+    extra.ut = utc2ut1(utc);
 
-    gcrf2itrs(utc, &loc.pos.extra.j2t, &loc.pos.extra.j2e, &loc.pos.extra.dj2e, &loc.pos.extra.ddj2e);
-    loc.pos.extra.t2j = rm_transpose(loc.pos.extra.j2t);
-    loc.pos.extra.e2j = rm_transpose(loc.pos.extra.j2e);
-    loc.pos.extra.de2j = rm_transpose(loc.pos.extra.dj2e);
-    loc.pos.extra.dde2j = rm_transpose(loc.pos.extra.ddj2e);
+    gcrf2itrs(utc, &extra.j2t, &extra.j2e, &extra.dj2e, &extra.ddj2e);
+    extra.t2j = rm_transpose(extra.j2t);
+    extra.e2j = rm_transpose(extra.j2e);
+    extra.de2j = rm_transpose(extra.dj2e);
+    extra.dde2j = rm_transpose(extra.ddj2e);
 
-    jpllib(utc, &loc.pos.extra.s2t, &loc.pos.extra.ds2t);
-    loc.pos.extra.t2s = rm_transpose(loc.pos.extra.s2t);
-    loc.pos.extra.dt2s = rm_transpose(loc.pos.extra.ds2t);
+    jpllib(utc, &extra.s2t, &extra.ds2t);
+    extra.t2s = rm_transpose(extra.s2t);
+    extra.dt2s = rm_transpose(extra.ds2t);
 
-    loc.pos.extra.j2s = rm_mmult(loc.pos.extra.t2s, loc.pos.extra.j2t);
-    loc.pos.extra.s2j = rm_transpose(loc.pos.extra.j2s);
+    extra.j2s = rm_mmult(extra.t2s, extra.j2t);
+    extra.s2j = rm_transpose(extra.j2s);
 
-    jplpos(JPL_SUN_BARY, JPL_EARTH, loc.pos.extra.tt, &loc.pos.extra.sun2earth);
-    loc.pos.extra.sun2earth.utc = utc;
+    jplpos(JPL_SUN_BARY, JPL_EARTH, extra.tt, &extra.sun2earth);
+    extra.sun2earth.utc = utc;
     locstruc tloc;
     tloc.utc = utc;
-    tloc.pos.extra = loc.pos.extra;
-    tloc.pos.eci = loc.pos.extra.sun2earth;
+    tloc.pos.extra = extra;
+    tloc.pos.eci = extra.sun2earth;
     tloc.pos.eci.s = rv_smult(-1., tloc.pos.eci.s);
     pos_eci2geoc(tloc);
-    loc.pos.extra.sungeo = tloc.pos.geod.s;
-    jplpos(JPL_SUN_BARY, JPL_MOON, loc.pos.extra.tt, &loc.pos.extra.sun2moon);
-    loc.pos.extra.sun2moon.utc = utc;
-    tloc.pos.eci.s = rv_sub(loc.pos.extra.sun2moon.s, loc.pos.extra.sun2earth.s);
+    extra.sungeo = tloc.pos.geod.s;
+    jplpos(JPL_SUN_BARY, JPL_MOON, extra.tt, &extra.sun2moon);
+    extra.sun2moon.utc = utc;
+    tloc.pos.eci.s = rv_sub(extra.sun2moon.s, extra.sun2earth.s);
     pos_eci2geoc(tloc);
-    loc.pos.extra.moongeo = tloc.pos.geod.s;
+    extra.moongeo = tloc.pos.geod.s;
+
+    pos_extra_copy(extra, loc.pos.extra);
+
+    // Replace the least recently used entry
+    std::lock_guard<mutex> lock(extracache.cache_mutex);
+    if (!extracache.entries.empty())
+    {
+        extracachestruc::entry *oldest = &extracache.entries[0];
+        for (extracachestruc::entry &entry : extracache.entries)
+        {
+            if (entry.used && entry.extra.utc == utc)
+            {
+                oldest = &entry;
+                break;
+            }
+            if (entry.used < oldest->used)
+            {
+                oldest = &entry;
+            }
+        }
+        oldest->extra = extra;
+        oldest->used = ++extracache.clock;
+    }
 
     //    pos_lvlh(utc, loc);
     return 0;
 }
 
+//! Set size of pos_extra() cache
+/*! Set the number of epochs whose time dependent ::Cosmos::Convert::extrapos are kept for
+ * sharing between every ::Cosmos::Convert::locstruc. Clears the cache.
+    \param size Number of epochs. Zero turns the cache off.
+    \return 0
+*/
+int32_t pos_extra_cache_size(size_t size)
+{
+    std::lock_guard<mutex> lock(extracache.cache_mutex);
+    extracache.entries.clear();
+    extracache.entries.resize(size);
+    extracache.clock = 0;
+    return 0;
+}
+
+//! Clear pos_extra() cache
+/*! Empty the cache and zero its counters.
+*/
+void pos_extra_cache_clear()
+{
+    std::lock_guard<mutex> lock(extracache.cache_mutex);
+    for (extracachestruc::entry &entry : extracache.entries)
+    {
+        entry.used = 0;
+    }
+    extracache.clock = 0;
+    extracache.hits = 0;
+    extracache.misses = 0;
+}
+
+//! pos_extra() cache counters
+/*! Return the number of times pos_extra() found its epoch in the cache, and the number
+ * of times it had to calculate it, since the last pos_extra_cache_clear().
+    \param hits Number of epochs found in the cache.
+    \param misses Number of epochs calculated.
+*/
+void pos_extra_cache_stats(size_t &hits, size_t &misses)
+{
+    std::lock_guard<mutex> lock(extracache.cache_mutex);
+    hits = extracache.hits;
+    misses = extracache.misses;
+}
+
 int32_t pos_lvlh(locstruc *loc)
 {
     return pos_lvlh(*loc);
@@ -2782,8 +2904,8 @@ int32_t pef2itrs(double utc, rmatrix *rm)
 
 int32_t itrs2pef(double utc, rmatrix *rm)
 {
-    static rmatrix orm;
-    static double outc = 0.;
+    static thread_local rmatrix orm;
+    static thread_local double outc = 0.;
 
     if (utc == outc)
     {
@@ -2808,8 +2930,8 @@ int32_t itrs2pef(double utc, rmatrix *rm)
 */
 int32_t mean2true(double ep0, rmatrix *pm)
 {
-    static rmatrix opm;
-    static double oep0 = 0.;
+    static thread_local rmatrix opm;
+    static thread_local double oep0 = 0.;
 
     if (ep0 == oep0)
     {
@@ -2834,8 +2956,8 @@ int32_t mean2true(double ep0, rmatrix *pm)
 */
 int32_t true2mean(double ep0, rmatrix *pm)
 {
-    static rmatrix opm;
-    static double oep0 = 0.;
+    static thread_local rmatrix opm;
+    static thread_local double oep0 = 0.;
     //	double nuts[4], jt;
     double eps;
     double cdp, sdp, ce, se, cde, sde;
@@ -2887,8 +3009,8 @@ int32_t mean2j2000(double ep0, rmatrix *pm)
 {
     //	double t0, t, tas2r, w, zeta, z, theta;
     //	double ca, sa, cb, sb, cg, sg;
-    static rmatrix opm;
-    static double oep0 = 0.;
+    static thread_local rmatrix opm;
+    static thread_local double oep0 = 0.;
 
     if (ep0 == oep0)
     {
@@ -2947,8 +3069,8 @@ int32_t mean2j2000(double ep0, rmatrix *pm)
 */
 int32_t itrs2gcrf(double utc, rmatrix *rnp, rmatrix *rm, rmatrix *drm, rmatrix *ddrm)
 {
-    static rmatrix orm, odrm, oddrm, ornp;
-    static double outc = 0.;
+    static thread_local rmatrix orm, odrm, oddrm, ornp;
+    static thread_local double outc = 0.;
 
     if (utc == outc)
     {
@@ -2985,9 +3107,9 @@ int32_t gcrf2itrs(double utc, rmatrix *rnp, rmatrix *rm, rmatrix *drm, rmatrix *
     rmatrix nrm[3], ndrm, nddrm;
     rmatrix pm, nm, sm, pw;
     static rmatrix bm = {{1., -0.000273e-8, 9.740996e-8}, {0.000273e-8, 1., 1.324146e-8}, {-9.740996e-8, -1.324146e-8, 1.}};
-    static rmatrix orm, odrm, oddrm, ornp;
-    static double outc = 0.;
-    static double realsec = 0.;
+    static thread_local rmatrix orm, odrm, oddrm, ornp;
+    static thread_local double outc = 0.;
+    static thread_local double realsec = 0.;
     int i;
 
     if (!isfinite(utc))
@@ -3103,8 +3225,8 @@ int32_t j20002mean(double ep1, rmatrix *pm)
 {
     double t, tas2r, w, zeta, z, theta;
     double ca, sa, cb, sb, cg, sg;
-    static rmatrix opm;
-    static double oep1 = 0.;
+    static thread_local rmatrix opm;
+    static thread_local double oep1 = 0.;
 
     if (ep1 == oep1)
     {
@@ -4368,7 +4490,7 @@ double geod2sep(gvector src, gvector dst)
     \param lines Vector of TLE's.
     \param eci Pointer to ::Cosmos::Convert::cartpos in ECI frame.
     */
-int lines2eci(double utc, vector<tlestruc> lines, cartpos &eci)
+int lines2eci(double utc, const vector<tlestruc> &lines, cartpos &eci)
 {
     uint16_t lindex = 0;
     int32_t iretn = 0;
@@ -4396,128 +4518,161 @@ int lines2eci(double utc, vector<tlestruc> lines, cartpos &eci)
 
 /**
          * SGP4 propagator algoritm
+         * Propagates through a per thread ::Sgp4, which is only initialized again when the TLE changes.
          * @param utc Specified time as Modified Julian Date
          * @param tle Two Line Element structure, given as pointer to a ::Cosmos::Convert::tlestruc
          * @param pos_teme result from SGP4 algorithm is a cartesian state given in TEME frame, as pointer to a ::Cosmos::Convert::cartpos
          */
-int sgp4(double utc, tlestruc tle, cartpos &pos_teme)
+int sgp4(double utc, const tlestruc &tle, cartpos &pos_teme)
 {
-    //	rmatrix pm = {{{{0.}}}};
-    //	static int lsnumber=-99;
-    static double c1 = 0.;
-    static double cosio = 0., x3thm1 = 0., xnodp = 0., aodp = 0., isimp = 0., eta = 0., sinio = 0., x1mth2 = 0., c4 = 0., c5 = 0.;
-    static double xmdot = 0., omgdot = 0., xnodot = 0., omgcof = 0., xmcof = 0., xnodcf = 0., t2cof = 0., xlcof = 0., aycof = 0.;
-    int i;
-    double temp, temp1, temp2, temp3, temp4, temp5, temp6;
-    double tempa, tempe, templ;
+    static thread_local Sgp4 last;
+
+    if (!last.Matches(tle))
+    {
+        last.Init(tle);
+    }
+    return last.Propagate(utc, pos_teme);
+}
+
+//! Initialize SGP4
+/*! Compute the terms of SGP4 that depend only on the Two Line Element.
+    \param tle Two Line Element to propagate.
+    \return 0, otherwise negative error.
+*/
+int32_t Sgp4::Init(const tlestruc &tle)
+{
+    double temp, temp1, temp2, temp3;
     // Mean motion per minute
     double mmm;
     double ao, a1, c2, c3, coef, coef1, theta4, c1sq;
     double theta2, betao2, betao, delo, del1, s4, qoms24, x1m5th, xhdot1;
-    double perige, eosq, pinvsq, tsi, etasq, eeta, psisq, g, xmdf;
-    double tsince, omgadf, alpha, xnoddf, xmp, tsq, xnode, delomg, delm;
+    double perige, eosq, pinvsq, tsi, etasq, eeta, psisq, g;
+
+    this->tle = tle;
+    eo = tle.e;
+    if (eo < .00000000001)
+    {
+        eo = .00000000001;
+    }
+    // RECOVER ORIGINAL MEAN MOTION ( xnodp ) AND SEMIMAJOR AXIS (aodp)
+    // FROM INPUT ELEMENTS
+    mmm = tle.mm * 60.;
+    a1 = pow((SGP4_XKE / mmm), SGP4_TOTHRD);
+    cosio = cos(tle.i);
+    theta2 = cosio * cosio;
+    x3thm1 = 3. * theta2 - 1.;
+    eosq = eo * eo;
+    betao2 = 1. - eosq;
+    betao = sqrt(betao2);
+    del1 = 1.5 * SGP4_CK2 * x3thm1 / (a1 * a1 * betao * betao2);
+    ao = a1 * (1. - del1 * (.5 * SGP4_TOTHRD + del1 * (1. + 134. / 81. * del1)));
+    delo = 1.5 * SGP4_CK2 * x3thm1 / (ao * ao * betao * betao2);
+    xnodp = mmm / (1. + delo);
+    aodp = ao / (1. - delo);
+    // INITIALIZATION
+    // FOR PERIGEE LESS THAN 220 KILOMETERS, THE isimp FLAG IS SET AND
+    // THE EQUATIONS ARE TRUNCATED TO LINEAR VARIATION IN sqrt A AND
+    // QUADRATIC VARIATION IN MEAN ANOMALY. ALSO, THE c3 TERM, THE
+    // DELTA alpha TERM, AND THE DELTA M TERM ARE DROPPED.
+    isimp = false;
+    if ((aodp * (1. - eo) / SGP4_AE) < (220. / SGP4_XKMPER + SGP4_AE))
+        isimp = true;
+    // FOR PERIGEE BELOW 156 KM, THE VALUES OF
+    // S AND SGP4_QOMS2T ARE ALTERED
+    s4 = SGP4_S;
+    qoms24 = SGP4_QOMS2T;
+    perige = (aodp * (1. - eo) - SGP4_AE) * SGP4_XKMPER;
+    if (perige < 156.)
+    {
+        s4 = perige - 78.;
+        if (perige <= 98.)
+        {
+            s4 = 20.;
+            qoms24 = pow(((120. - s4) * SGP4_AE / SGP4_XKMPER), 4.);
+            s4 = s4 / SGP4_XKMPER + SGP4_AE;
+        }
+    }
+    pinvsq = 1. / (aodp * aodp * betao2 * betao2);
+    tsi = 1. / (aodp - s4);
+    eta = aodp * eo * tsi;
+    etasq = eta * eta;
+    eeta = eo * eta;
+    psisq = fabs(1. - etasq);
+    coef = qoms24 * pow(tsi, 4.);
+    coef1 = coef / pow(psisq, 3.5);
+    c2 = coef1 * xnodp * (aodp * (1. + 1.5 * etasq + eeta * (4. + etasq)) + .75 * SGP4_CK2 * tsi / psisq * x3thm1 * (8. + 3. * etasq * (8. + etasq)));
+    c1 = tle.bstar * c2;
+    sinio = sin(tle.i);
+    g = -SGP4_XJ3 / SGP4_CK2 * pow(SGP4_AE, 3.);
+    c3 = coef * tsi * g * xnodp * SGP4_AE * sinio / eo;
+    x1mth2 = 1. - theta2;
+    c4 = 2. * xnodp * coef1 * aodp * betao2 * (eta * (2. + .5 * etasq) + eo * (.5 + 2. * etasq) - 2. * SGP4_CK2 * tsi / (aodp * psisq) * (-3. * x3thm1 * (1. - 2. * eeta + etasq * (1.5 - .5 * eeta)) + .75 * x1mth2 * (2. * etasq - eeta * (1. + etasq)) * cos(2. * tle.ap)));
+    c5 = 2. * coef1 * aodp * betao2 * (1. + 2.75 * (etasq + eeta) + eeta * etasq);
+    theta4 = theta2 * theta2;
+    temp1 = 3. * SGP4_CK2 * pinvsq * xnodp;
+    temp2 = temp1 * SGP4_CK2 * pinvsq;
+    temp3 = 1.25 * SGP4_CK4 * pinvsq * pinvsq * xnodp;
+    xmdot = xnodp + .5 * temp1 * betao * x3thm1 + .0625 * temp2 * betao * (13. - 78. * theta2 + 137. * theta4);
+    x1m5th = 1. - 5. * theta2;
+    omgdot = -.5 * temp1 * x1m5th + .0625 * temp2 * (7. - 114. * theta2 + 395. * theta4) + temp3 * (3. - 36. * theta2 + 49. * theta4);
+    xhdot1 = -temp1 * cosio;
+    xnodot = xhdot1 + (.5 * temp2 * (4. - 19. * theta2) + 2. * temp3 * (3. - 7. * theta2)) * cosio;
+    omgcof = tle.bstar * c3 * cos(tle.ap);
+    xmcof = -SGP4_TOTHRD * coef * tle.bstar * SGP4_AE / eeta;
+    xnodcf = 3.5 * betao2 * xhdot1 * c1;
+    t2cof = 1.5 * c1;
+    xlcof = .125 * g * sinio * (3. + 5. * cosio) / (1. + cosio);
+    aycof = .25 * g * sinio;
+    delmo = pow((1. + eta * cos(tle.ma)), 3.);
+    sinmo = sin(tle.ma);
+    x7thm1 = 7. * theta2 - 1.;
+    if (!isimp)
+    {
+        c1sq = c1 * c1;
+        d2 = 4. * aodp * tsi * c1sq;
+        temp = d2 * tsi * c1 / 3.;
+        d3 = (17. * aodp + s4) * temp;
+        d4 = .5 * temp * aodp * tsi * (221. * aodp + 31. * s4) * c1;
+        t3cof = d2 + 2. * c1sq;
+        t4cof = .25 * (3. * d3 + c1 * (12. * d2 + 10. * c1sq));
+        t5cof = .2 * (3. * d4 + 12. * c1 * d3 + 6. * d2 * d2 + 15. * c1sq * (2. * d2 + c1sq));
+    }
+    initialized = true;
+
+    return 0;
+}
+
+//! Check SGP4 TLE
+/*! Check whether this was initialized from the same elements as the provided TLE.
+    \param tle Two Line Element to compare.
+    \return True if the elements are the same.
+*/
+bool Sgp4::Matches(const tlestruc &tle) const
+{
+    return initialized && tle.utc == this->tle.utc && tle.snumber == this->tle.snumber && tle.mm == this->tle.mm && tle.e == this->tle.e && tle.i == this->tle.i && tle.raan == this->tle.raan && tle.ap == this->tle.ap && tle.ma == this->tle.ma && tle.bstar == this->tle.bstar;
+}
+
+//! Propagate SGP4
+/*! Calculate the position and velocity at the requested time.
+    \param utc Specified time as Modified Julian Date
+    \param pos_teme Cartesian state in the TEME frame.
+    \return 0, otherwise negative error.
+*/
+int32_t Sgp4::Propagate(double utc, cartpos &pos_teme) const
+{
+    int i;
+    double temp, temp1, temp2, temp3, temp4, temp5, temp6;
+    double tempa, tempe, templ;
+    double tsince, omgadf, alpha, xnoddf, xmp, tsq, xnode, delomg, delm, xmdf;
     double tcube, tfour, a, e, xl, beta, axn, xn, xll, ayn, capu, aynl;
-    double xlt, sinepw, cosepw, epw, ecose, esine, pl, r, elsq;
+    double xlt, sinepw, cosepw, epw, ecose, esine, pl, r, elsq, betal;
     double rdot, rfdot, cosu, sinu, u, sin2u, cos2u, uk, rk, ux, uy, uz;
     double vx, vy, vz, xinck, rdotk, rfdotk, sinuk, cosuk, sinik, cosik, xnodek;
     double xmx, xmy, sinnok, cosnok;
-    //	locstruc loc;
-    static double lutc = 0.;
-    static uint16_t lsnumber = 0;
-
-    static double delmo, sinmo, x7thm1, d2, d3, d4, t3cof, t4cof, t5cof, betal;
 
-    if (tle.utc != lutc || tle.snumber != lsnumber)
+    if (!initialized)
     {
-        if (tle.e < .00000000001)
-        {
-            tle.e = .00000000001;
-        }
-        // RECOVER ORIGINAL MEAN MOTION ( xnodp ) AND SEMIMAJOR AXIS (aodp)
-        // FROM INPUT ELEMENTS
-        mmm = tle.mm * 60.;
-        a1 = pow((SGP4_XKE / mmm), SGP4_TOTHRD);
-        cosio = cos(tle.i);
-        theta2 = cosio * cosio;
-        x3thm1 = 3. * theta2 - 1.;
-        eosq = tle.e * tle.e;
-        betao2 = 1. - eosq;
-        betao = sqrt(betao2);
-        del1 = 1.5 * SGP4_CK2 * x3thm1 / (a1 * a1 * betao * betao2);
-        ao = a1 * (1. - del1 * (.5 * SGP4_TOTHRD + del1 * (1. + 134. / 81. * del1)));
-        delo = 1.5 * SGP4_CK2 * x3thm1 / (ao * ao * betao * betao2);
-        xnodp = mmm / (1. + delo);
-        aodp = ao / (1. - delo);
-        // INITIALIZATION
-        // FOR PERIGEE LESS THAN 220 KILOMETERS, THE isimp FLAG IS SET AND
-        // THE EQUATIONS ARE TRUNCATED TO LINEAR VARIATION IN sqrt A AND
-        // QUADRATIC VARIATION IN MEAN ANOMALY. ALSO, THE c3 TERM, THE
-        // DELTA alpha TERM, AND THE DELTA M TERM ARE DROPPED.
-        isimp = 0;
-        if ((aodp * (1. - tle.e) / SGP4_AE) < (220. / SGP4_XKMPER + SGP4_AE))
-            isimp = 1;
-        // FOR PERIGEE BELOW 156 KM, THE VALUES OF
-        // S AND SGP4_QOMS2T ARE ALTERED
-        s4 = SGP4_S;
-        qoms24 = SGP4_QOMS2T;
-        perige = (aodp * (1. - tle.e) - SGP4_AE) * SGP4_XKMPER;
-        if (perige < 156.)
-        {
-            s4 = perige - 78.;
-            if (perige <= 98.)
-            {
-                s4 = 20.;
-                qoms24 = pow(((120. - s4) * SGP4_AE / SGP4_XKMPER), 4.);
-                s4 = s4 / SGP4_XKMPER + SGP4_AE;
-            }
-        }
-        pinvsq = 1. / (aodp * aodp * betao2 * betao2);
-        tsi = 1. / (aodp - s4);
-        eta = aodp * tle.e * tsi;
-        etasq = eta * eta;
-        eeta = tle.e * eta;
-        psisq = fabs(1. - etasq);
-        coef = qoms24 * pow(tsi, 4.);
-        coef1 = coef / pow(psisq, 3.5);
-        c2 = coef1 * xnodp * (aodp * (1. + 1.5 * etasq + eeta * (4. + etasq)) + .75 * SGP4_CK2 * tsi / psisq * x3thm1 * (8. + 3. * etasq * (8. + etasq)));
-        c1 = tle.bstar * c2;
-        sinio = sin(tle.i);
-        g = -SGP4_XJ3 / SGP4_CK2 * pow(SGP4_AE, 3.);
-        c3 = coef * tsi * g * xnodp * SGP4_AE * sinio / tle.e;
-        x1mth2 = 1. - theta2;
-        c4 = 2. * xnodp * coef1 * aodp * betao2 * (eta * (2. + .5 * etasq) + tle.e * (.5 + 2. * etasq) - 2. * SGP4_CK2 * tsi / (aodp * psisq) * (-3. * x3thm1 * (1. - 2. * eeta + etasq * (1.5 - .5 * eeta)) + .75 * x1mth2 * (2. * etasq - eeta * (1. + etasq)) * cos(2. * tle.ap)));
-        c5 = 2. * coef1 * aodp * betao2 * (1. + 2.75 * (etasq + eeta) + eeta * etasq);
-        theta4 = theta2 * theta2;
-        temp1 = 3. * SGP4_CK2 * pinvsq * xnodp;
-        temp2 = temp1 * SGP4_CK2 * pinvsq;
-        temp3 = 1.25 * SGP4_CK4 * pinvsq * pinvsq * xnodp;
-        xmdot = xnodp + .5 * temp1 * betao * x3thm1 + .0625 * temp2 * betao * (13. - 78. * theta2 + 137. * theta4);
-        x1m5th = 1. - 5. * theta2;
-        omgdot = -.5 * temp1 * x1m5th + .0625 * temp2 * (7. - 114. * theta2 + 395. * theta4) + temp3 * (3. - 36. * theta2 + 49. * theta4);
-        xhdot1 = -temp1 * cosio;
-        xnodot = xhdot1 + (.5 * temp2 * (4. - 19. * theta2) + 2. * temp3 * (3. - 7. * theta2)) * cosio;
-        omgcof = tle.bstar * c3 * cos(tle.ap);
-        xmcof = -SGP4_TOTHRD * coef * tle.bstar * SGP4_AE / eeta;
-        xnodcf = 3.5 * betao2 * xhdot1 * c1;
-        t2cof = 1.5 * c1;
-        xlcof = .125 * g * sinio * (3. + 5. * cosio) / (1. + cosio);
-        aycof = .25 * g * sinio;
-        delmo = pow((1. + eta * cos(tle.ma)), 3.);
-        sinmo = sin(tle.ma);
-        x7thm1 = 7. * theta2 - 1.;
-        if (isimp != 1)
-        {
-            c1sq = c1 * c1;
-            d2 = 4. * aodp * tsi * c1sq;
-            temp = d2 * tsi * c1 / 3.;
-            d3 = (17. * aodp + s4) * temp;
-            d4 = .5 * temp * aodp * tsi * (221. * aodp + 31. * s4) * c1;
-            t3cof = d2 + 2. * c1sq;
-            t4cof = .25 * (3. * d3 + c1 * (12. * d2 + 10. * c1sq));
-            t5cof = .2 * (3. * d4 + 12. * c1 * d3 + 6. * d2 * d2 + 15. * c1sq * (2. * d2 + c1sq));
-        }
-        lsnumber = tle.snumber;
-        lutc = tle.utc;
+        return TLE_ERROR_OUTOFRANGE;
     }
 
     // UPDATE FOR SECULAR GRAVITY AND ATMOSPHERIC DRAG
@@ -4532,7 +4687,7 @@ int sgp4(double utc, tlestruc tle, cartpos &pos_teme)
     tempa = 1. - c1 * tsince;
     tempe = tle.bstar * c4 * tsince;
     templ = t2cof * tsq;
-    if (isimp != 1)
+    if (!isimp)
     {
         delomg = omgcof * tsince;
         delm = xmcof * (pow((1. + eta * cos(xmdf)), 3.) - delmo);
@@ -4546,7 +4701,7 @@ int sgp4(double utc, tlestruc tle, cartpos &pos_teme)
         templ = templ + t3cof * tcube + tfour * (t4cof + tsince * t5cof);
     }
     a = aodp * tempa * tempa;
-    e = tle.e - tempe;
+    e = eo - tempe;
     xl = xmp + alpha + xnode + xnodp * templ;
     beta = sqrt(1. - e * e);
     xn = SGP4_XKE / pow(a, 1.5);
@@ -4626,9 +4781,257 @@ int sgp4(double utc, tlestruc tle, cartpos &pos_teme)
     pos_teme.v.col[1] = 1000. * SGP4_XKMPER * (rdotk * uy + rfdotk * vy) / 60.;
     pos_teme.v.col[2] = 1000. * SGP4_XKMPER * (rdotk * uz + rfdotk * vz) / 60.;
 
+    pos_teme.utc = utc;
+
     return 0;
 }
 
+//! Propagate SGP4 to several times
+/*! Calculate the position and velocity at each of the requested times.
+    \param utc Array of times as Modified Julian Date
+    \param count Number of times.
+    \param pos_teme Array of at least count cartesian states in the TEME frame.
+    \return Number of states calculated, otherwise negative error.
+*/
+int32_t Sgp4::Propagate(const double *utc, size_t count, cartpos *pos_teme) const
+{
+    int32_t iretn;
+    for (size_t i=0; i<count; ++i)
+    {
+        if ((iretn = Propagate(utc[i], pos_teme[i])) < 0)
+        {
+            return iretn;
+        }
+    }
+    return count;
+}
+
+//! Add to SGP4 catalog
+/*! Initialize a ::Sgp4 for the TLE and add its terms to the catalog.
+    \param tle Two Line Element to add.
+    \return Index of the new entry, otherwise negative error.
+*/
+int32_t Sgp4Catalog::Add(const tlestruc &tle)
+{
+    int32_t iretn;
+    Sgp4 satellite;
+    if ((iretn = satellite.Init(tle)) < 0)
+    {
+        return iretn;
+    }
+    this->tle.push_back(tle);
+    epoch.push_back(tle.utc);
+    ma.push_back(tle.ma);
+    ap.push_back(tle.ap);
+    raan.push_back(tle.raan);
+    incl.push_back(tle.i);
+    bstar.push_back(tle.bstar);
+    eo.push_back(satellite.eo);
+    xmdot.push_back(satellite.xmdot);
+    omgdot.push_back(satellite.omgdot);
+    xnodot.push_back(satellite.xnodot);
+    xnodcf.push_back(satellite.xnodcf);
+    c1.push_back(satellite.c1);
+    c4.push_back(satellite.c4);
+    t2cof.push_back(satellite.t2cof);
+    eta.push_back(satellite.eta);
+    delmo.push_back(satellite.delmo);
+    sinmo.push_back(satellite.sinmo);
+    aodp.push_back(satellite.aodp);
+    xnodp.push_back(satellite.xnodp);
+    xlcof.push_back(satellite.xlcof);
+    aycof.push_back(satellite.aycof);
+    cosio.push_back(satellite.cosio);
+    sinio.push_back(satellite.sinio);
+    x3thm1.push_back(satellite.x3thm1);
+    x1mth2.push_back(satellite.x1mth2);
+    x7thm1.push_back(satellite.x7thm1);
+    // Terms dropped for a low perigee add nothing
+    c5.push_back(satellite.isimp ? 0. : satellite.c5);
+    omgcof.push_back(satellite.isimp ? 0. : satellite.omgcof);
+    xmcof.push_back(satellite.isimp ? 0. : satellite.xmcof);
+    d2.push_back(satellite.d2);
+    d3.push_back(satellite.d3);
+    d4.push_back(satellite.d4);
+    t3cof.push_back(satellite.t3cof);
+    t4cof.push_back(satellite.t4cof);
+    t5cof.push_back(satellite.t5cof);
+    return this->tle.size() - 1;
+}
+
+//! Empty SGP4 catalog
+void Sgp4Catalog::Clear()
+{
+    *this = Sgp4Catalog();
+}
+
+//! Propagate SGP4 catalog
+/*! Propagate every satellite in the catalog to the same time, filling ::sx, ::sy, ::sz, ::vx, ::vy
+ * and ::vz. Gives the same results as ::Sgp4::Propagate for each satellite, up to rounding where
+ * an optimizing compiler fuses the operations of the loops differently.
+    \param utc Specified time as Modified Julian Date
+    \param eci If true, convert from TEME to ECI, otherwise leave in TEME.
+    \return Number of satellites, otherwise negative error.
+*/
+int32_t Sgp4Catalog::Propagate(double utc, bool eci)
+{
+    size_t count = tle.size();
+    sx.resize(count);
+    sy.resize(count);
+    sz.resize(count);
+    vx.resize(count);
+    vy.resize(count);
+    vz.resize(count);
+    a.resize(count);
+    xn.resize(count);
+    xnode.resize(count);
+    axn.resize(count);
+    ayn.resize(count);
+    capu.resize(count);
+    ecose.resize(count);
+    esine.resize(count);
+    sinepw.resize(count);
+    cosepw.resize(count);
+
+    // UPDATE FOR SECULAR GRAVITY AND ATMOSPHERIC DRAG, AND LONG PERIOD PERIODICS
+    for (size_t i=0; i<count; ++i)
+    {
+        double tsince = (utc - epoch[i]) * SGP4_XMNPDA;
+        double xmdf = ma[i] + xmdot[i] * tsince;
+        double omgadf = ap[i] + omgdot[i] * tsince;
+        double xnoddf = raan[i] + xnodot[i] * tsince;
+        double tsq = tsince * tsince;
+        xnode[i] = xnoddf + xnodcf[i] * tsq;
+        double tempa = 1. - c1[i] * tsince;
+        double tempe = bstar[i] * c4[i] * tsince;
+        double templ = t2cof[i] * tsq;
+        double delomg = omgcof[i] * tsince;
+        double delm = xmcof[i] * (pow((1. + eta[i] * cos(xmdf)), 3.) - delmo[i]);
+        double temp = delomg + delm;
+        double xmp = xmdf + temp;
+        double alpha = omgadf - temp;
+        double tcube = tsq * tsince;
+        double tfour = tsince * tcube;
+        tempa = tempa - d2[i] * tsq - d3[i] * tcube - d4[i] * tfour;
+        tempe = tempe + bstar[i] * c5[i] * (sin(xmp) - sinmo[i]);
+        templ = templ + t3cof[i] * tcube + tfour * (t4cof[i] + tsince * t5cof[i]);
+        a[i] = aodp[i] * tempa * tempa;
+        double e = eo[i] - tempe;
+        double xl = xmp + alpha + xnode[i] + xnodp[i] * templ;
+        double beta = sqrt(1. - e * e);
+        xn[i] = SGP4_XKE / pow(a[i], 1.5);
+        axn[i] = e * cos(alpha);
+        temp = 1. / (a[i] * beta * beta);
+        double xll = temp * xlcof[i] * axn[i];
+        double aynl = temp * aycof[i];
+        double xlt = xl + xll;
+        ayn[i] = e * sin(alpha) + aynl;
+        capu[i] = xlt - xnode[i];
+    }
+
+    // SOLVE KEPLERS EQUATION, one satellite at a time
+    for (size_t i=0; i<count; ++i)
+    {
+        capu[i] = ranrm(capu[i]);
+        double temp2 = capu[i];
+        double temp3 = 0., temp4 = 0., temp5 = 0., temp6 = 0.;
+        double sine = 0., cose = 0.;
+        for (uint16_t j=1; j<=10; ++j)
+        {
+            sine = sin(temp2);
+            cose = cos(temp2);
+            temp3 = axn[i] * sine;
+            temp4 = ayn[i] * cose;
+            temp5 = axn[i] * cose;
+            temp6 = ayn[i] * sine;
+            double epw = (capu[i] - temp4 + temp3 - temp2) / (1. - temp5 - temp6) + temp2;
+            if (fabs(epw - temp2) <= SGP4_E6A)
+                break;
+            temp2 = epw;
+        }
+        sinepw[i] = sine;
+        cosepw[i] = cose;
+        ecose[i] = temp5 + temp6;
+        esine[i] = temp3 - temp4;
+    }
+
+    // SHORT PERIODICS, ORIENTATION, POSITION AND VELOCITY in TEME
+    for (size_t i=0; i<count; ++i)
+    {
+        double elsq = axn[i] * axn[i] + ayn[i] * ayn[i];
+        double temp = 1. - elsq;
+        double pl = a[i] * temp;
+        double r = a[i] * (1. - ecose[i]);
+        double temp1 = 1. / r;
+        double rdot = SGP4_XKE * sqrt(a[i]) * esine[i] * temp1;
+        double rfdot = SGP4_XKE * sqrt(pl) * temp1;
+        double temp2 = a[i] * temp1;
+        double betal = sqrt(temp);
+        double temp3 = 1. / (1. + betal);
+        double cosu = temp2 * (cosepw[i] - axn[i] + ayn[i] * esine[i] * temp3);
+        double sinu = temp2 * (sinepw[i] - ayn[i] - axn[i] * esine[i] * temp3);
+        double u = actan(sinu, cosu);
+        double sin2u = 2. * sinu * cosu;
+        double cos2u = 2. * cosu * cosu - 1.;
+        temp = 1. / pl;
+        temp1 = SGP4_CK2 * temp;
+        temp2 = temp1 * temp;
+        double rk = r * (1. - 1.5 * temp2 * betal * x3thm1[i]) + .5 * temp1 * x1mth2[i] * cos2u;
+        double uk = u - .25 * temp2 * x7thm1[i] * sin2u;
+        double xnodek = xnode[i] + 1.5 * temp2 * cosio[i] * sin2u;
+        double xinck = incl[i] + 1.5 * temp2 * cosio[i] * sinio[i] * cos2u;
+        double rdotk = rdot - xn[i] * temp1 * x1mth2[i] * sin2u;
+        double rfdotk = rfdot + xn[i] * temp1 * (x1mth2[i] * cos2u + 1.5 * x3thm1[i]);
+        double sinuk = sin(uk);
+        double cosuk = cos(uk);
+        double sinik = sin(xinck);
+        double cosik = cos(xinck);
+        double sinnok = sin(xnodek);
+        double cosnok = cos(xnodek);
+        double xmx = -sinnok * cosik;
+        double xmy = cosnok * cosik;
+        double ux = xmx * sinuk + cosnok * cosuk;
+        double uy = xmy * sinuk + sinnok * cosuk;
+        double uz = sinik * sinuk;
+        double wx = xmx * cosuk - cosnok * sinuk;
+        double wy = xmy * cosuk - sinnok * sinuk;
+        double wz = sinik * cosuk;
+        sx[i] = 1000. * SGP4_XKMPER * rk * ux;
+        sy[i] = 1000. * SGP4_XKMPER * rk * uy;
+        sz[i] = 1000. * SGP4_XKMPER * rk * uz;
+        vx[i] = 1000. * SGP4_XKMPER * (rdotk * ux + rfdotk * wx) / 60.;
+        vy[i] = 1000. * SGP4_XKMPER * (rdotk * uy + rfdotk * wy) / 60.;
+        vz[i] = 1000. * SGP4_XKMPER * (rdotk * uz + rfdotk * wz) / 60.;
+    }
+
+    if (eci)
+    {
+        // Equation of Equinoxes, Nutation, Precession and Frame Bias combined
+        rmatrix sm, nm, pm, bm;
+        teme2true(utc, &sm);
+        true2mean(utc, &nm);
+        mean2j2000(utc, &pm);
+        j20002gcrf(&bm);
+        rmatrix rm = rm_mmult(bm, rm_mmult(pm, rm_mmult(nm, sm)));
+        const rvector *m = rm.row;
+        for (size_t i=0; i<count; ++i)
+        {
+            double x = sx[i], y = sy[i], z = sz[i];
+            sx[i] = m[0].col[0] * x + m[0].col[1] * y + m[0].col[2] * z;
+            sy[i] = m[1].col[0] * x + m[1].col[1] * y + m[1].col[2] * z;
+            sz[i] = m[2].col[0] * x + m[2].col[1] * y + m[2].col[2] * z;
+            x = vx[i];
+            y = vy[i];
+            z = vz[i];
+            vx[i] = m[0].col[0] * x + m[0].col[1] * y + m[0].col[2] * z;
+            vy[i] = m[1].col[0] * x + m[1].col[1] * y + m[1].col[2] * z;
+            vz[i] = m[2].col[0] * x + m[2].col[1] * y + m[2].col[2] * z;
+        }
+    }
+
+    return count;
+}
+
 double atan3(double sa, double cb)
 {
     // sa = sine of angle, cb = cos of angle
@@ -5182,14 +5585,26 @@ int32_t eci2tle2(cartpos eci, tlestruc &tle)
          * @param tle Two Line Element, given as pointer to a ::Cosmos::Convert::tlestruc
          * @param eci Converted location, given as pointer to a ::Cosmos::Convert::cartpos
          */
-int tle2eci(double utc, tlestruc tle, cartpos &eci)
+int tle2eci(double utc, const tlestruc &tle, cartpos &eci)
 {
+    int32_t iretn;
 
     // call sgp4, eci is passed by reference
-    sgp4(utc, tle, eci);
-
-    // eci = *teme;
+    if ((iretn = sgp4(utc, tle, eci)) < 0)
+    {
+        return iretn;
+    }
+    return teme2eci(utc, eci);
+}
 
+//! Convert TEME to ECI
+/*! Convert a cartesian state from the True Equator Mean Equinox frame used by SGP4 to ECI.
+    \param utc Time of the state as Modified Julian Date.
+    \param eci State in TEME, converted in place to ECI.
+    \return 0, otherwise negative error.
+*/
+int32_t teme2eci(double utc, cartpos &eci)
+{
     // Uniform of Date to True of Date (Equation of Equinoxes)
     rmatrix sm;
     teme2true(utc, &sm);
@@ -5989,8 +6404,8 @@ string tle2tlestring(tlestruc reftle)
 */
 rvector utc2nuts(double mjd)
 {
-    static double lmjd = 0.;
-    static uvector lcalc = {{{0., 0., 0.}, 0.}};
+    static thread_local double lmjd = 0.;
+    static thread_local uvector lcalc = {{{0., 0., 0.}, 0.}};
 
     if (mjd != lmjd)
     {
@@ -6012,8 +6427,8 @@ matrix, for the provided UTC date.
 */
 double utc2dpsi(double mjd)
 {
-    static double lmjd = 0.;
-    static double lcalc = 0.;
+    static thread_local double lmjd = 0.;
+    static thread_local double lcalc = 0.;
     rvector nuts;
 
     if (mjd != lmjd)
@@ -6033,8 +6448,8 @@ matrix, for the provided UTC date.
 */
 double utc2depsilon(double mjd)
 {
-    static double lmjd = 0.;
-    static double lcalc = 0.;
+    static thread_local double lmjd = 0.;
+    static thread_local double lcalc = 0.;
     rvector nuts;
 
     if (mjd != lmjd)
@@ -6053,8 +6468,8 @@ double utc2depsilon(double mjd)
 */
 double utc2gast(double mjd)
 {
-    static double lmjd = 0.;
-    static double lgast = 0.;
+    static thread_local double lmjd = 0.;
+    static thread_local double lgast = 0.;
     double omega, F, D;
 
     if (mjd != lmjd)
@@ -6080,36 +6495,12 @@ double utc2gast(double mjd)
 */
 double utc2dut1(double mjd)
 {
-    static double lmjd = 0.;
-    static double lcalc = 0.;
-    double frac;
-    //	uint32_t mjdi;
-    uint32_t iersidx;
-
-    if (mjd != lmjd)
+    const IersTable *table = iers_table();
+    if (table == nullptr)
     {
-        if (load_iers() && iers.size() > 2)
-        {
-            if ((uint32_t)mjd >= iersbase)
-            {
-                if ((iersidx = (uint32_t)mjd - iersbase) > iers.size())
-                {
-                    iersidx = iers.size() - 2;
-                }
-            }
-            else
-            {
-                iersidx = 0;
-            }
-            //			mjdi = (uint32_t)mjd;
-            frac = mjd - (uint32_t)mjd;
-            lcalc = ((frac * iers[1 + iersidx].dutc + (1. - frac) * iers[iersidx].dutc) / 86400.);
-            lmjd = mjd;
-        }
-        else
-            lcalc = 0.;
+        return 0.;
     }
-    return (lcalc);
+    return table->Dut1(mjd);
 }
 
 //! Convert UTC to UT1
@@ -6121,20 +6512,31 @@ double utc2dut1(double mjd)
 */
 double utc2ut1(double mjd)
 {
-    static double lmjd = 0.;
-    static double lut = 0.;
+    const IersTable *table = iers_table();
+    if (table == nullptr)
+    {
+        return 0.;
+    }
+    return table->Utc2Ut1(mjd);
+}
 
-    if (mjd != lmjd)
+//! Convert UTC to UT1 at many times
+/*! Convert a list of Coordinated Universal Times to Universal Time.
+\param mjd UTC in Modified Julian Day.
+\param ut1 UT1 in Modified Julian Day, one for each UTC.
+\return 0, otherwise negative error.
+*/
+int32_t utc2ut1(const vector<double> &mjd, vector<double> &ut1)
+{
+    const IersTable *table = iers_table();
+    if (table == nullptr)
     {
-        if (load_iers())
-        {
-            lut = mjd + utc2dut1(mjd);
-            lmjd = mjd;
-        }
-        else
-            lut = 0.;
+        int32_t iretn = load_iers();
+        return iretn < 0 ? iretn : GENERAL_ERROR_EMPTY;
     }
-    return (lut);
+    ut1.resize(mjd.size());
+    table->Utc2Ut1(mjd.data(), mjd.size(), ut1.data());
+    return 0;
 }
 
 //! Convert TT to UTC.
@@ -6146,27 +6548,12 @@ double utc2ut1(double mjd)
 */
 double tt2utc(double mjd)
 {
-    uint32_t iersidx;
-    int32_t iretn = 0;
-
-    if ((iretn = load_iers()) && iers.size() > 1)
+    const IersTable *table = iers_table();
+    if (table == nullptr)
     {
-        if ((uint32_t)mjd >= iersbase)
-        {
-            if ((iersidx = (uint32_t)mjd - iersbase) > iers.size())
-            {
-                iersidx = iers.size() - 1;
-            }
-        }
-        else
-        {
-            iersidx = 0;
-            return ((double)iretn);
-        }
-        return (mjd - (32.184 + iers[iersidx].ls) / 86400.);
+        return 0.;
     }
-    else
-        return (0.);
+    return table->Tt2Utc(mjd);
 }
 
 //! Convert UTC to TT.
@@ -6178,36 +6565,31 @@ double tt2utc(double mjd)
 */
 double utc2tt(double mjd)
 {
-    static double lmjd = 0.;
-    static double ltt = 0.;
-    uint32_t iersidx = 0;
-    int32_t iretn = 0;
+    const IersTable *table = iers_table();
+    if (table == nullptr)
+    {
+        return static_cast<double>(load_iers());
+    }
+    return table->Utc2Tt(mjd);
+}
 
-    if (mjd != lmjd)
+//! Convert UTC to TT at many times
+/*! Convert a list of Coordinated Universal Times to Terrestrial Dynamical Time.
+\param mjd UTC in Modified Julian Day.
+\param tt TT in Modified Julian Day, one for each UTC.
+\return 0, otherwise negative error.
+*/
+int32_t utc2tt(const vector<double> &mjd, vector<double> &tt)
+{
+    const IersTable *table = iers_table();
+    if (table == nullptr)
     {
-        if ((iretn = load_iers()) && iers.size() > 1)
-        {
-            if ((uint32_t)mjd >= iersbase)
-            {
-                if ((iersidx = (uint32_t)mjd - iersbase) > iers.size())
-                {
-                    iersidx = iers.size() - 1;
-                }
-            }
-            else
-            {
-                iersidx = 0;
-            }
-            ltt = (mjd + (32.184 + iers[iersidx].ls) / 86400.);
-            lmjd = mjd;
-            return (ltt);
-        }
-        else
-        {
-            return ((double)iretn);
-        }
+        int32_t iretn = load_iers();
+        return iretn < 0 ? iretn : GENERAL_ERROR_EMPTY;
     }
-    return (ltt);
+    tt.resize(mjd.size());
+    table->Utc2Tt(mjd.data(), mjd.size(), tt.data());
+    return 0;
 }
 
 //! Load IERS Polar Motion, UT1-UTC, Leap Seconds.
@@ -6222,60 +6604,239 @@ double utc2tt(double mjd)
 */
 int32_t load_iers()
 {
-    FILE *fdes;
-    iersstruc tiers;
+    static mutex iers_mutex;
 
-    if (iers.size() == 0)
+    const IersTable *table = iers_context.load(std::memory_order_acquire);
+    if (table == nullptr)
     {
-        string fname;
-        int32_t iretn = get_cosmosresources(fname);
-        if (iretn < 0)
+        std::lock_guard<mutex> lock(iers_mutex);
+        table = iers_context.load(std::memory_order_relaxed);
+        if (table == nullptr)
         {
-            return iretn;
-        }
-        fname += "/general/iers_pm_dut_ls.txt";
-        if ((fdes = fopen(fname.c_str(), "r")) != NULL)
-        {
-            char data[100];
-            while (fgets(data, 100, fdes))
+            string fname;
+            int32_t iretn = get_cosmosresources(fname);
+            if (iretn < 0)
+            {
+                return iretn;
+            }
+            fname += "/general/iers_pm_dut_ls.txt";
+            IersTable *ntable = new IersTable;
+            iretn = ntable->Load(fname);
+            if (iretn <= 0)
             {
-                sscanf(data, "%u %lg %lg %lg %u", &tiers.mjd, &tiers.pmx, &tiers.pmy, &tiers.dutc, &tiers.ls);
-                iers.push_back(tiers);
+                delete ntable;
+                return iretn;
             }
-            fclose(fdes);
+            // Never freed, as readers hold it without a lock
+            iers_context.store(ntable, std::memory_order_release);
+            table = ntable;
         }
-        if (iers.size())
-            iersbase = iers[0].mjd;
     }
-    return (iers.size());
+    return table->Size();
 }
 
-//! Leap Seconds
-/*! Returns number of leap seconds for provided Modified Julian Day.
-\param mjd Provided time.
-\return Number of leap seconds, or 0.
+//! IERS table
+/*! Return the table of Earth orientation and time scales from COSMOS resources, loading it
+* the first time.
+\return Pointer to the table, otherwise nullptr.
 */
-int32_t leap_seconds(double mjd)
+const IersTable *iers_table()
 {
-    uint32_t iersidx;
+    const IersTable *table = iers_context.load(std::memory_order_acquire);
+    if (table == nullptr && load_iers() > 0)
+    {
+        table = iers_context.load(std::memory_order_acquire);
+    }
+    return table;
+}
 
-    if (load_iers() && iers.size() > 1)
+//! Load IERS table
+/*! Read an IERS file of one line per day, each holding the MJD, the Polar Motion for X and
+* Y in radians, UT1-UTC in seconds of time, and the number of Leap Seconds.
+\param filename Path of IERS file.
+\return Number of days, otherwise negative error.
+*/
+int32_t IersTable::Load(string filename)
+{
+    FILE *fdes = fopen(filename.c_str(), "r");
+    if (fdes == nullptr)
+    {
+        return -errno;
+    }
+    entries.clear();
+    char data[100];
+    while (fgets(data, 100, fdes))
     {
-        if ((uint32_t)mjd >= iersbase)
+        uint32_t mjd;
+        uint32_t ls;
+        entry tentry;
+        if (sscanf(data, "%u %lg %lg %lg %u", &mjd, &tentry.pmx, &tentry.pmy, &tentry.dutc, &ls) != 5)
         {
-            if ((iersidx = (uint32_t)mjd - iersbase) > iers.size())
-            {
-                iersidx = iers.size() - 1;
-            }
+            continue;
         }
-        else
+        tentry.ls = ls;
+        if (entries.empty())
+        {
+            base = mjd;
+        }
+        else if (mjd < base + entries.size())
         {
-            iersidx = 0;
+            continue;
         }
-        return (iers[iersidx].ls);
+        // Hold the last day over any missing days, so that every day is at its own index
+        while (mjd > base + entries.size())
+        {
+            entries.push_back(entries.back());
+        }
+        entries.push_back(tentry);
+    }
+    fclose(fdes);
+    return entries.size();
+}
+
+// Index of the day at or before the requested time, and the fraction of the way to the next
+size_t IersTable::Index(double mjd, double &frac) const
+{
+    double day = floor(mjd);
+    if (!(day >= base))
+    {
+        frac = 0.;
+        return 0;
+    }
+    size_t index = static_cast<size_t>(day - base);
+    if (index + 1 >= entries.size())
+    {
+        frac = 0.;
+        return entries.size() - 1;
+    }
+    frac = mjd - day;
+    return index;
+}
+
+//! UT1-UTC
+/*! \param mjd UTC in Modified Julian Day.
+\return UT1-UTC in days, interpolated between days.
+*/
+double IersTable::Dut1(double mjd) const
+{
+    if (entries.empty())
+    {
+        return 0.;
+    }
+    double frac;
+    size_t index = Index(mjd, frac);
+    if (frac == 0.)
+    {
+        return entries[index].dutc / 86400.;
+    }
+    return (frac * entries[index + 1].dutc + (1. - frac) * entries[index].dutc) / 86400.;
+}
+
+//! Polar motion
+/*! \param mjd UTC in Modified Julian Day.
+\return Polar motion in radians, interpolated between days.
+*/
+cvector IersTable::PolarMotion(double mjd) const
+{
+    cvector pm = cv_zero();
+    if (entries.empty())
+    {
+        return pm;
+    }
+    double frac;
+    size_t index = Index(mjd, frac);
+    if (frac == 0.)
+    {
+        pm.x = entries[index].pmx;
+        pm.y = entries[index].pmy;
     }
     else
+    {
+        pm.x = frac * entries[index + 1].pmx + (1. - frac) * entries[index].pmx;
+        pm.y = frac * entries[index + 1].pmy + (1. - frac) * entries[index].pmy;
+    }
+    return pm;
+}
+
+//! Leap seconds
+/*! \param mjd UTC in Modified Julian Day.
+\return Leap seconds in effect on that day.
+*/
+int32_t IersTable::LeapSeconds(double mjd) const
+{
+    if (entries.empty())
+    {
+        return 0;
+    }
+    double frac;
+    return entries[Index(mjd, frac)].ls;
+}
+
+//! Convert UTC to UT1
+double IersTable::Utc2Ut1(double mjd) const
+{
+    return mjd + Dut1(mjd);
+}
+
+//! Convert UTC to TT
+double IersTable::Utc2Tt(double mjd) const
+{
+    return mjd + (32.184 + LeapSeconds(mjd)) / 86400.;
+}
+
+//! Convert UTC to TDB
+double IersTable::Utc2Tdb(double mjd) const
+{
+    double g = 6.2400756746 + .0172019703436 * (mjd - 51544.5);
+    return Utc2Tt(mjd) + (.001658 * sin(g) + .000014 * sin(2 * g)) / 86400.;
+}
+
+//! Convert TT to UTC
+double IersTable::Tt2Utc(double mjd) const
+{
+    return mjd - (32.184 + LeapSeconds(mjd)) / 86400.;
+}
+
+//! Convert UTC to UT1 at many times
+void IersTable::Utc2Ut1(const double *mjd, size_t count, double *ut1) const
+{
+    for (size_t i=0; i<count; ++i)
+    {
+        ut1[i] = Utc2Ut1(mjd[i]);
+    }
+}
+
+//! Convert UTC to TT at many times
+void IersTable::Utc2Tt(const double *mjd, size_t count, double *tt) const
+{
+    for (size_t i=0; i<count; ++i)
+    {
+        tt[i] = Utc2Tt(mjd[i]);
+    }
+}
+
+//! Convert UTC to TDB at many times
+void IersTable::Utc2Tdb(const double *mjd, size_t count, double *tdb) const
+{
+    for (size_t i=0; i<count; ++i)
+    {
+        tdb[i] = Utc2Tdb(mjd[i]);
+    }
+}
+
+//! Leap Seconds
+/*! Returns number of leap seconds for provided Modified Julian Day.
+\param mjd Provided time.
+\return Number of leap seconds, or 0.
+*/
+int32_t leap_seconds(double mjd)
+{
+    const IersTable *table = iers_table();
+    if (table == nullptr)
+    {
         return 0;
+    }
+    return table->LeapSeconds(mjd);
 }
 
 //! Polar motion
@@ -6285,33 +6846,12 @@ int32_t leap_seconds(double mjd)
 */
 cvector polar_motion(double mjd)
 {
-    cvector pm;
-    double frac;
-    //	uint32_t mjdi;
-    uint32_t iersidx;
-
-    pm = cv_zero();
-    if (load_iers() && iers.size() > 2)
+    const IersTable *table = iers_table();
+    if (table == nullptr)
     {
-        if ((uint32_t)mjd >= iersbase)
-        {
-            if ((iersidx = (uint32_t)mjd - iersbase) > iers.size())
-            {
-                iersidx = iers.size() - 2;
-            }
-        }
-        else
-        {
-            iersidx = 0;
-        }
-        //		mjdi = (uint32_t)mjd;
-        frac = mjd - (uint32_t)mjd;
-        pm = cv_zero();
-        pm.x = frac * iers[1 + iersidx].pmx + (1. - frac) * iers[iersidx].pmx;
-        pm.y = frac * iers[1 + iersidx].pmy + (1. - frac) * iers[iersidx].pmy;
+        return cv_zero();
     }
-
-    return (pm);
+    return table->PolarMotion(mjd);
 }
 
 //! Earth Rotation Angle
@@ -6322,8 +6862,8 @@ cvector polar_motion(double mjd)
 */
 double utc2era(double mjd)
 {
-    static double lmjd = 0.;
-    static double ltheta = 0.;
+    static thread_local double lmjd = 0.;
+    static thread_local double ltheta = 0.;
     double ut1;
 
     if (mjd != lmjd)
@@ -6338,8 +6878,8 @@ double utc2era(double mjd)
 
 double utc2gmst2000(double utc)
 {
-    static double lutc = 0.;
-    static double lgmst = 0.;
+    static thread_local double lutc = 0.;
+    static thread_local double lgmst = 0.;
     double tt;
 
     if (utc > 0.)
@@ -6364,8 +6904,8 @@ double utc2gmst2000(double utc)
 */
 double utc2gmst1982(double mjd)
 {
-    static double lmjd = 0.;
-    static double lcalc = 0.;
+    static thread_local double lmjd = 0.;
+    static thread_local double lcalc = 0.;
     double jcen;
 
     if (mjd != lmjd)
@@ -6386,8 +6926,8 @@ double utc2gmst1982(double mjd)
 */
 double utc2jcenut1(double mjd)
 {
-    static double lmjd = 0.;
-    static double lcalc = 0.;
+    static thread_local double lmjd = 0.;
+    static thread_local double lcalc = 0.;
 
     if (mjd != lmjd)
     {
@@ -6403,8 +6943,8 @@ double utc2jcenut1(double mjd)
         */
 double utc2jcentt(double mjd)
 {
-    static double lmjd = 0.;
-    static double lcalc = 0.;
+    static thread_local double lmjd = 0.;
+    static thread_local double lcalc = 0.;
 
     if (mjd != lmjd)
     {
@@ -6431,8 +6971,8 @@ double utc2jcentt(double mjd)
 double utc2epsilon(double mjd)
 {
     // Vallado, et al, AAS-06_134, eq. 17
-    static double lmjd = 0.;
-    static double lcalc = 0.;
+    static thread_local double lmjd = 0.;
+    static thread_local double lcalc = 0.;
     double jcen;
 
     if (mjd != lmjd)
@@ -6452,8 +6992,8 @@ double utc2epsilon(double mjd)
         */
 double utc2L(double mjd)
 {
-    static double lmjd = 0.;
-    static double lcalc = 0.;
+    static thread_local double lmjd = 0.;
+    static thread_local double lcalc = 0.;
     double jcen;
 
     if (mjd != lmjd)
@@ -6473,8 +7013,8 @@ double utc2L(double mjd)
         */
 double utc2Lp(double mjd)
 {
-    static double lmjd = 0.;
-    static double lcalc = 0.;
+    static thread_local double lmjd = 0.;
+    static thread_local double lcalc = 0.;
     double jcen;
 
     if (mjd != lmjd)
@@ -6494,8 +7034,8 @@ double utc2Lp(double mjd)
         */
 double utc2F(double mjd)
 {
-    static double lmjd = 0.;
-    static double lcalc = 0.;
+    static thread_local double lmjd = 0.;
+    static thread_local double lcalc = 0.;
     double jcen;
 
     if (mjd != lmjd)
@@ -6515,8 +7055,8 @@ double utc2F(double mjd)
         */
 double utc2D(double mjd)
 {
-    static double lmjd = 0.;
-    static double lcalc = 0.;
+    static thread_local double lmjd = 0.;
+    static thread_local double lcalc = 0.;
     double jcen;
 
     if (mjd != lmjd)
@@ -6536,8 +7076,8 @@ double utc2D(double mjd)
         */
 double utc2omega(double mjd)
 {
-    static double lmjd = 0.;
-    static double lcalc = 0.;
+    static thread_local double lmjd = 0.;
+    static thread_local double lcalc = 0.;
     double jcen;
 
     if (mjd != lmjd)
@@ -6609,21 +7149,31 @@ double utc2theta(double utc)
         */
 double utc2tdb(double mjd)
 {
-    static double lmjd = 0.;
-    static double ltdb = 0.;
-    double tt, g;
+    const IersTable *table = iers_table();
+    if (table == nullptr)
+    {
+        return 0.;
+    }
+    return table->Utc2Tdb(mjd);
+}
 
-    if (mjd != lmjd)
+//! Convert UTC to TDB at many times
+/*! Convert a list of Coordinated Universal Times to Barycentric Dynamical Time.
+\param mjd UTC in Modified Julian Day.
+\param tdb TDB in Modified Julian Day, one for each UTC.
+\return 0, otherwise negative error.
+*/
+int32_t utc2tdb(const vector<double> &mjd, vector<double> &tdb)
+{
+    const IersTable *table = iers_table();
+    if (table == nullptr)
     {
-        tt = utc2tt(mjd);
-        if (tt > 0.)
-        {
-            g = 6.2400756746 + .0172019703436 * (mjd - 51544.5);
-            ltdb = (tt + (.001658 * sin(g) + .000014 * sin(2 * g)) / 86400.);
-            lmjd = mjd;
-        }
+        int32_t iretn = load_iers();
+        return iretn < 0 ? iretn : GENERAL_ERROR_EMPTY;
     }
-    return (ltdb);
+    tdb.resize(mjd.size());
+    table->Utc2Tdb(mjd.data(), mjd.size(), tdb.data());
+    return 0;
 }
 
 //! Convert UTC to GPS
@@ -111,6 +111,9 @@ namespace Cosmos {
 
         int32_t loc_clear(locstruc &loc);
         int32_t pos_extra(double utc, locstruc &loc);
+        int32_t pos_extra_cache_size(size_t size);
+        void pos_extra_cache_clear();
+        void pos_extra_cache_stats(size_t &hits, size_t &misses);
         int32_t pos_lvlh(locstruc &loc);
         int32_t pos_clear(locstruc &loc);
         int32_t pos_icrf(locstruc &loc);
@@ -260,13 +263,14 @@ namespace Cosmos {
         int32_t sat2geoc(rvector sat, locstruc &loc, rvector &pos);
         int32_t geod2sep(gvector src, gvector dst, double &sep);
         double geod2sep(gvector src, gvector dst);
-        int lines2eci(double mjd, vector<tlestruc> tle, cartpos &eci);
-        int tle2eci(double mjd, tlestruc tle, cartpos &eci);
+        int lines2eci(double mjd, const vector<tlestruc> &tle, cartpos &eci);
+        int tle2eci(double mjd, const tlestruc &tle, cartpos &eci);
+        int32_t teme2eci(double mjd, cartpos &eci);
         double atan3(double sa, double cb);
         int32_t eci2tle(cartpos eci, tlestruc &tle);
         int32_t eci2tle2(cartpos eci, tlestruc &tle);
 //        int32_t rv2tle(double utc, cartpos eci, tlestruc &tle);
-        int sgp4(double utc, tlestruc tle, cartpos &pos_teme);
+        int sgp4(double utc, const tlestruc &tle, cartpos &pos_teme);
         tlestruc get_line(uint16_t index, vector<tlestruc> tle);
         int32_t load_lines(string fname, vector<tlestruc>& tle);
         int32_t load_lines_multi(string fname, vector<tlestruc>& tle);
@@ -285,6 +289,7 @@ namespace Cosmos {
         double utc2dpsi(double mjd);
         double utc2gast(double mjd);
         double utc2ut1(double mjd);
+        int32_t utc2ut1(const vector<double> &mjd, vector<double> &ut1);
         double utc2dut1(double mjd);
         int32_t load_iers();
         cvector polar_motion(double mjd);
@@ -294,6 +299,7 @@ namespace Cosmos {
         double utc2gmst2000(double mjd=0.);
         double utc2jcenut1(double mjd);
         double utc2tt(double mjd);
+        int32_t utc2tt(const vector<double> &mjd, vector<double> &tt);
         double utc2jcentt(double mjd);
         double utc2epsilon(double mjd);
         double utc2L(double mjd);
@@ -305,6 +311,7 @@ namespace Cosmos {
         double utc2z(double mjd);
         double utc2gps(double utc);
         double utc2tdb(double mjd);
+        int32_t utc2tdb(const vector<double> &mjd, vector<double> &tdb);
         double utc2theta(double mjd);
         double  tt2utc(double mjd);
         double  gps2utc(double gps);
@@ -328,6 +335,107 @@ namespace Cosmos {
                     // 2nd derivative
                     Vector a;
                 };
+
+        //! IERS Earth orientation and time scales
+        //! The daily polar motion, UT1-UTC and leap seconds of the IERS table, loaded once and then
+        //! only read. Every lookup indexes the table directly by day, so one IersTable may be
+        //! shared between threads. Outside the table, the values at its ends are held.
+        //! iers_table() returns the one loaded from COSMOS resources.
+        class IersTable
+        {
+        public:
+            int32_t Load(string filename);
+            size_t Size() const { return entries.size(); }
+            double Dut1(double mjd) const;
+            cvector PolarMotion(double mjd) const;
+            int32_t LeapSeconds(double mjd) const;
+            double Utc2Ut1(double mjd) const;
+            double Utc2Tt(double mjd) const;
+            double Utc2Tdb(double mjd) const;
+            double Tt2Utc(double mjd) const;
+            void Utc2Ut1(const double *mjd, size_t count, double *ut1) const;
+            void Utc2Tt(const double *mjd, size_t count, double *tt) const;
+            void Utc2Tdb(const double *mjd, size_t count, double *tdb) const;
+
+        private:
+            struct entry
+            {
+                //! Polar motion (radians)
+                double pmx;
+                double pmy;
+                //! UT1-UTC (seconds)
+                double dutc;
+                int32_t ls;
+            };
+            size_t Index(double mjd, double &frac) const;
+
+            vector<entry> entries;
+            double base = 0.;
+        };
+
+        const IersTable *iers_table();
+
+        //! SGP4 propagator
+        //! Holds everything SGP4 derives from a single Two Line Element, computed once by Init(), so
+        //! that propagating to a new time only costs the time dependent part. Propagation does not
+        //! change the object, so one Sgp4 may be shared between threads.
+        class Sgp4
+        {
+        public:
+            Sgp4() {}
+            explicit Sgp4(const tlestruc &tle) { Init(tle); }
+
+            int32_t Init(const tlestruc &tle);
+            bool Matches(const tlestruc &tle) const;
+            int32_t Propagate(double utc, cartpos &pos_teme) const;
+            int32_t Propagate(const double *utc, size_t count, cartpos *pos_teme) const;
+
+            //! Two Line Element this was initialized from
+            tlestruc tle;
+
+        private:
+            friend class Sgp4Catalog;
+            bool initialized = false;
+            double eo = 0.;
+            double c1 = 0., c4 = 0., c5 = 0.;
+            double cosio = 0., sinio = 0., x3thm1 = 0., x1mth2 = 0., x7thm1 = 0.;
+            double xnodp = 0., aodp = 0., eta = 0.;
+            double xmdot = 0., omgdot = 0., xnodot = 0., omgcof = 0., xmcof = 0., xnodcf = 0.;
+            double t2cof = 0., t3cof = 0., t4cof = 0., t5cof = 0., xlcof = 0., aycof = 0.;
+            double delmo = 0., sinmo = 0., d2 = 0., d3 = 0., d4 = 0.;
+            bool isimp = false;
+        };
+
+        //! SGP4 catalog
+        //! A set of satellites propagated together to a single time. The terms of each ::Sgp4 are
+        //! kept as one array per term, and the secular and short period parts of SGP4 run as loops
+        //! over those arrays, with no branches, so the compiler can vectorize their arithmetic. Only
+        //! the solution of Kepler's equation, whose iterations depend on the data, is done one
+        //! satellite at a time. Results are kept as one array per component, and the conversion from
+        //! TEME to ECI is computed once per call and applied across the arrays.
+        class Sgp4Catalog
+        {
+        public:
+            int32_t Add(const tlestruc &tle);
+            size_t Size() const { return tle.size(); }
+            void Clear();
+            int32_t Propagate(double utc, bool eci=true);
+
+            //! Two Line Elements, in the order added
+            vector<tlestruc> tle;
+            //! Position (m) and velocity (m/s) of each satellite from the last Propagate
+            vector<double> sx, sy, sz;
+            vector<double> vx, vy, vz;
+
+        private:
+            //! Elements and terms of each satellite. Terms that SGP4 drops for a low perigee are zero.
+            vector<double> epoch, ma, ap, raan, incl, bstar, eo;
+            vector<double> xmdot, omgdot, xnodot, xnodcf, c1, c4, c5, t2cof, omgcof, xmcof;
+            vector<double> eta, delmo, sinmo, d2, d3, d4, t3cof, t4cof, t5cof;
+            vector<double> aodp, xnodp, xlcof, aycof, cosio, sinio, x3thm1, x1mth2, x7thm1;
+            //! Working arrays, from one part of Propagate to the next
+            vector<double> a, xn, xnode, axn, ayn, capu, ecose, esine, sinepw, cosepw;
+        };
         //! @}
 	json11::Json make_swarm_information_object(const string& name, const string& desc, const vector<string>& node_names);
 	json11::Json make_sensor_information_object(const string& sensor_name, const double& fov, const double& ifov);
@@ -283,9 +283,382 @@ int32_t DataLog::CloseIfStrideTime()
     return COSMOS_GENERAL_ERROR_NOTREADY;
 }
 
+//! Construct LogStream
+//! \param node Node name.
+//! \param location Location, subfolder of node.
+//! \param agent Agent name, subfolder of location.
+//! \param type Type part of name.
+//! \param extra Extra part of name.
+//! \param capacity Size of ring buffer in bytes.
+LogStream::LogStream(string node, string location, string agent, string type, string extra, size_t capacity)
+    : node(node), location(location), agent(agent), type(type), extra(extra), ring(capacity)
+{
+    lastflush = lastwrite = currentmjd();
+}
+
+LogStream::~LogStream()
+{
+    Close();
+}
+
+//! \brief Write LogStream
+//! Queue a record, followed by a newline, for the file named for the provided UTC. If the name
+//! differs from that of the previous record, the previous file is written out and closed first.
+//! \param utc UTC to be converted to year (yyyy), julian day (jjj) and seconds (sssss).
+//! \param record String to be appended to file.
+//! \return Path of file the record will be written to.
+string LogStream::Write(double utc, const string& record)
+{
+    size_t size = record.size() + 1;
+
+    // Common case: same file and room in the ring
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        lastwrite = currentmjd();
+        if (utc == pathutc && !path.empty() && count + size <= ring.size())
+        {
+            Append(record.data(), record.size());
+            Append("\n", 1);
+            return path;
+        }
+    }
+
+    std::lock_guard<std::mutex> flock(fmtx);
+    std::lock_guard<std::mutex> lock(mtx);
+    if (utc != pathutc || path.empty())
+    {
+        string npath = data_type_path(node, location, agent, utc, type, extra);
+        pathutc = utc;
+        if (npath != path)
+        {
+            CloseLocked();
+            path = npath;
+        }
+    }
+    if (count + size > ring.size())
+    {
+        FlushLocked();
+    }
+    if (size > ring.size())
+    {
+        // Too large to buffer
+        if (OpenLocked() >= 0)
+        {
+            fprintf(fout, "%s\n", record.c_str());
+            fflush(fout);
+        }
+    }
+    else
+    {
+        Append(record.data(), record.size());
+        Append("\n", 1);
+    }
+    return path;
+}
+
+//! \brief Flush LogStream
+//! Write out everything queued so far. Writers may keep queuing while the file is written.
+//! \return Number of bytes written, or negative error.
+int32_t LogStream::Flush()
+{
+    std::lock_guard<std::mutex> flock(fmtx);
+    size_t start;
+    size_t size;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        lastflush = currentmjd();
+        if (!count)
+        {
+            return 0;
+        }
+        start = head;
+        size = count;
+    }
+
+    // Only this thread changes fout and the queued bytes while fmtx is held
+    int32_t iretn = WriteOut(start, size);
+
+    std::lock_guard<std::mutex> lock(mtx);
+    head = (start + size) % ring.size();
+    count -= size;
+    return iretn;
+}
+
+//! \brief Close LogStream
+//! Write out everything queued so far and close the file.
+//! \return Zero, or negative error.
+int32_t LogStream::Close()
+{
+    std::lock_guard<std::mutex> flock(fmtx);
+    std::lock_guard<std::mutex> lock(mtx);
+    return CloseLocked();
+}
+
+//! Path of current file
+string LogStream::Path()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return path;
+}
+
+//! Seconds since last write
+double LogStream::Age()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return 86400. * (currentmjd() - lastwrite);
+}
+
+//! Seconds since last flush
+double LogStream::FlushAge()
+{
+    std::lock_guard<std::mutex> lock(mtx);
+    return 86400. * (currentmjd() - lastflush);
+}
+
+//! Copy bytes into the ring, wrapping at the end. Caller holds mtx and has checked for room.
+void LogStream::Append(const char* data, size_t size)
+{
+    size_t tail = (head + count) % ring.size();
+    size_t first = std::min(size, ring.size() - tail);
+    memcpy(&ring[tail], data, first);
+    memcpy(&ring[0], data + first, size - first);
+    count += size;
+}
+
+//! Open the file at path, unless it is already open. A file that has been moved or removed
+//! since it was opened, such as by ::log_move_file in another process, is closed and the file
+//! at path opened, so that no records are written to it after it has been moved. Caller holds fmtx.
+int32_t LogStream::OpenLocked()
+{
+    if (fout != nullptr)
+    {
+        struct stat pst, fst;
+        if (stat(path.c_str(), &pst) == 0 && fstat(fileno(fout), &fst) == 0 && pst.st_ino == fst.st_ino && pst.st_dev == fst.st_dev)
+        {
+            return 0;
+        }
+        fclose(fout);
+    }
+    fout = data_open(path, const_cast<char *>("a+"));
+    if (fout == nullptr)
+    {
+        return GENERAL_ERROR_OPEN;
+    }
+    return 0;
+}
+
+//! Write bytes from the ring to the file, opening it if needed. Caller holds fmtx.
+int32_t LogStream::WriteOut(size_t start, size_t size)
+{
+    int32_t iretn = OpenLocked();
+    if (iretn < 0)
+    {
+        return iretn;
+    }
+    size_t first = std::min(size, ring.size() - start);
+    size_t written = fwrite(&ring[start], 1, first, fout);
+    if (size > first)
+    {
+        written += fwrite(&ring[0], 1, size - first, fout);
+    }
+    fflush(fout);
+    if (written != size)
+    {
+        return GENERAL_ERROR_BAD_SIZE;
+    }
+    return written;
+}
+
+//! Flush with fmtx and mtx held
+int32_t LogStream::FlushLocked()
+{
+    lastflush = currentmjd();
+    if (!count)
+    {
+        return 0;
+    }
+    int32_t iretn = WriteOut(head, count);
+    head = 0;
+    count = 0;
+    return iretn;
+}
+
+//! Close with fmtx and mtx held
+int32_t LogStream::CloseLocked()
+{
+    int32_t iretn = FlushLocked();
+    if (fout != nullptr)
+    {
+        fclose(fout);
+        fout = nullptr;
+    }
+    return iretn < 0 ? iretn : 0;
+}
+
+//! \ingroup datalib_statics
+//! @{
+
+//! Open ::LogStream for ::log_write, keyed by path components
+static map<string, std::shared_ptr<LogStream>> log_streams;
+static std::mutex log_streams_mutex;
+static std::condition_variable log_streams_wake;
+static std::thread log_streams_thread;
+static bool log_streams_shutdown = false;
+//! Ring buffer size for new streams. Zero writes straight through.
+static size_t log_streams_capacity = 65536;
+//! Seconds a record may wait in a ring before being written out
+static double log_streams_interval = 1.;
+//! Seconds without a write before a stream is closed
+static double log_streams_idle = 60.;
+
+//! @}
+
+//! Background flush of ::log_streams
+static void log_streams_loop()
+{
+    std::unique_lock<std::mutex> lock(log_streams_mutex);
+    while (!log_streams_shutdown)
+    {
+        log_streams_wake.wait_for(lock, std::chrono::milliseconds(static_cast<int64_t>(500. * log_streams_interval)));
+        vector<std::shared_ptr<LogStream>> streams;
+        vector<std::shared_ptr<LogStream>> idle;
+        for (auto it=log_streams.begin(); it!=log_streams.end(); )
+        {
+            if (it->second->Age() > log_streams_idle)
+            {
+                // Closed outside the lock, when no log_write is still using it
+                idle.push_back(std::move(it->second));
+                it = log_streams.erase(it);
+            }
+            else
+            {
+                streams.push_back(it->second);
+                ++it;
+            }
+        }
+        double interval = log_streams_interval;
+        lock.unlock();
+        for (std::shared_ptr<LogStream> &stream : streams)
+        {
+            if (stream->FlushAge() >= interval)
+            {
+                stream->Flush();
+            }
+        }
+        streams.clear();
+        idle.clear();
+        lock.lock();
+    }
+}
+
+//! Stop background flush and close every stream, at exit
+static struct log_streams_guard
+{
+    ~log_streams_guard()
+    {
+        {
+            std::lock_guard<std::mutex> lock(log_streams_mutex);
+            log_streams_shutdown = true;
+        }
+        log_streams_wake.notify_all();
+        if (log_streams_thread.joinable())
+        {
+            log_streams_thread.join();
+        }
+        log_streams.clear();
+    }
+} log_streams_exit;
+
+//! Find or open the ::LogStream for a set of path components
+//! \return Stream, or nullptr if buffering is off.
+static std::shared_ptr<LogStream> log_stream(string node, string location, string agent, string type, string extra)
+{
+    string key = node + "/" + location + "/" + agent + "/" + type + "/" + extra;
+    std::lock_guard<std::mutex> lock(log_streams_mutex);
+    if (!log_streams_capacity || log_streams_shutdown)
+    {
+        return nullptr;
+    }
+    auto it = log_streams.find(key);
+    if (it != log_streams.end())
+    {
+        return it->second;
+    }
+    if (!log_streams_thread.joinable())
+    {
+        log_streams_thread = std::thread(log_streams_loop);
+    }
+    std::shared_ptr<LogStream> stream(new LogStream(node, location, agent, type, extra, log_streams_capacity));
+    log_streams[key] = stream;
+    return stream;
+}
+
+//! Flush log streams
+/*! Write out everything ::log_write has queued. If a path is given, the stream writing to it
+ * is also closed, so the file can be moved.
+ * \param path Path of file to close, or empty for none.
+ * \return Zero, or negative error.
+ */
+int32_t log_flush(string path)
+{
+    vector<std::shared_ptr<LogStream>> streams;
+    {
+        std::lock_guard<std::mutex> lock(log_streams_mutex);
+        for (auto &entry : log_streams)
+        {
+            streams.push_back(entry.second);
+        }
+    }
+    int32_t iretn = 0;
+    for (std::shared_ptr<LogStream> &stream : streams)
+    {
+        int32_t tretn;
+        if (!path.empty() && stream->Path() == path)
+        {
+            tretn = stream->Close();
+        }
+        else
+        {
+            tretn = stream->Flush();
+        }
+        if (tretn < 0)
+        {
+            iretn = tretn;
+        }
+    }
+    return iretn;
+}
+
+//! Set log buffering
+/*! Set how ::log_write buffers records. Open streams are closed and reopened with the new settings
+ * on their next write.
+ * \param capacity Size of each stream's ring buffer in bytes. Zero opens, writes and closes the
+ * file for every record.
+ * \param interval Seconds a record may wait before being written out.
+ * \return Zero, or negative error.
+ */
+int32_t log_set_buffering(size_t capacity, double interval)
+{
+    if (interval <= 0.)
+    {
+        return GENERAL_ERROR_OUTOFRANGE;
+    }
+    map<string, std::shared_ptr<LogStream>> streams;
+    {
+        std::lock_guard<std::mutex> lock(log_streams_mutex);
+        log_streams_capacity = capacity;
+        log_streams_interval = interval;
+        streams.swap(log_streams);
+    }
+    log_streams_wake.notify_all();
+    return 0;
+}
+
 //! Write log entry - full
 /*! Append the provided string to a file in the {node}/{location}/{agent} directory. The file name
  * is created as {node}_yyyyjjjsssss_{extra}.{type}
+ * Records are queued in a ::LogStream that keeps the file open, and are written out within the
+ * interval set by ::log_set_buffering, or immediately with "immediate" location.
  * \param node Node name.
  * \param agent Agent name.
  * \param utc UTC to be converted to year (yyyy), julian day (jjj) and seconds (sssss).
@@ -302,6 +675,15 @@ string log_write(string node, string agent, double utc, string extra, string typ
     if (utc == 0.)
         return "";
 
+    if (location != "immediate")
+    {
+        std::shared_ptr<LogStream> stream = log_stream(node, location, agent, type, extra);
+        if (stream != nullptr)
+        {
+            return stream->Write(utc, record);
+        }
+    }
+
     //    if (extra.empty())
     //    {
     //        path = data_type_path(node, location, agent, utc, type);
@@ -379,6 +761,7 @@ int32_t log_move_file(string oldpath, string newpath, bool compress, double time
 {
     int32_t iretn = 0;
     ElapsedTime timer;
+    log_flush(oldpath);
     if (compress && oldpath.find(".gz") == string::npos)
     {
         // The compression is only for files, not directories
@@ -975,7 +1358,7 @@ string data_name(double mjd, string type, string node, string agent, string extr
  */
 int32_t data_name_date(string node, string filename, uint16_t &year, uint16_t &jday, uint32_t &seconds)
 {
-    if (sscanf(filename.substr(node.size()+1).c_str(), "%4" SCNu16 "%3" SCNu16 "%5" SCNu32 "", &year, &jday, &seconds) == 3 && seconds < 86400 && jday < 367)
+    if (filename.size() > node.size() + 1 && sscanf(filename.substr(node.size()+1).c_str(), "%4" SCNu16 "%3" SCNu16 "%5" SCNu32 "", &year, &jday, &seconds) == 3 && seconds < 86400 && jday < 367)
     {
         return 0;
     }
@@ -987,7 +1370,8 @@ int32_t data_name_date(string node, string filename, uint16_t &year, uint16_t &j
 
 //! Get date from file name.
 /*! Assuming the COSMOS standard filename format from ::data_name, extract
- * the date portion and return it as a Modified Julian Day.
+ * the date portion and return it as a Modified Julian Day. Both the current
+ * _{unix milliseconds}_{node} and the older {node}_yyyyjjjsssss forms are accepted.
  * \param node Name of Node.
  * \param filename Name of File.
  * \param utc Holder for returned utc.
@@ -999,6 +1383,15 @@ int32_t data_name_date(string node, string filename, double &utc)
     uint16_t jday;
     uint32_t seconds;
 
+    // Current format: _{unix milliseconds}_{node}...
+    uint64_t unix_ms;
+    int length = 0;
+    if (sscanf(filename.c_str(), "_%" SCNu64 "%n", &unix_ms, &length) == 1 && length > 1 && (filename[length] == '_' || filename[length] == '.'))
+    {
+        utc = unix2utc(unix_ms / 1000.);
+        return 0;
+    }
+
     int32_t iretn = data_name_date(node, filename, year, jday, seconds);
 
     if (!iretn)
@@ -2107,39 +2500,216 @@ int32_t data_move_file(string path, string location, bool compress)
              */
 int32_t data_load_archive(string node, string agent, double utcbegin, double utcend, string type, vector<string> &result)
 {
-    std::ifstream tfd;
-    string tstring;
-    vector <filestruc> files;
+    result.clear();
+    int32_t iretn = data_read_archive(node, agent, utcbegin, utcend, type, [&result](const string &record) -> int32_t
+    {
+        result.push_back(record);
+        return 0;
+    });
+    return iretn < 0 ? iretn : 0;
+}
 
+//! Stream data from archive
+/*! Pass each record of the specified type from the data archive for the specified Node and Agent
+ * to a callback, in time order, without holding more than one record in memory. Files are selected
+ * as for ::data_load_archive, and may be gzip compressed.
+ * \param node Name of Node.
+ * \param agent Name of Agent.
+ * \param utcbegin Starting UTC.
+ * \param utcend Ending UTC.
+ * \param type Type extension.
+ * \param callback Called with each record. A negative return stops reading and is returned.
+ * \return Number of records read, or negative error.
+ */
+int32_t data_read_archive(string node, string agent, double utcbegin, double utcend, string type, std::function<int32_t(const string&)> callback)
+{
+    DataArchiveReader reader;
+    int32_t iretn = reader.Open(node, agent, utcbegin, utcend, type);
+    if (iretn < 0)
+    {
+        return iretn;
+    }
 
-    result.clear();
+    int32_t count = 0;
+    string record;
+    while ((iretn = reader.Next(record)) > 0)
+    {
+        iretn = callback(record);
+        if (iretn < 0)
+        {
+            return iretn;
+        }
+        ++count;
+    }
+    return iretn < 0 ? iretn : count;
+}
+
+DataArchiveReader::~DataArchiveReader()
+{
+    Close();
+}
+
+//! \brief Open DataArchiveReader
+//! Prepare to read records from the archive, positioned at the first file covering the starting UTC.
+//! \param node Name of Node.
+//! \param agent Name of Agent.
+//! \param utcbegin Starting UTC.
+//! \param utcend Ending UTC.
+//! \param type Type extension, without any .gz.
+//! \return Zero, or negative error.
+int32_t DataArchiveReader::Open(string node, string agent, double utcbegin, double utcend, string type)
+{
+    Close();
+    if (utcend < utcbegin)
+    {
+        return GENERAL_ERROR_OUTOFRANGE;
+    }
+    this->node = node;
+    this->agent = agent;
+    this->type = type;
+    this->utcbegin = utcbegin;
+    this->utcend = utcend;
+    mjd = floor(utcbegin) - 1.;
+    files.clear();
+    fileidx = 0;
+    return 0;
+}
 
-    for (double mjd = floor(utcbegin); mjd <= floor(utcend); ++mjd)
+//! \brief Read next record
+//! \param record Holder for the record, without its newline.
+//! \return Size of the record plus one, zero at the end of the range, or negative error.
+int32_t DataArchiveReader::Next(string& record)
+{
+    char buffer[8192];
+    record.clear();
+    while (true)
     {
-        files = data_list_archive(node, agent, mjd, type);
-        for (size_t i=0; i<files.size(); ++i)
+        if (fin == nullptr)
         {
-            if (mjd == floor(utcbegin) && i < files.size()-2 && files[i+1].utc < utcbegin)
+            int32_t iretn = NextFile();
+            if (iretn <= 0)
             {
-                continue;
+                return iretn;
             }
-            else if (mjd == floor(utcend) && files[i].utc > utcend)
+        }
+
+        bool partial = false;
+        while (gzgets(fin, buffer, sizeof(buffer)) != nullptr)
+        {
+            size_t len = strlen(buffer);
+            if (len && buffer[len-1] == '\n')
             {
-                continue;
+                record.append(buffer, len-1);
+                return record.size() + 1;
             }
+            record.append(buffer, len);
+            partial = true;
+        }
+        gzclose(fin);
+        fin = nullptr;
+        if (partial)
+        {
+            // Last record in file had no newline
+            return record.size() + 1;
+        }
+    }
+}
 
-            tfd.open(files[i].path);
-            if (tfd.is_open())
+//! \brief Read a chunk of records
+//! \param records Holder for up to count records. Previous contents are replaced.
+//! \param count Maximum number of records to read.
+//! \return Number of records read, zero at the end of the range, or negative error.
+int32_t DataArchiveReader::Read(vector<string>& records, size_t count)
+{
+    records.resize(count);
+    size_t i = 0;
+    int32_t iretn = 0;
+    while (i < count && (iretn = Next(records[i])) > 0)
+    {
+        ++i;
+    }
+    records.resize(i);
+    if (iretn < 0 && !i)
+    {
+        return iretn;
+    }
+    return i;
+}
+
+//! \brief Close DataArchiveReader
+int32_t DataArchiveReader::Close()
+{
+    if (fin != nullptr)
+    {
+        gzclose(fin);
+        fin = nullptr;
+    }
+    path.clear();
+    return 0;
+}
+
+//! Open the next file in the range
+//! \return 1 if a file was opened, zero at the end of the range.
+int32_t DataArchiveReader::NextFile()
+{
+    while (true)
+    {
+        if (fileidx >= files.size())
+        {
+            // Move on to the next day that has any files
+            files.clear();
+            fileidx = 0;
+            while (files.empty())
             {
-                while (std::getline(tfd,tstring))
+                mjd += 1.;
+                if (mjd > floor(utcend))
+                {
+                    return 0;
+                }
+                string directory = data_archive_path(node, agent, mjd);
+                if (directory.empty() || !data_isdir(directory))
                 {
-                    result.push_back(tstring);
+                    continue;
+                }
+                for (filestruc file : data_list_files(directory))
+                {
+                    size_t tsize = type.size() + 1;
+                    if ((file.name.size() > tsize && file.name.compare(file.name.size() - tsize, tsize, "." + type) == 0) || (file.name.size() > tsize + 3 && file.name.compare(file.name.size() - tsize - 3, tsize + 3, "." + type + ".gz") == 0))
+                    {
+                        if (data_name_date(node, file.name, file.utc) == 0)
+                        {
+                            files.push_back(file);
+                        }
+                    }
+                }
+                std::sort(files.begin(), files.end(), [](const filestruc &a, const filestruc &b) { return a.utc < b.utc; });
+
+                // Skip files that end before the start of the range
+                if (mjd == floor(utcbegin))
+                {
+                    while (fileidx + 1 < files.size() && files[fileidx + 1].utc <= utcbegin)
+                    {
+                        ++fileidx;
+                    }
                 }
-                tfd.close();
             }
         }
+
+        const filestruc &file = files[fileidx++];
+        if (file.utc > utcend)
+        {
+            fileidx = files.size();
+            mjd = floor(utcend);
+            return 0;
+        }
+        fin = gzopen(file.path.c_str(), "rb");
+        if (fin != nullptr)
+        {
+            path = file.path;
+            fileutc = file.utc;
+            return 1;
+        }
     }
-    return 0;
 }
 
 int32_t data_load_archive(string node, string agent, double mjd, string type, vector<string> &result)
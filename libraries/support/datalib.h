@@ -124,6 +124,8 @@ typedef struct
 } filestruc;
 
 void log_reopen();
+int32_t log_flush(string path="");
+int32_t log_set_buffering(size_t capacity, double interval=1.);
 string log_write(string node, int type, double utc, const char* data);
 string log_write(string node, string agent, double utc, string type, const char *data);
 string log_write(string node, string agent, double utc, string extra, string type, string record, string location="temp");
@@ -197,6 +199,7 @@ string get_cosmosrealms(bool create_flag=false);
 string get_realmdir(string realm, bool create_flag=false);
 int32_t data_load_archive(string node, string agent, double utcbegin, double utcend, string type, vector<string> &result);
 int32_t data_load_archive(string node, string agent, double mjd, string type, vector<string> &result);
+int32_t data_read_archive(string node, string agent, double utcbegin, double utcend, string type, std::function<int32_t(const string&)> callback);
 int32_t data_move_file(filestruc file, string location="outgoing", bool compress=true);
 int32_t data_move_file(string path, string location="outgoing", bool compress="true");
 //int32_t data_load_archive(double mjd, vector<string> &telem, vector<string> &event, cosmosstruc* root);
@@ -238,6 +241,87 @@ private:
     FILE* fout;
 };
 
+//! Buffered log stream
+//! Keeps one ::log_write file open for a node/location/agent/type/extra combination, collecting
+//! records in a ring buffer that is written out when full, or by a background thread once it has
+//! been waiting longer than the flush interval. The file is closed and a new one opened whenever
+//! the path for the record's UTC changes, so files still roll on the interval boundaries chosen
+//! by the caller. If another process moves or removes the file while it is open, it is opened
+//! again at its path before the next write out.
+class LogStream
+{
+public:
+    LogStream(string node, string location, string agent, string type, string extra="", size_t capacity=65536);
+    ~LogStream();
+    string Write(double utc, const string& record);
+    int32_t Flush();
+    int32_t Close();
+    string Path();
+    double Age();
+    double FlushAge();
+
+    string node;
+    string location;
+    string agent;
+    string type;
+    string extra;
+
+private:
+    void Append(const char* data, size_t size);
+    int32_t OpenLocked();
+    int32_t WriteOut(size_t start, size_t size);
+    int32_t FlushLocked();
+    int32_t CloseLocked();
+
+    //! Serializes file access: flushing, rolling and closing
+    std::mutex fmtx;
+    //! Protects the ring and path. Always taken after fmtx.
+    std::mutex mtx;
+    FILE* fout = nullptr;
+    string path;
+    double pathutc = 0.;
+    vector<char> ring;
+    size_t head = 0;
+    size_t count = 0;
+    double lastflush = 0.;
+    double lastwrite = 0.;
+};
+
+//! Streaming archive reader
+//! Reads the records of one type, in time order, from the plain or gzip compressed files that
+//! ::log_write and ::log_move_file leave in {node}/data/{agent}/{yyyy}/{ddd}. Files are selected
+//! by the time in their names: reading starts with the file covering the starting UTC and stops
+//! after the last file starting before the ending UTC. Only one file is open at a time, so
+//! memory use does not grow with the length of the time range.
+class DataArchiveReader
+{
+public:
+    DataArchiveReader() {}
+    ~DataArchiveReader();
+    int32_t Open(string node, string agent, double utcbegin, double utcend, string type);
+    int32_t Next(string& record);
+    int32_t Read(vector<string>& records, size_t count);
+    int32_t Close();
+
+    //! Path of file currently being read
+    string path;
+    //! UTC from the name of file currently being read
+    double fileutc = 0.;
+
+private:
+    int32_t NextFile();
+
+    string node;
+    string agent;
+    string type;
+    double utcbegin = 0.;
+    double utcend = 0.;
+    double mjd = 0.;
+    vector<filestruc> files;
+    size_t fileidx = 0;
+    gzFile fin = nullptr;
+};
+
 //class NodeList
 //{
 //public:
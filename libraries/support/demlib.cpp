@@ -32,16 +32,20 @@
 #include "support/demlib.h"
 #include <mutex>
 #include <sys/stat.h>
+#if !defined(COSMOS_WIN_OS)
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace Cosmos {
     namespace Convert {
 
-        map_dem_body *bodies[20] = {NULL};
+        static std::atomic<map_dem_body *> bodies[MAX_DEM_BODIES];
         char bodynames[20][15] = {"mercury","venus","earth","mars","jupiter","saturn","uranus","neptune","pluto","moon","sun","near","","","","","","","",""};
-        static uint32_t maxalloc=300000000L, totalloc=0;
-        //static sem_t *bsem,tsem;
+        // Held only to open bodies and map DEMs, never to look them up
         static mutex bsem;
-        // running: 0 = uninitialized, 1 = ready, 2 = insufficient memory
+        // running: 0 = uninitialized, 1 = ready
         static int running = 0;
 
 
@@ -53,94 +57,187 @@ namespace Cosmos {
 */
         map_dem_body *planet_dem(int body)
         {
-            if (bodies[body-1] == NULL)
+            map_dem_body *tbody = bodies[body-1].load(std::memory_order_acquire);
+            if (tbody == nullptr)
             {
-                if ((bodies[body-1] = map_dem_open(body)) == NULL) { return nullptr; }
+                tbody = map_dem_open(body);
             }
-            return (bodies[body-1]);
+            return tbody;
         }
 
+        //! Initialize DEM engine
+        /*! DEMs are mapped into memory as they are needed, so there is nothing to size.
+    \return 0
+*/
         int map_dem_init()
         {
-            void *tptr;
+            running = 1;
+            return 0;
+        }
 
-            if (!running)
+        //! Map a DEM into memory
+        /*! Maps the file for a DEM, or reads it where it cannot be mapped, and publishes it
+ * for lookups. Called with ::bsem held.
+    \param body ::map_dem_body the DEM belongs to.
+    \param sdem ::map_dem_dem to load.
+    \return Pointer to its pixels, or nullptr if it could not be loaded.
+*/
+        static const dem_pixel *map_dem_load(map_dem_body *body, map_dem_dem *sdem)
+        {
+            const dem_pixel *pixel = sdem->pixel.load(std::memory_order_acquire);
+            if (pixel != nullptr || sdem->missing)
+            {
+                return pixel;
+            }
+
+            string fname;
+            if (get_cosmosresources(fname) < 0)
+            {
+                sdem->missing = true;
+                return nullptr;
+            }
+            fname += "/mapping/";
+            fname += body->name;
+            fname += "/";
+            fname += sdem->name;
+            size_t size = static_cast<size_t>(sdem->xcount) * sdem->ycount * sizeof(dem_pixel);
+
+#if !defined(COSMOS_WIN_OS)
+            int fd = open(fname.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                sdem->missing = true;
+                return nullptr;
+            }
+            struct stat st;
+            if (size && fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= size)
+            {
+                void *map = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+                if (map != MAP_FAILED)
+                {
+                    close(fd);
+                    sdem->size = size;
+                    sdem->mapped = true;
+                    sdem->utc = currentmjd(0.);
+                    pixel = static_cast<const dem_pixel *>(map);
+                    sdem->pixel.store(pixel, std::memory_order_release);
+                    return pixel;
+                }
+            }
+            close(fd);
+#endif
+
+            // Short files, and systems without mmap, are read into memory
+            FILE *fp = fopen(fname.c_str(), "rb");
+            if (fp == nullptr)
             {
-                //#ifdef COSMOS_MAC_OS
-                //		if ((bsem=sem_open("demcache",O_CREAT,O_RDWR,1)) != SEM_FAILED)
-                //#else
-                //		bsem = &tsem;
-                //		if ((sem_init(bsem,0,1)) != 0)
-                //#endif
-                //		{
-                //			return (DEM_ERROR_SEMINIT);
-                //		}
+                sdem->missing = true;
+                return nullptr;
+            }
+            dem_pixel *buffer = static_cast<dem_pixel *>(calloc(static_cast<size_t>(sdem->xcount) * sdem->ycount + 1, sizeof(dem_pixel)));
+            if (buffer == nullptr)
+            {
+                fclose(fp);
+                return nullptr;
             }
-            // Determine reasonable maxalloc, and whether we should run at all
-            for (maxalloc=1U<<31; maxalloc>1U<<27; maxalloc=maxalloc>>1)
+            // Whatever the file is short of is left flat
+            fread(buffer, 1, size, fp);
+            fclose(fp);
+            sdem->size = size;
+            sdem->mapped = false;
+            sdem->utc = currentmjd(0.);
+            sdem->pixel.store(buffer, std::memory_order_release);
+            return buffer;
+        }
+
+        //! Release the memory of a DEM
+        /*! Only to be used once nothing can be looking the DEM up.
+    \param sdem ::map_dem_dem to release.
+*/
+        static void map_dem_release(map_dem_dem *sdem)
+        {
+            const dem_pixel *pixel = sdem->pixel.exchange(nullptr);
+            if (pixel != nullptr)
             {
-                if ((tptr=malloc(maxalloc)) != NULL)
+#if !defined(COSMOS_WIN_OS)
+                if (sdem->mapped)
+                {
+                    munmap(const_cast<dem_pixel *>(pixel), sdem->size);
+                }
+                else
+#endif
                 {
-                    maxalloc = maxalloc>>4;
-                    running = 1;
-                    free(tptr);
-                    return 0;
+                    free(const_cast<dem_pixel *>(pixel));
                 }
             }
-            maxalloc = 0;
-            // running: 0 = uninitialized, 1 = ready, 2 = insufficient memory
-            running = 2;
-            return DEM_ERROR_INSUFFICIENT_MEMORY;
+            sdem->size = 0;
+            sdem->mapped = false;
+            sdem->utc = 0.;
         }
 
+        //! Limit resident DEMs
+        /*! Advise the operating system that all but the most recently mapped DEMs of a body
+ * are not needed. Their pages are dropped, and read back in if they are used again, so
+ * lookups in progress are not disturbed.
+    \param body Integer value of planetary body.
+    \param num Number of DEMs to leave alone, up to 10.
+*/
         void map_dem_cache(int body, int num)
         {
-            int indexl, count;
-            uint32_t i, dalloc;
-            double utcl;
-
             if (num > 10)
                 num = 10;
-            //	sem_wait(bsem);
-            bsem.lock();
-            if (bodies[body-1] == NULL)
+            map_dem_body *tbody = bodies[body-1].load(std::memory_order_acquire);
+            if (tbody == nullptr)
             {
-                //		sem_post(bsem);
-                bsem.unlock();
                 return;
             }
 
-            do
+            std::lock_guard<mutex> lock(bsem);
+            vector<map_dem_dem *> loaded;
+            for (uint16_t i=0; i<tbody->demcount; i++)
             {
-                count = 0;
-                utcl = currentmjd(0.);
-                indexl = -1;
-                for (i=0; i<bodies[body-1]->demcount; i++)
+                if (tbody->dems[i].pixel.load(std::memory_order_relaxed) != nullptr)
                 {
-                    if (bodies[body-1]->dems[i].pixel.size())
-                    {
-                        count++;
-                        if (bodies[body-1]->dems[i].utc <= utcl)
-                        {
-                            indexl = i;
-                            utcl = bodies[body-1]->dems[i].utc;
-                        }
-                    }
+                    loaded.push_back(&tbody->dems[i]);
                 }
-                if (count > num)
+            }
+            if (loaded.size() <= static_cast<size_t>(num))
+            {
+                return;
+            }
+            std::sort(loaded.begin(), loaded.end(), [](map_dem_dem *a, map_dem_dem *b) { return a->utc > b->utc; });
+#if !defined(COSMOS_WIN_OS)
+            for (size_t i=num; i<loaded.size(); i++)
+            {
+                if (loaded[i]->mapped)
                 {
-                    bodies[body-1]->dems[indexl].utc = 0.;
-                    bodies[body-1]->dems[indexl].pixel.clear();
-                    dalloc = bodies[body-1]->dems[indexl].ycount * (bodies[body-1]->dems[indexl].xcount*sizeof(dem_pixel) + sizeof(dem_pixel *));
-                    if (totalloc >= dalloc) {
-                        totalloc -= dalloc;
-                    } else {
-                        totalloc = 0;
-                    }
+                    madvise(const_cast<dem_pixel *>(loaded[i]->pixel.load(std::memory_order_relaxed)), loaded[i]->size, MADV_DONTNEED);
                 }
-            } while (count > num);
-            //	sem_post(bsem);
-            bsem.unlock();
+            }
+#endif
+        }
+
+        //! Close DEM for body
+        /*! Release every DEM of a body. Nothing may be looking up DEMs of the body while it closes.
+    \param body ::map_dem_body returned by ::map_dem_open.
+*/
+        void map_dem_close(map_dem_body *body)
+        {
+            if (body == nullptr)
+            {
+                return;
+            }
+            std::lock_guard<mutex> lock(bsem);
+            for (uint16_t i=0; i<MAX_DEM_BODIES; i++)
+            {
+                map_dem_body *tbody = body;
+                bodies[i].compare_exchange_strong(tbody, nullptr);
+            }
+            for (uint16_t i=0; i<body->demcount; i++)
+            {
+                map_dem_release(&body->dems[i]);
+            }
+            delete body;
         }
 
         map_dem_body *map_dem_open(int bodynum)
@@ -154,23 +251,13 @@ namespace Cosmos {
             int iretn, iretn1, ir, ic, irmin, irmax, icmin, icmax;
             uint16_t demtype, dc;
 
-            if (bodies[bodynum-1] != NULL)
-                return (bodies[bodynum-1]);
+            std::lock_guard<mutex> lock(bsem);
+            if (bodies[bodynum-1].load(std::memory_order_acquire) != nullptr)
+                return (bodies[bodynum-1].load(std::memory_order_acquire));
 
             if (!running)
             {
-                if ((iretn=map_dem_init()) < 0)
-                {
-                    errno = -iretn;
-                    return nullptr;
-                }
-            }
-
-            // running: 0 = uninitialized, 1 = ready, 2 = insufficient memory
-            if (running == 2)
-            {
-                errno = -DEM_ERROR_INSUFFICIENT_MEMORY;
-                return nullptr;
+                map_dem_init();
             }
 
             iretn = get_cosmosresources(tname);
@@ -187,9 +274,10 @@ namespace Cosmos {
                 errno = -iretn;
                 return nullptr;
             }
-            body = (map_dem_body *)calloc(1,sizeof(map_dem_body));
+            body = new (std::nothrow) map_dem_body();
             if (body == NULL)
             {
+                fclose(fp);
                 errno = -DEM_ERROR_INSUFFICIENT_MEMORY;
                 return nullptr;
             }
@@ -208,6 +296,7 @@ namespace Cosmos {
             iretn = get_cosmosresources(tname);
             if (iretn < 0)
             {
+                delete body;
                 errno = -iretn;
                 return nullptr;
             }
@@ -216,6 +305,7 @@ namespace Cosmos {
             tname += "/dems5.dat";
             if ((fp=fopen(tname.c_str(),"r"))==NULL)
             {
+                delete body;
                 errno = -DEM_ERROR_NOTFOUND;
                 return nullptr;
             }
@@ -224,7 +314,6 @@ namespace Cosmos {
             while ((iretn=fscanf(fp,"%s %lf %lf %u %u %lf %hu",body->dems[dc].name,&body->dems[dc].lonul,&body->dems[dc].latul,&body->dems[dc].xcount,&body->dems[dc].ycount,&body->dems[dc].psize,&demtype)) != EOF)
             {
                 body->dems[dc].psize = RADOF(body->dems[dc].psize);
-                body->dems[dc].pixel.clear();
                 switch (demtype)
                 {
                 case DEM_TYPE_SINGLE:
@@ -239,6 +328,8 @@ namespace Cosmos {
                     iretn = get_cosmosresources(tname);
                     if (iretn < 0)
                     {
+                        fclose(fp);
+                        delete body;
                         errno = -iretn;
                         return nullptr;
                     }
@@ -249,6 +340,8 @@ namespace Cosmos {
                     tname += "/dems5.dat";
                     if ((fp1=fopen(tname.c_str(),"r"))==NULL)
                     {
+                        fclose(fp);
+                        delete body;
                         errno = -DEM_ERROR_NOTFOUND;
                         return nullptr;
                     }
@@ -260,7 +353,6 @@ namespace Cosmos {
                     {
                         sprintf(body->dems[dc].name,"%s/%s",tname.c_str(),ttname);
                         body->dems[dc].psize = RADOF(body->dems[dc].psize);
-                        body->dems[dc].pixel.clear();
                         body->dems[dc].lonul = RADOF(body->dems[dc].lonul)-body->dems[dc].psize/2.;
                         body->dems[dc].lonlr = body->dems[dc].lonul + (body->dems[dc].xcount) * body->dems[dc].psize;
                         body->dems[dc].latul = RADOF(body->dems[dc].latul)+body->dems[dc].psize/2.;
@@ -309,7 +401,7 @@ namespace Cosmos {
             }
 
             body->demcount = dc;
-            bodies[bodynum-1] = body;
+            bodies[bodynum-1].store(body, std::memory_order_release);
             return (body);
         }
 
@@ -327,43 +419,19 @@ namespace Cosmos {
             return (pixel.alt);
         }
 
-        //! Height in DEM
-        /*! If the Lat:Lon is within one of the provided DEM's, return the
- * data for that pixel.
-    \param body Integer value of planetary body. See \ref convertlib_constants for values.
-    \param lon Longitude in readians.
+        //! Find DEM
+        /*! Search the DEM index of a body for the DEM covering a location at the best
+ * resolution required.
+    \param body ::map_dem_body to search.
+    \param lon Longitude in radians.
     \param lat Latitude in radians.
     \param res Best resolution required, in radians.
-    \return ::dem_pixel for that location.
+    \return ::map_dem_dem covering the location, or nullptr.
 */
-        dem_pixel map_dem_pixel(int body, double lon, double lat, double res)
+        static map_dem_dem *map_dem_find(map_dem_body *body, double lon, double lat, double res)
         {
-            dem_pixel pixel={0., {0., 0., 1.}};
-            double decrow, deccol, cutc;
-            int32_t erow, ecol, dci, cidx, cbdy;
-            uint32_t drow, dcol;
-            uint32_t i, j, dsize, m;
-            map_dem_dem *sdem;
-            FILE *fp;
-
-            // running: 0 = uninitialized, 1 = ready, 2 = insufficient memory
-            if (running == 2)
-                return (pixel);
-
-            if (bodies[body-1] == NULL)
-            {
-                if (map_dem_open(body) == NULL) return (pixel);
-            }
-
-            if (std::isnan(lat) || std::isnan(lon) || lat<-DPI2 || lat>DPI || lon<-DPI || lon>DPI)
-                return (pixel);
-
-            if (bodies[body-1] == NULL)
-                return (pixel);
-
-            sdem = NULL;
-
-            // First: Find which DEM we need
+            int32_t erow, ecol, dci;
+            uint32_t i, j;
 
             ecol = (int32_t)(400.*(lon + DPI)/D2PI);
             if (ecol < 0)
@@ -379,102 +447,74 @@ namespace Cosmos {
 
             dci = -1;
             // Search the appropriate demindex for a DEM that fits our needs.
-            for (i=0; i<bodies[body-1]->demindexc[erow][ecol]; i++)
+            for (i=0; i<body->demindexc[erow][ecol]; i++)
             {
-                j = bodies[body-1]->demindexi[erow][ecol][i];
-                if (lon >= bodies[body-1]->dems[j].lonul-1e-13 && lon <= bodies[body-1]->dems[j].lonlr+1e-13 && lat >=
-                    bodies[body-1]->dems[j].latlr-1e-13 && lat <= bodies[body-1]->dems[j].latul+1e-13)
+                j = body->demindexi[erow][ecol][i];
+                if (lon >= body->dems[j].lonul-1e-13 && lon <= body->dems[j].lonlr+1e-13 && lat >=
+                    body->dems[j].latlr-1e-13 && lat <= body->dems[j].latul+1e-13)
                 {
                     if (dci < 0)
                         dci = j;
-                    if (res/bodies[body-1]->dems[j].psize >= 2.)
+                    if (res/body->dems[j].psize >= 2.)
                         break;
                     dci = j;
                 }
             }
 
-            // Check whether the DEM is already loaded and load if necessary
-            //	sem_wait(bsem);
-            bsem.lock();
-            sdem = &bodies[body-1]->dems[dci];
-            //	if (sdem->pixel == NULL)
-            if (sdem->pixel.size() == 0)
-            {
-                dsize = sdem->ycount*(sizeof(dem_pixel *) + sdem->xcount*sizeof(dem_pixel));
-                while (totalloc + dsize > maxalloc)
-                {
-                    cbdy = cidx = -1;
-                    cutc = currentmjd(0.);
-                    for (m=0; m<MAX_DEM_BODIES; m++)
-                    {
-                        if (bodies[m])
-                        {
-                            for (i=0; i<bodies[m]->demcount; i++)
-                            {
-                                //						if (bodies[m]->dems[i].pixel)
-                                if (bodies[m]->dems[i].pixel.size())
-                                {
-                                    if (bodies[m]->dems[i].utc < cutc)
-                                    {
-                                        cidx = i;
-                                        cbdy = m;
-                                        cutc = bodies[m]->dems[i].utc;
-                                    }
-                                }
-                            }
-                            if (cidx >= 0)
-                            {
-                                bodies[cbdy]->dems[cidx].pixel.clear();
-                                totalloc -= bodies[cbdy]->dems[cidx].ycount*(sizeof(dem_pixel *) + bodies[cbdy]->dems[cidx].xcount*sizeof(dem_pixel));
-                                bodies[cbdy]->dems[cidx].utc = 0.;
-                                if (totalloc + dsize <= maxalloc)
-                                    break;
-                            }
-                        }
-                    }
-                }
-                string fname;
-                int32_t iretn = get_cosmosresources(fname);
-                if (iretn < 0)
-                {
-                    errno = -iretn;
-                    return pixel;
-                }
-                fname += "/mapping/";
-                fname += bodies[body-1]->name;
-                fname += "/";
-                fname += sdem->name;
-                fp = fopen(fname.c_str(),"rb");
-                sdem->pixel.resize(sdem->ycount);
-                if (sdem->pixel.size() != sdem->ycount)
-                {
-                    maxalloc = (uint32_t)(.9 * maxalloc);
-                    return (pixel);
-                }
-                for (i=0; i<sdem->ycount; i++)
-                {
-                    sdem->pixel[i].resize(sdem->xcount);
-                    if (sdem->pixel[i].size() != sdem->xcount)
-                    {
-                        sdem->pixel.clear();
-                        maxalloc = (uint32_t)(.9 * maxalloc);
-                        return (pixel);
-                    }
-                    size_t count = fread(sdem->pixel[i].data(),sizeof(dem_pixel),sdem->xcount,fp);
-                    if (!count)
-                    {
-                        break;
-                    }
-                }
-                sdem->utc = currentmjd(0.);
-                totalloc += dsize;
-                if (maxalloc < totalloc + 2 * dsize)
-                {
-                    maxalloc += 2 * dsize;
+            if (dci < 0)
+                return nullptr;
+            return &body->dems[dci];
+        }
 
-                }
-                fclose(fp);
+        //! Pixels of DEM
+        /*! Returns the pixels of a DEM, mapping it first if need be. Once it is mapped, no
+ * lock is taken.
+    \param body ::map_dem_body the DEM belongs to.
+    \param sdem ::map_dem_dem to look up.
+    \return Pointer to its pixels, or nullptr if it could not be loaded.
+*/
+        static inline const dem_pixel *map_dem_pixels(map_dem_body *body, map_dem_dem *sdem)
+        {
+            const dem_pixel *pixel = sdem->pixel.load(std::memory_order_acquire);
+            if (pixel == nullptr)
+            {
+                std::lock_guard<mutex> lock(bsem);
+                pixel = map_dem_load(body, sdem);
             }
+            return pixel;
+        }
+
+        //! Height in DEM
+        /*! If the Lat:Lon is within one of the provided DEM's, return the
+ * data for that pixel.
+    \param body Integer value of planetary body. See \ref convertlib_constants for values.
+    \param lon Longitude in readians.
+    \param lat Latitude in radians.
+    \param res Best resolution required, in radians.
+    \return ::dem_pixel for that location.
+*/
+        dem_pixel map_dem_pixel(int body, double lon, double lat, double res)
+        {
+            dem_pixel pixel={0., {0., 0., 1.}};
+            double decrow, deccol;
+            uint32_t drow, dcol;
+            map_dem_dem *sdem;
+            map_dem_body *tbody;
+
+            if ((tbody = planet_dem(body)) == nullptr)
+                return (pixel);
+
+            if (std::isnan(lat) || std::isnan(lon) || lat<-DPI2 || lat>DPI || lon<-DPI || lon>DPI)
+                return (pixel);
+
+            // First: Find which DEM we need
+            if ((sdem = map_dem_find(tbody, lon, lat, res)) == nullptr)
+                return (pixel);
+
+            // Check whether the DEM is already mapped and map if necessary
+            const dem_pixel *pixels = map_dem_pixels(tbody, sdem);
+            if (pixels == nullptr)
+                return (pixel);
 
             decrow = ((sdem->latul - lat) /sdem->psize) - .5;
             if (decrow < 0.)
@@ -491,15 +531,91 @@ namespace Cosmos {
             if (dcol >= sdem->xcount)
                 dcol = sdem->xcount - 1;
 
-            pixel = sdem->pixel[drow][dcol];
-            //	sem_post(bsem);
-            bsem.unlock();
-            pixel.alt = (float)(pixel.alt * bodies[body-1]->vscale);
-            pixel.nmap[2] = (float)(pixel.nmap[2] * bodies[body-1]->htov);
+            pixel = pixels[static_cast<size_t>(drow) * sdem->xcount + dcol];
+            pixel.alt = (float)(pixel.alt * tbody->vscale);
+            pixel.nmap[2] = (float)(pixel.nmap[2] * tbody->htov);
 
             return (pixel);
         }
 
+        //! Interpolate DEM
+        /*! Sample a DEM at many locations at once. Each location is found in the DEM that
+ * ::map_dem_pixel would use, and its altitude and normal are interpolated bilinearly
+ * between the centers of the four pixels around it. Locations outside every DEM, or in
+ * one that cannot be loaded, get a flat pixel. No lock is taken once the DEMs involved
+ * are mapped, so any number of threads may sample at once.
+    \param body Integer value of planetary body. See \ref convertlib_constants for values.
+    \param lon Array of longitudes in radians.
+    \param lat Array of latitudes in radians.
+    \param count Number of locations.
+    \param res Best resolution required, in radians.
+    \param pixels Array of count ::dem_pixel to fill.
+    \return Number of locations found in a DEM, otherwise negative error.
+*/
+        int32_t map_dem_sample(int body, const double *lon, const double *lat, size_t count, double res, dem_pixel *pixels)
+        {
+            const dem_pixel flat={0., {0., 0., 1.}};
+            map_dem_body *tbody;
+            map_dem_dem *sdem = nullptr;
+            const dem_pixel *spixels = nullptr;
+            int32_t found = 0;
+
+            if (body < 1 || body > MAX_DEM_BODIES)
+                return (MAP_DEM_ERROR_BODY);
+
+            if ((tbody = planet_dem(body)) == nullptr)
+                return (DEM_ERROR_NOTFOUND);
+
+            for (size_t i=0; i<count; ++i)
+            {
+                pixels[i] = flat;
+                if (std::isnan(lat[i]) || std::isnan(lon[i]) || lat[i]<-DPI2 || lat[i]>DPI || lon[i]<-DPI || lon[i]>DPI)
+                    continue;
+
+                // Neighbouring locations are usually in the same DEM
+                map_dem_dem *tdem = map_dem_find(tbody, lon[i], lat[i], res);
+                if (tdem == nullptr)
+                    continue;
+                if (tdem != sdem)
+                {
+                    sdem = tdem;
+                    spixels = map_dem_pixels(tbody, sdem);
+                }
+                if (spixels == nullptr)
+                    continue;
+
+                // Position relative to the pixel centers, held at the edges
+                double x = (lon[i] - sdem->lonul) / sdem->psize - .5;
+                double y = (sdem->latul - lat[i]) / sdem->psize - .5;
+                x = std::min(std::max(x, 0.), sdem->xcount - 1.);
+                y = std::min(std::max(y, 0.), sdem->ycount - 1.);
+                uint32_t c0 = static_cast<uint32_t>(x);
+                uint32_t r0 = static_cast<uint32_t>(y);
+                uint32_t c1 = std::min(c0 + 1, sdem->xcount - 1);
+                uint32_t r1 = std::min(r0 + 1, sdem->ycount - 1);
+                float fx = static_cast<float>(x - c0);
+                float fy = static_cast<float>(y - r0);
+
+                const dem_pixel &p00 = spixels[static_cast<size_t>(r0) * sdem->xcount + c0];
+                const dem_pixel &p01 = spixels[static_cast<size_t>(r0) * sdem->xcount + c1];
+                const dem_pixel &p10 = spixels[static_cast<size_t>(r1) * sdem->xcount + c0];
+                const dem_pixel &p11 = spixels[static_cast<size_t>(r1) * sdem->xcount + c1];
+                float w00 = (1.f - fx) * (1.f - fy);
+                float w01 = fx * (1.f - fy);
+                float w10 = (1.f - fx) * fy;
+                float w11 = fx * fy;
+                pixels[i].alt = (float)((w00 * p00.alt + w01 * p01.alt + w10 * p10.alt + w11 * p11.alt) * tbody->vscale);
+                for (uint16_t k=0; k<3; ++k)
+                {
+                    pixels[i].nmap[k] = w00 * p00.nmap[k] + w01 * p01.nmap[k] + w10 * p10.nmap[k] + w11 * p11.nmap[k];
+                }
+                pixels[i].nmap[2] = (float)(pixels[i].nmap[2] * tbody->htov);
+                ++found;
+            }
+
+            return found;
+        }
+
         int map_dem_tilt(int body, double lon, double lat, double scalekm, dem_pixel *pixel)
         {
             double tiltrho;
@@ -507,9 +623,13 @@ namespace Cosmos {
             if (lat<-DPI2 || lat>DPI || lon<-DPI || lon>DPI || scalekm <=0. || scalekm >1000.)
                 return (-1);
 
-            tiltrho = scalekm/bodies[body-1]->radius;
+            map_dem_body *tbody = planet_dem(body);
+            if (tbody == nullptr)
+                return (-1);
+
+            tiltrho = scalekm/tbody->radius;
             *pixel = Convert::map_dem_pixel(body,lon,lat,tiltrho);
-            bodies[body-1]->htov = (bodies[body-1]->hscale/bodies[body-1]->vscale);
+            tbody->htov = (tbody->hscale/tbody->vscale);
             return 0;
         }
     }
@@ -43,13 +43,15 @@
 //!
 //! DEMs are stored as floating point numbers in groups of 4; representing altitude in meters, and a
 //! Normal (NMAP) in x, y, and z. DEMs for each planetary body are stored at different resolutions, allowing
-//! for a minimum of overhead. Only the DEMs required for the desired location and resolution are loaded.
-//! Memory use is limited by recycling the oldest accessed DEMs and reclaiming their memory.
+//! for a minimum of overhead. Only the DEMs required for the desired location and resolution are mapped
+//! into memory, and the operating system decides which of their pages stay resident. Once a DEM is
+//! mapped, looking up a pixel takes no locks.
 //!
 //! General usage involves first first opening the DEM system for a given body through ::map_dem_open. This
 //! This will return a handle that can be used for all subsequent DEM calls for that body. See \ref demlib_planets
 //! for the constants for the various planets. Once a planetary body is open calls to ::map_dem_pixel will return
-//! the DEM value for the requested Latitude and Longitude, at the requested resolution.
+//! the DEM value for the requested Latitude and Longitude, at the requested resolution. ::map_dem_sample
+//! interpolates the DEM at many locations at once.
 
 #ifndef MAP_DEM_H
 #define MAP_DEM_H
@@ -57,6 +59,7 @@
 #include "support/configCosmos.h"
 #include "support/timelib.h"
 #include "support/datalib.h"
+#include <atomic>
 
 namespace Cosmos {
     namespace Convert {
@@ -91,7 +94,8 @@ namespace Cosmos {
         } dem_pixel;
 
         //! DEM support structure
-        /*! Internal structure for storing the various DEMs that are read in.
+        /*! Internal structure for storing the various DEMs that are read in. Once mapped, pixel
+  points at ycount rows of xcount ::dem_pixel.
   */
         typedef struct
         {
@@ -107,7 +111,10 @@ namespace Cosmos {
             uint32_t ycount;
             double dlon;
             double dlat;
-            vector< vector<dem_pixel> > pixel;
+            std::atomic<const dem_pixel *> pixel;
+            size_t size;
+            bool mapped;
+            bool missing;
         } map_dem_dem;
 
         //! Planetary body support structure
@@ -144,8 +151,8 @@ namespace Cosmos {
         void map_dem_scale(map_dem_body *body, double vscale, double hscale);
         int map_dem_tilt(int body, double lon, double lat, double scale, dem_pixel *pixel);
         dem_pixel map_dem_pixel(int body, double lon, double lat, double res);
-        dem_pixel map_dem_pixel(int body,double lon, double lat, double res);
         double map_dem_alt(int body, double lon, double lat, double res);
+        int32_t map_dem_sample(int body, const double *lon, const double *lat, size_t count, double res, dem_pixel *pixels);
         int map_dem_init();
         //! @}
     }
@@ -32,21 +32,353 @@
 */
 
 #include <mutex>
+#include <atomic>
+#include <algorithm>
 #include "support/ephemlib.h"
 #include "support/jpleph.h"
 #include "support/datalib.h"
 #include "support/timelib.h"
+#if !defined(COSMOS_WIN_OS)
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+//! Most Chebyshev coefficients per component in any record
+#define JPL_MAX_COEFFICIENTS 32
 
 namespace Cosmos {
     namespace Convert {
 
-        static void *jplephem = nullptr;
+        static JplEphemeris jplephem;
 
         static mutex eph_mutex;
 
+        static std::atomic<uint32_t> jpl_generations(0);
+
         //! \addtogroup ephemlib_functions
         //! @{
 
+        JplEphemeris::~JplEphemeris()
+        {
+            Close();
+        }
+
+        //! Open JPL Ephemeris
+        /*! Read the header of a binary JPL Ephemeris and map the rest of the file into memory.
+            \param filename Path of ephemeris file.
+            \return 0, otherwise negative error.
+        */
+        int32_t JplEphemeris::Open(string filename)
+        {
+            Close();
+
+            // Let jpleph make sense of the header
+            jpl_eph_data *eph = static_cast<jpl_eph_data *>(jpl_init_ephemeris(filename.c_str(), nullptr, nullptr));
+            if (eph == nullptr)
+            {
+                return -errno;
+            }
+            start = eph->ephem_start;
+            end = eph->ephem_end;
+            step = eph->ephem_step;
+            emrat = eph->emrat;
+            memcpy(ipt, eph->ipt, sizeof(ipt));
+            recsize = eph->recsize;
+            ncoeff = eph->ncoeff;
+            swap_bytes = eph->swap_bytes != 0;
+            jpl_close_ephemeris(eph);
+            for (uint16_t i=0; i<13; ++i)
+            {
+                if (ipt[i][1] > JPL_MAX_COEFFICIENTS)
+                {
+                    return JPLEPHEM_ERROR_OUTOFRANGE;
+                }
+            }
+
+#if !defined(COSMOS_WIN_OS)
+            int fd = open(filename.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                return -errno;
+            }
+            struct stat st;
+            if (fstat(fd, &st) < 0)
+            {
+                int32_t iretn = -errno;
+                close(fd);
+                return iretn;
+            }
+            void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+            close(fd);
+            if (map == MAP_FAILED)
+            {
+                return -errno;
+            }
+            data = static_cast<const char *>(map);
+            size = st.st_size;
+#else
+            FILE *fp = fopen(filename.c_str(), "rb");
+            if (fp == nullptr)
+            {
+                return -errno;
+            }
+            fseek(fp, 0, SEEK_END);
+            size = ftell(fp);
+            fseek(fp, 0, SEEK_SET);
+            buffer.resize(size / sizeof(double) + 1);
+            size = fread(buffer.data(), 1, size, fp);
+            fclose(fp);
+            data = reinterpret_cast<const char *>(buffer.data());
+#endif
+            generation = ++jpl_generations;
+            return 0;
+        }
+
+        //! Close JPL Ephemeris
+        void JplEphemeris::Close()
+        {
+#if !defined(COSMOS_WIN_OS)
+            if (data != nullptr)
+            {
+                munmap(const_cast<char *>(data), size);
+            }
+#endif
+            buffer.clear();
+            data = nullptr;
+            size = 0;
+            generation = 0;
+        }
+
+        bool JplEphemeris::IsOpen() const
+        {
+            return data != nullptr;
+        }
+
+        // Record covering the requested time, and the fraction of the record at that time. The
+        // last record used is kept by each thread.
+        const double *JplEphemeris::Record(double jd, double &t) const
+        {
+            if (!(jd >= start && jd <= end))
+            {
+                return nullptr;
+            }
+
+            // Find the record as jpl_state() does
+            double s = jd - .5;
+            double midnight = floor(s);
+            double fraction = s - midnight;
+            midnight += .5;
+            long nr = static_cast<long>((midnight - start) / step) + 2;
+            if (midnight == end)
+            {
+                --nr;
+            }
+            t = (midnight - ((1. * nr - 2.) * step + start) + fraction) / step;
+
+            struct recordcache
+            {
+                uint32_t generation = 0;
+                long record = -1;
+                const double *coef = nullptr;
+                vector<double> copy;
+            };
+            static thread_local recordcache cache;
+            if (cache.generation != generation || cache.record != nr)
+            {
+                size_t offset = static_cast<size_t>(nr) * recsize;
+                if (offset + ncoeff * sizeof(double) > size)
+                {
+                    return nullptr;
+                }
+                if (swap_bytes || offset % sizeof(double))
+                {
+                    cache.copy.resize(ncoeff);
+                    memcpy(cache.copy.data(), data + offset, ncoeff * sizeof(double));
+                    if (swap_bytes)
+                    {
+                        for (double &value : cache.copy)
+                        {
+                            char *bytes = reinterpret_cast<char *>(&value);
+                            std::reverse(bytes, bytes + sizeof(double));
+                        }
+                    }
+                    cache.coef = cache.copy.data();
+                }
+                else
+                {
+                    cache.coef = reinterpret_cast<const double *>(data + offset);
+                }
+                cache.generation = generation;
+                cache.record = nr;
+            }
+            return cache.coef;
+        }
+
+        // Position, velocity and acceleration of one ephemeris entry, summed as in interp() of jpleph
+        void JplEphemeris::Interpolate(const double *record, double t, int32_t index, int32_t ncm, double state[9]) const
+        {
+            const double *coef = &record[ipt[index][0] - 1];
+            int32_t ncf = ipt[index][1];
+            int32_t na = ipt[index][2];
+
+            // Sub-interval, and Chebyshev time within it
+            double dna = static_cast<double>(na);
+            double dt1, temp1;
+            modf(t, &dt1);
+            double temp = dna * t;
+            int32_t l = static_cast<int32_t>(temp - dt1);
+            double tc = 2. * (modf(temp, &temp1) + dt1) - 1.;
+
+            // Chebyshev polynomials and their first and second derivatives
+            double pc[JPL_MAX_COEFFICIENTS], vc[JPL_MAX_COEFFICIENTS], ac[JPL_MAX_COEFFICIENTS];
+            double twot = tc + tc;
+            pc[0] = 1.;
+            pc[1] = tc;
+            vc[0] = 0.;
+            vc[1] = 1.;
+            ac[0] = 0.;
+            ac[1] = 0.;
+            for (int32_t j=2; j<ncf; ++j)
+            {
+                pc[j] = twot * pc[j-1] - pc[j-2];
+                vc[j] = twot * vc[j-1] + pc[j-1] + pc[j-1] - vc[j-2];
+                ac[j] = twot * ac[j-1] + 4. * vc[j-1] - ac[j-2];
+            }
+
+            // Positions in km, rates per second
+            double vfac = (dna + dna) / (step * 86400.);
+            for (int32_t i=0; i<ncm; ++i)
+            {
+                const double *c = coef + ncf * (i + l * ncm);
+                double p = 0., v = 0., a = 0.;
+                for (int32_t j=ncf-1; j>=0; --j)
+                {
+                    p += pc[j] * c[j];
+                    v += vc[j] * c[j];
+                    a += ac[j] * c[j];
+                }
+                state[i] = p;
+                state[i + ncm] = v * vfac;
+                state[i + 2 * ncm] = a * vfac * vfac;
+            }
+        }
+
+        //! State from JPL Ephemeris
+        /*! Position, velocity and acceleration of one body with respect to another, following
+         * the conventions of jpl_pleph(), including Nutations (14) and Librations (15).
+            \param jd Julian day.
+            \param target Body, numbered as for jpl_pleph().
+            \param center Body the state is relative to.
+            \param state Position, velocity and acceleration. For Nutations, the two angles, then
+            their rates, then their accelerations.
+            \return 0, otherwise negative error.
+        */
+        int32_t JplEphemeris::State(double jd, int32_t target, int32_t center, double state[9]) const
+        {
+            for (uint16_t i=0; i<9; ++i)
+            {
+                state[i] = 0.;
+            }
+            if (target == center)
+            {
+                return 0;
+            }
+
+            double t;
+            const double *record = Record(jd, t);
+            if (record == nullptr)
+            {
+                return JPLEPHEM_ERROR_OUTOFRANGE;
+            }
+
+            if (target == JPL_NUTATIONS)
+            {
+                if (ipt[11][1] <= 0)
+                {
+                    return JPLEPHEM_ERROR_NUTATIONS;
+                }
+                Interpolate(record, t, 11, 2, state);
+                return 0;
+            }
+            if (target == JPL_LIBRATIONS)
+            {
+                if (ipt[12][1] <= 0)
+                {
+                    return JPLEPHEM_ERROR_LIBRATIONS;
+                }
+                Interpolate(record, t, 12, 3, state);
+                return 0;
+            }
+            if (target < 1 || target > 13 || center < 1 || center > 13)
+            {
+                return JPLEPHEM_ERROR_OUTOFRANGE;
+            }
+
+            // Barycentric states, combined as in jpl_pleph()
+            double emb[9], moon[9];
+            bool earthmoon = target == JPL_EARTH || target == JPL_MOON || center == JPL_EARTH || center == JPL_MOON;
+            if (earthmoon)
+            {
+                Interpolate(record, t, 2, 3, emb);
+                Interpolate(record, t, 9, 3, moon);
+            }
+            auto body = [&](int32_t number, double pv[9])
+            {
+                switch (number)
+                {
+                case JPL_EARTH:
+                    for (uint16_t i=0; i<9; ++i)
+                    {
+                        pv[i] = emb[i] - moon[i] / (1. + emrat);
+                    }
+                    break;
+                case JPL_MOON:
+                    for (uint16_t i=0; i<9; ++i)
+                    {
+                        pv[i] = moon[i] + (emb[i] - moon[i] / (1. + emrat));
+                    }
+                    break;
+                case JPL_SUN:
+                    Interpolate(record, t, 10, 3, pv);
+                    break;
+                case JPL_SUN_BARY:
+                    for (uint16_t i=0; i<9; ++i)
+                    {
+                        pv[i] = 0.;
+                    }
+                    break;
+                case JPL_EARTH_BARY:
+                    Interpolate(record, t, 2, 3, pv);
+                    break;
+                default:
+                    Interpolate(record, t, number - 1, 3, pv);
+                    break;
+                }
+            };
+
+            double to[9], from[9];
+            if (target * center == 30 && target + center == 13)
+            {
+                // Moon from Earth, or Earth from Moon
+                for (uint16_t i=0; i<9; ++i)
+                {
+                    to[i] = target == JPL_MOON ? moon[i] : 0.;
+                    from[i] = center == JPL_MOON ? moon[i] : 0.;
+                }
+            }
+            else
+            {
+                body(target, to);
+                body(center, from);
+            }
+            for (uint16_t i=0; i<9; ++i)
+            {
+                state[i] = to[i] - from[i];
+            }
+            return 0;
+        }
+
         //! Librations from JPL Ephemeris
         /*! Position and Velocity values for Lunar Libration from the JPL Ephemeris
         \param utc Modified julian day of position
@@ -61,7 +393,7 @@ namespace Cosmos {
 
         int32_t jpllib(double utc,rmatrix &rm, rmatrix &drm)
         {
-            double pvec[6];
+            double pvec[9];
             int32_t iretn = 0;
 
             iretn = jplopen();
@@ -70,9 +402,7 @@ namespace Cosmos {
                 return iretn;
             }
 
-            eph_mutex.lock();
-            iretn = jpl_pleph(jplephem,utc + JD_MJD_OFFSET,15,0,pvec,1);
-            eph_mutex.unlock();
+            iretn = jplephem.State(utc + JD_MJD_OFFSET, JPL_LIBRATIONS, 0, pvec);
             if (iretn < 0)
             {
                 return iretn;
@@ -92,7 +422,7 @@ namespace Cosmos {
 */
         int32_t jplnut(double utc, double nuts[])
         {
-            double pvec[6];
+            double pvec[9];
 
             if (!std::isfinite(utc))
             {
@@ -105,9 +435,7 @@ namespace Cosmos {
                 return iretn;
             }
 
-            eph_mutex.lock();
-            iretn = jpl_pleph(jplephem,utc + JD_MJD_OFFSET,static_cast<int>(JPL_NUTATIONS),0,pvec,1);
-            eph_mutex.unlock();
+            iretn = jplephem.State(utc + JD_MJD_OFFSET, JPL_NUTATIONS, 0, pvec);
             if (iretn < 0)
             {
                 return iretn;
@@ -135,7 +463,7 @@ namespace Cosmos {
 
         int32_t jplpos(long from, long to, double utc, Convert::cartpos &pos)
         {
-            static double pvec[3][6];
+            double pvec[9];
 
             pos.s = pos.v = pos.a = rv_zero();
 
@@ -145,48 +473,57 @@ namespace Cosmos {
                 return iretn;
             }
 
-            eph_mutex.lock();
-            iretn = jpl_pleph(jplephem,utc + JD_MJD_OFFSET - .05/86400., static_cast<int>(to), static_cast<int>(from) ,pvec[0],1);
-            eph_mutex.unlock();
+            iretn = jplephem.State(utc + JD_MJD_OFFSET, static_cast<int32_t>(to), static_cast<int32_t>(from), pvec);
             if (iretn < 0)
             {
                 return iretn;
             }
 
-            eph_mutex.lock();
-            iretn = jpl_pleph(jplephem,utc + JD_MJD_OFFSET, static_cast<int>(to), static_cast<int>(from) ,pvec[1],1);
-            eph_mutex.unlock();
-            if (iretn < 0)
+            for (uint16_t i=0; i<3; ++i)
             {
-                return iretn;
+                pos.s.col[i] = pvec[i] * 1000.;
+                pos.v.col[i] = pvec[i + 3] * 1000.;
+                pos.a.col[i] = pvec[i + 6] * 1000.;
             }
+            pos.utc = utc;
 
-            eph_mutex.lock();
-            iretn = jpl_pleph(jplephem,utc + JD_MJD_OFFSET + .05/86400., static_cast<int>(to), static_cast<int>(from) ,pvec[2],1);
-            eph_mutex.unlock();
-            if (iretn < 0)
+            return 0;
+        }
+
+        //! Positions from JPL Ephemeris
+        /*! Position, velocity and acceleration vectors from one solar system object to another
+         * in J2000 coordinates, at each of a list of times.
+        \param from Starting object for vectors.
+        \param to Ending object for vectors.
+        \param utcs Modified julian days of positions.
+        \param pos Storage for returned vectors, one for each time.
+        \return 0, otherwise negative error.
+*/
+        int32_t jplpos(long from, long to, const vector<double> &utcs, vector<Convert::cartpos> &pos)
+        {
+            pos.resize(utcs.size());
+            for (size_t i=0; i<utcs.size(); ++i)
             {
-                return iretn;
+                int32_t iretn = jplpos(from, to, utcs[i], pos[i]);
+                if (iretn < 0)
+                {
+                    return iretn;
+                }
             }
-
-            pos.s.col[0] = pvec[1][0] * 1000.;
-            pos.s.col[1] = pvec[1][1] * 1000.;
-            pos.s.col[2] = pvec[1][2] * 1000.;
-            pos.v.col[0] = pvec[1][3] * 1000.;
-            pos.v.col[1] = pvec[1][4] * 1000.;
-            pos.v.col[2] = pvec[1][5] * 1000.;
-            pos.a.col[0] = (pvec[2][3] - pvec[0][3]) * 10000.;
-            pos.a.col[1] = (pvec[2][4] - pvec[0][4]) * 10000.;
-            pos.a.col[2] = (pvec[2][5] - pvec[0][5]) * 10000.;
-            pos.utc = utc;
-
             return 0;
         }
 
         int32_t jplopen()
         {
-            if (jplephem == nullptr)
+            static std::atomic<bool> opened(false);
+
+            if (!opened.load(std::memory_order_acquire))
             {
+                std::lock_guard<mutex> lock(eph_mutex);
+                if (opened.load(std::memory_order_relaxed))
+                {
+                    return 0;
+                }
                 string fname;
                 int32_t iretn = get_cosmosresources(fname);
                 if (iretn < 0)
@@ -194,11 +531,12 @@ namespace Cosmos {
                     return iretn;
                 }
                 fname +=  "/general/lnx1900.405";
-                jplephem = jpl_init_ephemeris(fname.c_str(),nullptr,nullptr);
-                if (jplephem == nullptr)
+                iretn = jplephem.Open(fname);
+                if (iretn < 0)
                 {
-                    return -errno;
+                    return iretn;
                 }
+                opened.store(true, std::memory_order_release);
             }
             return 0;
         }
@@ -30,8 +30,6 @@
 #ifndef EPHEMLIB_H
 #define EPHEMLIB_H
 
-#endif // EPHEMLIB_H
-
 
 /*! \file ephemlib.h
         \brief ephemlib include file
@@ -55,9 +53,51 @@ namespace Cosmos {
         //! \defgroup ephemlib_functions Ephemeris functions
         //! @{
 
+        //! Memory mapped JPL Ephemeris
+        /*! Reads a binary JPL Development Ephemeris through a read only memory map, so that any
+         * number of threads can evaluate it at once without locking. Each thread keeps the
+         * record it used last, and position, velocity and acceleration all come from a single
+         * pass over the Chebyshev coefficients. Results are in the units of jpl_pleph(): km,
+         * km/s and km/s^2, or radians and radians/s.
+         */
+        class JplEphemeris
+        {
+        public:
+            JplEphemeris() = default;
+            JplEphemeris(const JplEphemeris &) = delete;
+            JplEphemeris &operator=(const JplEphemeris &) = delete;
+            ~JplEphemeris();
+
+            int32_t Open(string filename);
+            void Close();
+            bool IsOpen() const;
+            int32_t State(double jd, int32_t target, int32_t center, double state[9]) const;
+
+        private:
+            const double *Record(double jd, double &t) const;
+            void Interpolate(const double *record, double t, int32_t index, int32_t ncm, double state[9]) const;
+
+            //! Header, as read by jpl_init_ephemeris()
+            double start = 0.;
+            double end = 0.;
+            double step = 0.;
+            double emrat = 0.;
+            int32_t ipt[13][3];
+            int32_t recsize = 0;
+            int32_t ncoeff = 0;
+            bool swap_bytes = false;
+            //! Mapped file
+            const char *data = nullptr;
+            size_t size = 0;
+            vector<double> buffer;
+            //! Distinguishes each file opened, for the per thread record
+            uint32_t generation = 0;
+        };
+
         int32_t jplnut(double mjd, double nuts[]);
         int32_t jplpos(long from, long to, double mjd, Convert::cartpos *pos);
         int32_t jplpos(long from, long to, double mjd, Convert::cartpos &pos);
+        int32_t jplpos(long from, long to, const vector<double> &mjds, vector<Convert::cartpos> &pos);
         int32_t jpllib(double utc,rmatrix *rm, rmatrix *drm);
         int32_t jpllib(double utc,rmatrix &rm, rmatrix &drm);
         int32_t jplopen();
@@ -65,3 +105,5 @@ namespace Cosmos {
         //! @}
     }
 }
+
+#endif // EPHEMLIB_H
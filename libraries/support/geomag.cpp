@@ -66,514 +66,378 @@
 */
 
 #include "support/geomag.h"
+#include <atomic>
 
 namespace Cosmos {
     namespace Convert {
 
-        /* The following include file must define a function 'std::isnan' */
-        /* This function, which returns '1' if the number is NaN and 0*/
-        /* otherwise, could be hand-written if not available. */
-        /* Comment out one of the two following lines, as applicable */
-#include <cmath>               /* for gcc */
-        //#include <mathimf.h>            /* for Intel icc */
+        //! WGS-84 ellipsoid and reference radius of the model (km)
+        static const double wmm_a = 6378.137;
+        static const double wmm_b = 6356.7523142;
+        static const double wmm_re = 6371.2;
 
-#define NaN log(-1.0)
+        static std::atomic<uint32_t> geomag_generations(0);
 
-        int32_t E0000(int IENTRY, int *maxdeg, float alt,float rlat,float rlon, float time, float *dec, float *dip, float *ti, float *gv);
-        int32_t geomag(int *maxdeg);
-        int32_t geomg1(float alt, float rlat, float rlon, float time, float *dec, float *dip, float *ti, float *gv, float *bx, float *by, float *bz);
-        char geomag_introduction(float epochlowlim);
-
-        static int initialized = 0;
-        static char fname[100];
-
-
-        //! Main function to compute the magnetic field from the
-        //! World Magnetic Model
-        /*! Input: Position, time | output: Mag Field
-        \param pos geodetic position (lon, lat, alt) in (rad, rad, meters)
-        \param time in decimal year, ex. use mjd2year(currentmjd())
-        \param comp are the magnetic field x,y,z components in Topocentric System
-*/
-        int32_t geomag_front(gvector pos, double time, rvector &comp)
+        //! Model loaded for one 5 year span
+        struct geomag_span
         {
-            static int maxdeg, itime;
-            static float alt,  dec, dip, ti, gv, bx, by, bz;
-
-            // this reads the coefficients, specify path if neccessary
-            itime = 5 * (int)(time/5.);
-            string rname;
-            int32_t iretn = get_cosmosresources(rname);
-            if (iretn < 0)
-            {
-                return iretn;
-            }
-            sprintf(fname, "%s/general/wmm_%04d.cof", rname.c_str(), itime);
-
-            /* INITIALIZE GEOMAG ROUTINE */
-
-
-            maxdeg = 12;
-            //	warn_H = 0;
-            //	warn_H_val = 99999.0;
-            //	warn_H_strong = 0;
-            //	warn_H_strong_val = 99999.0;
-            //	warn_P = 0;
-
-            if (!initialized)
-            {
-                iretn = geomag(&maxdeg);
-                if (iretn < 0)
-                {
-                    return iretn;
-                }
-                initialized = 1;
-            }
-
-
-            // convert alt to km
-            alt = (float)(pos.h/1000.);
-            // !!! add comment/description to each filed
-            iretn = geomg1(alt, // altitude in km
-                           (float)pos.lat, // lattitude in rad?
-                           (float)pos.lon, // longitude in rad?
-                           (float)time, // time in decimal year
-                           &dec,
-                           &dip,
-                           &ti,
-                           &gv,
-                           &bx,
-                           &by,
-                           &bz);
-            if (iretn < 0)
-            {
-                return iretn;
-            }
-            //      time = time1 + 1.0;
-
-
-            /*COMPUTE X, Y, Z, AND H COMPONENTS OF THE MAGNETIC FIELD*/
-            //	ti *= 1e-9;
-            //	comp->col[0] = ti*(cos(dec)*cos(dip));
-            //	comp->col[1] = ti*(cos(dip)*sin(dec));
-            //	comp->col[2] = ti*(sin(dip));
-            comp.col[0] = static_cast <double>(bx * 1e-9f);
-            comp.col[1] = static_cast <double>(by * 1e-9f);
-            comp.col[2] = static_cast <double>(bz * 1e-9f);
-
-            /*
-    if (length_rv(lcomp) != 0. && lcomp.col[0] != comp->col[0] && lcomp.col[1] != comp->col[1] &&lcomp.col[2] != comp->col[2])
-    {
-        dcomp = rv_smult(1./(time-ltime),rv_sub(*comp,lcomp));
-        lperiod = .001*length_rv(*comp)/length_rv(dcomp);
-    }
-    ltime = time;
-    lcomp = *comp;
-    */
-            return 0;
-        }
-        /*************************************************************************/
-
-        int32_t E0000(int IENTRY, int *maxdeg, float alt, float rlat, float rlon, float time, float *dec, float *dip, float *ti, float *gv, float *bx, float *by, float *bz)
+            int32_t itime;
+            GeomagModel model;
+        };
+
+        static std::atomic<const geomag_span *> geomag_context(nullptr);
+
+        //! Load World Magnetic Model
+        /*! Read a WMM coefficient file: a header line starting with the epoch in decimal years,
+         * then a line for each degree n and order m holding gnm, hnm, and their yearly changes,
+         * ending with a line of 9s. The Schmidt semi-normalized coefficients are converted to
+         * unnormalized ones here, once.
+        \param filename Path of WMM file.
+        \return Number of coefficient lines, otherwise negative error.
+*/
+        int32_t GeomagModel::Load(string filename)
         {
-            register int n,m,D3,D4;
-            static int maxord,i,icomp,j,D1,D2,in,im;
-            static float c[13][13],cd[13][13],tc[13][13],dp[13][13],snorm[169],
-                    sp[13],cp[13],fn[13],fm[13],pp[13],k[13][13],dtr,a,b,re,
-                    a2,b2,c2,a4,b4,c4,epoch=0.,gnm,hnm,dgnm,dhnm,flnmj,otime,oalt,
-                    olat,olon,dt,glon,glat,srlon,srlat,crlon,crlat,srlat2,
-                    crlat2,q,q1,q2,ct,st,r2,r,d,ca,sa,aor,ar,br,bt,bp,bpp,
-                    par,temp1,temp2,parp,bh;
-            static char model[20], c_str[81], c_new[5];
-            static float *p = snorm;
-            //char answer;
-
-            FILE *wmmdat;
-            char* ichar;
-
-            switch(IENTRY){case 0: goto GEOMAG; case 1: goto GEOMG1;}
-
-GEOMAG:
-            if ((wmmdat=fopen(fname,"r")) == NULL)
+            FILE *wmmdat = fopen(filename.c_str(), "r");
+            if (wmmdat == nullptr)
             {
                 return GEOMAG_ERROR_NOTFOUND;
             }
 
-
-            /* INITIALIZE CONSTANTS */
-            maxord = *maxdeg;
-            sp[0] = 0.0;
-            cp[0] = *p = pp[0] = 1.0;
-            dp[0][0] = 0.0;
-            a = (float)6378.137;
-            b = (float)6356.7523142;
-            re = (float)6371.2;
-            a2 = a*a;
-            b2 = b*b;
-            c2 = a2-b2;
-            a4 = a2*a2;
-            b4 = b2*b2;
-            c4 = a4 - b4;
-
-            /* READ WORLD MAGNETIC MODEL SPHERICAL HARMONIC COEFFICIENTS */
-            c[0][0] = 0.0;
-            cd[0][0] = 0.0;
-
-            ichar = fgets(c_str, 80, wmmdat);
-            if (ichar != NULL)
+            coefficients nc = {};
+            coefficients ncd = {};
+            double nepoch = 0.;
+            char c_str[100];
+            if (fgets(c_str, 100, wmmdat) == nullptr || sscanf(c_str, "%lf", &nepoch) != 1)
             {
-                sscanf(c_str,"%f%s",&epoch,model);
+                fclose(wmmdat);
+                return GENERAL_ERROR_EMPTY;
             }
-S3:
-            ichar = fgets(c_str, 80, wmmdat);
-            /* CHECK FOR LAST LINE IN FILE */
-            for (i=0; i<4 && (c_str[i] != '\0'); i++)
-            {
-                c_new[i] = c_str[i];
-                c_new[i+1] = '\0';
-            }
-            icomp = strcmp("9999", c_new);
-            if (icomp == 0) goto S4;
-            /* END OF FILE NOT ENCOUNTERED, GET VALUES */
-            sscanf(c_str,"%d%d%f%f%f%f",&in,&im,&gnm,&hnm,&dgnm,&dhnm);
-            if (im <= in)
+
+            int32_t count = 0;
+            int32_t nmax = 0;
+            while (fgets(c_str, 100, wmmdat) != nullptr && strncmp(c_str, "9999", 4))
             {
-                c[im][in] = gnm;
-                cd[im][in] = dgnm;
+                int32_t in, im;
+                double gnm, hnm, dgnm, dhnm;
+                if (sscanf(c_str, "%d%d%lf%lf%lf%lf", &in, &im, &gnm, &hnm, &dgnm, &dhnm) != 6 || in < 1 || in > MaxDegree || im < 0 || im > in)
+                {
+                    continue;
+                }
+                nc[im][in] = gnm;
+                ncd[im][in] = dgnm;
                 if (im != 0)
                 {
-                    c[in][im-1] = hnm;
-                    cd[in][im-1] = dhnm;
+                    nc[in][im-1] = hnm;
+                    ncd[in][im-1] = dhnm;
                 }
+                nmax = std::max(nmax, in);
+                ++count;
+            }
+            fclose(wmmdat);
+            if (count == 0)
+            {
+                return GENERAL_ERROR_EMPTY;
             }
-            goto S3;
 
-            /* CONVERT SCHMIDT NORMALIZED GAUSS COEFFICIENTS TO UNNORMALIZED */
-S4:
-            *snorm = 1.0;
-            for (n=1; n<=maxord; n++)
+            // Convert Schmidt normalized Gauss coefficients to unnormalized
+            coefficients nk = {};
+            double snorm[MaxDegree + 1][MaxDegree + 1];
+            snorm[0][0] = 1.;
+            for (int32_t n=1; n<=nmax; ++n)
             {
-                *(snorm+n) = *(snorm+n-1)*(float)(2*n-1)/(float)n;
-                j = 2;
-                for (m=0,D1=1,D2=(n-m+D1)/D1; D2>0; D2--,m+=D1)
+                snorm[0][n] = snorm[0][n-1] * (2 * n - 1) / n;
+                int32_t j = 2;
+                for (int32_t m=0; m<=n; ++m)
                 {
-                    k[m][n] = (float)(((n-1)*(n-1))-(m*m))/(float)((2*n-1)*(2*n-3));
+                    nk[m][n] = static_cast<double>((n - 1) * (n - 1) - m * m) / ((2 * n - 1) * (2 * n - 3));
                     if (m > 0)
                     {
-                        flnmj = (float)((n-m+1)*j)/(float)(n+m);
-                        *(snorm+n+m*13) = *(snorm+n+(m-1)*13)*sqrt(flnmj);
+                        double flnmj = static_cast<double>((n - m + 1) * j) / (n + m);
+                        snorm[m][n] = snorm[m-1][n] * sqrt(flnmj);
                         j = 1;
-                        c[n][m-1] = *(snorm+n+m*13)*c[n][m-1];
-                        cd[n][m-1] = *(snorm+n+m*13)*cd[n][m-1];
+                        nc[n][m-1] *= snorm[m][n];
+                        ncd[n][m-1] *= snorm[m][n];
                     }
-                    c[m][n] = *(snorm+n+m*13)*c[m][n];
-                    cd[m][n] = *(snorm+n+m*13)*cd[m][n];
+                    nc[m][n] *= snorm[m][n];
+                    ncd[m][n] *= snorm[m][n];
                 }
-                fn[n] = (float)(n+1);
-                fm[n] = (float)n;
             }
-            k[1][1] = 0.0;
-
-            otime = oalt = olat = olon = -1000.0;
-            fclose(wmmdat);
-            return 0;
-
-            /*************************************************************************/
-
-GEOMG1:
-            dt = time - epoch;
-            if (otime < 0.0 && (dt < 0.0 || dt > 15.0))
-            {
-                /*
-        printf("\n\n WARNING - TIME EXTENDS BEYOND MODEL 5-YEAR LIFE SPAN");
-        printf("\n CONTACT NGDC FOR PRODUCT UPDATES:");
-        printf("\n         National Geophysical Data Center");
-        printf("\n         NOAA EGC/2");
-        printf("\n         325 Broadway");
-        printf("\n         Boulder, CO 80303 USA");
-        printf("\n         Attn: Susan McLean or Stefan Maus");
-        printf("\n         Phone:  (303) 497-6478 or -6522");
-        printf("\n         Email:  Susan.McLean@noaa.gov");
-        printf("\n         or");
-        printf("\n         Stefan.Maus@noaa.gov");
-        printf("\n         Web: http://www.ngdc.noaa.gov/seg/WMM/");
-        printf("\n\n EPOCH  = %.3f",epoch);
-        printf("\n TIME   = %.3f",time);
-        */
-                *bx = *by =*bz = *dec = *dip = *ti = *gv = 0.;
-                return GEOMAG_ERROR_OUTOFRANGE;
-                /*
-        printf("\n Do you wish to continue? (y or n) ");
-        scanf("%c%*[^\n]",&answer);
-        getchar();
-        if ((answer == 'n') || (answer == 'N'))
-        {
-            printf("\n Do you wish to enter more point data? (y or n) ");
-            scanf("%c%*[^\n]",&answer);
-            getchar();
-            if ((answer == 'y')||(answer == 'Y')) goto GEOMG1;
-            else exit (0);
+            nk[1][1] = 0.;
+
+            memcpy(c, nc, sizeof(c));
+            memcpy(cd, ncd, sizeof(cd));
+            memcpy(k, nk, sizeof(k));
+            epoch = nepoch;
+            maxord = nmax;
+            generation = ++geomag_generations;
+            return count;
         }
-        */
-            }
 
-            dtr = (float)(DPI/180.0);
-            glon = rlon/dtr;
-            glat = rlat/dtr;
-            srlon = sin(rlon);
-            srlat = sin(rlat);
-            crlon = cos(rlon);
-            crlat = cos(rlat);
-            srlat2 = srlat*srlat;
-            crlat2 = crlat*crlat;
-            sp[1] = srlon;
-            cp[1] = crlon;
-
-            /* CONVERT FROM GEODETIC COORDS. TO SPHERICAL COORDS. */
-            if (alt != oalt || glat != olat)
+        //! Time adjusted coefficients
+        /*! Return the Gauss coefficients adjusted to the given time. The last set is kept for
+         * each thread, and only recalculated when the time or the model changes.
+        \param year Time in decimal years.
+        \return Reference to the calling thread's adjusted coefficients.
+*/
+        const GeomagModel::coefficients &GeomagModel::Adjust(double year) const
+        {
+            struct adjustcache
             {
-                q = sqrt(a2-c2*srlat2);
-                q1 = alt*q;
-                q2 = ((q1+a2)/(q1+b2))*((q1+a2)/(q1+b2));
-                ct = srlat/sqrt(q2*crlat2+srlat2);
-                st = (float)sqrt(1.0-(ct*ct));
-                r2 = (float)((alt*alt)+2.0*q1+(a4-c4*srlat2)/(q*q));
-                r = sqrt(r2);
-                d = sqrt(a2*crlat2+b2*srlat2);
-                ca = (alt+d)/r;
-                sa = c2*crlat*srlat/(r*d);
-            }
-            if (glon != olon)
+                uint32_t generation = 0;
+                double year = 0.;
+                coefficients tc;
+            };
+            static thread_local adjustcache cache;
+            if (cache.generation != generation || cache.year != year)
             {
-                for (m=2; m<=maxord; m++)
+                double dt = year - epoch;
+                for (int32_t m=0; m<=MaxDegree; ++m)
                 {
-                    sp[m] = sp[1]*cp[m-1]+cp[1]*sp[m-1];
-                    cp[m] = cp[1]*cp[m-1]-sp[1]*sp[m-1];
+                    for (int32_t n=0; n<=MaxDegree; ++n)
+                    {
+                        cache.tc[m][n] = c[m][n] + dt * cd[m][n];
+                    }
                 }
+                cache.generation = generation;
+                cache.year = year;
             }
-            aor = re/r;
-            ar = aor*aor;
-            br = bt = bp = bpp = 0.0;
-            for (n=1; n<=maxord; n++)
+            return cache.tc;
+        }
+
+        //! Field at one position
+        /*! Sum the spherical harmonic expansion of the adjusted coefficients at a geodetic position.
+        \param tc Time adjusted coefficients.
+        \param pos Geodetic position (lon, lat, alt) in (rad, rad, meters).
+        \param comp Magnetic field x, y, z components in the Topocentric System, in Tesla.
+*/
+        void GeomagModel::Evaluate(const coefficients &tc, const gvector &pos, rvector &comp) const
+        {
+            const double a2 = wmm_a * wmm_a;
+            const double b2 = wmm_b * wmm_b;
+            const double c2 = a2 - b2;
+            const double a4 = a2 * a2;
+            const double c4 = a4 - b2 * b2;
+
+            double alt = pos.h / 1000.;
+            double srlat = sin(pos.lat);
+            double crlat = cos(pos.lat);
+            double srlat2 = srlat * srlat;
+            double crlat2 = crlat * crlat;
+
+            // Convert from geodetic to spherical coordinates
+            double q = sqrt(a2 - c2 * srlat2);
+            double q1 = alt * q;
+            double q2 = ((q1 + a2) / (q1 + b2)) * ((q1 + a2) / (q1 + b2));
+            double ct = srlat / sqrt(q2 * crlat2 + srlat2);
+            double st = sqrt(1. - ct * ct);
+            double r = sqrt(alt * alt + 2. * q1 + (a4 - c4 * srlat2) / (q * q));
+            double d = sqrt(a2 * crlat2 + b2 * srlat2);
+            double ca = (alt + d) / r;
+            double sa = c2 * crlat * srlat / (r * d);
+
+            double sp[MaxDegree + 1];
+            double cp[MaxDegree + 1];
+            sp[0] = 0.;
+            cp[0] = 1.;
+            sp[1] = sin(pos.lon);
+            cp[1] = cos(pos.lon);
+            for (int32_t m=2; m<=maxord; ++m)
+            {
+                sp[m] = sp[1] * cp[m-1] + cp[1] * sp[m-1];
+                cp[m] = cp[1] * cp[m-1] - sp[1] * sp[m-1];
+            }
+
+            double p[MaxDegree + 1][MaxDegree + 1];
+            double dp[MaxDegree + 1][MaxDegree + 1];
+            double pp[MaxDegree + 1];
+            p[0][0] = 1.;
+            dp[0][0] = 0.;
+            pp[0] = 1.;
+            double aor = wmm_re / r;
+            double ar = aor * aor;
+            double br = 0., bt = 0., bp = 0., bpp = 0.;
+            for (int32_t n=1; n<=maxord; ++n)
             {
-                ar = ar*aor;
-                for (m=0,D3=1,D4=(n+m+D3)/D3; D4>0; D4--,m+=D3)
+                ar *= aor;
+                for (int32_t m=0; m<=n; ++m)
                 {
-                    /*
-   COMPUTE UNNORMALIZED ASSOCIATED LEGENDRE POLYNOMIALS
-   AND DERIVATIVES VIA RECURSION RELATIONS
-*/
-                    if (alt != oalt || glat != olat)
+                    // Unnormalized associated Legendre polynomials and derivatives
+                    if (n == m)
                     {
-                        if (n == m)
-                        {
-                            *(p+n+m*13) = st**(p+n-1+(m-1)*13);
-                            dp[m][n] = st*dp[m-1][n-1]+ct**(p+n-1+(m-1)*13);
-                            goto S50;
-                        }
-                        if (n == 1 && m == 0)
-                        {
-                            *(p+n+m*13) = ct**(p+n-1+m*13);
-                            dp[m][n] = ct*dp[m][n-1]-st**(p+n-1+m*13);
-                            goto S50;
-                        }
-                        if (n > 1 && n != m)
-                        {
-                            if (m > n-2) *(p+n-2+m*13) = 0.0;
-                            if (m > n-2) dp[m][n-2] = 0.0;
-                            *(p+n+m*13) = ct**(p+n-1+m*13)-k[m][n]**(p+n-2+m*13);
-                            dp[m][n] = ct*dp[m][n-1] - st**(p+n-1+m*13)-k[m][n]*dp[m][n-2];
-                        }
+                        p[m][n] = st * p[m-1][n-1];
+                        dp[m][n] = st * dp[m-1][n-1] + ct * p[m-1][n-1];
                     }
-S50:
-                    /*
-    TIME ADJUST THE GAUSS COEFFICIENTS
-*/
-                    if (time != otime)
+                    else if (n == 1)
                     {
-                        tc[m][n] = c[m][n]+dt*cd[m][n];
-                        if (m != 0) tc[n][m-1] = c[n][m-1]+dt*cd[n][m-1];
+                        p[m][n] = ct * p[m][n-1];
+                        dp[m][n] = ct * dp[m][n-1] - st * p[m][n-1];
                     }
-                    /*
-    ACCUMULATE TERMS OF THE SPHERICAL HARMONIC EXPANSIONS
-*/
-                    par = ar**(p+n+m*13);
+                    else
+                    {
+                        if (m > n - 2)
+                        {
+                            p[m][n-2] = 0.;
+                            dp[m][n-2] = 0.;
+                        }
+                        p[m][n] = ct * p[m][n-1] - k[m][n] * p[m][n-2];
+                        dp[m][n] = ct * dp[m][n-1] - st * p[m][n-1] - k[m][n] * dp[m][n-2];
+                    }
+
+                    // Accumulate terms of the spherical harmonic expansions
+                    double par = ar * p[m][n];
+                    double temp1, temp2;
                     if (m == 0)
                     {
-                        temp1 = tc[m][n]*cp[m];
-                        temp2 = tc[m][n]*sp[m];
+                        temp1 = tc[m][n] * cp[m];
+                        temp2 = tc[m][n] * sp[m];
                     }
                     else
                     {
-                        temp1 = tc[m][n]*cp[m]+tc[n][m-1]*sp[m];
-                        temp2 = tc[m][n]*sp[m]-tc[n][m-1]*cp[m];
+                        temp1 = tc[m][n] * cp[m] + tc[n][m-1] * sp[m];
+                        temp2 = tc[m][n] * sp[m] - tc[n][m-1] * cp[m];
                     }
-                    bt = bt-ar*temp1*dp[m][n];
-                    bp += (fm[m]*temp2*par);
-                    br += (fn[n]*temp1*par);
-                    /*
-    SPECIAL CASE:  NORTH/SOUTH GEOGRAPHIC POLES
-*/
-                    if (st == 0.0 && m == 1)
+                    bt -= ar * temp1 * dp[m][n];
+                    bp += m * temp2 * par;
+                    br += (n + 1) * temp1 * par;
+
+                    // Special case: north/south geographic poles
+                    if (st == 0. && m == 1)
                     {
-                        if (n == 1) pp[n] = pp[n-1];
-                        else pp[n] = ct*pp[n-1]-k[m][n]*pp[n-2];
-                        parp = ar*pp[n];
-                        bpp += (fm[m]*temp2*parp);
+                        pp[n] = n == 1 ? pp[n-1] : ct * pp[n-1] - k[m][n] * pp[n-2];
+                        bpp += m * temp2 * ar * pp[n];
                     }
                 }
             }
-            if (st == 0.0) bp = bpp;
-            else bp /= st;
-            /*
-    ROTATE MAGNETIC VECTOR COMPONENTS FROM SPHERICAL TO
-    GEODETIC COORDINATES
-*/
-            *bx = -bt*ca-br*sa;
-            *by = bp;
-            *bz = bt*sa-br*ca;
-            // EJP: 1.) switch from LH to RH coordinates, 2.) reverse direction of field to represent actual direction
-            /*
-    *bx = bt*ca+br*sa;
-    *by = -bp;
-    *bz = bt*sa-br*ca;
-  */
-            /*
-    COMPUTE DECLINATION (DEC), INCLINATION (DIP) AND
-    TOTAL INTENSITY (TI)
-*/
-            bh = sqrt((*bx**bx)+(*by**by));
-            *ti = sqrt((bh*bh)+(*bz**bz));
-            *dec = atan2(*by,*bx);
-            *dip = atan2(*bz,bh);
-            /*
-    COMPUTE MAGNETIC GRID VARIATION IF THE CURRENT
-    GEODETIC POSITION IS IN THE ARCTIC OR ANTARCTIC
-    (I.E. GLAT > +55 DEGREES OR GLAT < -55 DEGREES)
-
-    OTHERWISE, SET MAGNETIC GRID VARIATION TO -999.0
-*/
-            *gv = -999.0;
-            if (fabs(glat) >= 55.)
-            {
-                if (glat > 0.0 && glon >= 0.0) *gv = (*dec-rlon)/dtr;
-                if (glat > 0.0 && glon < 0.0) *gv = (*dec+fabs(rlon))/dtr;
-                if (glat < 0.0 && glon >= 0.0) *gv = (*dec+rlon)/dtr;
-                if (glat < 0.0 && glon < 0.0) *gv = (*dec-fabs(rlon))/dtr;
-                if (*gv > +180.0) *gv -= 360.0;
-                if (*gv < -180.0) *gv += 360.0;
-            }
-            otime = time;
-            oalt = alt;
-            olat = glat;
-            olon = glon;
-            return 0;
-        }
-
-        /*************************************************************************/
+            bp = st == 0. ? bpp : bp / st;
 
-        int32_t geomag(int *maxdeg)
-        {
-            return E0000(0,maxdeg,0.0,0.0,0.0,0.0,NULL,NULL,NULL,NULL,NULL,NULL,NULL);
+            // Rotate from spherical to geodetic coordinates, in Tesla
+            comp.col[0] = (-bt * ca - br * sa) * 1e-9;
+            comp.col[1] = bp * 1e-9;
+            comp.col[2] = (bt * sa - br * ca) * 1e-9;
         }
 
-        /*************************************************************************/
-
-        int32_t geomg1(float alt, float rlat, float rlon, float time, float *dec, float *dip, float *ti, float *gv, float *bx, float *by, float *bz)
+        //! Magnetic field
+        /*! Calculate the field of the model at one geodetic position.
+        \param pos Geodetic position (lon, lat, alt) in (rad, rad, meters).
+        \param year Time in decimal years.
+        \param comp Magnetic field x, y, z components in the Topocentric System, in Tesla.
+        \return 0, otherwise negative error.
+*/
+        int32_t GeomagModel::Field(gvector pos, double year, rvector &comp) const
         {
-            return E0000(1,NULL,alt,rlat,rlon,time,dec,dip,ti,gv,bx,by,bz);
+            return Field(&pos, 1, year, &comp);
         }
 
-        /*************************************************************************/
-
-        char geomag_introduction(float epochlowlim)
+        //! Magnetic field at many positions
+        /*! Calculate the field of the model at a list of geodetic positions, all at one time.
+         * Times more than 15 years after the epoch of the model, or before it, are rejected.
+        \param pos Geodetic positions (lon, lat, alt) in (rad, rad, meters).
+        \param count Number of positions.
+        \param year Time in decimal years.
+        \param comp Magnetic field x, y, z components in the Topocentric System, in Tesla, one
+        for each position.
+        \return 0, otherwise negative error.
+*/
+        int32_t GeomagModel::Field(const gvector *pos, size_t count, double year, rvector *comp) const
         {
-            char help;
-            static char ans;
-            int iretn;
-
-            printf("\n\n Welcome to the World Magnetic Model (WMM) %4.0f C-Program\n\n", epochlowlim);
-            printf("            --- Version 2.0, September 2005 ---\n\n");
-            printf("\n This program estimates the strength and direction of ");
-            printf("\n Earth's main magnetic field for a given point/area.");
-            printf("\n Enter h for help and contact information or c to continue.");
-            printf ("\n >");
-            iretn = scanf("%c%*[^\n]",&help);
-            if (!iretn)
+            if (!IsLoaded())
+            {
+                return GEOMAG_ERROR_NOTFOUND;
+            }
+            double dt = year - epoch;
+            if (dt < 0. || dt > 15.)
             {
-                ans = 'y';
-                return ans;
+                return GEOMAG_ERROR_OUTOFRANGE;
             }
-            getchar();
+            const coefficients &tc = Adjust(year);
+            for (size_t i=0; i<count; ++i)
+            {
+                Evaluate(tc, pos[i], comp[i]);
+            }
+            return 0;
+        }
+
+        //! World Magnetic Model for a time
+        /*! Return the model from the COSMOS resources file for the 5 year span holding the given
+         * time, general/wmm_YYYY.cof, loading it the first time it is needed.
+        \param year Time in decimal years.
+        \return Pointer to the model, otherwise nullptr.
+*/
+        const GeomagModel *geomag_model(double year)
+        {
+            static mutex geomag_mutex;
+            static std::map<int32_t, const geomag_span *> spans;
 
-            if ((help == 'h') || (help == 'H'))
+            int32_t itime = 5 * static_cast<int32_t>(year / 5.);
+            const geomag_span *span = geomag_context.load(std::memory_order_acquire);
+            if (span == nullptr || span->itime != itime)
             {
-                printf("\n Help information ");
-
-                printf("\n The World Magnetic Model (WMM) for %7.2f", epochlowlim);
-                printf("\n is a model of Earth's main magnetic field.  The WMM");
-                printf("\n is recomputed every five (5) years, in years divisible by ");
-                printf("\n five (i.e. 2005, 2010).  See the contact information below");
-                printf("\n to obtain more information on the WMM and associated software.");
-                printf("\n ");
-                printf("\n Input required is the location in geodetic latitude and");
-                printf("\n longitude (positive for northern latitudes and eastern ");
-                printf("\n longitudes), geodetic altitude in meters, and the date of ");
-                printf("\n interest in years.");
-
-                printf("\n\n\n The program computes the estimated magnetic Declination");
-                printf("\n (D) which is sometimes called MAGVAR, Inclination (I), Total");
-                printf("\n Intensity (F or TI), Horizontal Intensity (H or HI), Vertical");
-                printf("\n Intensity (Z), and Grid Variation (GV). Declination and Grid");
-                printf("\n Variation are measured in units of degrees and are considered");
-                printf("\n positive when east or north.  Inclination is measured in units");
-                printf("\n of degrees and is considered positive when pointing down (into");
-                printf("\n the Earth).  The WMM is reference to the WGS-84 ellipsoid and");
-                printf("\n is valid for 5 years after the base epoch.");
-
-                printf("\n\n\n It is very important to note that a  degree and  order 12 model,");
-                printf("\n such as WMM, describes only the long  wavelength spatial magnetic ");
-                printf("\n fluctuations due to  Earth's core.  Not included in the WMM series");
-                printf("\n models are intermediate and short wavelength spatial fluctuations ");
-                printf("\n that originate in Earth's mantle and crust. Consequently, isolated");
-                printf("\n angular errors at various  positions on the surface (primarily over");
-                printf("\n land, incontinental margins and  over oceanic seamounts, ridges and");
-                printf("\n trenches) of several degrees may be expected.  Also not included in");
-                printf("\n the model are temporal fluctuations of magnetospheric and ionospheric");
-                printf("\n origin. On the days during and immediately following magnetic storms,");
-                printf("\n temporal fluctuations can cause substantial deviations of the geomagnetic");
-                printf("\n field  from model  values.  If the required  declination accuracy  is");
-                printf("\n more stringent than the WMM  series of models provide, the user is");
-                printf("\n advised to request special (regional or local) surveys be performed");
-                printf("\n and models prepared. Please make requests of this nature to the");
-                printf("\n National Geospatial-Intelligence Agency (NGA) at the address below.");
-
-                printf("\n\n\n Contact Information");
-
-                printf("\n  Software and Model Support");
-                printf("\n	National Geophysical Data Center");
-                printf("\n	NOAA EGC/2");
-                printf("\n	325 Broadway");
-                printf("\n	Boulder, CO 80303 USA");
-                printf("\n	Attn: Susan McLean or Stefan Maus");
-                printf("\n	Phone:  (303) 497-6478 or -6522");
-                printf("\n	Email:  Susan.McLean@noaa.gov or Stefan.Maus@noaa.gov ");
-
-                printf("\n\n\n Continue with program? (y or n) ");
-                iretn = scanf("%c%*[^\n]", &ans);
-                if (!iretn)
+                std::lock_guard<mutex> lock(geomag_mutex);
+                auto it = spans.find(itime);
+                if (it != spans.end())
+                {
+                    span = it->second;
+                }
+                else
                 {
-                    ans = 'y';
-                    return ans;
+                    string rname;
+                    if (get_cosmosresources(rname) < 0)
+                    {
+                        return nullptr;
+                    }
+                    char fname[300];
+                    snprintf(fname, sizeof(fname), "%s/general/wmm_%04d.cof", rname.c_str(), itime);
+                    geomag_span *nspan = new geomag_span;
+                    nspan->itime = itime;
+                    if (nspan->model.Load(fname) < 0)
+                    {
+                        delete nspan;
+                        return nullptr;
+                    }
+                    // Never freed, as readers hold it without a lock
+                    spans[itime] = nspan;
+                    span = nspan;
                 }
-                getchar();
+                geomag_context.store(span, std::memory_order_release);
             }
-            else
+            return &span->model;
+        }
+
+        //! Main function to compute the magnetic field from the
+        //! World Magnetic Model
+        /*! Input: Position, time | output: Mag Field
+        \param pos geodetic position (lon, lat, alt) in (rad, rad, meters)
+        \param time in decimal year, ex. use mjd2year(currentmjd())
+        \param comp are the magnetic field x,y,z components in Topocentric System
+        \return 0, otherwise negative error.
+*/
+        int32_t geomag_front(gvector pos, double time, rvector &comp)
+        {
+            const GeomagModel *model = geomag_model(time);
+            if (model == nullptr)
             {
-                ans = 'y';
+                return GEOMAG_ERROR_NOTFOUND;
             }
+            return model->Field(pos, time, comp);
+        }
 
-            return(ans);
+        //! Magnetic field at many positions from the World Magnetic Model
+        /*! Calculate the field at a list of geodetic positions, all at one time.
+        \param pos geodetic positions (lon, lat, alt) in (rad, rad, meters)
+        \param time in decimal year, ex. use mjd2year(currentmjd())
+        \param comp are the magnetic field x,y,z components in Topocentric System, one for each
+        position
+        \return 0, otherwise negative error.
+*/
+        int32_t geomag_front(const vector<gvector> &pos, double time, vector<rvector> &comp)
+        {
+            const GeomagModel *model = geomag_model(time);
+            if (model == nullptr)
+            {
+                return GEOMAG_ERROR_NOTFOUND;
+            }
+            comp.resize(pos.size());
+            return model->Field(pos.data(), pos.size(), time, comp.data());
         }
     }
 }
@@ -53,7 +53,44 @@ namespace Cosmos {
         //! \defgroup geomag_functions World Magnetic Model function declarations
         //! @{
 
+        //! World Magnetic Model
+        //! The spherical harmonic coefficients of one WMM file, read and unnormalized once by
+        //! Load() and then only read. The field is evaluated in double precision with all working
+        //! state on the stack, so one GeomagModel may be shared between threads. Each thread keeps
+        //! the coefficients it last adjusted to a time, so that calls at the same time adjust them
+        //! only once.
+        class GeomagModel
+        {
+        public:
+            static const int32_t MaxDegree = 12;
+
+            int32_t Load(string filename);
+            bool IsLoaded() const { return maxord > 0; }
+            double Epoch() const { return epoch; }
+            int32_t Field(gvector pos, double year, rvector &comp) const;
+            int32_t Field(const gvector *pos, size_t count, double year, rvector *comp) const;
+
+        private:
+            typedef double coefficients[MaxDegree + 1][MaxDegree + 1];
+            const coefficients &Adjust(double year) const;
+            void Evaluate(const coefficients &tc, const gvector &pos, rvector &comp) const;
+
+            //! Unnormalized Gauss coefficients: g in [m][n], h in [n][m-1]
+            coefficients c = {};
+            //! Their secular variation per year
+            coefficients cd = {};
+            //! Legendre recursion factors
+            coefficients k = {};
+            //! Decimal year of the model
+            double epoch = 0.;
+            int32_t maxord = 0;
+            //! Distinguishes each Load() for the adjusted coefficients kept by each thread
+            uint32_t generation = 0;
+        };
+
+        const GeomagModel *geomag_model(double year);
         int32_t geomag_front(gvector pos, double year, rvector &comp);
+        int32_t geomag_front(const vector<gvector> &pos, double year, vector<rvector> &comp);
 
         //! @}
     }
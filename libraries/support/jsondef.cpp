@@ -42,6 +42,286 @@ namespace Cosmos
         {
             
         }
+
+        // Namespace 2.0 serializers. Integers and enumerations are written as int, as get_json() always has.
+        template<class T> static typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value, json11::Json>::type name_json(const T& value);
+        static json11::Json name_json(const bool& value);
+        static json11::Json name_json(const float& value);
+        static json11::Json name_json(const double& value);
+        static json11::Json name_json(const string& value);
+        template<class T> static typename std::enable_if<std::is_class<T>::value, json11::Json>::type name_json(const T& value);
+        template<class T> static json11::Json name_json(const T* value);
+        template<class T> static json11::Json name_json(const vector<T>& values);
+
+        template<class T> static typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value, json11::Json>::type name_json(const T& value)
+        {
+            return json11::Json(static_cast<int>(value));
+        }
+
+        static json11::Json name_json(const bool& value)
+        {
+            return json11::Json(value);
+        }
+
+        static json11::Json name_json(const float& value)
+        {
+            return json11::Json(static_cast<double>(value));
+        }
+
+        static json11::Json name_json(const double& value)
+        {
+            return json11::Json(value);
+        }
+
+        static json11::Json name_json(const string& value)
+        {
+            return json11::Json(value);
+        }
+
+        template<class T> static typename std::enable_if<std::is_class<T>::value, json11::Json>::type name_json(const T& value)
+        {
+            return json11::Json(value);
+        }
+
+        template<class T> static json11::Json name_json(const T* value)
+        {
+            return name_json(*value);
+        }
+
+        template<class T> static json11::Json name_json(const vector<T>& values)
+        {
+            json11::Json::array array;
+            array.reserve(values.size());
+            for (size_t i=0; i<values.size(); ++i)
+            {
+                array.push_back(name_json(values[i]));
+            }
+            return array;
+        }
+
+        // Namespace 2.0 deserializers. Elements of a vector are only set where the JSON is not null.
+        template<class T> static typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type name_assign(T& value, const json11::Json& json);
+        static void name_assign(bool& value, const json11::Json& json);
+        static void name_assign(float& value, const json11::Json& json);
+        static void name_assign(double& value, const json11::Json& json);
+        static void name_assign(string& value, const json11::Json& json);
+        template<class T> static typename std::enable_if<std::is_class<T>::value>::type name_assign(T& value, const json11::Json& json);
+        template<class T> static void name_assign(T*& value, const json11::Json& json);
+        template<class T> static void name_assign(vector<T>& values, const json11::Json& json);
+        static void name_assign(vector<bool>& values, const json11::Json& json);
+
+        template<class T> static typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type name_assign(T& value, const json11::Json& json)
+        {
+            value = static_cast<T>(json.long_value());
+        }
+
+        static void name_assign(bool& value, const json11::Json& json)
+        {
+            value = json.bool_value();
+        }
+
+        static void name_assign(float& value, const json11::Json& json)
+        {
+            value = json.number_value();
+        }
+
+        static void name_assign(double& value, const json11::Json& json)
+        {
+            value = json.number_value();
+        }
+
+        static void name_assign(string& value, const json11::Json& json)
+        {
+            value = json.string_value();
+        }
+
+        template<class T> static typename std::enable_if<std::is_class<T>::value>::type name_assign(T& value, const json11::Json& json)
+        {
+            value.from_json(json.dump());
+        }
+
+        template<class T> static void name_assign(T*& value, const json11::Json& json)
+        {
+            value->from_json(json.dump());
+        }
+
+        template<class T> static void name_assign(vector<T>& values, const json11::Json& json)
+        {
+            for (size_t i=0; i<values.size(); ++i)
+            {
+                if (!json[i].is_null())
+                {
+                    name_assign(values[i], json[i]);
+                }
+            }
+        }
+
+        static void name_assign(vector<bool>& values, const json11::Json& json)
+        {
+            for (size_t i=0; i<values.size(); ++i)
+            {
+                if (!json[i].is_null())
+                {
+                    values[i] = json[i].bool_value();
+                }
+            }
+        }
+
+        template<class T> static json11::Json name_to_json(const void* ptr)
+        {
+            return name_json(*static_cast<const T*>(ptr));
+        }
+
+        template<class T> static void name_from_json(void* ptr, const json11::Json& json)
+        {
+            name_assign(*static_cast<T*>(ptr), json);
+        }
+
+        //! Table of Namespace 2.0 serializers, indexed by type tag - 1
+        /*! Datatypes without a to_json or from_json are still listed so that their names are accepted,
+         * and ignored, by cosmosstruc::set_json().
+         */
+        static const vector<cosmosstruc::name_handler>& name_handlers()
+        {
+            static const vector<cosmosstruc::name_handler> handlers = {
+                {"uint32_t", name_to_json<uint32_t>, name_from_json<uint32_t>},
+                {"int32_t", name_to_json<int32_t>, name_from_json<int32_t>},
+                {"uint16_t", name_to_json<uint16_t>, name_from_json<uint16_t>},
+                {"int16_t", name_to_json<int16_t>, name_from_json<int16_t>},
+                {"uint8_t", name_to_json<uint8_t>, name_from_json<uint8_t>},
+                {"int8_t", name_to_json<int8_t>, name_from_json<int8_t>},
+                {"int", name_to_json<int>, name_from_json<int>},
+                {"size_t", name_to_json<size_t>, name_from_json<size_t>},
+                {"bool", name_to_json<bool>, name_from_json<bool>},
+                {"string", name_to_json<string>, name_from_json<string>},
+                {"float", name_to_json<float>, name_from_json<float>},
+                {"double", name_to_json<double>, name_from_json<double>},
+                {"agent_request_entry", nullptr, nullptr},
+                {"agentstruc", name_to_json<agentstruc>, name_from_json<agentstruc>},
+                {"attstruc", name_to_json<Convert::attstruc>, name_from_json<Convert::attstruc>},
+                {"beatstruc", name_to_json<beatstruc>, name_from_json<beatstruc>},
+                {"cartpos", name_to_json<Convert::cartpos>, name_from_json<Convert::cartpos>},
+                {"cosmosstruc", name_to_json<cosmosstruc>, name_from_json<cosmosstruc>},
+                {"cvector", name_to_json<cvector>, name_from_json<cvector>},
+                {"devicestruc", name_to_json<devicestruc>, name_from_json<devicestruc>},
+                {"devspecstruc", name_to_json<devspecstruc>, name_from_json<devspecstruc>},
+                {"equationstruc", name_to_json<equationstruc>, name_from_json<equationstruc>},
+                {"sim_param", name_to_json<sim_param>, name_from_json<sim_param>},
+                {"sim_state", name_to_json<sim_state>, name_from_json<sim_state>},
+                {"eventstruc", name_to_json<eventstruc>, name_from_json<eventstruc>},
+                {"extraatt", name_to_json<Convert::extraatt>, name_from_json<Convert::extraatt>},
+                {"extrapos", name_to_json<Convert::extrapos>, name_from_json<Convert::extrapos>},
+                {"face", name_to_json<Cosmos::wavefront::face>, name_from_json<Cosmos::wavefront::face>},
+                {"facestruc", name_to_json<facestruc>, name_from_json<facestruc>},
+                {"geoidpos", name_to_json<Convert::geoidpos>, name_from_json<Convert::geoidpos>},
+                {"group", name_to_json<Cosmos::wavefront::group>, name_from_json<Cosmos::wavefront::group>},
+                {"gvector", name_to_json<gvector>, name_from_json<gvector>},
+                {"line", name_to_json<Cosmos::wavefront::line>, name_from_json<Cosmos::wavefront::line>},
+                {"jsonhandle", name_to_json<jsonhandle>, name_from_json<jsonhandle>},
+                {"jsonnode", name_to_json<jsonnode>, name_from_json<jsonnode>},
+                {"locstruc", name_to_json<Convert::locstruc>, name_from_json<Convert::locstruc>},
+                {"material", name_to_json<Cosmos::wavefront::material>, name_from_json<Cosmos::wavefront::material>},
+                {"NetworkType", nullptr, nullptr},
+                {"nodestruc", name_to_json<nodestruc>, name_from_json<nodestruc>},
+                {"piecestruc", name_to_json<piecestruc>, name_from_json<piecestruc>},
+                {"physicsstruc", name_to_json<physicsstruc>, name_from_json<physicsstruc>},
+                {"point", name_to_json<Cosmos::wavefront::point>, name_from_json<Cosmos::wavefront::point>},
+                {"portstruc", name_to_json<portstruc>, name_from_json<portstruc>},
+                {"PORT_TYPE", name_to_json<PORT_TYPE>, name_from_json<PORT_TYPE>},
+                {"posstruc", name_to_json<Convert::posstruc>, name_from_json<Convert::posstruc>},
+                {"qatt", name_to_json<Convert::qatt>, name_from_json<Convert::qatt>},
+                {"quaternion", name_to_json<quaternion>, name_from_json<quaternion>},
+                {"rmatrix", name_to_json<rmatrix>, name_from_json<rmatrix>},
+                {"rvector", name_to_json<rvector>, name_from_json<rvector>},
+                {"socket_channel", nullptr, nullptr},
+                {"spherpos", name_to_json<Convert::spherpos>, name_from_json<Convert::spherpos>},
+                {"svector", name_to_json<svector>, name_from_json<svector>},
+                {"targetstruc", name_to_json<targetstruc>, name_from_json<targetstruc>},
+                {"tlestruc", name_to_json<Convert::tlestruc>, name_from_json<Convert::tlestruc>},
+                {"trianglestruc", name_to_json<trianglestruc>, name_from_json<trianglestruc>},
+                {"unitstruc", name_to_json<unitstruc>, name_from_json<unitstruc>},
+                {"userstruc", name_to_json<userstruc>, name_from_json<userstruc>},
+                {"Vector", name_to_json<Vector>, name_from_json<Vector>},
+                {"vertexstruc", name_to_json<vertexstruc>, nullptr},
+                {"wavefront", name_to_json<wavefront>, name_from_json<wavefront>},
+                {"vector<uint32_t>", name_to_json<vector<uint32_t>>, name_from_json<vector<uint32_t>>},
+                {"vector<vector<uint32_t>>", name_to_json<vector<vector<uint32_t>>>, name_from_json<vector<vector<uint32_t>>>},
+                {"vector<int32_t>", name_to_json<vector<int32_t>>, name_from_json<vector<int32_t>>},
+                {"vector<vector<int32_t>>", name_to_json<vector<vector<int32_t>>>, name_from_json<vector<vector<int32_t>>>},
+                {"vector<uint16_t>", name_to_json<vector<uint16_t>>, name_from_json<vector<uint16_t>>},
+                {"vector<vector<uint16_t>>", name_to_json<vector<vector<uint16_t>>>, name_from_json<vector<vector<uint16_t>>>},
+                {"vector<int16_t>", name_to_json<vector<int16_t>>, name_from_json<vector<int16_t>>},
+                {"vector<vector<int16_t>>", name_to_json<vector<vector<int16_t>>>, name_from_json<vector<vector<int16_t>>>},
+                {"vector<uint8_t>", name_to_json<vector<uint8_t>>, name_from_json<vector<uint8_t>>},
+                {"vector<vector<uint8_t>>", name_to_json<vector<vector<uint8_t>>>, name_from_json<vector<vector<uint8_t>>>},
+                {"vector<int8_t>", name_to_json<vector<int8_t>>, name_from_json<vector<int8_t>>},
+                {"vector<vector<int8_t>>", name_to_json<vector<vector<int8_t>>>, name_from_json<vector<vector<int8_t>>>},
+                {"vector<int>", name_to_json<vector<int>>, name_from_json<vector<int>>},
+                {"vector<vector<int>>", name_to_json<vector<vector<int>>>, name_from_json<vector<vector<int>>>},
+                {"vector<size_t>", name_to_json<vector<size_t>>, name_from_json<vector<size_t>>},
+                {"vector<vector<size_t>>", name_to_json<vector<vector<size_t>>>, name_from_json<vector<vector<size_t>>>},
+                {"vector<bool>", name_to_json<vector<bool>>, name_from_json<vector<bool>>},
+                {"vector<vector<bool>>", name_to_json<vector<vector<bool>>>, name_from_json<vector<vector<bool>>>},
+                {"vector<string>", name_to_json<vector<string>>, name_from_json<vector<string>>},
+                {"vector<vector<string>>", name_to_json<vector<vector<string>>>, name_from_json<vector<vector<string>>>},
+                {"vector<float>", name_to_json<vector<float>>, name_from_json<vector<float>>},
+                {"vector<vector<float>>", name_to_json<vector<vector<float>>>, name_from_json<vector<vector<float>>>},
+                {"vector<double>", name_to_json<vector<double>>, name_from_json<vector<double>>},
+                {"vector<vector<double>>", name_to_json<vector<vector<double>>>, name_from_json<vector<vector<double>>>},
+                {"vector<agent_request_entry>", nullptr, nullptr},
+                {"vector<agentstruc>", name_to_json<vector<agentstruc>>, name_from_json<vector<agentstruc>>},
+                {"vector<devicestruc>", name_to_json<vector<devicestruc>>, name_from_json<vector<devicestruc>>},
+                {"vector<devicestruc*>", name_to_json<vector<devicestruc*>>, name_from_json<vector<devicestruc*>>},
+                {"vector<equationstruc>", name_to_json<vector<equationstruc>>, name_from_json<vector<equationstruc>>},
+                {"vector<sim_param>", name_to_json<vector<sim_param>>, name_from_json<vector<sim_param>>},
+                {"vector<sim_state>", name_to_json<vector<sim_state>>, name_from_json<vector<sim_state>>},
+                {"vector<eventstruc>", name_to_json<vector<eventstruc>>, name_from_json<vector<eventstruc>>},
+                {"vector<face>", name_to_json<vector<Cosmos::wavefront::face>>, name_from_json<vector<Cosmos::wavefront::face>>},
+                {"vector<facestruc>", name_to_json<vector<facestruc>>, name_from_json<vector<facestruc>>},
+                {"vector<group>", name_to_json<vector<Cosmos::wavefront::group>>, name_from_json<vector<Cosmos::wavefront::group>>},
+                {"vector<line>", name_to_json<vector<Cosmos::wavefront::line>>, name_from_json<vector<Cosmos::wavefront::line>>},
+                {"vector<material>", name_to_json<vector<Cosmos::wavefront::material>>, name_from_json<vector<Cosmos::wavefront::material>>},
+                {"vector<piecestruc>", name_to_json<vector<piecestruc>>, name_from_json<vector<piecestruc>>},
+                {"vector<point>", name_to_json<vector<Cosmos::wavefront::point>>, name_from_json<vector<Cosmos::wavefront::point>>},
+                {"vector<portstruc>", name_to_json<vector<portstruc>>, name_from_json<vector<portstruc>>},
+                {"vector<targetstruc>", name_to_json<vector<targetstruc>>, name_from_json<vector<targetstruc>>},
+                {"vector<Convert::tlestruc>", name_to_json<vector<Convert::tlestruc>>, name_from_json<vector<Convert::tlestruc>>},
+                {"vector<trianglestruc>", name_to_json<vector<trianglestruc>>, name_from_json<vector<trianglestruc>>},
+                {"vector<unitstruc>", name_to_json<vector<unitstruc>>, name_from_json<vector<unitstruc>>},
+                {"vector<userstruc>", name_to_json<vector<userstruc>>, name_from_json<vector<userstruc>>},
+                {"vector<Vector>", name_to_json<vector<Vector>>, name_from_json<vector<Vector>>},
+                {"vector<vector<unitstruc>>", name_to_json<vector<vector<unitstruc>>>, name_from_json<vector<vector<unitstruc>>>},
+                {"vector<vertexstruc>", name_to_json<vector<vertexstruc>>, name_from_json<vector<vertexstruc>>},
+            };
+            return handlers;
+        }
+
+        uint16_t cosmosstruc::get_type_tag(const string& t)
+        {
+            static const std::unordered_map<string, uint16_t> tags = []()
+            {
+                std::unordered_map<string, uint16_t> index;
+                const vector<name_handler>& handlers = name_handlers();
+                for (uint16_t i=0; i<handlers.size(); ++i)
+                {
+                    index.insert(std::make_pair(handlers[i].type, i + 1));
+                }
+                return index;
+            }();
+            std::unordered_map<string, uint16_t>::const_iterator it = tags.find(t);
+            return it == tags.end() ? 0 : it->second;
+        }
+
+        const cosmosstruc::name_handler* cosmosstruc::get_type_handler(uint16_t tag)
+        {
+            const vector<name_handler>& handlers = name_handlers();
+            if (tag == 0 || tag > handlers.size())
+            {
+                return nullptr;
+            }
+            return &handlers[tag - 1];
+        }
+
         #ifndef INFLIGHT_BUILD
 
         void cosmosstruc::add_default_names()
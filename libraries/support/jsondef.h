@@ -514,6 +514,8 @@ namespace Cosmos
 #define COSMOS_MAX_NAME 40
         //! Maximum value of JSON HASH
 #define JSON_MAX_HASH (COSMOS_MAX_NAME*37)
+        //! Deepest stack of a compiled JSON equation
+#define JSON_MAX_EQUATION_STACK 32
         //! Maximum JSON buffer
 #define JSTRINGMAXBUFFER (AGENTMAXBUFFER-2)
         //! Maximum number of ::cosmosstruc elements
@@ -1182,6 +1184,40 @@ class sim_param	{
             jsonoperand operand[2];
         };
 
+        //! JSON equation program step
+        /*! Single step of a compiled JSON equation. JSON_OPERAND_CONSTANT and JSON_OPERAND_NAME
+        steps push a value on the stack, JSON_OPERAND_EQUATION steps replace the top two values
+        with the result of the operation.
+*/
+        struct jsonstep
+        {
+            //! JSON Operand Type
+            uint16_t type;
+            //! JSON equation operation, for JSON_OPERAND_EQUATION
+            uint16_t operation;
+            //! CONSTANT uses value, NAME uses ::jsonhandle in ::cosmosstruc::jmap.
+            union
+            {
+                double value;
+                jsonhandle data;
+            };
+        };
+
+        //! Compiled JSON equation
+        /*! A JSON equation flattened from its ::jsonequation tree into postfix steps, with
+ * every Namespace name already looked up, so that it can be calculated again and again
+ * without parsing, hashing or allocating.
+ * - text: Equation the program was compiled from.
+ * - steps: Steps in the order they are performed.
+ * - depth: Deepest the stack gets.
+*/
+        struct jsonprogram
+        {
+            string text;
+            vector<jsonstep> steps;
+            uint16_t depth = 0;
+        };
+
         //! Agent Request Function
         //! Format of a user supplied function to handle a given request
         typedef int32_t (*agent_request_function)(char* request_string, char* output_string, void *root);
@@ -2246,6 +2282,60 @@ class sim_param	{
             }
         };
 
+        //! Target visibility index
+        /*! Sorts the stationary targets of a node into cells of latitude and longitude, so that
+ * ::update_target only visits the cells under the node's horizon. Each entry keeps the
+ * geodetic position its target was indexed at, and how far beyond the horizon it can still be
+ * seen from. Targets that move, or are too large to place, are updated every time. Rebuilt by
+ * ::update_target whenever the list of targets changes. Only used when ::targetindex::cull is
+ * set.
+ */
+        struct targetindex
+        {
+            struct entry
+            {
+                //! Geodetic position when indexed
+                gvector geod;
+                //! Unit vector towards it
+                rvector unit;
+                //! Angle beyond the horizon it can still be seen from (radians)
+                double reach = 0.;
+                //! Last update it was visited by
+                uint32_t pass = 0;
+            };
+
+            //! Only update the targets that could be in view. Targets out of view then keep
+            //! the bearing, distance, range and look angles of their last update, so leave it
+            //! off for anything that reads those ahead of a pass.
+            bool cull = false;
+            //! Targets indexed, and where their list was, to notice when it changes
+            size_t count = 0;
+            const targetstruc *base = nullptr;
+            //! Entry for each target
+            vector<entry> entries;
+            //! Indexed targets in order of cell, with the cell of each
+            vector<uint32_t> cells;
+            vector<uint32_t> order;
+            //! Targets that are not indexed
+            vector<uint32_t> always;
+            //! Largest height and reach of the indexed targets
+            double maxheight = 0.;
+            double maxreach = 0.;
+            //! Indexed targets within the horizon at the last update
+            vector<uint32_t> inview;
+            //! Every target visited by the last update
+            vector<uint32_t> updated;
+            uint32_t pass = 0;
+
+            //! Forget the indexed targets, keeping whether to cull
+            void clear()
+            {
+                bool keep = cull;
+                *this = targetindex();
+                cull = keep;
+            }
+        };
+
         //! Port structure
         /*! Contains information about I/O ports available to devices. The
  * ::allstruc::portidx entry in each device structure indicates which of these
@@ -4789,7 +4879,7 @@ union as a ::devicestruc.
             //! Time step in seconds
             size_t memoryusage()
             {
-                size_t total = 5 * sizeof(double) + 10 * sizeof(float) + 13 * sizeof(Vector);
+                size_t total = 8 * sizeof(double) + 10 * sizeof(float) + 13 * sizeof(Vector);
                 for (size_t i=0; i<faces.size(); ++i)
                 {
                     total += faces[i].memoryusage();
@@ -4842,6 +4932,10 @@ union as a ::devicestruc.
 
             //! Simulation mode as listed in \def defs_physics
             int32_t mode = 0;
+            //! Atmospheric density from the last full model evaluation, with its time and rate of change
+            double density_utc = 0.;
+            double density = 0.;
+            double density_period = 0.;
             Vector ftorque;
             Vector atorque;
             Vector rtorque;
@@ -5628,6 +5722,25 @@ union as a ::devicestruc.
             uint16_t subsystem = 0;
         };
 
+        //! Compiled JSON output table
+        /*! A list of ::jsonentry resolved once, by ::json_compile_table, into the quoted name and
+ * value formatter of each entry. Output with ::json_of_template then only has to format values
+ * into a reused string.
+*/
+        struct jsontemplate
+        {
+            struct field
+            {
+                //! Entry to output
+                const jsonentry *entry = nullptr;
+                //! Quoted name and colon
+                string prefix;
+                //! Formatter for simple types, writing at most 32 characters. Otherwise nullptr, for ::json_out_type
+                size_t (*format)(char *tstring, const uint8_t *data) = nullptr;
+            };
+            vector<field> fields;
+        };
+
         //void replace(string& str, const string& from, const string& to);
         //vector<size_t> find_newlines(const string& sample);
         //void pretty_form(string& js);
@@ -5776,6 +5889,7 @@ union as a ::devicestruc.
                 }
                 name_map(names).swap(names);
                 type_map(types).swap(types);
+                name_index_map(name_index).swap(name_index);
 //                for (auto &name : names)
 //                {
 //                    name_mapping(name).swap(name);
@@ -5866,6 +5980,8 @@ union as a ::devicestruc.
             vector<targetstruc> target;
             uint16_t target_cnt = 0;
             uint16_t target_idx = -1;
+            //! Index of the targets by location
+            targetindex target_index;
 
             //! Single entry vector for user information.
             vector<userstruc> user;
@@ -6185,6 +6301,43 @@ union as a ::devicestruc.
             name_map names;
             type_map types;
 
+            /// Serializer and deserializer for one Namespace 2.0 datatype, selected by numeric type tag.
+            struct name_handler
+            {
+                /// Datatype as given to #add_name()
+                string type;
+                /// Convert the data at a memory address to JSON. `nullptr` if not supported.
+                json11::Json (*to_json)(const void* ptr);
+                /// Set the data at a memory address from JSON. `nullptr` if not supported.
+                void (*from_json)(void* ptr, const json11::Json& json);
+            };
+
+            /// Interned Namespace 2.0 entry: memory address and numeric type tag of a name.
+            struct name_entry
+            {
+                void* ptr;
+                uint16_t tag;
+            };
+
+            using name_index_map = std::unordered_map<string,name_entry>;
+
+            /// Hashed index of every name in #names, kept in step by #add_name() and #remove_name().
+            name_index_map name_index;
+
+            /// Gets the numeric type tag for a Namespace 2.0 datatype.
+            /** Tags index a table of serializers built once, on first use, for every datatype supported by #get_json() and #set_json().
+        @param	t	string representing datatype
+        @return	Type tag, or 0 if the datatype has no serializer.
+    */
+            static uint16_t get_type_tag(const string& t);
+
+            /// Gets the serializer and deserializer for a numeric type tag.
+            /**
+        @param	tag	Type tag returned by #get_type_tag()
+        @return	Pointer to the handler, or `nullptr` if \p tag is unknown.
+    */
+            static const name_handler* get_type_handler(uint16_t tag);
+
             /// Checks if provided name exists within Namespace 2.0
             /**
         @param	s	string representing name to search for
@@ -6192,7 +6345,7 @@ union as a ::devicestruc.
     */
             bool name_exists(const string& s)
             {
-                return (names.find(s) == names.end()) ? false : true;
+                return (name_index.find(s) == name_index.end()) ? false : true;
             }
 
             /// Returns the length of the map used to represent Namespace 2.0
@@ -6299,7 +6452,8 @@ union as a ::devicestruc.
             void add_name(const string& s, void* v, string t)	{
 //                names.insert(name_mapping(s,v));
                 names[s] = v;
-                types.insert(type_mapping(s,t));
+                const string& type = types.insert(type_mapping(s,t)).first->second;
+                name_index[s] = name_entry{v, get_type_tag(type)};
             };
             //TODO:   change_name(..) functions, match_name(), find_aliases(), etc
 
@@ -6311,6 +6465,7 @@ union as a ::devicestruc.
             void remove_name(const string& s) {
                 names.erase(s);
                 types.erase(s);
+                name_index.erase(s);
             }
 
             /// Removes names from Namespace 2.0 recursively.
@@ -6329,6 +6484,7 @@ union as a ::devicestruc.
                     if (p->first.compare(s) == 0 ||								// if exact match s is found. eg: "jmap" but not "jmapped"
                         p->first.compare(0, sbracket.size(), sbracket) == 0 ||	// if search string s + [ is found. eg: "jmap[0]"
                         p->first.compare(0, sdot.size(), sdot) == 0) {			// if search string s + . is found. eg: "node.name"
+                        name_index.erase(p->first);
                         names.erase(p++);
                     } else {
                         ++p;
@@ -6386,9 +6542,9 @@ union as a ::devicestruc.
     */
             template<class T>
             T* get_pointer(const string& s) const	{
-                name_map::const_iterator it = names.find(s);
-                if(it == names.end())	{	cerr<<"name <"<<s<<"> not found!"<<endl; return nullptr;	}
-                return (T*)(it->second);
+                name_index_map::const_iterator it = name_index.find(s);
+                if(it == name_index.end())	{	cerr<<"name <"<<s<<"> not found!"<<endl; return nullptr;	}
+                return (T*)(it->second.ptr);
             }
 
             /// Gets the pointer to the memory address associated with the provided name in Namespace 2.0.
@@ -6397,9 +6553,9 @@ union as a ::devicestruc.
             @return	void pointer to associated memory address. Returns `nullptr` if name is not found.
             */
             void* get_pointer(const string& s) const	{
-                name_map::const_iterator it = names.find(s);
-                if(it == names.end())	{	cerr<<"name <"<<s<<"> not found!"<<endl; return nullptr;	}
-                return it->second;
+                name_index_map::const_iterator it = name_index.find(s);
+                if(it == name_index.end())	{	cerr<<"name <"<<s<<"> not found!"<<endl; return nullptr;	}
+                return it->second.ptr;
             }
 
             /// Gets the value of the data associated with the provided name in Namespace 2.0.
@@ -6411,8 +6567,8 @@ union as a ::devicestruc.
             T get_value(const string& s) const	{
                 // change to static null object?
                 T dummy = T();
-                name_map::const_iterator it = names.find(s);
-                if(it == names.end())	{	cerr<<"name <"<<s<<"> not found!"<<endl; return dummy;	}
+                name_index_map::const_iterator it = name_index.find(s);
+                if(it == name_index.end())	{	cerr<<"name <"<<s<<"> not found!"<<endl; return dummy;	}
                 return *get_pointer<T>(s);
             }
 
@@ -6420,8 +6576,8 @@ union as a ::devicestruc.
             T get_ivalue(const string& s) const	{
                 // change to static null object?
                 T dummy = T();
-                name_map::const_iterator it = names.find(s);
-                if(it == names.end())	{	cerr<<"name <"<<s<<"> not found!"<<endl; return dummy;	}
+                name_index_map::const_iterator it = name_index.find(s);
+                if(it == name_index.end())	{	cerr<<"name <"<<s<<"> not found!"<<endl; return dummy;	}
                 return **get_pointer<T*>(s);
             }
 
@@ -6434,8 +6590,8 @@ union as a ::devicestruc.
             template<class T>
             void set_value(const string& s, const T& value) const	{
                 // maybe if not found should be inserted??  hmmm....  ask Eric
-                name_map::const_iterator it = names.find(s);
-                if(it == names.end())	{	cerr<<"name <"<<s<<"> not found!"<<endl; return;	}
+                name_index_map::const_iterator it = name_index.find(s);
+                if(it == name_index.end())	{	cerr<<"name <"<<s<<"> not found!"<<endl; return;	}
                 *get_pointer<T>(s) = value;
             }
 
@@ -6457,479 +6613,16 @@ union as a ::devicestruc.
                     //cout<<"\tJSON name     = <"<<name<<">"<<endl;
                     if(error.empty()) {
                         if(!p[name].is_null())	{
-                            if(name_exists(name))  {
-                                string type = get_type(name);
-                                // base data type
-                                if(type == "string")	{
-                                    set_value<string>(name, p[name].string_value());
-                                } else if(type == "double")	{
-                                    set_value<double>(name, p[name].number_value());
-                                } else if (type == "float")	{
-                                    set_value<float>(name, p[name].number_value());
-                                } else if (type == "int")	{
-                                    set_value<int>(name, p[name].long_value());
-                                } else if (type == "bool")	{
-                                    set_value<bool>(name, p[name].bool_value());
-                                } else if (type == "uint32_t")	{
-                                    set_value<uint32_t>(name, p[name].long_value());
-                                } else if (type == "int32_t")	{
-                                    set_value<int32_t>(name, p[name].long_value());
-                                } else if (type == "uint16_t")	{
-                                    set_value<uint16_t>(name, p[name].long_value());
-                                } else if (type == "int16_t")	{
-                                    set_value<int16_t>(name, p[name].long_value());
-                                } else if (type == "uint8_t")	{
-                                    set_value<uint8_t>(name, p[name].long_value());
-                                } else if (type == "int8_t")	{
-                                    set_value<int8_t>(name, p[name].long_value());
-                                } else if (type == "size_t") {
-                                    set_value<size_t>(name, p[name].long_value());
-
-                                    // user-defined types
-
-                                } else if (type == "agent_request_entry") {
-                                    //get_pointer<agent_request_entry>(name)->from_json(json);
-                                } else if (type == "agentstruc") {
-                                    get_pointer<agentstruc>(name)->from_json(p[name].dump());
-                                } else if (type == "attstruc") {
-                                    get_pointer<Convert::attstruc>(name)->from_json(p[name].dump());
-                                } else if (type == "beatstruc") {
-                                    get_pointer<beatstruc>(name)->from_json(p[name].dump());
-                                } else if (type == "cartpos") {
-                                    get_pointer<Convert::cartpos>(name)->from_json(p[name].dump());
-                                } else if (type == "cosmosstruc") {
-                                    get_pointer<cosmosstruc>(name)->from_json(p[name].dump());
-                                } else if (type == "cvector") {
-                                    get_pointer<cvector>(name)->from_json(p[name].dump());
-                                } else if (type == "devicestruc") {
-                                    get_pointer<devicestruc>(name)->from_json(p[name].dump());
-                                } else if (type == "devspecstruc") {
-                                    get_pointer<devspecstruc>(name)->from_json(p[name].dump());
-                                } else if (type == "equationstruc") {
-                                    get_pointer<equationstruc>(name)->from_json(p[name].dump());
-                                } else if (type == "sim_param") {
-                                    get_pointer<sim_param>(name)->from_json(p[name].dump());
-                                } else if (type == "sim_state") {
-                                    get_pointer<sim_state>(name)->from_json(p[name].dump());
-                                } else if (type == "eventstruc") {
-                                    get_pointer<eventstruc>(name)->from_json(p[name].dump());
-                                } else if (type == "extraatt") {
-                                    get_pointer<Convert::extraatt>(name)->from_json(p[name].dump());
-                                } else if (type == "extrapos") {
-                                    get_pointer<Convert::extrapos>(name)->from_json(p[name].dump());
-                                } else if (type == "face") {
-                                    get_pointer<Cosmos::wavefront::face>(name)->from_json(p[name].dump());
-                                } else if (type == "facestruc") {
-                                    get_pointer<facestruc>(name)->from_json(p[name].dump());
-                                } else if (type == "geoidpos") {
-                                    get_pointer<Convert::geoidpos>(name)->from_json(p[name].dump());
-                                } else if (type == "group") {
-                                    get_pointer<Cosmos::wavefront::group>(name)->from_json(p[name].dump());
-                                } else if (type == "gvector") {
-                                    get_pointer<gvector>(name)->from_json(p[name].dump());
-                                } else if (type == "jsonhandle") {
-                                    get_pointer<jsonhandle>(name)->from_json(p[name].dump());
-                                } else if (type == "jsonnode") {
-                                    get_pointer<jsonnode>(name)->from_json(p[name].dump());
-                                } else if (type == "line") {
-                                    get_pointer<Cosmos::wavefront::line>(name)->from_json(p[name].dump());
-                                } else if (type == "locstruc") {
-                                    get_pointer<Convert::locstruc>(name)->from_json(p[name].dump());
-                                } else if (type == "material") {
-                                    get_pointer<Cosmos::wavefront::material>(name)->from_json(p[name].dump());
-                                } else if (type == "NetworkType") {
-                                    //get_pointer<NetworkType>(name)->from_json(p[name].dump());
-                                } else if (type == "nodestruc") {
-                                    get_pointer<nodestruc>(name)->from_json(p[name].dump());
-                                } else if (type == "physicsstruc") {
-                                    get_pointer<physicsstruc>(name)->from_json(p[name].dump());
-                                } else if (type == "piecestruc") {
-                                    get_pointer<piecestruc>(name)->from_json(p[name].dump());
-                                } else if (type == "point") {
-                                    get_pointer<Cosmos::wavefront::point>(name)->from_json(p[name].dump());
-                                } else if (type == "portstruc") {
-                                    get_pointer<portstruc>(name)->from_json(p[name].dump());
-                                } else if (type == "PORT_TYPE") {
-                                    set_value<PORT_TYPE>(name, static_cast<PORT_TYPE>(p[name].long_value()));
-                                } else if (type == "posstruc") {
-                                    get_pointer<Convert::posstruc>(name)->from_json(p[name].dump());
-                                } else if (type == "qatt") {
-                                    get_pointer<Convert::qatt>(name)->from_json(p[name].dump());
-                                } else if (type == "quaternion") {
-                                    get_pointer<quaternion>(name)->from_json(p[name].dump());
-                                } else if (type == "rmatrix") {
-                                    get_pointer<rmatrix>(name)->from_json(p[name].dump());
-                                } else if (type == "rvector") {
-                                    get_pointer<rvector>(name)->from_json(p[name].dump());
-                                } else if (type == "socket_channel") {
-                                    //get_pointer<socket_channel>(name)->from_json(p[name].dump());
-                                } else if (type == "spherpos") {
-                                    get_pointer<Convert::spherpos>(name)->from_json(p[name].dump());
-                                } else if (type == "svector") {
-                                    get_pointer<svector>(name)->from_json(p[name].dump());
-                                } else if (type == "targetstruc") {
-                                    get_pointer<targetstruc>(name)->from_json(p[name].dump());
-                                } else if (type == "tlestruc") {
-                                    get_pointer<Convert::tlestruc>(name)->from_json(p[name].dump());
-                                } else if (type == "trianglestruc") {
-                                    get_pointer<trianglestruc>(name)->from_json(p[name].dump());
-                                } else if (type == "unitstruc") {
-                                    get_pointer<unitstruc>(name)->from_json(p[name].dump());
-                                } else if (type == "userstruc") {
-                                    get_pointer<userstruc>(name)->from_json(p[name].dump());
-                                } else if (type == "Vector") {
-                                    get_pointer<Vector>(name)->from_json(p[name].dump());
-//                                } else if (type == "vertexstruc") {
-//                                    get_pointer<vertexstruc>(name)->from_json(p[name].dump());
-                                } else if (type == "wavefront") {
-                                    get_pointer<wavefront>(name)->from_json(p[name].dump());
-                                } else if (type == "sim_param") {
-                                    get_pointer<sim_param>(name)->from_json(p[name].dump());
-                                } else if (type == "sim_state") {
-                                    get_pointer<sim_state>(name)->from_json(p[name].dump());
-
-                                    // vector of base types
-                                } else if (type == "vector<uint32_t>") {
-                                    for(size_t i = 0; i < get_pointer<vector<uint32_t>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<uint32_t>>(name)->at(i) = p[name][i].long_value();
-                                        }
-                                    }
-                                } else if (type == "vector<vector<uint32_t>>") {
-                                    for(size_t i = 0; i < get_pointer<vector<vector<uint32_t>>>(name)->size(); ++i) {
-                                        for(size_t j = 0; j < get_pointer<vector<vector<uint32_t>>>(name)->at(i).size(); ++j) {
-                                            if(!p[name][i][j].is_null()) {
-                                                get_pointer<vector<vector<uint32_t>>>(name)->at(i).at(j) = p[name][i][j].long_value();
-                                            }
-                                        }
-                                    }
-                                } else if (type == "vector<int32_t>") {
-                                    for(size_t i = 0; i < get_pointer<vector<int32_t>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<int32_t>>(name)->at(i) = p[name][i].long_value();
-                                        }
-                                    }
-                                } else if (type == "vector<vector<int32_t>>") {
-                                    for(size_t i = 0; i < get_pointer<vector<vector<int32_t>>>(name)->size(); ++i) {
-                                        for(size_t j = 0; j < get_pointer<vector<vector<int32_t>>>(name)->at(i).size(); ++j) {
-                                            if(!p[name][i][j].is_null()) {
-                                                get_pointer<vector<vector<int32_t>>>(name)->at(i).at(j) = p[name][i][j].long_value();
-                                            }
-                                        }
-                                    }
-                                } else if (type == "vector<uint16_t>") {
-                                    for(size_t i = 0; i < get_pointer<vector<uint16_t>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<uint16_t>>(name)->at(i) = p[name][i].long_value();
-                                        }
-                                    }
-                                } else if (type == "vector<vector<uint16_t>>") {
-                                    for(size_t i = 0; i < get_pointer<vector<vector<uint16_t>>>(name)->size(); ++i) {
-                                        for(size_t j = 0; j < get_pointer<vector<vector<uint16_t>>>(name)->at(i).size(); ++j) {
-                                            if(!p[name][i][j].is_null()) {
-                                                get_pointer<vector<vector<uint16_t>>>(name)->at(i).at(j) = p[name][i][j].long_value();
-                                            }
-                                        }
-                                    }
-                                } else if (type == "vector<int16_t>") {
-                                    for(size_t i = 0; i < get_pointer<vector<int16_t>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<int16_t>>(name)->at(i) = p[name][i].long_value();
-                                        }
-                                    }
-                                } else if (type == "vector<vector<int16_t>>") {
-                                    for(size_t i = 0; i < get_pointer<vector<vector<int16_t>>>(name)->size(); ++i) {
-                                        for(size_t j = 0; j < get_pointer<vector<vector<int16_t>>>(name)->at(i).size(); ++j) {
-                                            if(!p[name][i][j].is_null()) {
-                                                get_pointer<vector<vector<int16_t>>>(name)->at(i).at(j) = p[name][i][j].long_value();
-                                            }
-                                        }
-                                    }
-                                } else if (type == "vector<uint8_t>") {
-                                    for(size_t i = 0; i < get_pointer<vector<uint8_t>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<uint8_t>>(name)->at(i) = p[name][i].long_value();
-                                        }
-                                    }
-                                } else if (type == "vector<vector<uint8_t>>") {
-                                    for(size_t i = 0; i < get_pointer<vector<vector<uint8_t>>>(name)->size(); ++i) {
-                                        for(size_t j = 0; j < get_pointer<vector<vector<uint8_t>>>(name)->at(i).size(); ++j) {
-                                            if(!p[name][i][j].is_null()) {
-                                                get_pointer<vector<vector<uint8_t>>>(name)->at(i).at(j) = p[name][i][j].long_value();
-                                            }
-                                        }
-                                    }
-                                } else if (type == "vector<int8_t>") {
-                                    for(size_t i = 0; i < get_pointer<vector<int8_t>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<int8_t>>(name)->at(i) = p[name][i].long_value();
-                                        }
-                                    }
-                                } else if (type == "vector<vector<int8_t>>") {
-                                    for(size_t i = 0; i < get_pointer<vector<vector<int8_t>>>(name)->size(); ++i) {
-                                        for(size_t j = 0; j < get_pointer<vector<vector<int8_t>>>(name)->at(i).size(); ++j) {
-                                            if(!p[name][i][j].is_null()) {
-                                                get_pointer<vector<vector<int8_t>>>(name)->at(i).at(j) = p[name][i][j].long_value();
-                                            }
-                                        }
-                                    }
-                                } else if (type == "vector<int>") {
-                                    for(size_t i = 0; i < get_pointer<vector<int>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<int>>(name)->at(i) = p[name][i].long_value();
-                                        }
-                                    }
-                                } else if (type == "vector<vector<int>>") {
-                                    for(size_t i = 0; i < get_pointer<vector<vector<int>>>(name)->size(); ++i) {
-                                        for(size_t j = 0; j < get_pointer<vector<vector<int>>>(name)->at(i).size(); ++j) {
-                                            if(!p[name][i][j].is_null()) {
-                                                get_pointer<vector<vector<int>>>(name)->at(i).at(j) = p[name][i][j].long_value();
-                                            }
-                                        }
-                                    }
-                                } else if (type == "vector<size_t>") {
-                                    for(size_t i = 0; i < get_pointer<vector<size_t>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<size_t>>(name)->at(i) = p[name][i].long_value();
-                                        }
-                                    }
-                                } else if (type == "vector<vector<size_t>>") {
-                                    for(size_t i = 0; i < get_pointer<vector<vector<size_t>>>(name)->size(); ++i) {
-                                        for(size_t j = 0; j < get_pointer<vector<vector<size_t>>>(name)->at(i).size(); ++j) {
-                                            if(!p[name][i][j].is_null()) {
-                                                get_pointer<vector<vector<size_t>>>(name)->at(i).at(j) = p[name][i][j].long_value();
-                                            }
-                                        }
-                                    }
-                                } else if (type == "vector<bool>") {
-                                    for(size_t i = 0; i < get_pointer<vector<bool>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<bool>>(name)->at(i) = p[name][i].bool_value();
-                                        }
-                                    }
-                                } else if (type == "vector<vector<bool>>") {
-                                    for(size_t i = 0; i < get_pointer<vector<vector<bool>>>(name)->size(); ++i) {
-                                        for(size_t j = 0; j < get_pointer<vector<vector<bool>>>(name)->at(i).size(); ++j) {
-                                            if(!p[name][i][j].is_null()) {
-                                                get_pointer<vector<vector<bool>>>(name)->at(i).at(j) = p[name][i][j].bool_value();
-                                            }
-                                        }
-                                    }
-                                } else if (type == "vector<string>") {
-                                    for(size_t i = 0; i < get_pointer<vector<string>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<string>>(name)->at(i) = p[name][i].string_value();
-                                        }
-                                    }
-                                } else if (type == "vector<vector<string>>") {
-                                    for(size_t i = 0; i < get_pointer<vector<vector<string>>>(name)->size(); ++i) {
-                                        for(size_t j = 0; j < get_pointer<vector<vector<string>>>(name)->at(i).size(); ++j) {
-                                            if(!p[name][i][j].is_null()) {
-                                                get_pointer<vector<vector<string>>>(name)->at(i).at(j) = p[name][i][j].string_value();
-                                            }
-                                        }
-                                    }
-                                } else if (type == "vector<float>") {
-                                    for(size_t i = 0; i < get_pointer<vector<float>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<float>>(name)->at(i) = p[name][i].number_value();
-                                        }
-                                    }
-                                } else if (type == "vector<vector<float>>") {
-                                    for(size_t i = 0; i < get_pointer<vector<vector<float>>>(name)->size(); ++i) {
-                                        for(size_t j = 0; j < get_pointer<vector<vector<float>>>(name)->at(i).size(); ++j) {
-                                            if(!p[name][i][j].is_null()) {
-                                                get_pointer<vector<vector<float>>>(name)->at(i).at(j) = p[name][i][j].number_value();
-                                            }
-                                        }
-                                    }
-                                } else if (type == "vector<double>") {
-                                    for(size_t i = 0; i < get_pointer<vector<double>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<double>>(name)->at(i) = p[name][i].number_value();
-                                        }
-                                    }
-                                } else if (type == "vector<vector<double>>") {
-                                    for(size_t i = 0; i < get_pointer<vector<vector<double>>>(name)->size(); ++i) {
-                                        for(size_t j = 0; j < get_pointer<vector<vector<double>>>(name)->at(i).size(); ++j) {
-                                            if(!p[name][i][j].is_null()) {
-                                                get_pointer<vector<vector<double>>>(name)->at(i).at(j) = p[name][i][j].number_value();
-                                            }
-                                        }
-                                    }
-
-                                    // vector of user-defined types
-                                    //} else if (type == "vector<agent_request_entry>") {
-                                    //	for(size_t i = 0; i < get_pointer<vector<agent_request_entry>>(name)->size(); ++i) {
-                                    //		if(!p[name][i].is_null()) {
-                                    //			get_pointer<vector<agent_request_entry>>(name)->at(i).from_json(p[name][i].dump());
-                                    //		}
-                                    //	}
-                                } else if (type == "vector<agentstruc>") {
-                                    for(size_t i = 0; i < get_pointer<vector<agentstruc>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<agentstruc>>(name)->at(i).from_json(p[name][i].dump());
-                                        }
-                                    }
-                                } else if (type == "vector<devicestruc>") {
-                                    for(size_t i = 0; i < get_pointer<vector<devicestruc>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<devicestruc>>(name)->at(i).from_json(p[name][i].dump());
-                                        }
-                                    }
-                                } else if (type == "vector<devicestruc*>") {
-                                    for(size_t i = 0; i < get_pointer<vector<devicestruc*>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<devicestruc*>>(name)->at(i)->from_json(p[name][i].dump());
-                                        }
-                                    }
-                                } else if (type == "vector<equationstruc>") {
-                                    for(size_t i = 0; i < get_pointer<vector<equationstruc>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<equationstruc>>(name)->at(i).from_json(p[name][i].dump());
-                                        }
-                                    }
-                                } else if (type == "vector<sim_param>") {
-                                    for(size_t i = 0; i < get_pointer<vector<sim_param>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<sim_param>>(name)->at(i).from_json(p[name][i].dump());
-                                        }
-                                    }
-                                } else if (type == "vector<sim_state>") {
-                                    for(size_t i = 0; i < get_pointer<vector<sim_state>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<sim_state>>(name)->at(i).from_json(p[name][i].dump());
-                                        }
-                                    }
-                                } else if (type == "vector<eventstruc>") {
-                                    for(size_t i = 0; i < get_pointer<vector<eventstruc>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<eventstruc>>(name)->at(i).from_json(p[name][i].dump());
-                                        }
-                                    }
-                                } else if (type == "vector<face>") {
-                                    for(size_t i = 0; i < get_pointer<vector<Cosmos::wavefront::face>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<Cosmos::wavefront::face>>(name)->at(i).from_json(p[name][i].dump());
-                                        }
-                                    }
-                                } else if (type == "vector<facestruc>") {
-                                    for(size_t i = 0; i < get_pointer<vector<facestruc>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<facestruc>>(name)->at(i).from_json(p[name][i].dump());
-                                        }
-                                    }
-                                } else if (type == "vector<group>") {
-                                    for(size_t i = 0; i < get_pointer<vector<Cosmos::wavefront::group>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<Cosmos::wavefront::group>>(name)->at(i).from_json(p[name][i].dump());
-                                        }
-                                    }
-                                } else if (type == "vector<line>") {
-                                    for(size_t i = 0; i < get_pointer<vector<Cosmos::wavefront::line>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<Cosmos::wavefront::line>>(name)->at(i).from_json(p[name][i].dump());
-                                        }
-                                    }
-                                } else if (type == "vector<material>") {
-                                    for(size_t i = 0; i < get_pointer<vector<Cosmos::wavefront::material>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<Cosmos::wavefront::material>>(name)->at(i).from_json(p[name][i].dump());
-                                        }
-                                    }
-                                } else if (type == "vector<piecestruc>") {
-                                    for(size_t i = 0; i < get_pointer<vector<piecestruc>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<piecestruc>>(name)->at(i).from_json(p[name][i].dump());
-                                        }
-                                    }
-                                } else if (type == "vector<point>") {
-                                    for(size_t i = 0; i < get_pointer<vector<Cosmos::wavefront::point>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<Cosmos::wavefront::point>>(name)->at(i).from_json(p[name][i].dump());
-                                        }
-                                    }
-                                } else if (type == "vector<portstruc>") {
-                                    for(size_t i = 0; i < get_pointer<vector<portstruc>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<portstruc>>(name)->at(i).from_json(p[name][i].dump());
-                                        }
-                                    }
-                                } else if (type == "vector<targetstruc>") {
-                                    for(size_t i = 0; i < get_pointer<vector<targetstruc>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<targetstruc>>(name)->at(i).from_json(p[name][i].dump());
-                                        }
-                                    }
-                                } else if (type == "vector<Convert::tlestruc>") {
-                                    for(size_t i = 0; i < get_pointer<vector<Convert::tlestruc>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<Convert::tlestruc>>(name)->at(i).from_json(p[name][i].dump());
-                                        }
-                                    }
-                                } else if (type == "vector<trianglestruc>") {
-                                    for(size_t i = 0; i < get_pointer<vector<trianglestruc>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<trianglestruc>>(name)->at(i).from_json(p[name][i].dump());
-                                        }
-                                    }
-                                } else if (type == "vector<unitstruc>") {
-                                    for(size_t i = 0; i < get_pointer<vector<unitstruc>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<unitstruc>>(name)->at(i).from_json(p[name][i].dump());
-                                        }
-                                    }
-                                } else if (type == "vector<userstruc>") {
-                                    for(size_t i = 0; i < get_pointer<vector<userstruc>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<userstruc>>(name)->at(i).from_json(p[name][i].dump());
-                                        }
-                                    }
-                                } else if (type == "vector<Vector>") {
-                                    for(size_t i = 0; i < get_pointer<vector<Vector>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<Vector>>(name)->at(i).from_json(p[name][i].dump());
-                                        }
-                                    }
-                                } else if (type == "vector<unitstruc>") {
-                                    for(size_t i = 0; i < get_pointer<vector<unitstruc>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<unitstruc>>(name)->at(i).from_json(p[name][i].dump());
-                                        }
-                                    }
-                                } else if (type == "vector<vector<unitstruc>>") {
-                                    for(size_t i = 0; i < get_pointer<vector<vector<unitstruc>>>(name)->size(); ++i) {
-                                        for(size_t j = 0; j < get_pointer<vector<vector<unitstruc>>>(name)->at(i).size(); ++j) {
-                                            if(!p[name][i][j].is_null()) {
-                                                get_pointer<vector<vector<unitstruc>>>(name)->at(i).at(j).from_json(p[name][i][j].dump());
-                                            }
-                                        }
-                                    }
-                                } else if (type == "vector<vertexstruc>") {
-                                    for(size_t i = 0; i < get_pointer<vector<vertexstruc>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<vertexstruc>>(name)->at(i).from_json(p[name][i].dump());
-                                        }
-                                    }
-                                } else if (type == "vector<sim_param>") {
-                                    for(size_t i = 0; i < get_pointer<vector<sim_param>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<sim_param>>(name)->at(i).from_json(p[name][i].dump());
-                                        }
-                                    }
-                                } else if (type == "vector<sim_state>") {
-                                    for(size_t i = 0; i < get_pointer<vector<sim_state>>(name)->size(); ++i) {
-                                        if(!p[name][i].is_null()) {
-                                            get_pointer<vector<sim_state>>(name)->at(i).from_json(p[name][i].dump());
-                                        }
-                                    }
-                                } else	{
-                                    // I guess this block means the type is not supported!
-                                    // could re-add templated version of set_json so user
-                                    // can explicitly call for given unsupported datatype
-                                    //get_pointer<T>(name)->from_json(json);
+                            name_index_map::const_iterator it = name_index.find(name);
+                            if(it != name_index.end())  {
+                                const name_handler* handler = get_type_handler(it->second.tag);
+                                if(handler == nullptr)	{
+                                    // type is not supported
                                     return;
                                 }
+                                if(handler->from_json != nullptr)	{
+                                    handler->from_json(it->second.ptr, p[name]);
+                                }
                             }
                         }
                     }
@@ -6958,244 +6651,12 @@ union as a ::devicestruc.
         @return	JSON-formatted string of data. Returns empty string if name is not found.
     */
             string get_json(const string& s)	{
-                if(name_exists(s))  {
+                name_index_map::const_iterator it = name_index.find(s);
+                if(it != name_index.end())  {
                     json11::Json json;
-                    string type = get_type(s);
-                    // base data types
-                    if (type == "uint32_t") {
-                        json = json11::Json::object { { s, get_value<int>(s) } };
-                    } else if (type == "int32_t") {
-                        json = json11::Json::object { { s, get_value<int32_t>(s) } };
-                    } else if (type == "uint16_t") {
-                        json = json11::Json::object { { s, get_value<uint16_t>(s) } };
-                    } else if (type == "int16_t") {
-                        json = json11::Json::object { { s, get_value<int16_t>(s) } };
-                    } else if (type == "uint8_t") {
-                        json = json11::Json::object { { s, get_value<uint8_t>(s) } };
-                    } else if (type == "int8_t") {
-                        json = json11::Json::object { { s, get_value<int8_t>(s) } };
-                    } else if (type == "int") {
-                        json = json11::Json::object { { s, get_value<int>(s) } };
-                    } else if (type == "size_t") {
-                        json = json11::Json::object { { s, get_value<int>(s) } };
-                    } else if (type == "bool") {
-                        json = json11::Json::object { { s, get_value<bool>(s) } };
-                    } else if (type == "string") {
-                        json = json11::Json::object { { s, get_value<string>(s) } };
-                    } else if (type == "float") {
-                        json = json11::Json::object { { s, get_value<float>(s) } };
-                    } else if (type == "double") {
-                        json = json11::Json::object { { s, get_value<double>(s) } };
-
-                        // user-defined types
-                    } else if (type == "agent_request_entry") {
-                        //	json = json11::Json::object { { s, get_value<agent_request_entry>(s) } };
-                    } else if (type == "agentstruc") {
-                        json = json11::Json::object { { s, get_value<agentstruc>(s) } };
-                    } else if (type == "attstruc") {
-                        json = json11::Json::object { { s, get_value<Convert::attstruc>(s) } };
-                    } else if (type == "beatstruc") {
-                        json = json11::Json::object { { s, get_value<beatstruc>(s) } };
-                    } else if (type == "cartpos") {
-                        json = json11::Json::object { { s, get_value<Convert::cartpos>(s) } };
-                    } else if (type == "cosmosstruc") {
-                        json = json11::Json::object { { s, get_value<cosmosstruc>(s) } };
-                    } else if (type == "cvector") {
-                        json = json11::Json::object { { s, get_value<cvector>(s) } };
-                    } else if (type == "devicestruc") {
-                        json = json11::Json::object { { s, get_value<devicestruc>(s) } };
-                    } else if (type == "devspecstruc") {
-                        json = json11::Json::object { { s, get_value<devspecstruc>(s) } };
-                    } else if (type == "equationstruc") {
-                        json = json11::Json::object { { s, get_value<equationstruc>(s) } };
-                    } else if (type == "sim_param") {
-                        json = json11::Json::object { { s, get_value<sim_param>(s) } };
-                    } else if (type == "sim_state") {
-                        json = json11::Json::object { { s, get_value<sim_state>(s) } };
-                    } else if (type == "eventstruc") {
-                        json = json11::Json::object { { s, get_value<eventstruc>(s) } };
-                    } else if (type == "extraatt") {
-                        json = json11::Json::object { { s, get_value<Convert::extraatt>(s) } };
-                    } else if (type == "extrapos") {
-                        json = json11::Json::object { { s, get_value<Convert::extrapos>(s) } };
-                    } else if (type == "face") {
-                        json = json11::Json::object { { s, get_value<Cosmos::wavefront::face>(s) } };
-                    } else if (type == "facestruc") {
-                        json = json11::Json::object { { s, get_value<facestruc>(s) } };
-                    } else if (type == "geoidpos") {
-                        json = json11::Json::object { { s, get_value<Convert::geoidpos>(s) } };
-                    } else if (type == "group") {
-                        json = json11::Json::object { { s, get_value<Cosmos::wavefront::group>(s) } };
-                    } else if (type == "gvector") {
-                        json = json11::Json::object { { s, get_value<gvector>(s) } };
-                    } else if (type == "line") {
-                        json = json11::Json::object { { s, get_value<Cosmos::wavefront::line>(s) } };
-                    } else if (type == "jsonhandle") {
-                        json = json11::Json::object { { s, get_value<jsonhandle>(s) } };
-                    } else if (type == "jsonnode") {
-                        json = json11::Json::object { { s, get_value<jsonnode>(s) } };
-                    } else if (type == "locstruc") {
-                        json = json11::Json::object { { s, get_value<Convert::locstruc>(s) } };
-                    } else if (type == "material") {
-                        json = json11::Json::object { { s, get_value<Cosmos::wavefront::material>(s) } };
-                    } else if (type == "NetworkType") {
-                        //	json = json11::Json::object { { s, get_value<NetworkType>(s) } };
-                    } else if (type == "nodestruc") {
-                        json = json11::Json::object { { s, get_value<nodestruc>(s) } };
-                    } else if (type == "piecestruc") {
-                        json = json11::Json::object { { s, get_value<piecestruc>(s) } };
-                    } else if (type == "physicsstruc") {
-                        json = json11::Json::object { { s, get_value<physicsstruc>(s) } };
-                    } else if (type == "point") {
-                        json = json11::Json::object { { s, get_value<Cosmos::wavefront::point>(s) } };
-                    } else if (type == "portstruc") {
-                        json = json11::Json::object { { s, get_value<portstruc>(s) } };
-                    } else if (type == "PORT_TYPE") {
-                        json = json11::Json::object { { s, get_value<PORT_TYPE>(s) } };
-                    } else if (type == "posstruc") {
-                        json = json11::Json::object { { s, get_value<Convert::posstruc>(s) } };
-                    } else if (type == "qatt") {
-                        json = json11::Json::object { { s, get_value<Convert::qatt>(s) } };
-                    } else if (type == "quaternion") {
-                        json = json11::Json::object { { s, get_value<quaternion>(s) } };
-                    } else if (type == "rmatrix") {
-                        json = json11::Json::object { { s, get_value<rmatrix>(s) } };
-                    } else if (type == "rvector") {
-                        json = json11::Json::object { { s, get_value<rvector>(s) } };
-                    } else if (type == "rvector[]") {
-                        //	json = json11::Json::object { { s, get_value<rvector[]>(s) } };
-                    } else if (type == "socket_channel") {
-                        //	json = json11::Json::object { { s, get_value<socket_channel>(s) } };
-                    } else if (type == "socket_channel[]") {
-                        //	json = json11::Json::object { { s, get_value<socket_channel[]>(s) } };
-                    } else if (type == "spherpos") {
-                        json = json11::Json::object { { s, get_value<Convert::spherpos>(s) } };
-                    } else if (type == "svector") {
-                        json = json11::Json::object { { s, get_value<svector>(s) } };
-                    } else if (type == "targetstruc") {
-                        json = json11::Json::object { { s, get_value<targetstruc>(s) } };
-                    } else if (type == "tlestruc") {
-                        json = json11::Json::object { { s, get_value<Convert::tlestruc>(s) } };
-                    } else if (type == "trianglestruc") {
-                        json = json11::Json::object { { s, get_value<trianglestruc>(s) } };
-                    } else if (type == "unitstruc") {
-                        json = json11::Json::object { { s, get_value<unitstruc>(s) } };
-                    } else if (type == "userstruc") {
-                        json = json11::Json::object { { s, get_value<userstruc>(s) } };
-                    } else if (type == "Vector") {
-                        json = json11::Json::object { { s, get_value<Vector>(s) } };
-                    } else if (type == "vertexstruc") {
-                        json = json11::Json::object { { s, get_value<vertexstruc>(s) } };
-                    } else if (type == "wavefront") {
-                        json = json11::Json::object { { s, get_value<wavefront>(s) } };
-                    } else if (type == "sim_param") {
-                        json = json11::Json::object { { s, get_value<sim_param>(s) } };
-                    } else if (type == "sim_state") {
-                        json = json11::Json::object { { s, get_value<sim_state>(s) } };
-
-                        // vector of primitives
-                    } else if (type == "vector<uint32_t>") {
-                        json = json11::Json::object { { s, get_value<vector<int> >(s) } };
-                    } else if (type == "vector<vector<uint32_t>>") {
-                        json = json11::Json::object { { s, get_value<vector<vector<int> > >(s) } };
-                    } else if (type == "vector<int32_t>") {
-                        json = json11::Json::object { { s, get_value<vector<int32_t> >(s) } };
-                    } else if (type == "vector<vector<int32_t>>") {
-                        json = json11::Json::object { { s, get_value<vector<vector<int32_t> > >(s) } };
-                    } else if (type == "vector<uint16_t>") {
-                        json = json11::Json::object { { s, get_value<vector<uint16_t> >(s) } };
-                    } else if (type == "vector<vector<uint16_t>>") {
-                        json = json11::Json::object { { s, get_value<vector<vector<uint16_t> > >(s) } };
-                    } else if (type == "vector<int16_t>") {
-                        json = json11::Json::object { { s, get_value<vector<int16_t> >(s) } };
-                    } else if (type == "vector<vector<int16_t>>") {
-                        json = json11::Json::object { { s, get_value<vector<vector<int16_t> > >(s) } };
-                    } else if (type == "vector<uint8_t>") {
-                        json = json11::Json::object { { s, get_value<vector<uint8_t> >(s) } };
-                    } else if (type == "vector<vector<uint8_t>>") {
-                        json = json11::Json::object { { s, get_value<vector<vector<uint8_t> > >(s) } };
-                    } else if (type == "vector<int8_t>") {
-                        json = json11::Json::object { { s, get_value<vector<int8_t> >(s) } };
-                    } else if (type == "vector<vector<int8_t>>") {
-                        json = json11::Json::object { { s, get_value<vector<vector<int8_t> > >(s) } };
-                    } else if (type == "vector<int>") {
-                        json = json11::Json::object { { s, get_value<vector<int> >(s) } };
-                    } else if (type == "vector<vector<int>>") {
-                        json = json11::Json::object { { s, get_value<vector<vector<int> > >(s) } };
-                    } else if (type == "vector<size_t>") {
-                        json = json11::Json::object { { s, get_value<vector<int> >(s) } };
-                    } else if (type == "vector<vector<size_t>>") {
-                        json = json11::Json::object { { s, get_value<vector<vector<int> > >(s) } };
-                    } else if (type == "vector<bool>") {
-                        json = json11::Json::object { { s, get_value<vector<bool> >(s) } };
-                    } else if (type == "vector<vector<bool>>") {
-                        json = json11::Json::object { { s, get_value<vector<vector<bool> > >(s) } };
-                    } else if (type == "vector<string>") {
-                        json = json11::Json::object { { s, get_value<vector<string> >(s) } };
-                    } else if (type == "vector<vector<string>>") {
-                        json = json11::Json::object { { s, get_value<vector<vector<string> > >(s) } };
-                    } else if (type == "vector<float>") {
-                        json = json11::Json::object { { s, get_value<vector<float> >(s) } };
-                    } else if (type == "vector<vector<float>>") {
-                        json = json11::Json::object { { s, get_value<vector<vector<float> > >(s) } };
-                    } else if (type == "vector<double>") {
-                        json = json11::Json::object { { s, get_value<vector<double> >(s) } };
-                    } else if (type == "vector<vector<double>>") {
-                        json = json11::Json::object { { s, get_value<vector<vector<double> > >(s) } };
-
-                        // vector of user-defined types
-                    } else if (type == "vector<agent_request_entry>") {
-                        //	json = json11::Json::object { { s, get_value<vector<agent_request_entry> >(s) } };
-                    } else if (type == "vector<agentstruc>") {
-                        json = json11::Json::object { { s, get_value<vector<agentstruc> >(s) } };
-                    } else if (type == "vector<devicestruc>") {
-                        json = json11::Json::object { { s, get_value<vector<devicestruc> >(s) } };
-                    } else if (type == "vector<devicestruc*>") {
-                        json = json11::Json::object { { s, get_ivalue<vector<devicestruc> > (s) } };
-                    } else if (type == "vector<equationstruc>") {
-                        json = json11::Json::object { { s, get_value<vector<equationstruc> >(s) } };
-                    } else if (type == "vector<sim_param>") {
-                        json = json11::Json::object { { s, get_value<vector<sim_param> >(s) } };
-                    } else if (type == "vector<sim_state>") {
-                        json = json11::Json::object { { s, get_value<vector<sim_state> >(s) } };
-                    } else if (type == "vector<eventstruc>") {
-                        json = json11::Json::object { { s, get_value<vector<eventstruc> >(s) } };
-                    } else if (type == "vector<face>") {
-                        json = json11::Json::object { { s, get_value<vector<Cosmos::wavefront::face> >(s) } };
-                    } else if (type == "vector<facestruc>") {
-                        json = json11::Json::object { { s, get_value<vector<facestruc> >(s) } };
-                    } else if (type == "vector<group>") {
-                        json = json11::Json::object { { s, get_value<vector<Cosmos::wavefront::group> >(s) } };
-                    } else if (type == "vector<line>") {
-                        json = json11::Json::object { { s, get_value<vector<Cosmos::wavefront::line> >(s) } };
-                    } else if (type == "vector<material>") {
-                        json = json11::Json::object { { s, get_value<vector<Cosmos::wavefront::material> >(s) } };
-                    } else if (type == "vector<piecestruc>") {
-                        json = json11::Json::object { { s, get_value<vector<piecestruc> >(s) } };
-                    } else if (type == "vector<point>") {
-                        json = json11::Json::object { { s, get_value<vector<Cosmos::wavefront::point> >(s) } };
-                    } else if (type == "vector<portstruc>") {
-                        json = json11::Json::object { { s, get_value<vector<portstruc> >(s) } };
-                    } else if (type == "vector<targetstruc>") {
-                        json = json11::Json::object { { s, get_value<vector<targetstruc> >(s) } };
-                    } else if (type == "vector<Convert::tlestruc>") {
-                        json = json11::Json::object { { s, get_value<vector<Convert::tlestruc> >(s) } };
-                    } else if (type == "vector<trianglestruc>") {
-                        json = json11::Json::object { { s, get_value<vector<trianglestruc> >(s) } };
-                    } else if (type == "vector<unitstruc>") {
-                        json = json11::Json::object { { s, get_value<vector<unitstruc> >(s) } };
-                    } else if (type == "vector<userstruc>") {
-                        json = json11::Json::object { { s, get_value<vector<userstruc> >(s) } };
-                    } else if (type == "vector<Vector>") {
-                        json = json11::Json::object { { s, get_value<vector<Vector> >(s) } };
-                    } else if (type == "vector<vector<unitstruc>>") {
-                        json = json11::Json::object { { s, get_value<vector<vector<unitstruc> > >(s) } };
-                    } else if (type == "vector<vertexstruc>") {
-                        json = json11::Json::object { { s, get_value<vector<vertexstruc> >(s) } };
-                    } else if (type == "vector<sim_param>") {
-                        json = json11::Json::object { { s, get_value<vector<sim_param> >(s) } };
-                    } else if (type == "vector<sim_state>") {
-                        json = json11::Json::object { { s, get_value<vector<sim_state> >(s) } };
+                    const name_handler* handler = get_type_handler(it->second.tag);
+                    if(handler != nullptr && handler->to_json != nullptr)	{
+                        json = json11::Json::object { { s, handler->to_json(it->second.ptr) } };
                     }
                     return json.dump();
                 } else {
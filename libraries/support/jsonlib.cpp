@@ -438,6 +438,7 @@ void json_init_reserve(cosmosstruc* cinfo) {
     cinfo->pieces.clear();
     cinfo->device.clear();
     cinfo->target.clear();
+    cinfo->target_index = targetindex();
 
     cinfo->sim_states.clear();
     //    cinfo->sim_states.reserve(MAX_NUMBER_OF_SATELLITES);
@@ -5187,6 +5188,51 @@ double json_equation(jsonhandle *handle, cosmosstruc *cinfo)
     return(json_equation(&cinfo->emap[handle->hash][handle->index], cinfo));
 }
 
+//! Perform one JSON equation operation
+/*! Apply a JSON_OPERATION_* to its two operands. Unary operations use only the first.
+    \param operation Operation to perform.
+    \param a0 First operand.
+    \param a1 Second operand.
+    \return Result of the operation, or NAN.
+*/
+static double json_equation_operation(uint16_t operation, double a0, double a1)
+{
+    switch(operation)
+    {
+    case JSON_OPERATION_NOT:
+        return !static_cast<bool>(a0);
+    case JSON_OPERATION_COMPLEMENT:
+        return ~static_cast<uint32_t>(a0);
+    case JSON_OPERATION_ADD:
+        return a0 + a1;
+    case JSON_OPERATION_SUBTRACT:
+        return a0 - a1;
+    case JSON_OPERATION_MULTIPLY:
+        return a0 * a1;
+    case JSON_OPERATION_DIVIDE:
+        return a0 / a1;
+    case JSON_OPERATION_MOD:
+        return fmod(a0, a1);
+    case JSON_OPERATION_AND:
+        return static_cast<int>(a0) && static_cast<int>(a1);
+    case JSON_OPERATION_OR:
+        return static_cast<int>(a0) || static_cast<int>(a1);
+    case JSON_OPERATION_GT:
+        return a0 > a1;
+    case JSON_OPERATION_LT:
+        return a0 < a1;
+    case JSON_OPERATION_EQ:
+        return fabs(a0 - a1) < std::numeric_limits<double>::epsilon();
+    case JSON_OPERATION_POWER:
+        return pow(a0, a1);
+    case JSON_OPERATION_BITWISEAND:
+        return static_cast<int>(a0) & static_cast<int>(a1);
+    case JSON_OPERATION_BITWISEOR:
+        return static_cast<int>(a0) | static_cast<int>(a1);
+    }
+    return NAN;
+}
+
 //! Return the results of a known JSON equation entry
 /*! Calculate a ::json_equation using already looked up entry from the map.
     \param ptr Pointer to a ::jsonequation from the map.
@@ -5197,7 +5243,7 @@ double json_equation(jsonhandle *handle, cosmosstruc *cinfo)
 */
 double json_equation(jsonequation *ptr, cosmosstruc *cinfo)
 {
-    double a[2]={0.,0.}, c=NAN;
+    double a[2]={0.,0.};
 
     for (uint16_t i=0; i<2; ++i)
     {
@@ -5217,55 +5263,150 @@ double json_equation(jsonequation *ptr, cosmosstruc *cinfo)
         }
     }
 
-    switch(ptr->operation)
+    return json_equation_operation(ptr->operation, a[0], a[1]);
+}
+
+//! Flatten a JSON equation entry into program steps
+/*! Append the steps for both operands, then the operation, keeping track of how deep the
+ * stack gets.
+    \param equation ::jsonequation from the map.
+    \param cinfo Reference to ::cosmosstruc to use.
+    \param program ::jsonprogram to append to.
+    \param height Height of the stack before these steps.
+    \return Zero, otherwise negative error.
+*/
+static int32_t json_equation_flatten(const jsonequation &equation, cosmosstruc *cinfo, jsonprogram &program, uint16_t height)
+{
+    int32_t iretn = 0;
+
+    for (uint16_t i=0; i<2; ++i)
     {
-    case JSON_OPERATION_NOT:
-        c = !static_cast<bool>(a[0]);
-        break;
-    case JSON_OPERATION_COMPLEMENT:
-        c = ~static_cast<uint32_t>(a[0]);
-        break;
-    case JSON_OPERATION_ADD:
-        c = a[0] + a[1];
-        break;
-    case JSON_OPERATION_SUBTRACT:
-        c = a[0] - a[1];
-        break;
-    case JSON_OPERATION_MULTIPLY:
-        c = a[0] * a[1];
-        break;
-    case JSON_OPERATION_DIVIDE:
-        c = a[0] / a[1];
-        break;
-    case JSON_OPERATION_MOD:
-        c = fmod(a[0], a[1]);
-        break;
-    case JSON_OPERATION_AND:
-        c = static_cast<int>(a[0]) && static_cast<int>(a[1]);
-        break;
-    case JSON_OPERATION_OR:
-        c = static_cast<int>(a[0]) || static_cast<int>(a[1]);
-        break;
-    case JSON_OPERATION_GT:
-        c = a[0] > a[1];
-        break;
-    case JSON_OPERATION_LT:
-        c = a[0] < a[1];
-        break;
-    case JSON_OPERATION_EQ:
-        c = fabs(a[0] - a[1]) < std::numeric_limits<double>::epsilon();
-        break;
-    case JSON_OPERATION_POWER:
-        c = pow(a[0], a[1]);
-        break;
-    case JSON_OPERATION_BITWISEAND:
-        c = static_cast<int>(a[0]) & static_cast<int>(a[1]);
-        break;
-    case JSON_OPERATION_BITWISEOR:
-        c = static_cast<int>(a[0]) | static_cast<int>(a[1]);
+        if (height + i >= JSON_MAX_EQUATION_STACK)
+        {
+            return JSON_ERROR_INDEX_SIZE;
+        }
+        jsonstep step;
+        step.operation = 0;
+        switch(equation.operand[i].type)
+        {
+        case JSON_OPERAND_EQUATION:
+            if ((iretn=json_equation_flatten(cinfo->emap[equation.operand[i].data.hash][equation.operand[i].data.index], cinfo, program, height + i)) < 0)
+            {
+                return iretn;
+            }
+            continue;
+        case JSON_OPERAND_NAME:
+            step.type = JSON_OPERAND_NAME;
+            step.data = equation.operand[i].data;
+            break;
+        case JSON_OPERAND_CONSTANT:
+            step.type = JSON_OPERAND_CONSTANT;
+            step.value = equation.operand[i].value;
+            break;
+        default:
+            step.type = JSON_OPERAND_CONSTANT;
+            step.value = 0.;
+            break;
+        }
+        program.steps.push_back(step);
+        if (height + i + 1 > program.depth)
+        {
+            program.depth = height + i + 1;
+        }
+    }
+
+    jsonstep step;
+    step.type = JSON_OPERAND_EQUATION;
+    step.operation = equation.operation;
+    step.value = 0.;
+    program.steps.push_back(step);
+
+    return 0;
+}
+
+//! Compile a JSON equation
+/*! Parse the next JSON equation out of a JSON stream, as for ::json_equation, and flatten it
+ * into a ::jsonprogram that can be calculated with ::json_equation without any parsing or
+ * lookups. Names refer to their place in ::cosmosstruc::jmap, which only ever grows, so the
+ * program stays good for as long as the ::cosmosstruc does.
+    \param ptr Pointer to a pointer to a JSON stream.
+    \param cinfo Reference to ::cosmosstruc to use.
+    \param program ::jsonprogram to fill. It is left empty if the equation is bad.
+    \return Number of steps, otherwise negative error.
+*/
+int32_t json_equation_compile(const char* &ptr, cosmosstruc *cinfo, jsonprogram &program)
+{
+    int32_t iretn = 0;
+    jsonhandle handle;
+
+    program.steps.clear();
+    program.depth = 0;
+    program.text.clear();
+
+    if ((iretn=json_parse_equation(ptr, program.text)) < 0)
+    {
+        return iretn;
+    }
+
+    if (cinfo->emap.size() == 0)
+    {
+        return JSON_ERROR_NOJMAP;
+    }
+
+    if ((iretn=json_equation_map(program.text, cinfo, &handle)) < 0)
+    {
+        return iretn;
+    }
+
+    if ((iretn=json_equation_flatten(cinfo->emap[handle.hash][handle.index], cinfo, program, 0)) < 0)
+    {
+        program.steps.clear();
+        program.depth = 0;
+        return iretn;
+    }
+
+    return static_cast<int32_t>(program.steps.size());
+}
+
+//! Return the results of a compiled JSON equation
+/*! Calculate a ::jsonprogram made by ::json_equation_compile. Nothing is parsed, looked up
+ * or allocated.
+    \param program ::jsonprogram to calculate.
+    \param cinfo Reference to ::cosmosstruc it was compiled against.
+    \return Result of the equation, or NAN.
+*/
+double json_equation(const jsonprogram &program, cosmosstruc *cinfo)
+{
+    double stack[JSON_MAX_EQUATION_STACK];
+    uint16_t height = 0;
+
+    if (program.steps.empty())
+    {
+        return NAN;
     }
 
-    return (c);
+    for (const jsonstep &step : program.steps)
+    {
+        switch(step.type)
+        {
+        case JSON_OPERAND_CONSTANT:
+            stack[height++] = step.value;
+            break;
+        case JSON_OPERAND_NAME:
+            if (step.data.index >= cinfo->jmap[step.data.hash].size())
+            {
+                return NAN;
+            }
+            stack[height++] = json_get_double(cinfo->jmap[step.data.hash][step.data.index], cinfo);
+            break;
+        case JSON_OPERAND_EQUATION:
+            --height;
+            stack[height-1] = json_equation_operation(step.operation, stack[height-1], stack[height]);
+            break;
+        }
+    }
+
+    return stack[0];
 }
 
 //! Extract JSON value matching name.
@@ -7249,6 +7390,7 @@ int32_t json_clear_cosmosstruc(int32_t type, cosmosstruc *cinfo)
         break;
     case JSON_STRUCT_TARGET:
         cinfo->target.clear();
+        cinfo->target_index.clear();
         break;
     case JSON_STRUCT_TLE:
         cinfo->tle.clear();
@@ -8572,6 +8714,7 @@ int32_t json_setup_realm(string &realm, cosmosstruc *cinfo)
         cinfo->target.push_back(targ);
     }
     fclose(fp);
+    cinfo->target_index.clear();
     return cinfo->target.size();
 }
 
@@ -8707,6 +8850,7 @@ int32_t json_clone_node(cosmosstruc *source, cosmosstruc *destination)
     destination->target_idx = source->target_idx;
     destination->target.clear();
     destination->target = source->target;
+    destination->target_index.clear();
     if (destination->target.size() != destination->target_cnt)
     {
         return (AGENT_ERROR_MEMORY);
@@ -10864,7 +11008,7 @@ const char *json_of_list(string &jstring, string list, cosmosstruc *cinfo)
     \param cinfo Reference to ::cosmosstruc to use.
     \return Pointer to the string if successful, otherwise nullptr.
 */
-const char *json_of_table(string &jstring, vector<jsonentry*> table, cosmosstruc *cinfo)
+const char *json_of_table(string &jstring, const vector<jsonentry*> &table, cosmosstruc *cinfo)
 {
     jstring.clear();
     for (auto entry: table)
@@ -10878,6 +11022,147 @@ const char *json_of_table(string &jstring, vector<jsonentry*> table, cosmosstruc
     return jstring.data();
 }
 
+// Value formatters for ::json_compile_table, matching the json_out_ functions for each type
+static size_t json_format_uint8(char *tstring, const uint8_t *data)
+{
+    return sprintf(tstring, "%u", *(uint8_t *)data);
+}
+
+static size_t json_format_uint16(char *tstring, const uint8_t *data)
+{
+    return sprintf(tstring, "%u", *(uint16_t *)data);
+}
+
+static size_t json_format_uint32(char *tstring, const uint8_t *data)
+{
+    return sprintf(tstring, "%u", *(uint32_t *)data);
+}
+
+static size_t json_format_int8(char *tstring, const uint8_t *data)
+{
+    return sprintf(tstring, "%" PRIi8, *(int8_t *)data);
+}
+
+static size_t json_format_int16(char *tstring, const uint8_t *data)
+{
+    return sprintf(tstring, "%d", *(int16_t *)data);
+}
+
+static size_t json_format_int32(char *tstring, const uint8_t *data)
+{
+    return sprintf(tstring, "%d", *(int32_t *)data);
+}
+
+static size_t json_format_float(char *tstring, const uint8_t *data)
+{
+    float value = *(float *)data;
+    return sprintf(tstring, "%.8g", isfinite(value) ? value : 0.f);
+}
+
+static size_t json_format_double(char *tstring, const uint8_t *data)
+{
+    double value = *(double *)data;
+    return sprintf(tstring, "%.17g", isfinite(value) ? value : 0.);
+}
+
+//! Compile JSON table
+/*! Resolve a table of ::jsonentry, as made by ::json_table_of_list, into a ::jsontemplate
+ * for repeated output with ::json_of_template.
+    \param jtemplate ::jsontemplate to fill.
+    \param table Vector of pointers to ::jsonentry. Empty entries are left out.
+    \param cinfo Reference to ::cosmosstruc to use.
+    \return Number of fields, otherwise negative error.
+*/
+int32_t json_compile_table(jsontemplate &jtemplate, const vector<jsonentry*> &table, cosmosstruc *cinfo)
+{
+    jtemplate.fields.clear();
+    for (auto entry: table)
+    {
+        if (entry == nullptr)
+        {
+            continue;
+        }
+        jsontemplate::field field;
+        field.entry = entry;
+        json_out_name(field.prefix, entry->name);
+        switch (entry->type)
+        {
+        case JSON_TYPE_BOOL:
+        case JSON_TYPE_UINT8:
+            field.format = json_format_uint8;
+            break;
+        case JSON_TYPE_UINT16:
+            field.format = json_format_uint16;
+            break;
+        case JSON_TYPE_UINT32:
+            field.format = json_format_uint32;
+            break;
+        case JSON_TYPE_INT8:
+            field.format = json_format_int8;
+            break;
+        case JSON_TYPE_INT16:
+            field.format = json_format_int16;
+            break;
+        case JSON_TYPE_INT32:
+            field.format = json_format_int32;
+            break;
+        case JSON_TYPE_FLOAT:
+            field.format = json_format_float;
+            break;
+        case JSON_TYPE_DOUBLE:
+        case JSON_TYPE_TIMESTAMP:
+            field.format = json_format_double;
+            break;
+        default:
+            field.format = nullptr;
+            break;
+        }
+        jtemplate.fields.push_back(field);
+    }
+    return jtemplate.fields.size();
+}
+
+//! Create JSON stream from compiled table
+/*! Fill the supplied string with the values of each field of a ::jsontemplate, giving the same
+ * result as ::json_of_table on the table it was compiled from. The string is cleared but keeps
+ * its capacity, so repeated calls with the same string need not allocate.
+    \param jstring Reference to string to fill.
+    \param jtemplate ::jsontemplate from ::json_compile_table.
+    \param cinfo Reference to ::cosmosstruc to use.
+    \return Pointer to the string.
+*/
+const char *json_of_template(string &jstring, const jsontemplate &jtemplate, cosmosstruc *cinfo)
+{
+    char tstring[40];
+
+    jstring.clear();
+    for (const jsontemplate::field &field : jtemplate.fields)
+    {
+        uint8_t *data = json_ptr_of_entry(*field.entry, cinfo);
+        if (data == nullptr)
+        {
+            continue;
+        }
+        size_t mark = jstring.size();
+        jstring += jstring.empty() ? '{' : ',';
+        jstring += field.prefix;
+        if (field.format != nullptr)
+        {
+            jstring.append(tstring, field.format(tstring, data));
+        }
+        else if (json_out_type(jstring, data, field.entry->type, cinfo) < 0)
+        {
+            jstring.resize(mark);
+        }
+    }
+    if (!jstring.empty())
+    {
+        jstring += '}';
+    }
+
+    return jstring.data();
+}
+
 //! Create JSON Track string
 /*! Generate a JSON stream showing the variables stored in an ::nodestruc.
     \param jstring Pointer to a string large enough to hold the end result.
@@ -13892,6 +14177,7 @@ int32_t load_target(cosmosstruc *cinfo)
         //JIMNOTE:  take away this resize
         //EJPNOTE: keep the resize, when combined with the original resize it keeps the pointers from being changed
         cinfo->target.resize(count);
+        cinfo->target_index.clear();
         return (count);
     }
     else
@@ -13954,34 +14240,88 @@ int32_t load_tle(cosmosstruc *cinfo)
     return GENERAL_ERROR_BAD_FD;
 }
 
-//! Update Track list
-/*! For each entry in the Track list, calculate the azimuth, elevation and range to and
- *from the current base location.
-    \param cinfo Reference to ::cosmosstruc to use.
- *	\return 0, otherwise negative error.
- */
-int32_t update_target(cosmosstruc *cinfo)
+//! Size of the cells of ::targetindex (radians)
+static const double target_cellsize = DPI / 180.;
+static const uint32_t target_rows = 180;
+static const uint32_t target_columns = 360;
+//! Allowance for the difference between geodetic and geocentric directions (radians)
+static const double target_margin = DPI / 180.;
+
+static uint32_t target_row(double lat)
 {
-    int32_t iretn = 0;
-    //    rvector topo, dv, ds;
-    for (uint32_t i=0; i<cinfo->target.size(); ++i)
+    int32_t row = static_cast<int32_t>(floor((lat + DPI2) / target_cellsize));
+    return static_cast<uint32_t>(std::min(std::max(row, 0), static_cast<int32_t>(target_rows) - 1));
+}
+
+static uint32_t target_column(double lon)
+{
+    lon = fmod(lon, D2PI);
+    if (lon < 0.)
     {
-        iretn = update_target(cinfo->node.loc, cinfo->target[i]);
+        lon += D2PI;
     }
-    return iretn;
+    return std::min(static_cast<uint32_t>(lon / target_cellsize), target_columns - 1);
+}
+
+static rvector target_unit(const gvector &geod)
+{
+    return rvector(cos(geod.lat) * cos(geod.lon), cos(geod.lat) * sin(geod.lon), sin(geod.lat));
 }
 
-int32_t update_target(Convert::locstruc source, targetstruc &target)
+//! Look from a source to a point of a target
+/*! Calculate bearing, distance, azimuth, elevation, range and closing speed between the
+ * source and the given location of the target, and the attitude needed to point at it.
+ */
+static int32_t update_target_look(const Convert::locstruc &source, targetstruc &target, const Convert::locstruc &tloc)
 {
     rvector topo, dv, ds;
-    Convert::locstruc targetloc;
 
-    target.loc.pos.geod.utc = source.pos.geod.utc;
-    target.loc.pos.geod.pass++;
-    Convert::loc_update(target.loc);
-    targetloc = target.loc;
+    // Calculate bearing and distance
+    double dx = cos(tloc.pos.geod.s.lat) * sin(tloc.pos.geod.s.lon - source.pos.geod.s.lon);
+    double dy = cos(source.pos.geod.s.lat) * sin(tloc.pos.geod.s.lat) - sin(source.pos.geod.s.lat) * cos(tloc.pos.geod.s.lat) * cos(tloc.pos.geod.s.lon - source.pos.geod.s.lon);
+    target.bearing = atan2(dy, dx);
+    target.distance = sep_rv(source.pos.geoc.s, tloc.pos.geoc.s);
+
+    Convert::geoc2topo(tloc.pos.geod.s, source.pos.geoc.s,topo);
+    Convert::topo2azel(topo, target.azto, target.elto);
+    if (target.elto <= 0.)
+    {
+        target.maxelto = target.elto;
+    }
+    else if (target.elto > target.maxelto)
+    {
+        target.maxelto = target.elto;
+    }
+
+    Convert::geoc2topo(source.pos.geod.s, tloc.pos.geoc.s, topo);
+    Convert::topo2azel(topo, target.azfrom, target.elfrom);
+    // Calculate direct vector from source to target
+    ds = rv_sub(tloc.pos.geoc.s, source.pos.geoc.s);
+    target.range = length_rv(ds);
+    // Calculate velocity of target WRT source
+    dv = rv_sub(tloc.pos.geoc.v, source.pos.geoc.v);
+    // Closing speed is length of ds in 1 second minus length of ds now.
+    target.close = length_rv(rv_sub(ds,dv)) - length_rv(ds);
+    target.utc = tloc.utc;
+
+    // Attitude the satellite has to have to look at the target
+    rvector targ_z = (rv_sub(target.loc.pos.eci.s, source.pos.eci.s));
+    // targ_z = source.pos.geoc.s * -0.1;
+
+    target.loc.att.icrf.s = q_irotate_for(rv_normal(targ_z), rv_normal(rv_cross(rv_normal(targ_z), source.pos.eci.v)), rv_unitz(), rv_unity());
+    return 0;
+}
+
+//! Update the view of a target from a source
+/*! Calculate the azimuth, elevation and range to and from the source location for a target
+ * whose position has already been brought up to the time of the source. Area targets are
+ * seen at the point nearest the source.
+ */
+static int32_t update_target_view(const Convert::locstruc &source, targetstruc &target)
+{
     if (target.size.lat)
     {
+        Convert::locstruc targetloc = target.loc;
         if (source.pos.geod.s.lon >= fixangle(target.loc.pos.geod.s.lon - target.size.lon / 2., false) && source.pos.geod.s.lon <= fixangle(target.loc.pos.geod.s.lon + target.size.lon / 2., false))
         {
             targetloc.pos.geod.s.lon = source.pos.geod.s.lon;
@@ -14033,47 +14373,226 @@ int32_t update_target(Convert::locstruc source, targetstruc &target)
             target.min = 0.;
             target.utc = targetloc.utc;
         }
+        return update_target_look(source, target, targetloc);
     }
-    else
+
+    target.min = 0.;
+    target.utc = target.loc.utc;
+    return update_target_look(source, target, target.loc);
+}
+
+//! Update a stationary target
+/*! Bring a target that does not move on the Earth up to the time of the source. Its
+ * geodetic and geocentric positions were found once, when it was indexed, so only its
+ * inertial position is turned with the Earth.
+ */
+static int32_t update_stationary_target(const Convert::locstruc &source, targetstruc &target)
+{
+    double utc = source.pos.geod.utc;
+    int32_t iretn = Convert::pos_extra(utc, target.loc);
+    if (iretn < 0)
     {
-        target.min = 0.;
-        target.utc = targetloc.utc;
+        return iretn;
     }
+    Convert::posstruc &pos = target.loc.pos;
+    target.loc.utc = pos.utc = pos.geod.utc = pos.geoc.utc = pos.eci.utc = utc;
+    pos.eci.s = rv_mmult(pos.extra.e2j, pos.geoc.s);
+    pos.eci.v = rv_add(rv_mmult(pos.extra.e2j, pos.geoc.v), rv_mmult(pos.extra.de2j, pos.geoc.s));
+    pos.eci.a = rv_add(rv_add(rv_mmult(pos.extra.e2j, pos.geoc.a), rv_smult(2., rv_mmult(pos.extra.de2j, pos.geoc.v))), rv_mmult(pos.extra.dde2j, pos.geoc.s));
+    return update_target_view(source, target);
+}
 
-    // Calculate bearing and distance
-    double dx = cos(targetloc.pos.geod.s.lat) * sin(targetloc.pos.geod.s.lon - source.pos.geod.s.lon);
-    double dy = cos(source.pos.geod.s.lat) * sin(targetloc.pos.geod.s.lat) - sin(source.pos.geod.s.lat) * cos(targetloc.pos.geod.s.lat) * cos(targetloc.pos.geod.s.lon - source.pos.geod.s.lon);
-    target.bearing = atan2(dy, dx);
-    target.distance = sep_rv(source.pos.geoc.s, targetloc.pos.geoc.s);
+//! Index the targets
+/*! Update every target in full, then sort those that stay in one place into ::targetindex.
+ * Area targets are placed by their center, and can be seen from as far beyond the horizon
+ * as half their size. Moving targets, and any larger than a cell, are left to be updated
+ * every time.
+    \param cinfo Reference to ::cosmosstruc to use.
+ *	\return 0, otherwise negative error.
+ */
+static int32_t index_target(cosmosstruc *cinfo)
+{
+    int32_t iretn = 0;
+    targetindex &index = cinfo->target_index;
+    index.count = cinfo->target.size();
+    index.base = cinfo->target.data();
+    index.entries.assign(index.count, targetindex::entry());
+    index.cells.clear();
+    index.order.clear();
+    index.always.clear();
+    index.inview.clear();
+    index.updated.clear();
+    index.maxheight = 0.;
+    index.maxreach = 0.;
+
+    vector<std::pair<uint32_t, uint32_t>> cells;
+    for (uint32_t i=0; i<index.count; ++i)
+    {
+        targetstruc &target = cinfo->target[i];
+        iretn = update_target(cinfo->node.loc, target);
+        index.updated.push_back(i);
+
+        const Convert::geoidpos &geod = target.loc.pos.geod;
+        double reach = std::max(fabs(target.size.lat), fabs(target.size.lon)) / 2.;
+        if (geod.v.lat != 0. || geod.v.lon != 0. || geod.v.h != 0. || geod.a.lat != 0. || geod.a.lon != 0. || geod.a.h != 0. || !(reach <= target_cellsize))
+        {
+            index.always.push_back(i);
+            continue;
+        }
+        targetindex::entry &entry = index.entries[i];
+        entry.geod = geod.s;
+        entry.unit = target_unit(geod.s);
+        entry.reach = reach;
+        index.maxheight = std::max(index.maxheight, geod.s.h);
+        index.maxreach = std::max(index.maxreach, reach);
+        cells.push_back(std::make_pair(target_row(geod.s.lat) * target_columns + target_column(geod.s.lon), i));
+        if (target.elto > 0.)
+        {
+            index.inview.push_back(i);
+        }
+    }
+    std::sort(cells.begin(), cells.end());
+    for (const std::pair<uint32_t, uint32_t> &cell : cells)
+    {
+        index.cells.push_back(cell.first);
+        index.order.push_back(cell.second);
+    }
+    return iretn;
+}
 
-    Convert::geoc2topo(targetloc.pos.geod.s, source.pos.geoc.s,topo);
-    Convert::topo2azel(topo, target.azto, target.elto);
-    if (target.elto <= 0.)
+//! Update Track list
+/*! For each entry in the Track list, calculate the azimuth, elevation and range to and
+ *from the current base location. If ::targetindex::cull is set, stationary targets are found
+ *through ::targetindex, and only those that could be above the horizon are updated, along
+ *with any that have just set. The rest keep the values from when they were last updated,
+ *with the target below the horizon, and ::targetindex::updated lists the targets updated.
+    \param cinfo Reference to ::cosmosstruc to use.
+ *	\return 0, otherwise negative error.
+ */
+int32_t update_target(cosmosstruc *cinfo)
+{
+    int32_t iretn = 0;
+    targetindex &index = cinfo->target_index;
+    if (!index.cull)
     {
-        target.maxelto = target.elto;
+        // Index is rebuilt if culling is turned on later
+        index.count = 0;
+        for (uint32_t i=0; i<cinfo->target.size(); ++i)
+        {
+            iretn = update_target(cinfo->node.loc, cinfo->target[i]);
+        }
+        return iretn;
     }
-    else if (target.elto > target.maxelto)
+
+    if (index.count != cinfo->target.size() || index.base != cinfo->target.data())
     {
-        target.maxelto = target.elto;
+        return index_target(cinfo);
     }
 
-    Convert::geoc2topo(source.pos.geod.s, targetloc.pos.geoc.s, topo);
-    Convert::topo2azel(topo, target.azfrom, target.elfrom);
-    // Calculate direct vector from source to target
-    ds = rv_sub(targetloc.pos.geoc.s, source.pos.geoc.s);
-    target.range = length_rv(ds);
-    // Calculate velocity of target WRT source
-    dv = rv_sub(targetloc.pos.geoc.v, source.pos.geoc.v);
-    // Closing speed is length of ds in 1 second minus length of ds now.
-    target.close = length_rv(rv_sub(ds,dv)) - length_rv(ds);
-    target.utc = targetloc.utc;
+    const Convert::locstruc &source = cinfo->node.loc;
+    double radius = length_rv(source.pos.geoc.s);
+    if (!(radius > 0.))
+    {
+        // Without a position, nothing can be ruled out
+        index.count = 0;
+        return index_target(cinfo);
+    }
 
-    // Attitude the satellite has to have to look at the target
-    rvector targ_z = (rv_sub(target.loc.pos.eci.s, source.pos.eci.s));
-    // targ_z = source.pos.geoc.s * -0.1;
+    ++index.pass;
+    index.updated.clear();
+    for (uint32_t i : index.always)
+    {
+        iretn = update_target(source, cinfo->target[i]);
+        index.updated.push_back(i);
+    }
 
-    target.loc.att.icrf.s = q_irotate_for(rv_normal(targ_z), rv_normal(rv_cross(rv_normal(targ_z), source.pos.eci.v)), rv_unitz(), rv_unity());
-    return 0;
+    // Angle from the point below the source to the farthest target that can see it
+    double rmin = REARTHM * FRATIO;
+    double horizon = acos(rmin / std::max(radius, rmin)) + acos(rmin / (rmin + std::max(index.maxheight, 0.))) + target_margin;
+    double theta = horizon + index.maxreach;
+    gvector center = source.pos.geod.s;
+    rvector unit = target_unit(center);
+
+    vector<uint32_t> inview;
+    auto visit = [&](uint32_t first, uint32_t last)
+    {
+        auto it = std::lower_bound(index.cells.begin(), index.cells.end(), first);
+        for (size_t j=it-index.cells.begin(); j<index.cells.size() && index.cells[j]<=last; ++j)
+        {
+            uint32_t i = index.order[j];
+            targetindex::entry &entry = index.entries[i];
+            if (dot_rv(entry.unit, unit) < cos(std::min(horizon + entry.reach, DPI)))
+            {
+                continue;
+            }
+            targetstruc &target = cinfo->target[i];
+            if (target.loc.pos.geod.s.lat != entry.geod.lat || target.loc.pos.geod.s.lon != entry.geod.lon || target.loc.pos.geod.s.h != entry.geod.h)
+            {
+                // Moved since it was indexed
+                index.count = 0;
+                iretn = update_target(source, target);
+            }
+            else
+            {
+                iretn = update_stationary_target(source, target);
+            }
+            entry.pass = index.pass;
+            inview.push_back(i);
+            index.updated.push_back(i);
+        }
+    };
+    if (theta >= DPI || center.lat + theta >= DPI2 || center.lat - theta <= -DPI2)
+    {
+        // Around a pole, every longitude
+        uint32_t first = theta >= DPI ? 0 : target_row(center.lat - theta);
+        uint32_t last = theta >= DPI ? target_rows - 1 : target_row(center.lat + theta);
+        visit(first * target_columns, last * target_columns + target_columns - 1);
+    }
+    else
+    {
+        double dlon = asin(std::min(sin(theta) / cos(center.lat), 1.));
+        uint32_t first = target_column(center.lon - dlon);
+        uint32_t last = target_column(center.lon + dlon);
+        for (uint32_t row=target_row(center.lat - theta); row<=target_row(center.lat + theta); ++row)
+        {
+            if (first <= last)
+            {
+                visit(row * target_columns + first, row * target_columns + last);
+            }
+            else
+            {
+                visit(row * target_columns, row * target_columns + last);
+                visit(row * target_columns + first, row * target_columns + target_columns - 1);
+            }
+        }
+    }
+
+    // Targets that have just set are updated once more, below the horizon
+    for (uint32_t i : index.inview)
+    {
+        if (index.entries[i].pass != index.pass)
+        {
+            iretn = update_stationary_target(source, cinfo->target[i]);
+            index.updated.push_back(i);
+        }
+    }
+    index.inview.swap(inview);
+    return iretn;
+}
+
+//! Update Target
+/*! Bring a target up to the time of the source, then calculate the azimuth, elevation and
+ * range to and from the source location.
+    \param source Location to view the target from.
+    \param target Target to update.
+ *	\return 0, otherwise negative error.
+ */
+int32_t update_target(const Convert::locstruc &source, targetstruc &target)
+{
+    target.loc.pos.geod.utc = source.pos.geod.utc;
+    target.loc.pos.geod.pass++;
+    Convert::loc_update(target.loc);
+    return update_target_view(source, target);
 }
 
 int32_t update_metrics(cosmosstruc *currentinfo)
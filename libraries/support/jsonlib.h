@@ -235,6 +235,8 @@ uint8_t *json_ptrto_2d(const char *token, uint16_t index1, uint16_t index2, cosm
 double json_equation(const char *&ptr, cosmosstruc *cinfo);
 double json_equation(jsonequation *ptr, cosmosstruc *cinfo); // TODO: overload with json_equation
 double json_equation(jsonhandle *handle, cosmosstruc *cinfo); // TODO: overload with json_equation
+int32_t json_equation_compile(const char *&ptr, cosmosstruc *cinfo, jsonprogram &program);
+double json_equation(const jsonprogram &program, cosmosstruc *cinfo);
 
 int32_t json_get_int(jsonhandle &handle, cosmosstruc *cinfo);
 int32_t json_get_int(string token, cosmosstruc *cinfo);
@@ -307,7 +309,9 @@ int32_t json_recenter_node(cosmosstruc *cinfo);
 
 const char *json_of_wildcard(string &jstring, string wildcard, cosmosstruc *cinfo);
 const char *json_of_list(string &jstring, string tokens, cosmosstruc *cinfo);
-const char *json_of_table(string &jstring,vector<jsonentry*> entries,cosmosstruc *cinfo);
+const char *json_of_table(string &jstring, const vector<jsonentry*> &entries, cosmosstruc *cinfo);
+int32_t json_compile_table(jsontemplate &jtemplate, const vector<jsonentry*> &entries, cosmosstruc *cinfo);
+const char *json_of_template(string &jstring, const jsontemplate &jtemplate, cosmosstruc *cinfo);
 const char *json_of_node(string &jstring, cosmosstruc *cinfo);
 const char *json_of_agent(string &jstring, cosmosstruc *cinfo);
 const char *json_of_target(string &jstring, cosmosstruc *cinfo, uint16_t num);
@@ -371,7 +375,7 @@ string lookup_node_id_name(cosmosstruc *cinfo, NODE_ID_TYPE node_id);
 
 int32_t load_target(cosmosstruc *cinfo);
 int32_t update_target(cosmosstruc *cinfo);
-int32_t update_target(Convert::locstruc source, targetstruc &target);
+int32_t update_target(const Convert::locstruc &source, targetstruc &target);
 int32_t update_metrics(cosmosstruc *currentinfo);
 size_t calc_events(vector<eventstruc> &dictionary, cosmosstruc *cinfo, vector<eventstruc> &events);
 uint16_t device_type_index(string name);
@@ -4,6 +4,154 @@
 
 namespace Cosmos {
     namespace Support {
+        constexpr uint8_t PacketComm::atsm[4];
+        constexpr uint8_t PacketComm::atsmr[4];
+        constexpr uint8_t PacketComm::satsm[4];
+
+        const std::map<PacketComm::TypeId, string> PacketComm::TypeString = {
+            {TypeId::DataObcBeacon, "Beacon"},
+            {TypeId::DataObcNop, "Nop"},
+            {TypeId::DataObcPong, "Pong"},
+            {TypeId::DataEpsResponse, "EpsResponse"},
+            {TypeId::DataRadioResponse, "RadioResponse"},
+            {TypeId::DataAdcsResponse, "AdcsResponse"},
+            {TypeId::DataObcResponse, "Response"},
+            {TypeId::DataRadioTest, "Test"},
+            {TypeId::DataObcTime, "Time"},
+            {TypeId::DataFileCommand, "FileCommand"},
+            {TypeId::DataFileMessage, "FileMessage"},
+            {TypeId::DataFileQueue, "FileQueue"},
+            {TypeId::DataFileCancel, "FileCancel"},
+            {TypeId::DataFileComplete, "FileComplete"},
+            {TypeId::DataFileReqMeta, "FileReqMeta"},
+            {TypeId::DataFileReqData, "FileReqData"},
+            {TypeId::DataFileMetaData, "FileMetaData"},
+            {TypeId::DataFileChunkData, "FileChunkData"},
+            {TypeId::DataFileReqComplete, "FileReqComplete"},
+            {TypeId::DataObcHeartbeat, "Heartbeat"},
+            {TypeId::CommandObcReset, "Reset"},
+            {TypeId::CommandObcReboot, "Reboot"},
+            {TypeId::CommandObcSendBeacon, "SendBeacon"},
+            {TypeId::CommandExecClearQueue, "ClearQueue"},
+            {TypeId::CommandObcExternalCommand, "ExternalCommand"},
+            {TypeId::CommandObcExternalTask, "ExternalTask"},
+            {TypeId::CommandObcHalt, "Halt"},
+            {TypeId::CommandRadioTest, "TestRadio"},
+            {TypeId::CommandFileListDirectory, "ListDirectory"},
+            {TypeId::CommandFileTransferFile, "TransferFile"},
+            {TypeId::CommandFileTransferNode, "TransferNode"},
+            {TypeId::CommandFileTransferRadio, "TransferRadio"},
+            {TypeId::CommandFileTransferList, "TransferList"},
+            {TypeId::CommandFileResetQueue, "FileResetQueue"},
+            {TypeId::CommandFileStopTransfer, "FileStopTransfer"},
+            {TypeId::CommandFileSendFileResponses, "SendFileResponses"},
+            {TypeId::CommandFileSaveFileProgress, "SaveFileProgress"},
+            {TypeId::CommandFileTransferDirectory, "TransferDirectory"},
+            {TypeId::CommandObcInternalRequest, "InternalRequest"},
+            {TypeId::CommandObcHeartbeat, "Heartbeat"},
+            {TypeId::CommandObcPing, "Ping"},
+            {TypeId::CommandObcSetTle, "SetTle"},
+            {TypeId::CommandObcSetTime, "SetTime"},
+            {TypeId::CommandObcGetTimeHuman, "GetTimeHuman"},
+            {TypeId::CommandObcGetTimeBinary, "GetTimeBinary"},
+            {TypeId::CommandExecSetOpsMode, "SetOpsMode"},
+            {TypeId::CommandExecEnableChannel, "EnableChannel"},
+            {TypeId::CommandAdcsCommunicate, "AdcsCommunicate"},
+            {TypeId::CommandAdcsState, "AdcsState"},
+            {TypeId::CommandAdcsSetRunMode, "AdcsSetRunMode"},
+            {TypeId::CommandAdcsGetAdcsState, "AdcsGetAdcsState"},
+            {TypeId::CommandAdcsOrbitParameters, "AdcsOrbitParameters"},
+            {TypeId::CommandEpsCommunicate, "EpsCommunicate"},
+            {TypeId::CommandEpsSwitchName, "EpsSwitchName"},
+            {TypeId::CommandEpsSwitchNumber, "EpsSwitchNumber"},
+            {TypeId::CommandEpsReset, "EpsReset"},
+            {TypeId::CommandEpsState, "EpsState"},
+            {TypeId::CommandEpsWatchdog, "EpsWatchdog"},
+            {TypeId::CommandEpsSetTime, "EpsSetTime"},
+            {TypeId::CommandEpsMinimumPower, "EpsMinimumPower"},
+            {TypeId::CommandEpsSwitchNames, "EpsSwitchNames"},
+            {TypeId::CommandEpsSwitchStatus, "EpsSwitchStatus"},
+            {TypeId::CommandExecLoadCommand, "ExecLoadCommand"},
+            {TypeId::CommandExecAddCommand, "ExecAddCommand"},
+            {TypeId::CommandRadioCommunicate, "RadioCommunicate"},
+            {TypeId::CommandRadioAstrodevCommunicate, "RadioAstrodevCommunicate"},
+            {TypeId::CommandCameraOn, "CameraOn"},
+            {TypeId::CommandCameraCapture, "CameraCapture"},
+        };
+
+        const std::map<string, PacketComm::TypeId> PacketComm::StringType = {
+            {"Beacon", TypeId::DataObcBeacon},
+            {"Nop", TypeId::DataObcNop},
+            {"Pong", TypeId::DataObcPong},
+            {"EpsResponse", TypeId::DataEpsResponse},
+            {"RadioResponse", TypeId::DataRadioResponse},
+            {"AdcsResponse", TypeId::DataAdcsResponse},
+            {"Response", TypeId::DataObcResponse},
+            {"Test", TypeId::DataRadioTest},
+            {"Time", TypeId::DataObcTime},
+
+            {"FileCommand", TypeId::DataFileCommand},
+            {"FileMessage", TypeId::DataFileMessage},
+            {"FileQueue", TypeId::DataFileQueue},
+            {"FileCancel", TypeId::DataFileCancel},
+            {"FileComplete", TypeId::DataFileComplete},
+            {"FileReqMeta", TypeId::DataFileReqMeta},
+            {"FileReqData", TypeId::DataFileReqData},
+            {"FileMetaData", TypeId::DataFileMetaData},
+            {"FileChunkData", TypeId::DataFileChunkData},
+            {"FileReqComplete", TypeId::DataFileReqComplete},
+
+            {"Heartbeat", TypeId::DataObcHeartbeat},
+
+            {"Reset", TypeId::CommandObcReset},
+            {"Reboot", TypeId::CommandObcReboot},
+            {"SendBeacon", TypeId::CommandObcSendBeacon},
+            {"ClearQueue", TypeId::CommandExecClearQueue},
+            {"ExternalCommand", TypeId::CommandObcExternalCommand},
+            {"ExternalTask", TypeId::CommandObcExternalTask},
+            {"Halt", TypeId::CommandObcHalt},
+            {"TestRadio", TypeId::CommandRadioTest},
+            {"ListDirectory", TypeId::CommandFileListDirectory},
+            {"TransferFile", TypeId::CommandFileTransferFile},
+            {"TransferNode", TypeId::CommandFileTransferNode},
+            {"TransferRadio", TypeId::CommandFileTransferRadio},
+            {"TransferList", TypeId::CommandFileTransferList},
+            {"FileResetQueue", TypeId::CommandFileResetQueue},
+            {"FileStopTransfer", TypeId::CommandFileStopTransfer},
+            {"SendFileResponses", TypeId::CommandFileSendFileResponses},
+            {"SaveFileProgress", TypeId::CommandFileSaveFileProgress},
+            {"TransferDirectory", TypeId::CommandFileTransferDirectory},
+            {"InternalRequest", TypeId::CommandObcInternalRequest},
+            {"Ping", TypeId::CommandObcPing},
+            {"SetTle", TypeId::CommandObcSetTle},
+            {"SetTime", TypeId::CommandObcSetTime},
+            {"GetTimeHuman", TypeId::CommandObcGetTimeHuman},
+            {"GetTimeBinary", TypeId::CommandObcGetTimeBinary},
+            {"SetOpsMode", TypeId::CommandExecSetOpsMode},
+            {"EnableChannel", TypeId::CommandExecEnableChannel},
+            {"EpsCommunicate", TypeId::CommandEpsCommunicate},
+            {"EpsSwitchName", TypeId::CommandEpsSwitchName},
+            {"EpsSwitchNumber", TypeId::CommandEpsSwitchNumber},
+            {"EpsReset", TypeId::CommandEpsReset},
+            {"EpsState", TypeId::CommandEpsState},
+            {"EpsWatchdog", TypeId::CommandEpsWatchdog},
+            {"EpsSetTime", TypeId::CommandEpsSetTime},
+            {"EpsMinimumPower", TypeId::CommandEpsMinimumPower},
+            {"EpsSwitchNames", TypeId::CommandEpsSwitchNames},
+            {"EpsSwitchStatus", TypeId::CommandEpsSwitchStatus},
+            {"AdcsCommunicate", TypeId::CommandAdcsCommunicate},
+            {"AdcsState", TypeId::CommandAdcsState},
+            {"AdcsSetRunMode", TypeId::CommandAdcsSetRunMode},
+            {"AdcsGetAdcsState", TypeId::CommandAdcsGetAdcsState},
+            {"AdcsOrbitParameters", TypeId::CommandAdcsOrbitParameters},
+            {"ExecLoadCommand", TypeId::CommandExecLoadCommand},
+            {"ExecAddCommand", TypeId::CommandExecAddCommand},
+            {"RadioCommunicate", TypeId::CommandRadioCommunicate},
+            {"RadioAstrodevCommunicate", TypeId::CommandRadioAstrodevCommunicate},
+            {"CameraOn", TypeId::CommandCameraOn},
+            {"CameraCapture", TypeId::CommandCameraCapture},
+        };
+
         PacketComm::PacketComm(uint16_t size)
         {
             if (size >= 4)
@@ -21,9 +169,10 @@ namespace Cosmos {
 
         void PacketComm::Invert(vector<uint8_t> &data)
         {
-            vector<uint8_t> result;
-            uint8from(data, result, ByteOrder::BIGENDIAN);
-            data = result;
+            for (uint8_t &byte : data)
+            {
+                byte = uint8from(&byte, ByteOrder::BIGENDIAN);
+            }
             return;
         }
 
@@ -58,8 +207,7 @@ namespace Cosmos {
                 {
                     // Short packet
                     header.data_size = wrapped.size() - 1;
-                    data.clear();
-                    data.insert(data.begin(), &wrapped[1], &wrapped[header.data_size+1]);
+                    data.assign(wrapped.begin() + 1, wrapped.begin() + header.data_size + 1);
                     uint8_t cs = 0;
                     for (uint8_t byte : data)
                     {
@@ -104,8 +252,7 @@ namespace Cosmos {
                             }
                             if (checkcrc)
                             {
-                                data.clear();
-                                data.insert(data.begin(), &wrapped[COSMOS_SIZEOF(Header)], &wrapped[header.data_size+COSMOS_SIZEOF(Header)]);
+                                data.assign(wrapped.begin() + COSMOS_SIZEOF(Header), wrapped.begin() + header.data_size + COSMOS_SIZEOF(Header));
                                 style = PacketStyle::V2;
                                 return data.size();
                             }
@@ -160,15 +307,18 @@ namespace Cosmos {
         bool PacketComm::ASMUnPacketize(bool checkcrc, bool descramble)
         {
             wrapped.clear();
+            if (packetized.size() < sizeof(atsm))
+            {
+                return false;
+            }
             if (atsm[0] == packetized[0] && atsm[1] == packetized[1] && atsm[2] == packetized[2] && atsm[3] == packetized[3])
             {
-                wrapped.insert(wrapped.begin(), &packetized[4], &packetized[packetized.size()]);
+                wrapped.assign(packetized.begin() + sizeof(atsm), packetized.end());
             }
             else if (atsmr[0] == packetized[0] && atsmr[1] == packetized[1] && atsmr[2] == packetized[2] && atsmr[3] == packetized[3])
             {
-                vector<uint8_t> input;
-                input.insert(input.begin(), &packetized[4], &packetized[packetized.size()]);
-                uint8from(input, wrapped, ByteOrder::BIGENDIAN);
+                wrapped.assign(packetized.begin() + sizeof(atsmr), packetized.end());
+                Invert(wrapped);
             }
             else
             {
@@ -256,9 +406,9 @@ namespace Cosmos {
                     {
                         cs += byte;
                     }
-                    wrapped.resize(1);
+                    wrapped.resize(1 + data.size());
                     wrapped[0] = ((cs & 0x0f) << 4) + (static_cast<uint8_t>(header.type) & 0x0f);
-                    wrapped.insert(wrapped.end(), data.begin(), data.end());
+                    std::copy(data.begin(), data.end(), wrapped.begin() + 1);
                 }
                 break;
 //            case PacketStyle::V1:
@@ -280,12 +430,12 @@ namespace Cosmos {
 //                break;
             case PacketStyle::V2:
                 {
+                    // Sized once, so a reused packet keeps its buffer
                     header.data_size = data.size();
-                    wrapped.resize(COSMOS_SIZEOF(Header));
+                    wrapped.resize(COSMOS_SIZEOF(Header) + data.size() + 2);
                     memcpy(&wrapped[0], &header, COSMOS_SIZEOF(Header));
-                    wrapped.insert(wrapped.end(), data.begin(), data.end());
-                    crc = calc_checksum ? calc_crc.calc(wrapped) : 0;
-                    wrapped.resize(wrapped.size()+2);
+                    std::copy(data.begin(), data.end(), wrapped.begin() + COSMOS_SIZEOF(Header));
+                    crc = calc_checksum ? calc_crc.calc(wrapped.data(), wrapped.size()-2) : 0;
                     wrapped[wrapped.size()-2] = crc & 0xff;
                     wrapped[wrapped.size()-1] = crc >> 8;
                 }
@@ -306,8 +456,7 @@ namespace Cosmos {
             {
                 return false;
             }
-            packetized.clear();
-            packetized.insert(packetized.begin(), wrapped.begin(), wrapped.end());
+            packetized.assign(wrapped.begin(), wrapped.end());
             return true;
         }
 
@@ -327,14 +476,14 @@ namespace Cosmos {
         bool PacketComm::ASMPacketize()
         {
             // Default call has no padding at the end
-            return ASMPacketize(data.size() + sizeof(PacketComm::header) + 2 + atsm.size(), false);
+            return ASMPacketize(data.size() + sizeof(PacketComm::header) + 2 + sizeof(atsm), false);
         }
 
         //! @param packet_wrapped_size Size to stuff a packet up to for fixed-sized requirements
         bool PacketComm::ASMPacketize(uint16_t packet_wrapped_size, bool scramble)
         {
             // 2 is crc size
-            if (data.size() + sizeof(PacketComm::header) + 2 + atsm.size() > packet_wrapped_size)
+            if (data.size() + sizeof(PacketComm::header) + 2 + sizeof(atsm) > packet_wrapped_size)
             {
                 return false;
             }
@@ -343,18 +492,18 @@ namespace Cosmos {
                 return false;
             }
             
-            packetized.clear();
-            packetized.insert(packetized.begin(), atsm.begin(), atsm.end());
-            packetized.insert(packetized.end(), wrapped.begin(), wrapped.end());
             // Adjust packet size to specified padded size
             // XBand seems to ignore packets if it's all just 0 or 1 (though it seems to like other numbers), so just fill with a sequence
-            packetized.resize(packet_wrapped_size, 0);
+            packetized.resize(packet_wrapped_size);
+            std::copy(atsm, atsm + sizeof(atsm), packetized.begin());
+            std::copy(wrapped.begin(), wrapped.end(), packetized.begin() + sizeof(atsm));
+            std::fill(packetized.begin() + sizeof(atsm) + wrapped.size(), packetized.end(), 0);
             // Apply Galois LFSR scrambling to avoid long contiguous sequences of 0s or 1s
             if (scramble)
             {
                 uint16_t lfsr = 0xACE1u;
                 const uint16_t poly = 0x8016;
-                for (size_t i=atsm.size(); i<packetized.size(); ++i)
+                for (size_t i=sizeof(atsm); i<packetized.size(); ++i)
                 {
                     uint16_t lsb = lfsr & 0x1;
                     lfsr >>= 1;
@@ -122,149 +122,10 @@ namespace Cosmos {
                 CommandCameraCapture = 0x882,
             };
 
-            std::map<TypeId, string> TypeString = {
-                {TypeId::DataObcBeacon, "Beacon"},
-                {TypeId::DataObcNop, "Nop"},
-                {TypeId::DataObcPong, "Pong"},
-                {TypeId::DataEpsResponse, "EpsResponse"},
-                {TypeId::DataRadioResponse, "RadioResponse"},
-                {TypeId::DataAdcsResponse, "AdcsResponse"},
-                {TypeId::DataObcResponse, "Response"},
-                {TypeId::DataRadioTest, "Test"},
-                {TypeId::DataObcTime, "Time"},
-                {TypeId::DataFileCommand, "FileCommand"},
-                {TypeId::DataFileMessage, "FileMessage"},
-                {TypeId::DataFileQueue, "FileQueue"},
-                {TypeId::DataFileCancel, "FileCancel"},
-                {TypeId::DataFileComplete, "FileComplete"},
-                {TypeId::DataFileReqMeta, "FileReqMeta"},
-                {TypeId::DataFileReqData, "FileReqData"},
-                {TypeId::DataFileMetaData, "FileMetaData"},
-                {TypeId::DataFileChunkData, "FileChunkData"},
-                {TypeId::DataFileReqComplete, "FileReqComplete"},
-                {TypeId::DataObcHeartbeat, "Heartbeat"},
-                {TypeId::CommandObcReset, "Reset"},
-                {TypeId::CommandObcReboot, "Reboot"},
-                {TypeId::CommandObcSendBeacon, "SendBeacon"},
-                {TypeId::CommandExecClearQueue, "ClearQueue"},
-                {TypeId::CommandObcExternalCommand, "ExternalCommand"},
-                {TypeId::CommandObcExternalTask, "ExternalTask"},
-                {TypeId::CommandObcHalt, "Halt"},
-                {TypeId::CommandRadioTest, "TestRadio"},
-                {TypeId::CommandFileListDirectory, "ListDirectory"},
-                {TypeId::CommandFileTransferFile, "TransferFile"},
-                {TypeId::CommandFileTransferNode, "TransferNode"},
-                {TypeId::CommandFileTransferRadio, "TransferRadio"},
-                {TypeId::CommandFileTransferList, "TransferList"},
-                {TypeId::CommandFileResetQueue, "FileResetQueue"},
-                {TypeId::CommandFileStopTransfer, "FileStopTransfer"},
-                {TypeId::CommandFileSendFileResponses, "SendFileResponses"},
-                {TypeId::CommandFileSaveFileProgress, "SaveFileProgress"},
-                {TypeId::CommandFileTransferDirectory, "TransferDirectory"},
-                {TypeId::CommandObcInternalRequest, "InternalRequest"},
-                {TypeId::CommandObcHeartbeat, "Heartbeat"},
-                {TypeId::CommandObcPing, "Ping"},
-                {TypeId::CommandObcSetTle, "SetTle"},
-                {TypeId::CommandObcSetTime, "SetTime"},
-                {TypeId::CommandObcGetTimeHuman, "GetTimeHuman"},
-                {TypeId::CommandObcGetTimeBinary, "GetTimeBinary"},
-                {TypeId::CommandExecSetOpsMode, "SetOpsMode"},
-                {TypeId::CommandExecEnableChannel, "EnableChannel"},
-                {TypeId::CommandAdcsCommunicate, "AdcsCommunicate"},
-                {TypeId::CommandAdcsState, "AdcsState"},
-                {TypeId::CommandAdcsSetRunMode, "AdcsSetRunMode"},
-                {TypeId::CommandAdcsGetAdcsState, "AdcsGetAdcsState"},
-                {TypeId::CommandAdcsOrbitParameters, "AdcsOrbitParameters"},
-                {TypeId::CommandEpsCommunicate, "EpsCommunicate"},
-                {TypeId::CommandEpsSwitchName, "EpsSwitchName"},
-                {TypeId::CommandEpsSwitchNumber, "EpsSwitchNumber"},
-                {TypeId::CommandEpsReset, "EpsReset"},
-                {TypeId::CommandEpsState, "EpsState"},
-                {TypeId::CommandEpsWatchdog, "EpsWatchdog"},
-                {TypeId::CommandEpsSetTime, "EpsSetTime"},
-                {TypeId::CommandEpsMinimumPower, "EpsMinimumPower"},
-                {TypeId::CommandEpsSwitchNames, "EpsSwitchNames"},
-                {TypeId::CommandEpsSwitchStatus, "EpsSwitchStatus"},
-                {TypeId::CommandExecLoadCommand, "ExecLoadCommand"},
-                {TypeId::CommandExecAddCommand, "ExecAddCommand"},
-                {TypeId::CommandRadioCommunicate, "RadioCommunicate"},
-                {TypeId::CommandRadioAstrodevCommunicate, "RadioAstrodevCommunicate"},
-                {TypeId::CommandCameraOn, "CameraOn"},
-                {TypeId::CommandCameraCapture, "CameraCapture"},
-            };
-
-            std::map<string, TypeId> StringType = {
-                {"Beacon", TypeId::DataObcBeacon},
-                {"Nop", TypeId::DataObcNop},
-                {"Pong", TypeId::DataObcPong},
-                {"EpsResponse", TypeId::DataEpsResponse},
-                {"RadioResponse", TypeId::DataRadioResponse},
-                {"AdcsResponse", TypeId::DataAdcsResponse},
-                {"Response", TypeId::DataObcResponse},
-                {"Test", TypeId::DataRadioTest},
-                {"Time", TypeId::DataObcTime},
-
-                {"FileCommand", TypeId::DataFileCommand},
-                {"FileMessage", TypeId::DataFileMessage},
-                {"FileQueue", TypeId::DataFileQueue},
-                {"FileCancel", TypeId::DataFileCancel},
-                {"FileComplete", TypeId::DataFileComplete},
-                {"FileReqMeta", TypeId::DataFileReqMeta},
-                {"FileReqData", TypeId::DataFileReqData},
-                {"FileMetaData", TypeId::DataFileMetaData},
-                {"FileChunkData", TypeId::DataFileChunkData},
-                {"FileReqComplete", TypeId::DataFileReqComplete},
+            //! Names of packet types, shared by every packet
+            static const std::map<TypeId, string> TypeString;
 
-                {"Heartbeat", TypeId::DataObcHeartbeat},
-
-                {"Reset", TypeId::CommandObcReset},
-                {"Reboot", TypeId::CommandObcReboot},
-                {"SendBeacon", TypeId::CommandObcSendBeacon},
-                {"ClearQueue", TypeId::CommandExecClearQueue},
-                {"ExternalCommand", TypeId::CommandObcExternalCommand},
-                {"ExternalTask", TypeId::CommandObcExternalTask},
-                {"Halt", TypeId::CommandObcHalt},
-                {"TestRadio", TypeId::CommandRadioTest},
-                {"ListDirectory", TypeId::CommandFileListDirectory},
-                {"TransferFile", TypeId::CommandFileTransferFile},
-                {"TransferNode", TypeId::CommandFileTransferNode},
-                {"TransferRadio", TypeId::CommandFileTransferRadio},
-                {"TransferList", TypeId::CommandFileTransferList},
-                {"FileResetQueue", TypeId::CommandFileResetQueue},
-                {"FileStopTransfer", TypeId::CommandFileStopTransfer},
-                {"SendFileResponses", TypeId::CommandFileSendFileResponses},
-                {"SaveFileProgress", TypeId::CommandFileSaveFileProgress},
-                {"TransferDirectory", TypeId::CommandFileTransferDirectory},
-                {"InternalRequest", TypeId::CommandObcInternalRequest},
-                {"Ping", TypeId::CommandObcPing},
-                {"SetTle", TypeId::CommandObcSetTle},
-                {"SetTime", TypeId::CommandObcSetTime},
-                {"GetTimeHuman", TypeId::CommandObcGetTimeHuman},
-                {"GetTimeBinary", TypeId::CommandObcGetTimeBinary},
-                {"SetOpsMode", TypeId::CommandExecSetOpsMode},
-                {"EnableChannel", TypeId::CommandExecEnableChannel},
-                {"EpsCommunicate", TypeId::CommandEpsCommunicate},
-                {"EpsSwitchName", TypeId::CommandEpsSwitchName},
-                {"EpsSwitchNumber", TypeId::CommandEpsSwitchNumber},
-                {"EpsReset", TypeId::CommandEpsReset},
-                {"EpsState", TypeId::CommandEpsState},
-                {"EpsWatchdog", TypeId::CommandEpsWatchdog},
-                {"EpsSetTime", TypeId::CommandEpsSetTime},
-                {"EpsMinimumPower", TypeId::CommandEpsMinimumPower},
-                {"EpsSwitchNames", TypeId::CommandEpsSwitchNames},
-                {"EpsSwitchStatus", TypeId::CommandEpsSwitchStatus},
-                {"AdcsCommunicate", TypeId::CommandAdcsCommunicate},
-                {"AdcsState", TypeId::CommandAdcsState},
-                {"AdcsSetRunMode", TypeId::CommandAdcsSetRunMode},
-                {"AdcsGetAdcsState", TypeId::CommandAdcsGetAdcsState},
-                {"AdcsOrbitParameters", TypeId::CommandAdcsOrbitParameters},
-                {"ExecLoadCommand", TypeId::CommandExecLoadCommand},
-                {"ExecAddCommand", TypeId::CommandExecAddCommand},
-                {"RadioCommunicate", TypeId::CommandRadioCommunicate},
-                {"RadioAstrodevCommunicate", TypeId::CommandRadioAstrodevCommunicate},
-                {"CameraOn", TypeId::CommandCameraOn},
-                {"CameraCapture", TypeId::CommandCameraCapture},
-            };
+            static const std::map<string, TypeId> StringType;
 
             struct __attribute__ ((packed)) CommunicateHeader
             {
@@ -336,9 +197,10 @@ namespace Cosmos {
                 uint32_t txid;
             };
 
-            vector<uint8_t> atsm = {0x1a, 0xcf, 0xfc, 0x1d};
-            vector<uint8_t> atsmr = {0x58, 0xf3, 0x3f, 0xb8};
-            vector<uint8_t> satsm = {0x35, 0x2e, 0xf8, 0x53};
+            //! Attached sync markers, shared by every packet
+            static constexpr uint8_t atsm[4] = {0x1a, 0xcf, 0xfc, 0x1d};
+            static constexpr uint8_t atsmr[4] = {0x58, 0xf3, 0x3f, 0xb8};
+            static constexpr uint8_t satsm[4] = {0x35, 0x2e, 0xf8, 0x53};
             CRC16 calc_crc;
 
             void Invert(vector<uint8_t>& data);
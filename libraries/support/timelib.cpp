@@ -233,8 +233,8 @@ namespace Cosmos {
 */
         calstruc mjd2cal(double mjd)
         {
-            static double lmjd = 0.;
-            static calstruc date;
+            static thread_local double lmjd = 0.;
+            static thread_local calstruc date;
 
             if (lmjd != mjd)
             {
@@ -285,11 +285,11 @@ namespace Cosmos {
 */
         int32_t mjd2ymd(double mjd, int32_t &year, int32_t &month, double &day, double &doy)
         {
-            static double lmjd = 0.;
-            static int32_t lyear = 1858;
-            static int32_t lmonth = 11;
-            static double lday = 17.;
-            static double ldoy = 321.;
+            static thread_local double lmjd = 0.;
+            static thread_local int32_t lyear = 1858;
+            static thread_local int32_t lmonth = 11;
+            static thread_local double lday = 17.;
+            static thread_local double ldoy = 321.;
 
             if (mjd != lmjd)
             {
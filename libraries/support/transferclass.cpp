@@ -34,9 +34,8 @@ static constexpr int32_t RET_CONTINUE = 1;
 //! Reusable buffer for file transfer chunks.
 static constexpr size_t MAX_CHUNK_SIZE = 4096*2;
 static PACKET_BYTE chunk[MAX_CHUNK_SIZE];
-//! Buffer to store file data to minimize I/O. NOT thread safe.
-static constexpr size_t READ_BUFFER_SIZE = 4*256*512; // modify as needed for best performance (a multiple N of readahead size RA * 512-byte sector)
-static PACKET_BYTE read_buffer[READ_BUFFER_SIZE];
+//! Size of each outgoing transaction's buffer of file data, to minimize I/O.
+static constexpr size_t READ_BUFFER_SIZE = 128*512; // modify as needed for best performance (a multiple N of readahead size RA * 512-byte sector)
 
 namespace Cosmos {
     namespace Support {
@@ -351,39 +350,40 @@ namespace Cosmos {
         /**
          * @brief Read file data into a buffer, using a pre-read buffer to minimize I/O.
          * 
-         * @param file File to read from
+         * Each transaction keeps its own window onto its file, so serving several
+         * files in turn still reads each of them sequentially.
+         * 
+         * @param tx Outgoing transaction to read the file of
          * @param dest Destination buffer to read data into
          * @param offset Offset into the file to read from
          * @param size Number of bytes to read from the file
          * @return Number of bytes read or negative on error.
          */
-        static int32_t buffered_read(FILE* file, PACKET_BYTE* dest, size_t offset, size_t size)
+        static int32_t buffered_read(tx_progress& tx, PACKET_BYTE* dest, size_t offset, size_t size)
         {
-            // Index of the start of the read buffer in the file. Used to determine if a buffered read request can be fulfilled by the pre-read buffered data.
-            static size_t start_of_buffer_fseek_index = std::numeric_limits<size_t>::max();
-            // Keep track of the current file that is being read from
-            static FILE* current_file = nullptr;
-            // The amount of data in the read buffer, which could be smaller than READ_BUFFER_SIZE if the file is smaller than the buffer size or if the end of the file was reached. 
-            static size_t buffer_size = 0;
-            if (file != current_file                    // If a different file is requested
-            || offset < start_of_buffer_fseek_index     // If the requested offset is before the start of the buffered read
-            || start_of_buffer_fseek_index + buffer_size <= offset + size) // If the requested read is larger than the buffered read
+            if (offset < tx.read_buffer_start                       // If the requested offset is before the start of the buffered read
+            || tx.read_buffer_start + tx.read_buffer_size < offset + size) // If the requested read is larger than the buffered read
             {
                 // Read a new buffer
-                if (file == nullptr || fseek(file, offset, SEEK_SET) != 0)
+                if (tx.fp == nullptr || fseek(tx.fp, offset, SEEK_SET) != 0)
                 {
                     return COSMOS_GENERAL_ERROR_BAD_FD;
                 }
-                start_of_buffer_fseek_index = offset;
-                current_file = file;
-                buffer_size = fread(read_buffer, 1, READ_BUFFER_SIZE, file);
-                if (buffer_size < READ_BUFFER_SIZE && ferror(file) && !feof(file))
+                tx.read_buffer.resize(READ_BUFFER_SIZE);
+                tx.read_buffer_start = offset;
+                tx.read_buffer_size = fread(tx.read_buffer.data(), 1, READ_BUFFER_SIZE, tx.fp);
+                if (tx.read_buffer_size < READ_BUFFER_SIZE && ferror(tx.fp) && !feof(tx.fp))
                 {
+                    tx.read_buffer_size = 0;
                     return COSMOS_GENERAL_ERROR_UNDERSIZE;
                 }
+                if (tx.read_buffer_size < size)
+                {
+                    return tx.read_buffer_size;
+                }
             }
             // Read from the buffer
-            memcpy(dest, read_buffer + (offset - start_of_buffer_fseek_index), size);
+            memcpy(dest, tx.read_buffer.data() + (offset - tx.read_buffer_start), size);
             return size;
         }
 
@@ -970,6 +970,7 @@ namespace Cosmos {
                 txq[dest_node_idx].outgoing.progress[tx_out.tx_id].file_info.push_back(filep);
             }
             txq[dest_node_idx].outgoing.progress[tx_out.tx_id].fp = tx_out.fp;
+            txq[dest_node_idx].outgoing.progress[tx_out.tx_id].read_buffer_size = 0;
             ++txq[dest_node_idx].outgoing.size;
 
             // Update total_bytes
@@ -1013,6 +1014,8 @@ namespace Cosmos {
                 fclose(txq[dest_node_idx].outgoing.progress[tx_id].fp);
             }
             txq[dest_node_idx].outgoing.progress[tx_id].fp = nullptr;
+            vector<PACKET_BYTE>().swap(txq[dest_node_idx].outgoing.progress[tx_id].read_buffer);
+            txq[dest_node_idx].outgoing.progress[tx_id].read_buffer_size = 0;
             txq[dest_node_idx].outgoing.progress[tx_id].enabled = false;
             txq[dest_node_idx].outgoing.progress[tx_id].tx_id = 0;
             txq[dest_node_idx].outgoing.progress[tx_id].file_crc = 0;
@@ -1167,7 +1170,7 @@ namespace Cosmos {
                     tp.chunk_end = tp.chunk_start + byte_count - 1;
 
                     // Read bytes into chunk
-                    int32_t iretn = buffered_read(txq[dest_node_idx].outgoing.progress[tx_id].fp, chunk, tp.chunk_start, byte_count);
+                    int32_t iretn = buffered_read(txq[dest_node_idx].outgoing.progress[tx_id], chunk, tp.chunk_start, byte_count);
                     if (iretn == static_cast<int32_t>(byte_count))
                     {
                         outgoing_packet.header.nodeorig = self_node_id;
@@ -1232,13 +1235,8 @@ namespace Cosmos {
                 // Then METADATA is received (after a )
                 // And then REQCOMPLETE was received
 
-                // Make sure file is flushed before trying to calculate the CRC
-                if (txq[orig_node_idx].incoming.progress[tx_id].fp != nullptr)
-                {
-                    fflush(txq[orig_node_idx].incoming.progress[tx_id].fp);
-                }
                 // Now check the file_crc
-                int32_t crcret = calc_crc.calc_file(txq[orig_node_idx].incoming.progress[tx_id].temppath + ".file");
+                int32_t crcret = calc_file_crc(txq[orig_node_idx].incoming.progress[tx_id], calc_crc);
                 if (crcret < 0 || txq[orig_node_idx].incoming.progress[tx_id].file_crc != crcret)
                 {
                     if (debug_log != nullptr)
@@ -1403,6 +1401,7 @@ namespace Cosmos {
             {
                 txq[orig_node_idx].incoming.progress[tx_in.tx_id].file_info.push_back(filep);
             }
+            txq[orig_node_idx].incoming.progress[tx_in.tx_id].data_crc = tx_in.data_crc;
             txq[orig_node_idx].incoming.progress[tx_in.tx_id].fp = tx_in.fp;
             ++txq[orig_node_idx].incoming.size;
 
@@ -1575,6 +1574,7 @@ namespace Cosmos {
             txq[orig_node_idx].incoming.progress[tx_id].file_size = 0.;
             txq[orig_node_idx].incoming.progress[tx_id].total_bytes = 0.;
             txq[orig_node_idx].incoming.progress[tx_id].file_info.clear();
+            txq[orig_node_idx].incoming.progress[tx_id].data_crc.clear();
 
             return incoming_tx_recount(orig_node_idx);
         }
@@ -1738,7 +1738,10 @@ namespace Cosmos {
                 else
                 {
                     fseek(txq[orig_node_idx].incoming.progress[tx_id].fp, tp.chunk_start, SEEK_SET);
-                    fwrite(data.chunk.data(), data.byte_count, 1, txq[orig_node_idx].incoming.progress[tx_id].fp);
+                    if (fwrite(data.chunk.data(), data.byte_count, 1, txq[orig_node_idx].incoming.progress[tx_id].fp) == 1)
+                    {
+                        add_chunk_crc(txq[orig_node_idx].incoming.progress[tx_id], tp, data.chunk.data(), calc_crc);
+                    }
                     if (debug_log != nullptr)
                     {
                         // Leave this commented out since there are a lot of DATA packets flowing
@@ -1753,9 +1756,8 @@ namespace Cosmos {
                         merge_chunks_overlap(txq[orig_node_idx].incoming.progress[tx_id]);
                         if (txq[orig_node_idx].incoming.progress[tx_id].total_bytes == txq[orig_node_idx].incoming.progress[tx_id].file_size)
                         {
-                            // Now check the file_crc
-                            fflush(txq[orig_node_idx].incoming.progress[tx_id].fp);
-                            int32_t crcret = calc_crc.calc_file(txq[orig_node_idx].incoming.progress[tx_id].temppath + ".file");
+                            // Now check the file_crc, from the CRCs of the chunks as they were written
+                            int32_t crcret = calc_file_crc(txq[orig_node_idx].incoming.progress[tx_id], calc_crc);
                             if (crcret < 0 || txq[orig_node_idx].incoming.progress[tx_id].file_crc != crcret)
                             {
                                 if (debug_log != nullptr)
@@ -2762,7 +2764,7 @@ void Transfer::print_file_packet(const PacketComm& packet, uint8_t direction, st
         }
     }
 
-    if (debug_log->Type())
+    if (debug_log != nullptr && debug_log->Type())
     {
         string node_name = lookup_node_id_name(cinfo, packet.data[0]);
         uint8_t node_id = check_node_id(cinfo, packet.data[0]);
@@ -520,70 +520,46 @@ namespace Cosmos {
         }
 
         //! Merges any overlapping chunks in the tx.file_info deque.
+        //! Leaves tx.file_info sorted, with no two chunks overlapping or touching,
+        //! which add_chunk() and find_chunks_missing() rely on.
         //! \param tx A tx_progress to merge chunks for
         //! \return Sum of bytes of the chunks in tx
         PACKET_FILE_SIZE_TYPE merge_chunks_overlap(tx_progress& tx)
         {
             // Remove any chunks that go beyond the file size
-            auto it = tx.file_info.begin();
             // If the METADATA has yet to be received, then file_size will be 0
             if (tx.file_size > 0)
             {
-                while (it != tx.file_info.end())
-                {
-                    if (it->chunk_end >= tx.file_size)
-                    {
-                        // TODO: consider if another data structure may be better
-                        it = tx.file_info.erase(it);
-                    }
-                    else {
-                        ++it;
-                    }
-                }
+                const PACKET_FILE_SIZE_TYPE file_size = tx.file_size;
+                tx.file_info.erase(std::remove_if(tx.file_info.begin(), tx.file_info.end(), [file_size](const file_progress& chunk) { return chunk.chunk_end >= file_size; }), tx.file_info.end());
+            }
+            // Chunks kept by add_chunk() are already in order
+            if (!std::is_sorted(tx.file_info.begin(), tx.file_info.end(), lower_chunk))
+            {
+                sort(tx.file_info.begin(), tx.file_info.end(), lower_chunk);
             }
-            switch (tx.file_info.size())
+            // Merge chunks in one pass
+            tx.total_bytes = 0;
+            size_t count = 0;
+            for (size_t i=0; i<tx.file_info.size(); ++i)
             {
-            case 0:
+                // Merge if this chunk's start overlaps with the previous chunk's end
+                if (count && tx.file_info[i].chunk_start <= tx.file_info[count-1].chunk_end + 1)
                 {
-                    tx.total_bytes = 0;
+                    // Sanity check in case this chunk's end was less than the previous chunk's end
+                    if (tx.file_info[i].chunk_end > tx.file_info[count-1].chunk_end)
+                    {
+                        tx.total_bytes += tx.file_info[i].chunk_end - tx.file_info[count-1].chunk_end;
+                        tx.file_info[count-1].chunk_end = tx.file_info[i].chunk_end;
+                    }
                 }
-                break;
-            case 1:
+                else
                 {
-                    tx.total_bytes = (tx.file_info[0].chunk_end - tx.file_info[0].chunk_start) + 1;
+                    tx.file_info[count++] = tx.file_info[i];
+                    tx.total_bytes += (tx.file_info[i].chunk_end - tx.file_info[i].chunk_start) + 1;
                 }
-                break;
-            default:
-                {
-                    tx.total_bytes = 0;
-                    sort(tx.file_info.begin(), tx.file_info.end(), lower_chunk);
-                    // Merge chunks
-                    for (auto it = tx.file_info.begin(); it != tx.file_info.end(); ++it)
-                    {
-                        tx.total_bytes += (it->chunk_end - it->chunk_start) + 1;
-                        auto it_next = it+1;
-                        while (it_next != tx.file_info.end())
-                        {
-                            // Merge if the next chunk's start overlaps with the previous chunk's end
-                            if (it_next->chunk_start <= it->chunk_end+1)
-                            {
-                                // Sanity check in case the next chunk's end was less than the previous chunk's end
-                                if (it_next->chunk_end > it->chunk_end)
-                                {
-                                    tx.total_bytes += it_next->chunk_end - it->chunk_end;
-                                    it->chunk_end = it_next->chunk_end;
-                                }
-                                it_next = tx.file_info.erase(it_next);
-                            }
-                            else
-                            {
-                                ++it_next;
-                            }
-                        } // End while
-                    } // End for
-                } // End default
-                break;
-            } // End switch
+            }
+            tx.file_info.resize(count);
 
             return tx.total_bytes;
         }
@@ -602,51 +578,28 @@ namespace Cosmos {
                 return missing;
             }
 
-            if (tx_in.file_info.size() == 0)
-            {
-                tp.chunk_start = 0;
-                tp.chunk_end = tx_in.file_size - 1;
-                missing.push_back(tp);
-            }
-            else
-            {
-                merge_chunks_overlap(tx_in);
-                sort(tx_in.file_info.begin(), tx_in.file_info.end(), lower_chunk);
-
-                // Check missing before first chunk
-                if (tx_in.file_info[0].chunk_start)
-                {
-                    tp.chunk_start = 0;
-                    tp.chunk_end = tx_in.file_info[0].chunk_start - 1;
-                    missing.push_back(tp);
-                }
-
-                // Check missing between chunks
-                for (uint32_t i=1; i<tx_in.file_info.size(); ++i)
-                {
-                    if (tx_in.file_info[i-1].chunk_end+1 != tx_in.file_info[i].chunk_start)
-                    {
-                        tp.chunk_start = tx_in.file_info[i-1].chunk_end + 1;
-                        tp.chunk_end = tx_in.file_info[i].chunk_start - 1;
-                        missing.push_back(tp);
-                    }
-                }
+            // Also recalculates total_bytes
+            merge_chunks_overlap(tx_in);
 
-                // Check missing after last chunk
-                if (tx_in.file_info[tx_in.file_info.size()-1].chunk_end + 1 != tx_in.file_size)
+            // The holes are whatever lies between the chunks received
+            PACKET_FILE_SIZE_TYPE next_start = 0;
+            for (const file_progress& prog : tx_in.file_info)
+            {
+                if (prog.chunk_start > next_start)
                 {
-                    tp.chunk_start = tx_in.file_info[tx_in.file_info.size()-1].chunk_end + 1;
-                    tp.chunk_end = tx_in.file_size - 1;
+                    tp.chunk_start = next_start;
+                    tp.chunk_end = prog.chunk_start - 1;
                     missing.push_back(tp);
                 }
+                next_start = prog.chunk_end + 1;
             }
-
-            // calculate bytes so far
-            tx_in.total_bytes = 0;
-            for (file_progress prog : tx_in.file_info)
+            if (next_start < tx_in.file_size)
             {
-                tx_in.total_bytes += (prog.chunk_end - prog.chunk_start) + 1;
+                tp.chunk_start = next_start;
+                tp.chunk_end = tx_in.file_size - 1;
+                missing.push_back(tp);
             }
+
             if (tx_in.total_bytes == tx_in.file_size)
             {
                 tx_in.sentdata = true;
@@ -692,6 +645,125 @@ namespace Cosmos {
             return updated;
         }
 
+        //! Adds the CRC of newly written bytes to the tx_progress CRC runs.
+        //! Used when a DATA packet is written to an incoming file. Only the bytes of the chunk not
+        //! already covered by tx.data_crc are counted. A run that the new bytes follow is extended
+        //! with them, and a run that they lead into is combined onto the end, so a file received
+        //! in order is a single run that grows a packet at a time.
+        //! \param tx The tx_progress of a file in the incoming queue
+        //! \param tp Data chunk that was written
+        //! \param chunk The bytes of the chunk
+        //! \param calc_crc CRC16 set up as for file_crc
+        void add_chunk_crc(tx_progress& tx, const file_progress& tp, const PACKET_BYTE* chunk, CRC16& calc_crc)
+        {
+            vector<chunk_crc>& runs = tx.data_crc;
+            PACKET_FILE_SIZE_TYPE start = tp.chunk_start;
+            while (start <= tp.chunk_end)
+            {
+                // First run that ends at or after start
+                auto next = std::lower_bound(runs.begin(), runs.end(), start, [](const chunk_crc& run, PACKET_FILE_SIZE_TYPE start) { return run.chunk_end < start; });
+                if (next != runs.end() && next->chunk_start <= start)
+                {
+                    // Already counted, skip to the end of this run
+                    if (next->chunk_end >= tp.chunk_end)
+                    {
+                        break;
+                    }
+                    start = next->chunk_end + 1;
+                    continue;
+                }
+
+                // Uncovered bytes run up to the next run, or the end of the chunk
+                PACKET_FILE_SIZE_TYPE end = tp.chunk_end;
+                if (next != runs.end() && next->chunk_start <= end)
+                {
+                    end = next->chunk_start - 1;
+                }
+                const PACKET_BYTE* bytes = chunk + (start - tp.chunk_start);
+                size_t size = (end - start) + 1;
+                if (next != runs.begin() && (next-1)->chunk_end + 1 == start)
+                {
+                    --next;
+                    next->crc = calc_crc.extend(next->crc, bytes, size);
+                    next->chunk_end = end;
+                }
+                else
+                {
+                    chunk_crc run;
+                    run.chunk_start = start;
+                    run.chunk_end = end;
+                    run.crc = calc_crc.extend(calc_crc.calc(nullptr, 0), bytes, size);
+                    next = runs.insert(next, run);
+                }
+                auto after = next + 1;
+                if (after != runs.end() && after->chunk_start == end + 1)
+                {
+                    next->crc = calc_crc.combine(next->crc, after->crc, (after->chunk_end - after->chunk_start) + 1);
+                    next->chunk_end = after->chunk_end;
+                    runs.erase(after);
+                }
+                start = end + 1;
+            }
+        }
+
+        //! Calculates the file_crc of a fully received incoming file.
+        //! The runs in tx.data_crc are combined without reading them back, so only bytes written
+        //! before this session (restored from the meta file) are read from disk. A file received
+        //! in one session is checked without any reading at all.
+        //! \param tx The tx_progress of a file in the incoming queue
+        //! \param calc_crc CRC16 set up as for file_crc
+        //! \return Non-negative CRC on success, negative on error
+        int32_t calc_file_crc(tx_progress& tx, CRC16& calc_crc)
+        {
+            string partial_filepath = tx.temppath + ".file";
+            if (tx.fp != nullptr)
+            {
+                fflush(tx.fp);
+            }
+            if (tx.data_crc.size() == 1 && tx.data_crc[0].chunk_start == 0 && tx.data_crc[0].chunk_end + 1 == tx.file_size)
+            {
+                return tx.data_crc[0].crc;
+            }
+            if (!tx.data_crc.empty() && tx.data_crc.back().chunk_end >= tx.file_size)
+            {
+                // Runs from beyond the end of the file, as when DATA came before METADATA
+                return calc_crc.calc_file(partial_filepath);
+            }
+
+            FILE* fp = fopen(partial_filepath.c_str(), "rb");
+            if (fp == nullptr)
+            {
+                return TRANSFER_ERROR_FILENAME;
+            }
+            int32_t iretn = 0;
+            uint16_t crc = calc_crc.calc(nullptr, 0);
+            PACKET_FILE_SIZE_TYPE start = 0;
+            for (size_t i=0; i<=tx.data_crc.size(); ++i)
+            {
+                // Read the bytes before each run, then the bytes after the last
+                PACKET_FILE_SIZE_TYPE end = i < tx.data_crc.size() ? tx.data_crc[i].chunk_start : tx.file_size;
+                if (end > start)
+                {
+                    if ((iretn = calc_crc.calc_file(fp, start, end - start)) < 0)
+                    {
+                        break;
+                    }
+                    crc = calc_crc.combine(crc, iretn, end - start);
+                }
+                if (i < tx.data_crc.size())
+                {
+                    crc = calc_crc.combine(crc, tx.data_crc[i].crc, (tx.data_crc[i].chunk_end - tx.data_crc[i].chunk_start) + 1);
+                    start = tx.data_crc[i].chunk_end + 1;
+                }
+            }
+            fclose(fp);
+            if (iretn < 0)
+            {
+                return iretn;
+            }
+            return crc;
+        }
+
         //! Adds a chunk to the tx_progress vector.
         //! Used when a DATA packet is received.
         //! \param tx The tx_progress of a file in the incoming queue
@@ -704,6 +776,9 @@ namespace Cosmos {
 
         //! Adds a chunk to the tx_progress vector.
         //! Called by the other add_chunk or add_chunks.
+        //! tx.file_info is kept sorted, with no two chunks overlapping or touching, so the
+        //! chunks that the new one meets are found by binary search, and merged with it in
+        //! place. tx.total_bytes is kept up to date as chunks are added and truncated.
         //! \param tx The tx_progress of a file in the incoming queue
         //! \param tp Data chunk to add
         //! \param is_start If this chunk's start is the holes vector's start
@@ -711,140 +786,71 @@ namespace Cosmos {
         //! \return true if tx_in was updated
         bool add_chunk(tx_progress& tx, const file_progress& tp, bool is_start, bool is_end)
         {
-            // Sort first before truncating either end
-            if (is_start || is_end)
-            {
-                sort(tx.file_info.begin(), tx.file_info.end(), lower_chunk);
-            }
-            // Bytes in hole
-            const PACKET_CHUNK_SIZE_TYPE byte_count = tp.chunk_end - tp.chunk_start + 1;
+            vector<file_progress>& chunks = tx.file_info;
 
-            // Do we have any data yet?
-            if (!tx.file_info.size())
+            // If the new chunk is the start hole, then truncate anything before
+            if (is_start)
             {
-                // Add first entry, then write data
-                tx.file_info.push_back(tp);
-                tx.total_bytes += byte_count;
-                return true;
+                // First chunk that ends at or after the new chunk's start
+                auto first = std::lower_bound(chunks.begin(), chunks.end(), tp.chunk_start, [](const file_progress& chunk, PACKET_FILE_SIZE_TYPE start) { return chunk.chunk_end < start; });
+                for (auto it = chunks.begin(); it != first; ++it)
+                {
+                    tx.total_bytes -= (it->chunk_end - it->chunk_start) + 1;
+                }
+                first = chunks.erase(chunks.begin(), first);
+                if (first != chunks.end() && first->chunk_start < tp.chunk_start)
+                {
+                    tx.total_bytes -= tp.chunk_start - first->chunk_start;
+                    first->chunk_start = tp.chunk_start;
+                }
             }
-            // Check against existing data
-            for (uint32_t j=0; j<tx.file_info.size(); ++j)
+            // If the new chunk is the end hole, then truncate anything beyond
+            if (is_end)
             {
-                // If we start before this entry
-                if (tp.chunk_start < tx.file_info[j].chunk_start)
+                // First chunk that starts after the new chunk's end
+                auto last = std::upper_bound(chunks.begin(), chunks.end(), tp.chunk_end, [](PACKET_FILE_SIZE_TYPE end, const file_progress& chunk) { return end < chunk.chunk_start; });
+                for (auto it = last; it != chunks.end(); ++it)
                 {
-                    
-                    // If the new chunk is the start hole, then truncate anything before
-                    if (is_start)
-                    {
-                        tx.file_info.erase(tx.file_info.begin(), tx.file_info.begin()+j);
-                        j = 0;
-                    }
-                    // If we end before this entry starts (at least one byte between)
-                    if (tp.chunk_end + 1 < tx.file_info[j].chunk_start)
-                    {
-                        // If the new chunk is the end hole, then truncate anything beyond
-                        if (is_end)
-                        {
-                            tx.file_info.resize(j);
-                        }
-                        // Insert the new chunk
-                        tx.file_info.insert(tx.file_info.begin()+j, tp);
-                        tx.total_bytes += byte_count;
-
-                        if (is_start || is_end)
-                        {
-                            // Recalculate total_bytes
-                            merge_chunks_overlap(tx);
-                        }
-                        return true;
-                    }
-                    // We end beyond the start of this chunk
-                    else
-                    {
-                        // If the new chunk is the end hole, then truncate anything beyond
-                        // and set the end to the new chunk's end
-                        if (is_end)
-                        {
-                            tx.file_info.resize(j+1);
-                            tx.file_info[j].chunk_end = tp.chunk_end;
-                        }
-                        // If we completely encompass this chunk, have this chunk match start and end
-                        if (tp.chunk_end > tx.file_info[j].chunk_end)
-                        {
-                            tx.total_bytes += (tx.file_info[j].chunk_start - tp.chunk_start);
-                            tx.total_bytes += (tp.chunk_end - tx.file_info[j].chunk_end);
-                            tx.file_info[j].chunk_start = tp.chunk_start;
-                            tx.file_info[j].chunk_end = tp.chunk_end;
-                            if (is_start || is_end)
-                            {
-                                // Recalculate total_bytes
-                                merge_chunks_overlap(tx);
-                            }
-                            return true;
-                        }
-                        // We end before the end of this chunk, then extend the front of this chunk
-                        tx.total_bytes += (tx.file_info[j].chunk_start - tp.chunk_start);
-                        tx.file_info[j].chunk_start = tp.chunk_start;
-                        if (is_start || is_end)
-                        {
-                            // Recalculate total_bytes
-                            merge_chunks_overlap(tx);
-                        }
-                        return true;
-                    }
+                    tx.total_bytes -= (it->chunk_end - it->chunk_start) + 1;
                 }
-                // If we start somewhere between the start and end of this chunk
-                else if (tp.chunk_start <= tx.file_info[j].chunk_end + 1)
+                last = chunks.erase(last, chunks.end());
+                if (last != chunks.begin() && (last-1)->chunk_end > tp.chunk_end)
                 {
-                    // If the new chunk is the end hole, then truncate anything beyond
-                    // and set the end to the new chunk's end
-                    if (is_end)
-                    {
-                        tx.file_info.resize(j+1);
-                        tx.file_info[j].chunk_end = tp.chunk_end;
-                    }
-                    // If the new chunk is the start hole, then truncate anything before
-                    if (is_start)
-                    {
-                        tx.file_info.erase(tx.file_info.begin(), tx.file_info.begin()+j);
-                        j = 0;
-                        tx.file_info[j].chunk_start = tp.chunk_start;
-                    }
-                    // If we end beyond the end of this chunk, then extend the end of this chunk
-                    if (tp.chunk_end > tx.file_info[j].chunk_end)
-                    {
-                        tx.total_bytes += (tp.chunk_end - tx.file_info[j].chunk_end);
-                        tx.file_info[j].chunk_end = tp.chunk_end;
-                        if (is_start || is_end)
-                        {
-                            // Recalculate total_bytes
-                            merge_chunks_overlap(tx);
-                        }
-                        return true;
-                    }
-                    if (is_start || is_end)
-                    {
-                        // Recalculate total_bytes
-                        merge_chunks_overlap(tx);
-                    }
-                    // New chunk is completely inside this chunk, just discard it.
-                    // Unless, we had to truncate anything before, then we did in fact update.
-                    return is_start || is_end;
+                    tx.total_bytes -= (last-1)->chunk_end - tp.chunk_end;
+                    (last-1)->chunk_end = tp.chunk_end;
                 }
-                // We were somewhere beyond the end of this chunk
-            } // End for
+            }
 
-            // If we are higher than everything currently in the list
-            // If the new chunk is the start hole, then clear the whole vector
-            if (is_start)
+            // Chunks that the new chunk overlaps or touches, from first up to last
+            auto first = std::lower_bound(chunks.begin(), chunks.end(), tp.chunk_start, [](const file_progress& chunk, PACKET_FILE_SIZE_TYPE start) { return chunk.chunk_end + 1 < start; });
+            auto last = std::upper_bound(first, chunks.end(), tp.chunk_end, [](PACKET_FILE_SIZE_TYPE end, const file_progress& chunk) { return end + 1 < chunk.chunk_start; });
+
+            // Nothing to merge with, so insert the new chunk
+            if (first == last)
+            {
+                chunks.insert(first, tp);
+                tx.total_bytes += (tp.chunk_end - tp.chunk_start) + 1;
+                return true;
+            }
+
+            // New chunk is completely inside a chunk, just discard it.
+            // Unless, we had to truncate anything, then we did in fact update.
+            if (last - first == 1 && first->chunk_start <= tp.chunk_start && first->chunk_end >= tp.chunk_end)
+            {
+                return is_start || is_end;
+            }
+
+            // Replace the chunks met with one that spans them and the new chunk
+            file_progress merged;
+            merged.chunk_start = std::min(first->chunk_start, tp.chunk_start);
+            merged.chunk_end = std::max((last-1)->chunk_end, tp.chunk_end);
+            for (auto it = first; it != last; ++it)
             {
-                tx.file_info.clear();
-                tx.total_bytes = 0;
+                tx.total_bytes -= (it->chunk_end - it->chunk_start) + 1;
             }
-            // Append
-            tx.file_info.push_back(tp);
-            tx.total_bytes += byte_count;
+            tx.total_bytes += (merged.chunk_end - merged.chunk_start) + 1;
+            *first = merged;
+            chunks.erase(first+1, last);
 
             return true;
         }
@@ -929,6 +935,9 @@ namespace Cosmos {
                     fclose(tx.progress[i].fp);
                     tx.progress[i].fp = nullptr;
                 }
+                // Drop any read-ahead of the file
+                vector<PACKET_BYTE>().swap(tx.progress[i].read_buffer);
+                tx.progress[i].read_buffer_size = 0;
             }
             return 0;
         }
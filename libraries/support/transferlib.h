@@ -45,6 +45,14 @@ namespace Cosmos {
             PACKET_FILE_SIZE_TYPE chunk_end;
         };
 
+        //! CRC of a run of bytes written to an incoming file
+        struct chunk_crc
+        {
+            PACKET_FILE_SIZE_TYPE chunk_start;
+            PACKET_FILE_SIZE_TYPE chunk_end;
+            PACKET_FILE_CRC_TYPE crc;
+        };
+
         //! All communication file packets to have this header
         struct file_packet_header
         {
@@ -157,7 +165,15 @@ namespace Cosmos {
             PACKET_FILE_SIZE_TYPE total_bytes=0;
             // Chunks to be sent, or chunks that have been received
             vector<file_progress> file_info;
+            // CRCs of the runs of bytes received this session, sorted, with no two overlapping or touching
+            vector<chunk_crc> data_crc;
             FILE * fp = nullptr;
+            // Read-ahead window onto an outgoing file, allocated on the first read
+            vector<PACKET_BYTE> read_buffer;
+            // Offset in the file of the start of read_buffer
+            PACKET_FILE_SIZE_TYPE read_buffer_start=0;
+            // Number of bytes of the file held in read_buffer
+            size_t read_buffer_size=0;
         };
 
         /// Holds data about the queue of file transfers in progress.
@@ -216,6 +232,8 @@ namespace Cosmos {
         bool add_chunk(tx_progress& tx, const file_progress& tp);
         bool add_chunk(tx_progress& tx, const file_progress& tp, bool first, bool last);
         bool add_chunks(tx_progress& tx, const vector<file_progress>& holes, uint8_t start_end_signifier);
+        void add_chunk_crc(tx_progress& tx, const file_progress& tp, const PACKET_BYTE* chunk, CRC16& calc_crc);
+        int32_t calc_file_crc(tx_progress& tx, CRC16& calc_crc);
 
         // Random utility functions
         bool filestruc_smaller_by_size(const filestruc& a, const filestruc& b);
@@ -479,6 +479,12 @@ int main(int argc, char *argv[])
                 fclose(fp);
             }
         }
+
+        // Run commands as they fall due for the rest of this loop
+        while (cmd_queue.wait_commands(agent->get_activeTimeout()))
+        {
+            cmd_queue.run_commands(agent, agent->getNode(), logdate_exec);
+        }
         agent->finish_active_loop();
     }
 
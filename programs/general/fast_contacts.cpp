@@ -28,53 +28,26 @@
 ********************************************************************/
 
 #include "support/convertlib.h"
-#include "support/jsonlib.h"
-#include "agent/agentclass.h"
-#include "physics/physicslib.h"
-#include "math/mathlib.h"
+#include "physics/contactlib.h"
 
-Agent *agent;
 double minimum_elevation = RADOF(10.);
-string nodename;
 string tlename;
 vector <Convert::tlestruc> tlelist;
-struct trackstruc
+
+//! One line of output
+struct eventstruc
 {
-    Convert::tlestruc tle;
-    Convert::locstruc loc;
-    rvector topo;
-    float elfrom;
-    float azfrom;
-    float elto;
-    float azto;
-    float highest;
-    string name;
-    bool visible;
-    bool peaked;
-    double startutc;
+    double utc;
+    size_t index;
+    uint8_t type;
 };
-vector <trackstruc> track;
-
-//mutex mut1;
-//mutex mut2;
-//mutex mut3;
-//mutex mut4;
-
-double utcnow;
-double utcstart;
-double utcend;
-double mylat;
-double mylon;
-
-void propcalc(size_t index);
 
 int main(int argc, char *argv[])
 {
-    //int32_t iretn = 0;
     double period = 1.;
+    double mylat = 0.;
+    double mylon = 0.;
 
-    printf("Iniitial\n");
-    fflush(stdout);
     switch (argc)
     {
     case 6:
@@ -87,106 +60,67 @@ int main(int argc, char *argv[])
         tlename = argv[1];
         break;
     default:
-        printf("Usage: fast_contacts tlename nodename [days]");
+        printf("Usage: fast_contacts tlename lat lon [days] [minelev]");
         exit (1);
         break;
     }
 
-    // Establish the command channel and heartbeat
-    printf("Starting agent\n");
-    fflush(stdout);
-    agent = new Agent();
-//    if ((iretn = agent->wait()) < 0)
-//    {
-//        agent->debug_log.Printf("%16.10f %s Failed to start Agent %s on Node %s Dated %s : %s\n",currentmjd(), mjd2iso8601(currentmjd()).c_str(), agent->getAgent().c_str(), agent->getNode().c_str(), utc2iso8601(data_ctime(argv[0])).c_str(), cosmos_error_string(iretn).c_str());
-//        exit(iretn);
-//    }
-//    else
-//    {
-//        agent->debug_log.Printf("%16.10f %s Started Agent %s on Node %s Dated %s\n",currentmjd(), mjd2iso8601(currentmjd()).c_str(), agent->getAgent().c_str(), agent->getNode().c_str(), utc2iso8601(data_ctime(argv[0])).c_str());
-//    }
-
-
-    agent->cinfo->node.loc.pos.geod.s.lat = RADOF(mylat);
-    agent->cinfo->node.loc.pos.geod.s.lon = RADOF(mylon);
-    agent->cinfo->node.loc.pos.geod.s.h = 348.;
-    agent->cinfo->node.loc.pos.geod.v = gv_zero();
-    agent->cinfo->node.loc.pos.geod.pass++;
-    Convert::pos_geod(&agent->cinfo->node.loc);
-
+    gvector station;
+    station.lat = RADOF(mylat);
+    station.lon = RADOF(mylon);
+    station.h = 348.;
 
     // Load Nodes
 
     printf("loading %s\n", tlename.c_str());
     fflush(stdout);
     load_lines_multi(tlename, tlelist);
+
+    Physics::ContactPredictor predictor;
+    predictor.SetThreads(std::thread::hardware_concurrency());
     for (size_t i=0; i<tlelist.size(); ++i)
     {
-        trackstruc ttrack;
-        ttrack.name = tlelist[i].name;
-        ttrack.visible = false;
-        ttrack.peaked = false;
-        ttrack.highest = 0.;
-        //        ttrack.type = NODE_TYPE_SATELLITE;
-        ttrack.tle = tlelist[i];
-        Convert::pos_clear(ttrack.loc);
-        track.push_back(ttrack);
+        predictor.AddSatellite(tlelist[i]);
     }
+    predictor.AddStation(station, minimum_elevation, minimum_elevation);
 
-    utcstart = currentmjd();
-    utcend = utcstart + period;
-    for (utcnow=utcstart; utcnow<utcend; utcnow+=1./86400)
-    {
-//#pragma omp parallel for
-        for (size_t i=0; i<track.size(); ++i)
-        {
-            propcalc(i);
-        }
-    }
-}
+    double utcstart = currentmjd();
+    double utcend = utcstart + period;
+    vector <Physics::contactstruc> contacts;
+    predictor.Predict(utcstart, utcend, contacts);
 
-void propcalc(size_t index)
-{
-    tle2eci(utcnow, track[index].tle, track[index].loc.pos.eci);
-    track[index].loc.pos.eci.pass++;
-    Convert::pos_eci(&track[index].loc);
-    Convert::geoc2topo(agent->cinfo->node.loc.pos.geod.s, track[index].loc.pos.geoc.s, track[index].topo);
-    Convert::topo2azel(track[index].topo, track[index].azfrom, track[index].elfrom);
-    switch ((uint8_t)track[index].visible)
+    // Report AOS, MAX and LOS of every contact in time order
+    vector <eventstruc> events;
+    for (size_t i=0; i<contacts.size(); ++i)
     {
-    case 0:
-        if (track[index].elfrom > minimum_elevation)
+        events.push_back({contacts[i].aos, i, 0});
+        if (contacts[i].tca < contacts[i].los)
         {
-            track[index].highest = track[index].elfrom;
-            track[index].startutc = utcnow;
-            track[index].visible = true;
-            track[index].peaked = false;
-            printf("%s %13.5f %s         AOS%02d: %4.0f sec %6.1f %5.1f deg\n", mjdToGregorian(utcnow).c_str(), utcnow, track[index].name.c_str(), (int)(DEGOF(minimum_elevation)), 86400.*(utcnow-track[index].startutc), DEGOF(track[index].azfrom), DEGOF(track[index].elfrom));
-            fflush(stdout);
+            events.push_back({contacts[i].tca, i, 1});
         }
-        break;
-    case 1:
-        if (track[index].elfrom < minimum_elevation)
+        if (contacts[i].los < utcend)
         {
-            track[index].visible = false;
-            printf("%s %13.5f %s     LOS%02d: %4.0f sec %6.1f %5.1f deg\n", mjdToGregorian(utcnow).c_str(), utcnow, track[index].name.c_str(), (int)(DEGOF(minimum_elevation)), 86400.*(utcnow-track[index].startutc), DEGOF(track[index].azfrom), DEGOF(track[index].elfrom));
-            fflush(stdout);
+            events.push_back({contacts[i].los, i, 2});
         }
-        else
+    }
+    std::stable_sort(events.begin(), events.end(), [](const eventstruc &a, const eventstruc &b) { return a.utc < b.utc; });
+
+    for (const eventstruc &event : events)
+    {
+        const Physics::contactstruc &contact = contacts[event.index];
+        const string &name = tlelist[contact.satellite].name;
+        switch (event.type)
         {
-            if (track[index].elfrom > track[index].highest)
-            {
-                track[index].highest = track[index].elfrom;
-            }
-            else
-            {
-                if (!track[index].peaked)
-                {
-                    track[index].peaked = true;
-                    printf("%s %13.5f %s             MAX: %4.0f sec %6.1f %5.1f deg\n", mjdToGregorian(utcnow).c_str(), utcnow, track[index].name.c_str(), 86400.*(utcnow-track[index].startutc), DEGOF(track[index].azfrom), DEGOF(track[index].elfrom));
-                }
-            }
+        case 0:
+            printf("%s %13.5f %s         AOS%02d: %4.0f sec %6.1f %5.1f deg\n", mjdToGregorian(event.utc).c_str(), event.utc, name.c_str(), (int)(DEGOF(minimum_elevation)), 0., DEGOF(contact.aosaz), DEGOF(minimum_elevation));
+            break;
+        case 1:
+            printf("%s %13.5f %s             MAX: %4.0f sec %6.1f %5.1f deg\n", mjdToGregorian(event.utc).c_str(), event.utc, name.c_str(), 86400.*(event.utc-contact.aos), DEGOF(contact.tcaaz), DEGOF(contact.tcael));
+            break;
+        case 2:
+            printf("%s %13.5f %s     LOS%02d: %4.0f sec %6.1f %5.1f deg\n", mjdToGregorian(event.utc).c_str(), event.utc, name.c_str(), (int)(DEGOF(minimum_elevation)), 86400.*(event.utc-contact.aos), DEGOF(contact.losaz), DEGOF(minimum_elevation));
+            break;
         }
-        break;
     }
+    fflush(stdout);
 }
@@ -31,6 +31,7 @@
 #include "support/jsonlib.h"
 #include "agent/agentclass.h"
 #include "physics/physicslib.h"
+#include "physics/contactlib.h"
 #include "math/mathlib.h"
 
 static Agent *agent;
@@ -60,7 +61,7 @@ static double utcnow;
 static double minelev = RADOF(15.);
 
 void propinit(size_t index, double dt);
-void proptrack(size_t index, double utcnow);
+void propephemeris(size_t index, double utcend, vector<Convert::cartpos> &ephemeris);
 void propthread(size_t index);
 
 int main(int argc, char *argv[])
@@ -158,13 +159,45 @@ int main(int argc, char *argv[])
         propinit(i, 1.);
     }
 
-    double utc;
-    for (utc=currentmjd(); utc<currentmjd()+period; utc+=1./86400)
+    // Find contacts over the Gauss-Jackson ephemeris of each node
+    Physics::ContactPredictor predictor;
+    predictor.SetThreads(std::thread::hardware_concurrency());
+    double utcstart = currentmjd();
+    vector<size_t> trackindex;
+    for (size_t i=0; i<track.size(); ++i)
+    {
+        vector<Convert::cartpos> ephemeris;
+        propephemeris(i, utcstart + period, ephemeris);
+        if ((iretn = predictor.AddSatellite(ephemeris)) < 0)
+        {
+            printf("Skipping Node %s: %s\n", track[i].name.c_str(), cosmos_error_string(iretn).c_str());
+            continue;
+        }
+        // Map predictor satellite index back to its track
+        trackindex.push_back(i);
+    }
+    predictor.AddStation(agent->cinfo->node.loc.pos.geod.s, 0., minelev);
+
+    vector<Physics::contactstruc> contacts;
+    predictor.Predict(utcstart, utcstart + period, contacts);
+    for (const Physics::contactstruc &contact : contacts)
     {
-        for (size_t i=0; i<track.size(); ++i)
+        if (contact.clipped)
         {
-            proptrack(i, utc);
+            continue;
         }
+        Convert::locstruc loc;
+        Convert::pos_clear(loc);
+        predictor.Position(contact.satellite, contact.tca, loc.pos.eci);
+        loc.pos.eci.pass++;
+        Convert::pos_eci(loc);
+        Convert::kepstruc kep;
+        Convert::eci2kep(loc.pos.eci, kep);
+        printf("%s %f %f ", track[trackindex[contact.satellite]].name.c_str(), DEGOF(loc.pos.earthsep), DEGOF(kep.beta));
+        printf("AOS0: %s %13.5f [ %6.1f %6.1f ] ", mjdToGregorian(contact.aos).c_str(), contact.aos, DEGOF(contact.aosaz), 0.);
+        printf("TCA[ %3.0f ]: %s %13.5f [ %6.1f %6.1f ] ", 86400.*(contact.tca-contact.aos), mjdToGregorian(contact.tca).c_str(), contact.tca, DEGOF(contact.tcaaz), DEGOF(contact.tcael));
+        printf("LOS0[ %3.0f ]: %s %13.5f [ %6.1f %6.1f ]\n", 86400.*(contact.los-contact.aos), mjdToGregorian(contact.los).c_str(), contact.los, DEGOF(contact.losaz), 0.);
+        fflush(stdout);
     }
 
 }
@@ -182,54 +215,28 @@ void propinit(size_t index, double dt)
     track[index].target.utc = track[index].target.loc.utc;
 }
 
-void proptrack(size_t index, double utcnow)
+// Propagate a node to the end of the period, keeping its state every minute. Stops early if the
+// propagator stops advancing, such as once the node is too low.
+void propephemeris(size_t index, double utcend, vector<Convert::cartpos> &ephemeris)
 {
-
-    Physics::gauss_jackson_propagate(track[index].gjh, track[index].physics, track[index].target.loc, utcnow);
-    update_target(agent->cinfo->node.loc, track[index].target);
-    if (track[index].target.elfrom > highest)
+    double utc = track[index].target.loc.pos.eci.utc;
+    do
     {
-        highest = track[index].target.elfrom;
-    }
-    switch (static_cast<uint8_t>(track[index].visible))
-    {
-    case 0:
-        if (track[index].target.elfrom > 0.)
+        vector<Convert::locstruc> states = Physics::gauss_jackson_propagate(track[index].gjh, track[index].physics, track[index].target.loc, utc);
+        if (!ephemeris.empty() && (states.size() < 2 || !(track[index].target.loc.pos.eci.utc > ephemeris.back().utc)))
         {
-            track[index].aos = track[index].target;
-            track[index].highest = 0.;
-            track[index].startutc = utcnow;
-            track[index].visible = true;
-            track[index].peaked = false;
-        }
-        break;
-    case 1:
-        if (track[index].target.elfrom > track[index].highest)
-        {
-            track[index].highest = track[index].target.elfrom;
-        }
-        else if (!track[index].peaked)
-        {
-            track[index].peaked = true;
-            track[index].tca = track[index].target;
-        }
-        if (track[index].target.elfrom < 0.)
-        {
-            track[index].los = track[index].target;
-            track[index].visible = false;
-            if (track[index].tca.elfrom >= minelev)
+            // A step longer than a minute may not be taken yet, but one that is overdue never will be
+            if (86400. * (utc - ephemeris.back().utc) > std::max(120., 2. * fabs(track[index].physics.dt)))
             {
-                Convert::kepstruc kep;
-                Convert::eci2kep(track[index].tca.loc.pos.eci, kep);
-                printf("%s %f %f ", track[index].name.c_str(), DEGOF(track[index].tca.loc.pos.earthsep), DEGOF(kep.beta));
-                printf("AOS0: %s %13.5f [ %6.1f %6.1f ] ", mjdToGregorian(track[index].aos.utc).c_str(), track[index].aos.utc, DEGOF(track[index].aos.azfrom), DEGOF(track[index].aos.elfrom));
-                printf("TCA[ %3.0f ]: %s %13.5f [ %6.1f %6.1f ] ", 86400.*(track[index].tca.utc-track[index].startutc), mjdToGregorian(track[index].tca.utc).c_str(), track[index].tca.utc, DEGOF(track[index].tca.azfrom), DEGOF(track[index].tca.elfrom));
-                printf("LOS0[ %3.0f ]: %s %13.5f [ %6.1f %6.1f ]\n", 86400.*(utcnow-track[index].startutc), mjdToGregorian(track[index].los.utc).c_str(), track[index].los.utc, DEGOF(track[index].los.azfrom), DEGOF(track[index].los.elfrom));
-                fflush(stdout);
+                printf("Node %s stopped propagating at %s\n", track[index].name.c_str(), mjdToGregorian(ephemeris.back().utc).c_str());
+                break;
             }
+            utc += 60./86400.;
+            continue;
         }
-        break;
-    }
+        ephemeris.push_back(track[index].target.loc.pos.eci);
+        utc += 60./86400.;
+    } while (ephemeris.back().utc < utcend);
 }
 
 void propthread(size_t index)
@@ -0,0 +1,107 @@
+// Benchmark for Channel packet queues
+// Pushes packets from 1, 4 and 16 producer threads to a single consumer, first through the
+// mutex protected queue and then through the lock-free ring, and reports throughput, drops
+// (from exceeding the channel maximum) and push to pull latency.
+// Usage: channel_queue_speed [packetcount] [datasize] [maximum]
+
+#include "support/configCosmos.h"
+#include "support/elapsedtime.h"
+#include "support/channellib.h"
+#include <algorithm>
+#include <atomic>
+
+using namespace Cosmos::Support;
+
+size_t packetcount = 200000;
+size_t datasize = 100;
+uint16_t maximum = 1000;
+
+int64_t now_ns()
+{
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+void run(bool lockfree, size_t producers)
+{
+    Channel channels;
+    channels.Init();
+    int32_t number = channels.Add("BENCH", Channel::PACKETCOMM_WRAPPED_SIZE, 0, 1e12, maximum);
+    channels.LockFree(number, lockfree);
+
+    std::atomic<size_t> running(producers);
+    vector<thread> threads;
+    ElapsedTime et;
+    for (size_t p=0; p<producers; ++p)
+    {
+        threads.push_back(thread([&, p] {
+            PacketComm packet;
+            packet.header.type = PacketComm::TypeId::DataObcNop;
+            for (size_t i=p; i<packetcount; i+=producers)
+            {
+                packet.data.resize(datasize);
+                int64_t stamp = now_ns();
+                memcpy(packet.data.data(), &stamp, sizeof(stamp));
+                if (lockfree)
+                {
+                    channels.Push(number, std::move(packet));
+                }
+                else
+                {
+                    channels.Push(number, packet);
+                }
+            }
+            --running;
+        }));
+    }
+
+    vector<double> latency;
+    latency.reserve(packetcount);
+    PacketComm packet;
+    while (running || channels.Size(number) > 0)
+    {
+        if (channels.Pull(number, packet) > 0)
+        {
+            int64_t stamp;
+            memcpy(&stamp, packet.data.data(), sizeof(stamp));
+            latency.push_back((now_ns() - stamp) * 1e-3);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+    double seconds = et.split();
+    for (thread &t : threads)
+    {
+        t.join();
+    }
+
+    std::sort(latency.begin(), latency.end());
+    double p50 = latency.size() ? latency[latency.size() / 2] : 0.;
+    double p99 = latency.size() ? latency[(latency.size() * 99) / 100] : 0.;
+    printf("%-9s producers: %2lu  %9.0f packets/sec  dropped: %6lu  latency p50: %8.1f usec  p99: %8.1f usec\n", lockfree ? "lock-free" : "mutex", producers, packetcount / seconds, packetcount - latency.size(), p50, p99);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        packetcount = atoi(argv[1]);
+    }
+    if (argc > 2)
+    {
+        datasize = std::max(static_cast<size_t>(atoi(argv[2])), sizeof(int64_t));
+    }
+    if (argc > 3)
+    {
+        maximum = atoi(argv[3]);
+    }
+
+    printf("Packets: %lu Data size: %lu Maximum: %u Cores: %u\n", packetcount, datasize, maximum, thread::hardware_concurrency());
+    for (size_t producers : {1, 4, 16})
+    {
+        run(false, producers);
+        run(true, producers);
+    }
+    return 0;
+}
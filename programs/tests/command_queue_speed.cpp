@@ -0,0 +1,123 @@
+// Load test for CommandQueue
+// Queues a large number of time tagged commands, in random order, due at an even rate over a
+// span of seconds, along with some conditional commands that never come true. Then runs the
+// queue the way agent_exec does, sleeping in wait_commands() until the next command is due.
+// Every command must run exactly once, in time order, and never early. Reports how long it
+// took to queue them all, and the dispatch jitter: how late each command ran.
+// Usage: command_queue_speed [eventcount] [span] [conditioncount]
+
+#include "support/configCosmos.h"
+#include "support/elapsedtime.h"
+#include "agent/command_queue.h"
+
+using namespace Cosmos::Support;
+
+size_t eventcount = 100000;
+double span = 10.;
+size_t conditioncount = 100;
+
+// Records when each command runs, instead of running it
+class BenchQueue : public CommandQueue
+{
+public:
+    int32_t run_command(Agent *, Event &cmd, string, double)
+    {
+        dispatched.push_back(std::make_pair(cmd.mjd, currentmjd(0.)));
+        return 0;
+    }
+
+    int32_t run_request(Agent *agent, Event &cmd, string node_name, double logdate_exec)
+    {
+        return run_command(agent, cmd, node_name, logdate_exec);
+    }
+
+    vector<std::pair<double, double>> dispatched;
+};
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        eventcount = atol(argv[1]);
+    }
+    if (argc > 2)
+    {
+        span = atof(argv[2]);
+    }
+    if (argc > 3)
+    {
+        conditioncount = atol(argv[3]);
+    }
+
+    BenchQueue queue;
+    vector<size_t> order(eventcount);
+    for (size_t i=0; i<eventcount; ++i)
+    {
+        order[i] = i;
+    }
+    srand(22);
+    for (size_t i=eventcount; i>1; --i)
+    {
+        std::swap(order[i - 1], order[rand() % i]);
+    }
+
+    double start = currentmjd(0.) + 2. / 86400.;
+    ElapsedTime et;
+    Event cmd;
+    cmd.type = EVENT_TYPE_COMMAND;
+    for (size_t i=0; i<eventcount; ++i)
+    {
+        cmd.name = "event" + std::to_string(order[i]);
+        cmd.mjd = start + order[i] * span / eventcount / 86400.;
+        queue.add_command(cmd);
+    }
+    for (size_t i=0; i<conditioncount; ++i)
+    {
+        cmd.generator("condition" + std::to_string(i), "", start, "(\"node_utc\"<0.)", EVENT_FLAG_CONDITIONAL | EVENT_FLAG_REPEAT, EVENT_TYPE_COMMAND);
+        queue.add_command(cmd);
+    }
+    double queuetime = et.split();
+    printf("Queued %lu commands and %lu conditions in %.3f sec (%.0f/sec)\n", eventcount, conditioncount, queuetime, (eventcount + conditioncount) / queuetime);
+
+    // Run until everything has been dispatched, or well past the end
+    size_t cycles = 0;
+    double end = start + (span + 5.) / 86400.;
+    while (queue.dispatched.size() < eventcount && currentmjd(0.) < end)
+    {
+        queue.wait_commands(end);
+        queue.run_commands(nullptr, "bench", 0.);
+        ++cycles;
+    }
+
+    size_t failures = 0;
+    vector<double> jitter;
+    double last = 0.;
+    for (std::pair<double, double> &dispatch : queue.dispatched)
+    {
+        jitter.push_back((dispatch.second - dispatch.first) * 86400000.);
+        if (jitter.back() < 0. || dispatch.first < last)
+        {
+            ++failures;
+        }
+        last = dispatch.first;
+    }
+    if (queue.dispatched.size() != eventcount || queue.get_command_size() != conditioncount)
+    {
+        ++failures;
+    }
+
+    double mean = 0.;
+    for (double value : jitter)
+    {
+        mean += value;
+    }
+    mean /= std::max(static_cast<size_t>(1), jitter.size());
+    std::sort(jitter.begin(), jitter.end());
+    jitter.push_back(0.);
+    printf("Dispatched %lu commands in %lu cycles\n", queue.dispatched.size(), cycles);
+    printf("Jitter msec: mean %.3f median %.3f 99%% %.3f max %.3f\n", mean, jitter[jitter.size() / 2], jitter[(jitter.size() - 1) * 99 / 100], jitter[jitter.size() > 1 ? jitter.size() - 2 : 0]);
+
+    bool pass = !failures;
+    printf("%s: %lu failures\n", pass ? "PASS" : "FAIL", failures);
+    return pass ? 0 : 1;
+}
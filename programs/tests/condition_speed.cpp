@@ -0,0 +1,112 @@
+// Benchmark for Event conditions
+// Tests a queue of conditional events against the Namespace the way CommandQueue::run_commands()
+// does, first by parsing each condition every time with json_equation(), as condition_true() used
+// to, then with condition_true() and its compiled conditions. Both must agree for every event,
+// every time. Reports evaluations per second each way.
+// Usage: condition_speed [eventcount] [loopcount]
+
+#include "support/configCosmos.h"
+#include "support/elapsedtime.h"
+#include "support/jsonlib.h"
+#include "agent/event.h"
+
+using namespace Cosmos;
+
+size_t eventcount = 300;
+size_t loopcount = 1000;
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        eventcount = atol(argv[1]);
+    }
+    if (argc > 2)
+    {
+        loopcount = atol(argv[2]);
+    }
+
+    cosmosstruc *cinfo = json_init();
+    if (cinfo == nullptr)
+    {
+        printf("Unable to initialize Namespace\n");
+        exit(1);
+    }
+
+    // A different threshold for every event, so every condition is its own equation
+    vector<Event> events(eventcount);
+    for (size_t i=0; i<eventcount; ++i)
+    {
+        char condition[200];
+        switch (i % 3)
+        {
+        case 0:
+            sprintf(condition, "(\"node_battlev\">%.3f)", 10. + i / 100.);
+            break;
+        case 1:
+            sprintf(condition, "((\"node_utc\">%.3f)&(\"node_battlev\"<%.3f))", 59000. + i / 100., 20. - i / 100.);
+            break;
+        case 2:
+            sprintf(condition, "(((\"node_powgen\"*2.)-\"node_battlev\")>%.3f)", i / 10.);
+            break;
+        }
+        events[i].generator("event" + std::to_string(i), "", 0., condition, EVENT_FLAG_CONDITIONAL, EVENT_TYPE_COMMAND);
+    }
+
+    vector<double> parsed(eventcount * loopcount);
+    vector<bool> compiled(eventcount * loopcount);
+    for (Event &event : events)
+    {
+        const char *cp = event.condition.c_str();
+        json_equation(cp, cinfo);
+        event.condition_true(cinfo);
+    }
+
+    ElapsedTime et;
+    for (size_t loop=0; loop<loopcount; ++loop)
+    {
+        cinfo->node.utc = 59000. + loop / 100.;
+        cinfo->node.phys.battlev = 10. + (loop % 100) / 10.;
+        cinfo->node.phys.powgen = (loop % 70) / 5.;
+        for (size_t i=0; i<eventcount; ++i)
+        {
+            const char *cp = events[i].condition.c_str();
+            parsed[loop * eventcount + i] = json_equation(cp, cinfo);
+        }
+    }
+    double parsetime = et.split();
+
+    et.reset();
+    for (size_t loop=0; loop<loopcount; ++loop)
+    {
+        cinfo->node.utc = 59000. + loop / 100.;
+        cinfo->node.phys.battlev = 10. + (loop % 100) / 10.;
+        cinfo->node.phys.powgen = (loop % 70) / 5.;
+        for (size_t i=0; i<eventcount; ++i)
+        {
+            compiled[loop * eventcount + i] = events[i].condition_true(cinfo);
+        }
+    }
+    double compiletime = et.split();
+
+    size_t failures = 0;
+    size_t truecount = 0;
+    for (size_t i=0; i<parsed.size(); ++i)
+    {
+        if ((fabs(parsed[i] - 1.) < std::numeric_limits<double>::epsilon()) != compiled[i] || std::isnan(parsed[i]))
+        {
+            ++failures;
+        }
+        truecount += compiled[i];
+    }
+
+    double evaluations = eventcount * loopcount;
+    printf("Events: %lu Loops: %lu True: %lu\n", eventcount, loopcount, truecount);
+    printf("Parsed:   %10.0f evaluations/sec\n", evaluations / parsetime);
+    printf("Compiled: %10.0f evaluations/sec\n", evaluations / compiletime);
+    json_destroy(cinfo);
+
+    bool pass = !failures;
+    printf("%s: %lu failures\n", pass ? "PASS" : "FAIL", failures);
+    return pass ? 0 : 1;
+}
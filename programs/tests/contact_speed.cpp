@@ -0,0 +1,180 @@
+// Check and benchmark for ContactPredictor
+// Steps a synthetic TLE catalog past a set of ground stations a second at a time, as
+// fast_contacts does, then finds the same contacts with ContactPredictor. Every contact must
+// match in AOS and LOS to within a second. Reports the time each way and the largest
+// differences. The brute force rotates to ITRS with gcrf2itrs() directly, rather than through
+// pos_eci(), which also wants the JPL ephemeris.
+// Usage: contact_speed [satellitecount] [days] [threadcount]
+
+#include "support/configCosmos.h"
+#include "support/elapsedtime.h"
+#include "support/convertlib.h"
+#include "physics/contactlib.h"
+
+using namespace Cosmos::Convert;
+using namespace Cosmos::Physics;
+
+size_t satellitecount = 10;
+double days = 1.;
+uint16_t threadcount = 1;
+double minelev = RADOF(10.);
+
+struct bruteforce
+{
+    uint32_t satellite;
+    uint32_t station;
+    double aos;
+    double max = 0.;
+    double los = 0.;
+};
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        satellitecount = atoi(argv[1]);
+    }
+    if (argc > 2)
+    {
+        days = atof(argv[2]);
+    }
+    if (argc > 3)
+    {
+        threadcount = atoi(argv[3]);
+    }
+
+    double utcstart = 59000.;
+    vector<tlestruc> tles(satellitecount);
+    for (size_t i=0; i<satellitecount; ++i)
+    {
+        tles[i].utc = utcstart - .5 - (i % 7) * .25;
+        tles[i].snumber = 10000 + i;
+        tles[i].bstar = 1e-5 * (1 + i % 10);
+        tles[i].i = RADOF(20. + (i * 37) % 80);
+        tles[i].raan = RADOF((i * 13) % 360);
+        tles[i].e = .0001 + .0002 * (i % 20);
+        tles[i].ap = RADOF((i * 29) % 360);
+        tles[i].ma = RADOF((i * 37) % 360);
+        tles[i].mm = D2PI * (14.5 + .05 * (i % 30)) / 86400.;
+    }
+
+    vector<locstruc> stations(3);
+    stations[0].pos.geod.s.lat = RADOF(21.3);
+    stations[0].pos.geod.s.lon = RADOF(-157.8);
+    stations[0].pos.geod.s.h = 348.;
+    stations[1].pos.geod.s.lat = RADOF(64.8);
+    stations[1].pos.geod.s.lon = RADOF(-147.7);
+    stations[1].pos.geod.s.h = 150.;
+    stations[2].pos.geod.s.lat = RADOF(-33.9);
+    stations[2].pos.geod.s.lon = RADOF(18.4);
+    stations[2].pos.geod.s.h = 10.;
+
+    // Brute force, as in fast_contacts
+    ElapsedTime et;
+    vector<bruteforce> found;
+    for (size_t i=0; i<satellitecount; ++i)
+    {
+        cartpos eci;
+        vector<int32_t> open(stations.size(), -1);
+        vector<float> highest(stations.size(), 0.f);
+        for (double utc=utcstart; utc<utcstart+days; utc+=1./86400)
+        {
+            rmatrix rnp, j2e, dj2e, ddj2e;
+            tle2eci(utc, tles[i], eci);
+            gcrf2itrs(utc, &rnp, &j2e, &dj2e, &ddj2e);
+            rvector geoc = rv_mmult(j2e, eci.s);
+            for (size_t j=0; j<stations.size(); ++j)
+            {
+                rvector topo;
+                float az, el;
+                geoc2topo(stations[j].pos.geod.s, geoc, topo);
+                topo2azel(topo, az, el);
+                if (open[j] < 0)
+                {
+                    if (el > minelev)
+                    {
+                        bruteforce contact;
+                        contact.satellite = i;
+                        contact.station = j;
+                        contact.aos = utc;
+                        open[j] = found.size();
+                        highest[j] = el;
+                        found.push_back(contact);
+                    }
+                }
+                else if (el < minelev)
+                {
+                    found[open[j]].los = utc;
+                    open[j] = -1;
+                }
+                else if (el > highest[j])
+                {
+                    highest[j] = el;
+                }
+                else if (found[open[j]].max == 0.)
+                {
+                    found[open[j]].max = utc;
+                }
+            }
+        }
+    }
+    double brutetime = et.split();
+
+    et.reset();
+    ContactPredictor predictor;
+    predictor.SetThreads(threadcount);
+    for (size_t i=0; i<satellitecount; ++i)
+    {
+        predictor.AddSatellite(tles[i]);
+    }
+    for (size_t j=0; j<stations.size(); ++j)
+    {
+        predictor.AddStation(stations[j].pos.geod.s, minelev);
+    }
+    vector<contactstruc> contacts;
+    predictor.Predict(utcstart, utcstart + days, contacts);
+    double predicttime = et.split();
+
+    // Match each brute force contact
+    size_t unmatched = 0;
+    double aoserror = 0., tcaerror = 0., loserror = 0.;
+    vector<bool> used(contacts.size(), false);
+    for (const bruteforce &contact : found)
+    {
+        bool matched = false;
+        for (size_t k=0; k<contacts.size(); ++k)
+        {
+            const contactstruc &predicted = contacts[k];
+            if (used[k] || predicted.satellite != contact.satellite || predicted.station != contact.station || 86400. * fabs(predicted.aos - contact.aos) > 1.)
+            {
+                continue;
+            }
+            // The brute force sees each event at the first second after it
+            aoserror = std::max(aoserror, 86400. * fabs(contact.aos - predicted.aos));
+            if (contact.max != 0.)
+            {
+                tcaerror = std::max(tcaerror, 86400. * fabs(contact.max - predicted.tca));
+            }
+            if (contact.los != 0.)
+            {
+                loserror = std::max(loserror, 86400. * fabs(contact.los - predicted.los));
+            }
+            used[k] = true;
+            matched = true;
+            break;
+        }
+        if (!matched)
+        {
+            ++unmatched;
+        }
+    }
+    size_t extra = std::count(used.begin(), used.end(), false);
+
+    printf("Satellites: %lu Stations: %lu Days: %.2f Threads: %u\n", satellitecount, stations.size(), days, threadcount);
+    printf("Brute force: %8.3f sec %lu contacts\n", brutetime, found.size());
+    printf("Predictor:   %8.3f sec %lu contacts Speedup: %.0f\n", predicttime, contacts.size(), brutetime / predicttime);
+    printf("Largest difference AOS: %.3f sec TCA: %.3f sec LOS: %.3f sec\n", aoserror, tcaerror, loserror);
+    bool pass = !unmatched && !extra && aoserror <= 1. && loserror <= 1.;
+    printf("%s: %lu unmatched %lu extra\n", pass ? "PASS" : "FAIL", unmatched, extra);
+    return pass ? 0 : 1;
+}
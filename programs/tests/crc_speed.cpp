@@ -0,0 +1,158 @@
+// Check and benchmark for the CRC16 kernels
+// Every kind of CRC16, through every kernel this processor has, must agree with the bit at a
+// time calc_crc16() for messages of every length up to a few blocks, at every alignment, and
+// continued from any remainder. The CCITT free functions must agree with the bit at a time
+// loops they replaced. Then times each kernel on messages from 64 bytes up to a megabyte, and
+// calc_file() on a file (a gigabyte unless told otherwise).
+// Usage: crc_speed [filesize]
+
+#include "support/configCosmos.h"
+#include "support/elapsedtime.h"
+#include "math/crclib.h"
+
+size_t filesize = 1024 * 1024 * 1024;
+string filename = "crc_speed.bin";
+
+const char *kernel_name(CRC16::Kernel kernel)
+{
+    switch (kernel)
+    {
+    case CRC16::Kernel::Bytewise:
+        return "Bytewise";
+    case CRC16::Kernel::Slicing8:
+        return "Slicing8";
+    case CRC16::Kernel::Clmul:
+        return "Clmul";
+    }
+    return "";
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        filesize = atol(argv[1]);
+    }
+
+    vector<CRC16::Kernel> kernels = {CRC16::Kernel::Bytewise, CRC16::Kernel::Slicing8};
+    CRC16 probe;
+    if (probe.set_kernel(CRC16::Kernel::Clmul) == 0)
+    {
+        kernels.push_back(CRC16::Kernel::Clmul);
+    }
+    printf("Best kernel: %s\n", kernel_name(CRC16::best_kernel()));
+
+    vector<uint8_t> buffer(1024 * 1024 + 16);
+    srand(16);
+    for (size_t i=0; i<buffer.size(); ++i)
+    {
+        buffer[i] = rand();
+    }
+
+    // Agreement
+    size_t failures = 0;
+    for (auto type : CRC16::types())
+    {
+        CRC16 calc_crc;
+        calc_crc.set(type.first);
+        string check = "123456789";
+        for (CRC16::Kernel kernel : kernels)
+        {
+            calc_crc.set_kernel(kernel);
+            if (calc_crc.calc(check) != type.second.test)
+            {
+                printf("%s %s: check value %04x, not %04x\n", type.first.c_str(), kernel_name(kernel), calc_crc.calc(check), type.second.test);
+                ++failures;
+            }
+            for (size_t size=0; size<300; ++size)
+            {
+                for (size_t offset=0; offset<16; offset+=5)
+                {
+                    vector<uint8_t> message(&buffer[offset], &buffer[offset + size]);
+                    uint16_t expected = calc_crc16(message, type.second.polynomial, type.second.initialcrc, type.second.xorout, type.second.lsbfirst);
+                    uint16_t crc = calc_crc.calc(&buffer[offset], size);
+                    uint16_t extended = calc_crc.extend(calc_crc.calc(&buffer[offset], size / 3), &buffer[offset + size / 3], size - size / 3);
+                    if (crc != expected || extended != expected)
+                    {
+                        printf("%s %s: size %lu offset %lu: %04x %04x, not %04x\n", type.first.c_str(), kernel_name(kernel), size, offset, crc, extended, expected);
+                        ++failures;
+                    }
+                }
+            }
+        }
+    }
+    for (size_t size=0; size<300; ++size)
+    {
+        vector<uint8_t> message(&buffer[0], &buffer[size]);
+        uint16_t initial = buffer[size] * 257 + buffer[size + 1];
+        if (calc_crc16ccitt_lsb(message, initial) != calc_crc16_lsb(message, CRC16CCITTLSB, initial) || calc_crc16ccitt_msb(message, initial) != calc_crc16_msb(message, CRC16CCITTMSB, initial))
+        {
+            printf("calc_crc16ccitt: size %lu\n", size);
+            ++failures;
+        }
+    }
+
+    // Messages
+    CRC16 calc_crc;
+    uint16_t sum = 0;
+    printf("%-9s", "Bytes");
+    for (CRC16::Kernel kernel : kernels)
+    {
+        printf(" %12s", kernel_name(kernel));
+    }
+    printf("  MB/sec\n");
+    for (size_t size : {64, 256, 1024, 16384, 1024 * 1024})
+    {
+        printf("%-9lu", size);
+        for (CRC16::Kernel kernel : kernels)
+        {
+            calc_crc.set_kernel(kernel);
+            size_t count = std::max(static_cast<size_t>(1), (64 * 1024 * 1024) / size);
+            ElapsedTime et;
+            for (size_t i=0; i<count; ++i)
+            {
+                sum += calc_crc.calc(&buffer[i % 16], size);
+            }
+            printf(" %12.0f", count * size / et.split() / 1e6);
+        }
+        printf("\n");
+    }
+
+    // File
+    FILE *fp = fopen(filename.c_str(), "wb");
+    if (fp == nullptr)
+    {
+        printf("Unable to write %s: %d\n", filename.c_str(), -errno);
+        exit(1);
+    }
+    for (size_t written=0; written<filesize; written+=1024 * 1024)
+    {
+        fwrite(buffer.data(), 1, std::min(filesize - written, static_cast<size_t>(1024 * 1024)), fp);
+    }
+    fclose(fp);
+    printf("File of %lu bytes:", filesize);
+    int32_t first = -1;
+    for (CRC16::Kernel kernel : kernels)
+    {
+        calc_crc.set_kernel(kernel);
+        ElapsedTime et;
+        int32_t crc = calc_crc.calc_file(filename);
+        printf(" %s %.0f MB/sec", kernel_name(kernel), filesize / et.split() / 1e6);
+        if (first < 0)
+        {
+            first = crc;
+        }
+        else if (crc != first)
+        {
+            printf(" (differs)");
+            ++failures;
+        }
+    }
+    printf("\n");
+    remove(filename.c_str());
+
+    volatile uint16_t sink = sum;
+    bool pass = !failures;
+    printf("%s: %lu failures\n", pass ? "PASS" : "FAIL", failures);
+    return (pass || sink != sink) ? 0 : 1;
+}
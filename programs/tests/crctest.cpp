@@ -14,7 +14,7 @@ int main(int argc, char *argv[])
     uint16_t crc;
 
     CRC16 calc_crc;
-    for (auto type : calc_crc.types)
+    for (auto type : CRC16::types())
     {
         calc_crc.set(type.first);
         if (input[0] == '0' && (input[1] == 'x' || input[1] == 'X'))
@@ -0,0 +1,196 @@
+// Check and benchmark for DEM lookups
+// Writes a DEM of four tiles, whose altitude and normal change linearly with latitude and
+// longitude, into a temporary resources folder. Checks that map_dem_sample() interpolates it
+// exactly inside each tile, and that map_dem_pixel() returns the pixels in the files. Then
+// times map_dem_pixel() and map_dem_sample() on random locations, from 1, 2 and 4 threads at
+// once. Reports lookups per second.
+// Usage: dem_speed [pointcount] [tilesize]
+
+#include "support/configCosmos.h"
+#include "support/elapsedtime.h"
+#include "support/convertdef.h"
+#include "support/demlib.h"
+#include "support/datalib.h"
+#include <thread>
+
+using namespace Cosmos::Convert;
+
+size_t pointcount = 1000000;
+uint32_t tilesize = 1000;
+double tiledegrees = 20.;
+
+// Altitude and normal at every pixel center
+dem_pixel expected(double lon, double lat)
+{
+    dem_pixel pixel;
+    pixel.alt = static_cast<float>(100. + 30. * lon - 20. * lat);
+    pixel.nmap[0] = static_cast<float>(lon / 100.);
+    pixel.nmap[1] = static_cast<float>(lat / 100.);
+    pixel.nmap[2] = 1.f;
+    return pixel;
+}
+
+bool close_to(const dem_pixel &a, const dem_pixel &b)
+{
+    return fabs(a.alt - b.alt) < 1e-3 * (1. + fabs(b.alt)) && fabs(a.nmap[0] - b.nmap[0]) < 1e-5 && fabs(a.nmap[1] - b.nmap[1]) < 1e-5 && fabs(a.nmap[2] - b.nmap[2]) < 1e-5;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        pointcount = atol(argv[1]);
+    }
+    if (argc > 2)
+    {
+        tilesize = atol(argv[2]);
+    }
+    double psize = tiledegrees / tilesize;
+
+    char root[] = "/tmp/dem_speed_XXXXXX";
+    if (mkdtemp(root) == nullptr)
+    {
+        printf("Unable to make temporary directory: %d\n", -errno);
+        exit(1);
+    }
+    string path = string(root) + "/mapping/earth";
+    string command = "mkdir -p " + path;
+    if (system(command.c_str()) != 0)
+    {
+        printf("Unable to make %s\n", path.c_str());
+        exit(1);
+    }
+    FILE *fp = fopen((path + "/body.dat").c_str(), "w");
+    fprintf(fp, "149598023. 6378.137 8.848 0. 0. 0.\n");
+    fclose(fp);
+
+    // Four tiles, from -20 to 20 degrees in latitude and longitude
+    FILE *index = fopen((path + "/dems5.dat").c_str(), "w");
+    vector<dem_pixel> row(tilesize);
+    for (int tile=0; tile<4; ++tile)
+    {
+        double lonul = -tiledegrees + (tile % 2) * tiledegrees + psize / 2.;
+        double latul = tiledegrees - (tile / 2) * tiledegrees - psize / 2.;
+        string name = "tile" + std::to_string(tile) + ".dem";
+        fprintf(index, "%s %.10f %.10f %u %u %.10f %d\n", name.c_str(), lonul, latul, tilesize, tilesize, psize, DEM_TYPE_SINGLE);
+        fp = fopen((path + "/" + name).c_str(), "wb");
+        for (uint32_t r=0; r<tilesize; ++r)
+        {
+            for (uint32_t c=0; c<tilesize; ++c)
+            {
+                row[c] = expected(lonul + c * psize, latul - r * psize);
+            }
+            fwrite(row.data(), sizeof(dem_pixel), tilesize, fp);
+        }
+        fclose(fp);
+    }
+    fclose(index);
+    set_cosmosresources(root, false);
+
+    // Interpolation is exact for a linear DEM, away from the edges of the tiles
+    size_t failures = 0;
+    vector<double> lon(pointcount), lat(pointcount);
+    srand(23);
+    for (size_t i=0; i<pointcount; ++i)
+    {
+        double x = (rand() % 2) * tiledegrees + psize + (tiledegrees - 2. * psize) * rand() / RAND_MAX;
+        double y = (rand() % 2) * tiledegrees + psize + (tiledegrees - 2. * psize) * rand() / RAND_MAX;
+        lon[i] = RADOF(x - tiledegrees);
+        lat[i] = RADOF(tiledegrees - y);
+    }
+    vector<dem_pixel> pixels(pointcount);
+    int32_t found = map_dem_sample(COSMOS_EARTH, lon.data(), lat.data(), pointcount, 0., pixels.data());
+    if (found != static_cast<int32_t>(pointcount))
+    {
+        printf("map_dem_sample found %d of %lu\n", found, pointcount);
+        ++failures;
+    }
+    for (size_t i=0; i<pointcount; ++i)
+    {
+        if (!close_to(pixels[i], expected(DEGOF(lon[i]), DEGOF(lat[i]))))
+        {
+            if (failures++ < 10)
+            {
+                printf("map_dem_sample %.6f %.6f: %.4f, not %.4f\n", DEGOF(lon[i]), DEGOF(lat[i]), pixels[i].alt, expected(DEGOF(lon[i]), DEGOF(lat[i])).alt);
+            }
+        }
+    }
+
+    // Single lookups land on pixels of the files
+    for (size_t i=0; i<1000; ++i)
+    {
+        dem_pixel pixel = map_dem_pixel(COSMOS_EARTH, lon[i], lat[i], 0.);
+        double plon = DEGOF(lon[i]);
+        double plat = DEGOF(lat[i]);
+        double column = (pixel.nmap[0] * 100. + tiledegrees) / psize - .5;
+        if (fabs(pixel.nmap[0] * 100. - plon) > 2. * psize || fabs(pixel.nmap[1] * 100. - plat) > 2. * psize || fabs(column - round(column)) > 1e-2)
+        {
+            if (failures++ < 10)
+            {
+                printf("map_dem_pixel %.6f %.6f: pixel at %.6f %.6f\n", plon, plat, pixel.nmap[0] * 100., pixel.nmap[1] * 100.);
+            }
+        }
+    }
+
+    // Out of the DEM is flat
+    double outside[2] = {RADOF(60.), RADOF(-60.)};
+    dem_pixel pixel;
+    if (map_dem_sample(COSMOS_EARTH, &outside[0], &outside[1], 1, 0., &pixel) != 0 || pixel.alt != 0.f || pixel.nmap[2] != 1.f)
+    {
+        printf("map_dem_sample outside the DEM\n");
+        ++failures;
+    }
+
+    // Speed
+    for (size_t threadcount : {1, 2, 4})
+    {
+        vector<std::thread> threads;
+        vector<dem_pixel> results(pointcount);
+        size_t share = pointcount / threadcount;
+        ElapsedTime et;
+        for (size_t t=0; t<threadcount; ++t)
+        {
+            threads.push_back(std::thread([&, t]()
+            {
+                for (size_t i=t*share; i<(t+1)*share; ++i)
+                {
+                    results[i] = map_dem_pixel(COSMOS_EARTH, lon[i], lat[i], 0.);
+                }
+            }));
+        }
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+        double pixeltime = et.split();
+
+        threads.clear();
+        et.reset();
+        for (size_t t=0; t<threadcount; ++t)
+        {
+            threads.push_back(std::thread([&, t]()
+            {
+                for (size_t i=t*share; i<(t+1)*share; i+=1000)
+                {
+                    size_t count = std::min(static_cast<size_t>(1000), (t+1)*share - i);
+                    map_dem_sample(COSMOS_EARTH, &lon[i], &lat[i], count, 0., &results[i]);
+                }
+            }));
+        }
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+        double sampletime = et.split();
+        printf("Threads: %lu map_dem_pixel: %10.0f/sec map_dem_sample: %10.0f/sec\n", threadcount, share * threadcount / pixeltime, share * threadcount / sampletime);
+    }
+
+    command = "rm -rf " + string(root);
+    if (system(command.c_str()) != 0)
+    {
+        printf("Unable to remove %s\n", root);
+    }
+    bool pass = !failures;
+    printf("%s: %lu failures\n", pass ? "PASS" : "FAIL", failures);
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,98 @@
+// Check and benchmark for GeomagModel
+// Loads a WMM file, then calculates the field at a set of positions one at a time, in a single
+// batch, and in batches from several threads at once. Every way must give the same answers.
+// Reports positions per second for each.
+// Usage: geomag_speed wmmfile [count] [threads]
+
+#include "support/configCosmos.h"
+#include "support/elapsedtime.h"
+#include "support/geomag.h"
+#include <thread>
+
+using namespace Cosmos::Convert;
+
+size_t count = 100000;
+size_t threadcount = 4;
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        printf("Usage: geomag_speed wmmfile [count] [threads]\n");
+        exit(1);
+    }
+    if (argc > 2)
+    {
+        count = atol(argv[2]);
+    }
+    if (argc > 3)
+    {
+        threadcount = atol(argv[3]);
+    }
+
+    GeomagModel model;
+    int32_t iretn = model.Load(argv[1]);
+    if (iretn < 0)
+    {
+        printf("Unable to load %s: %d\n", argv[1], iretn);
+        exit(1);
+    }
+    double year = model.Epoch() + 2.5;
+
+    vector<gvector> pos(count);
+    srand(24);
+    for (gvector &tpos : pos)
+    {
+        tpos.lat = (rand() / (double)RAND_MAX - .5) * DPI;
+        tpos.lon = (rand() / (double)RAND_MAX - .5) * D2PI;
+        tpos.h = rand() / (double)RAND_MAX * 1e6;
+    }
+
+    // One at a time
+    vector<rvector> single(count);
+    ElapsedTime et;
+    for (size_t i=0; i<count; ++i)
+    {
+        model.Field(pos[i], year, single[i]);
+    }
+    printf("Single:  %10.0f positions/sec\n", count / et.split());
+
+    // One batch
+    vector<rvector> batch(count);
+    et.reset();
+    model.Field(pos.data(), count, year, batch.data());
+    printf("Batch:   %10.0f positions/sec\n", count / et.split());
+    size_t failures = 0;
+    for (size_t i=0; i<count; ++i)
+    {
+        failures += memcmp(&single[i], &batch[i], sizeof(rvector)) != 0;
+    }
+
+    // A batch for each thread
+    vector<vector<rvector>> comps(threadcount, vector<rvector>(count));
+    vector<std::thread> threads;
+    et.reset();
+    for (size_t t=0; t<threadcount; ++t)
+    {
+        threads.push_back(std::thread([&, t]()
+        {
+            model.Field(pos.data(), count, year, comps[t].data());
+        }));
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    printf("Threads: %10.0f positions/sec with %lu threads\n", threadcount * count / et.split(), threadcount);
+    for (const vector<rvector> &comp : comps)
+    {
+        for (size_t i=0; i<count; ++i)
+        {
+            failures += memcmp(&single[i], &comp[i], sizeof(rvector)) != 0;
+        }
+    }
+
+    bool pass = !failures;
+    printf("%s: %lu failures\n", pass ? "PASS" : "FAIL", failures);
+    return pass ? 0 : 1;
+}
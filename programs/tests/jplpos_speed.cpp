@@ -0,0 +1,206 @@
+// Check and benchmark for the memory mapped JPL Ephemeris
+// Writes a synthetic ephemeris with the layout of DE405, then evaluates it for many bodies and
+// times through jpl_pleph() and through JplEphemeris. Positions and velocities must agree, and
+// accelerations must agree with velocities differenced over 0.1 seconds (to the 50 usec that a
+// Julian day resolves, so about 0.1%). Then times jplpos() as it was (three jpl_pleph() calls
+// under a mutex) against JplEphemeris.
+// Usage: jplpos_speed [loopcount]
+
+#include "support/configCosmos.h"
+#include "support/elapsedtime.h"
+#include "support/ephemlib.h"
+#include "support/jpleph.h"
+
+using namespace Cosmos::Convert;
+
+size_t loopcount = 100000;
+string filename = "jplpos_speed.405";
+
+// Coefficient offsets, coefficients per component, and sub-intervals, as in DE405
+int32_t ipt[13][3] = {{3, 14, 4}, {171, 10, 2}, {231, 13, 2}, {309, 11, 1}, {342, 8, 1}, {366, 7, 1}, {387, 6, 1}, {405, 6, 1}, {423, 6, 1}, {441, 13, 8}, {753, 11, 2}, {819, 10, 4}, {899, 10, 4}};
+double start = 2451536.5;
+double step = 32.;
+uint32_t recordcount = 20;
+
+int32_t write_ephemeris()
+{
+    int32_t kernel = 4;
+    for (uint16_t i=0; i<13; ++i)
+    {
+        kernel += ipt[i][1] * ipt[i][2] * (i == 11 ? 4 : 6);
+    }
+    size_t recsize = kernel * 4;
+    size_t ncoeff = kernel / 2;
+
+    vector<char> header(2 * recsize, 0);
+    sprintf(&header[0], "JPL Planetary Ephemeris DE405/LE405");
+    char *ptr = &header[2652];
+    double end = start + recordcount * step;
+    int32_t ncon = 0;
+    double au = 149597870.691;
+    double emrat = 81.30056;
+    int32_t version = 405;
+    memcpy(ptr, &start, 8);
+    memcpy(ptr + 8, &end, 8);
+    memcpy(ptr + 16, &step, 8);
+    memcpy(ptr + 24, &ncon, 4);
+    memcpy(ptr + 28, &au, 8);
+    memcpy(ptr + 36, &emrat, 8);
+    memcpy(ptr + 44, ipt, 36 * 4);
+    memcpy(ptr + 44 + 36 * 4, &version, 4);
+    memcpy(ptr + 48 + 36 * 4, ipt[12], 3 * 4);
+
+    FILE *fp = fopen(filename.c_str(), "wb");
+    if (fp == nullptr)
+    {
+        return -errno;
+    }
+    fwrite(header.data(), 1, header.size(), fp);
+
+    // Smooth series: large leading terms, falling away
+    srand(405);
+    vector<double> record(ncoeff);
+    for (uint32_t r=0; r<recordcount; ++r)
+    {
+        record[0] = start + r * step;
+        record[1] = record[0] + step;
+        for (uint16_t i=0; i<13; ++i)
+        {
+            size_t count = ipt[i][1] * ipt[i][2] * (i == 11 ? 2 : 3);
+            for (size_t j=0; j<count; ++j)
+            {
+                size_t order = j % ipt[i][1];
+                double scale = (i < 11 ? 1e8 : 1e-2) / pow(10., order);
+                record[ipt[i][0] - 1 + j] = scale * (2. * rand() / RAND_MAX - 1.);
+            }
+        }
+        fwrite(record.data(), sizeof(double), ncoeff, fp);
+        fwrite(header.data(), 1, recsize - ncoeff * sizeof(double), fp);
+    }
+    fclose(fp);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        loopcount = atoi(argv[1]);
+    }
+
+    int32_t iretn = write_ephemeris();
+    if (iretn < 0)
+    {
+        printf("Unable to write %s: %d\n", filename.c_str(), iretn);
+        exit(1);
+    }
+    void *pleph = jpl_init_ephemeris(filename.c_str(), nullptr, nullptr);
+    JplEphemeris mapped;
+    if (pleph == nullptr || (iretn = mapped.Open(filename)) < 0)
+    {
+        printf("Unable to open %s: %d\n", filename.c_str(), iretn);
+        exit(1);
+    }
+
+    // Every body against every other, at times spread through the file
+    vector<int32_t> bodies = {JPL_MERCURY, JPL_VENUS, JPL_EARTH, JPL_MARS, JPL_PLUTO, JPL_MOON, JPL_SUN, JPL_SUN_BARY, JPL_EARTH_BARY};
+    double worstpv = 0.;
+    double worsta = 0.;
+    size_t failures = 0;
+    for (double jd=start+.1; jd<start+recordcount*step-.1; jd+=1.37)
+    {
+        // Random coefficients are not continuous from one sub-interval (of at least 4 days) to the next
+        double offset = fmod(jd - start, 4.);
+        bool edge = offset < .001 || offset > 3.999;
+        for (int32_t target : bodies)
+        {
+            for (int32_t center : bodies)
+            {
+                double reference[3][6];
+                double state[9];
+                if (jpl_pleph(pleph, jd, target, center, reference[1], 1) < 0 || mapped.State(jd, target, center, state) < 0)
+                {
+                    ++failures;
+                    continue;
+                }
+                jpl_pleph(pleph, jd - .05/86400., target, center, reference[0], 1);
+                jpl_pleph(pleph, jd + .05/86400., target, center, reference[2], 1);
+                for (uint16_t i=0; i<3; ++i)
+                {
+                    double scale = std::max(1., fabs(reference[1][i]));
+                    worstpv = std::max(worstpv, fabs(state[i] - reference[1][i]) / scale);
+                    scale = std::max(1e-6, fabs(reference[1][i + 3]));
+                    worstpv = std::max(worstpv, fabs(state[i + 3] - reference[1][i + 3]) / scale);
+                    double difference = (reference[2][i + 3] - reference[0][i + 3]) * 10.;
+                    scale = std::max(1e-6, fabs(state[i + 6]));
+                    if (!edge)
+                    {
+                        worsta = std::max(worsta, fabs(state[i + 6] - difference) / scale);
+                    }
+                }
+            }
+        }
+        double reference[6];
+        double state[9];
+        jpl_pleph(pleph, jd, JPL_NUTATIONS, 0, reference, 1);
+        mapped.State(jd, JPL_NUTATIONS, 0, state);
+        for (uint16_t i=0; i<4; ++i)
+        {
+            worstpv = std::max(worstpv, fabs(state[i] - reference[i]) / std::max(1e-9, fabs(reference[i])));
+        }
+        jpl_pleph(pleph, jd, JPL_LIBRATIONS, 0, reference, 1);
+        mapped.State(jd, JPL_LIBRATIONS, 0, state);
+        for (uint16_t i=0; i<6; ++i)
+        {
+            worstpv = std::max(worstpv, fabs(state[i] - reference[i]) / std::max(1e-9, fabs(reference[i])));
+        }
+    }
+
+    // Sun and Moon, as pos_extra() asks for them, once a minute
+    mutex eph_mutex;
+    ElapsedTime et;
+    double sum = 0.;
+    for (size_t loop=0; loop<loopcount; ++loop)
+    {
+        double jd = start + 1. + loop / 1440.;
+        for (int32_t target : {JPL_EARTH, JPL_MOON})
+        {
+            double pvec[3][6];
+            for (int16_t i=-1; i<2; ++i)
+            {
+                eph_mutex.lock();
+                jpl_pleph(pleph, jd + i * .05/86400., target, JPL_SUN_BARY, pvec[i + 1], 1);
+                eph_mutex.unlock();
+            }
+            sum += pvec[1][0] + pvec[2][3] - pvec[0][3];
+        }
+    }
+    double plephtime = et.split();
+
+    et.reset();
+    for (size_t loop=0; loop<loopcount; ++loop)
+    {
+        double jd = start + 1. + loop / 1440.;
+        for (int32_t target : {JPL_EARTH, JPL_MOON})
+        {
+            double state[9];
+            mapped.State(jd, target, JPL_SUN_BARY, state);
+            sum -= state[0] + state[6];
+        }
+    }
+    double mappedtime = et.split();
+
+    jpl_close_ephemeris(pleph);
+    mapped.Close();
+    remove(filename.c_str());
+
+    size_t count = 2 * loopcount;
+    printf("Loops: %lu\n", loopcount);
+    printf("jpl_pleph() x3: %10.0f states/sec\n", count / plephtime);
+    printf("JplEphemeris:   %10.0f states/sec Speedup: %.2f\n", count / mappedtime, plephtime / mappedtime);
+    printf("Largest relative difference, position and velocity: %.3g acceleration: %.3g\n", worstpv, worsta);
+    bool pass = !failures && worstpv < 1e-12 && worsta < 1e-3;
+    printf("%s: %lu failures\n", pass ? "PASS" : "FAIL", failures);
+    volatile double sink = sum;
+    return (pass || sink != sink) ? 0 : 1;
+}
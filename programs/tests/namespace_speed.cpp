@@ -0,0 +1,178 @@
+// Benchmark for Namespace 2.0 lookups in cosmosstruc
+// Fills Namespace 2.0 up to the requested number of names, then times name lookup and get_json()
+// for every name against the previous way: an ordered map search followed by comparing the type
+// string against each supported type in turn. set_json() is timed for reference.
+// Usage: namespace_speed [namecount] [loopcount]
+
+#include "support/configCosmos.h"
+#include "support/elapsedtime.h"
+#include "support/jsonlib.h"
+
+size_t namecount = 10000;
+size_t loopcount = 10;
+
+// Previous lookup: map searches and a chain of type string compares
+const cosmosstruc::name_handler *ordered_lookup(cosmosstruc *cinfo, const string &name, void *&ptr)
+{
+    cosmosstruc::name_map::const_iterator it = cinfo->names.find(name);
+    if (it == cinfo->names.end())
+    {
+        return nullptr;
+    }
+    ptr = it->second;
+    string type = cinfo->get_type(name);
+    const cosmosstruc::name_handler *handler;
+    for (uint16_t tag=1; (handler=cosmosstruc::get_type_handler(tag)) != nullptr; ++tag)
+    {
+        if (type == handler->type)
+        {
+            return handler;
+        }
+    }
+    return nullptr;
+}
+
+// Current lookup: hashed name and type tag
+const cosmosstruc::name_handler *hashed_lookup(cosmosstruc *cinfo, const string &name, void *&ptr)
+{
+    cosmosstruc::name_index_map::const_iterator it = cinfo->name_index.find(name);
+    if (it == cinfo->name_index.end())
+    {
+        return nullptr;
+    }
+    ptr = it->second.ptr;
+    return cosmosstruc::get_type_handler(it->second.tag);
+}
+
+// Previous get_json()
+string ordered_get_json(cosmosstruc *cinfo, const string &name)
+{
+    void *ptr;
+    const cosmosstruc::name_handler *handler = ordered_lookup(cinfo, name, ptr);
+    json11::Json json;
+    if (handler != nullptr && handler->to_json != nullptr)
+    {
+        json = json11::Json::object { { name, handler->to_json(ptr) } };
+    }
+    return json.dump();
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        namecount = atoi(argv[1]);
+    }
+    if (argc > 2)
+    {
+        loopcount = atoi(argv[2]);
+    }
+
+    cosmosstruc *cinfo = json_init();
+    if (cinfo == nullptr)
+    {
+        printf("Unable to initialize cosmosstruc\n");
+        exit(1);
+    }
+    json_mapentries(cinfo);
+
+    // Pad with a mix of types, ordered so the later ones are far down the compare chain
+    size_t extra = namecount > cinfo->names.size() ? namecount - cinfo->names.size() : 0;
+    vector<double> dvalues(extra / 3 + 1);
+    vector<rvector> rvalues(extra / 3 + 1);
+    vector<vector<float>> fvalues(extra / 3 + 1, vector<float>(4));
+    for (size_t i=0; i<extra; ++i)
+    {
+        switch (i % 3)
+        {
+        case 0:
+            cinfo->add_name("bench.double[" + std::to_string(i / 3) + "]", &dvalues[i / 3], "double");
+            break;
+        case 1:
+            cinfo->add_name("bench.rvector[" + std::to_string(i / 3) + "]", &rvalues[i / 3], "rvector");
+            break;
+        case 2:
+            cinfo->add_name("bench.floats[" + std::to_string(i / 3) + "]", &fvalues[i / 3], "vector<float>");
+            break;
+        }
+    }
+
+    // Only time names whose values are small enough not to swamp the lookup
+    vector<string> names;
+    vector<string> jsons;
+    for (const auto &name : cinfo->names)
+    {
+        string type = cinfo->get_type(name.first);
+        if (type.find("struc") == string::npos && type != "wavefront" && type.find("vector<vector") == string::npos)
+        {
+            string json = cinfo->get_json(name.first);
+            if (json[0] == '{')
+            {
+                names.push_back(name.first);
+                jsons.push_back(json);
+            }
+        }
+    }
+    printf("Names: %lu Timed: %lu Loops: %lu\n", cinfo->names.size(), names.size(), loopcount);
+
+    ElapsedTime et;
+    size_t found = 0;
+    void *ptr;
+    for (size_t loop=0; loop<loopcount; ++loop)
+    {
+        for (const string &name : names)
+        {
+            found += ordered_lookup(cinfo, name, ptr) != nullptr;
+        }
+    }
+    double orderedlookup = et.split();
+
+    et.reset();
+    for (size_t loop=0; loop<loopcount; ++loop)
+    {
+        for (const string &name : names)
+        {
+            found -= hashed_lookup(cinfo, name, ptr) != nullptr;
+        }
+    }
+    double hashedlookup = et.split();
+
+    et.reset();
+    size_t bytes = 0;
+    for (size_t loop=0; loop<loopcount; ++loop)
+    {
+        for (const string &name : names)
+        {
+            bytes += ordered_get_json(cinfo, name).size();
+        }
+    }
+    double orderedtime = et.split();
+
+    et.reset();
+    for (size_t loop=0; loop<loopcount; ++loop)
+    {
+        for (const string &name : names)
+        {
+            bytes -= cinfo->get_json(name).size();
+        }
+    }
+    double hashedtime = et.split();
+
+    et.reset();
+    for (size_t loop=0; loop<loopcount; ++loop)
+    {
+        for (const string &json : jsons)
+        {
+            cinfo->set_json(json);
+        }
+    }
+    double settime = et.split();
+
+    size_t count = names.size() * loopcount;
+    printf("lookup ordered:   %.3f usec/name\n", 1e6 * orderedlookup / count);
+    printf("lookup hashed:    %.3f usec/name Speedup: %.2f\n", 1e6 * hashedlookup / count, orderedlookup / hashedlookup);
+    printf("get_json ordered: %.3f usec/name\n", 1e6 * orderedtime / count);
+    printf("get_json hashed:  %.3f usec/name Speedup: %.2f\n", 1e6 * hashedtime / count, orderedtime / hashedtime);
+    printf("set_json hashed:  %.3f usec/name\n", 1e6 * settime / count);
+    return (bytes || found) ? 1 : 0;
+}
@@ -0,0 +1,133 @@
+// Check and benchmark for PacketComm
+// Packs and unpacks the same packets over and over through one PacketComm each way, as a
+// channel does, for each of the raw, ASM and SLIP framings. Counts the heap allocations made
+// for each packet once the buffers have grown to size, which should be none, and checks that
+// every packet comes back as it went in. Then counts the allocations to make and to copy a
+// PacketComm. Reports packets per second and allocations per packet.
+// Usage: packetcomm_speed [loopcount] [datasize]
+
+#include "support/configCosmos.h"
+#include "support/elapsedtime.h"
+#include "support/packetcomm.h"
+#include <atomic>
+#include <new>
+
+using namespace Cosmos::Support;
+
+size_t loopcount = 100000;
+size_t datasize = 200;
+
+// Every allocation through the global operator new is counted
+static std::atomic<size_t> allocations(0);
+
+void *operator new(size_t size)
+{
+    ++allocations;
+    void *pointer = malloc(size ? size : 1);
+    if (pointer == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void operator delete(void *pointer) noexcept
+{
+    free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+    free(pointer);
+}
+
+enum class Framing
+{
+    Raw,
+    ASM,
+    SLIP
+};
+
+// Packs a packet, unpacks it into the other PacketComm, and checks it
+bool round_trip(PacketComm &out, PacketComm &in, Framing framing)
+{
+    bool ok = false;
+    switch (framing)
+    {
+    case Framing::Raw:
+        ok = out.RawPacketize();
+        in.packetized = out.packetized;
+        ok = ok && in.RawUnPacketize() >= 0;
+        break;
+    case Framing::ASM:
+        ok = out.ASMPacketize();
+        in.packetized = out.packetized;
+        ok = ok && in.ASMUnPacketize();
+        break;
+    case Framing::SLIP:
+        ok = out.SLIPPacketize();
+        in.packetized = out.packetized;
+        ok = ok && in.SLIPUnPacketize();
+        break;
+    }
+    return ok && in.header.type == out.header.type && in.data == out.data;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        loopcount = atol(argv[1]);
+    }
+    if (argc > 2)
+    {
+        datasize = atol(argv[2]);
+    }
+
+    bool pass = true;
+    printf("Loops: %lu Data size: %lu\n", loopcount, datasize);
+    for (Framing framing : {Framing::Raw, Framing::ASM, Framing::SLIP})
+    {
+        PacketComm out;
+        PacketComm in;
+        out.header.type = PacketComm::TypeId::DataFileChunkData;
+        out.data.resize(datasize);
+
+        // Grow the buffers to size, with every byte escaped for SLIP
+        size_t failures = 0;
+        std::fill(out.data.begin(), out.data.end(), 0xc0);
+        failures += !round_trip(out, in, framing);
+        for (size_t i=0; i<datasize; ++i)
+        {
+            out.data[i] = static_cast<uint8_t>(i * 7);
+        }
+
+        ElapsedTime et;
+        size_t start = allocations;
+        for (size_t loop=0; loop<loopcount; ++loop)
+        {
+            // Change the data, including SLIP's special bytes
+            out.data[loop % datasize] = static_cast<uint8_t>(loop);
+            out.data[(loop * 13) % datasize] = 0xc0;
+            failures += !round_trip(out, in, framing);
+        }
+        double elapsed = et.split();
+        double perpacket = static_cast<double>(allocations - start) / loopcount;
+
+        const char *name = framing == Framing::Raw ? "Raw " : (framing == Framing::ASM ? "ASM " : "SLIP");
+        printf("%s: %10.0f packets/sec %8.4f allocations/packet %lu failures\n", name, loopcount / elapsed, perpacket, failures);
+        pass = pass && !failures && perpacket == 0.;
+    }
+
+    size_t start = allocations;
+    PacketComm *packet = new PacketComm;
+    size_t made = allocations - start;
+    start = allocations;
+    PacketComm copy = *packet;
+    size_t copied = allocations - start;
+    delete packet;
+    printf("Allocations to make a PacketComm: %lu to copy one: %lu\n", made, copied);
+
+    printf("%s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
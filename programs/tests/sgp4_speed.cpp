@@ -0,0 +1,156 @@
+// Benchmark for SGP4 propagation of a TLE catalog
+// Builds a synthetic catalog, then propagates every satellite in turn through sgp4() (which must
+// initialize again for each new TLE), through one Sgp4 per TLE, and through an Sgp4Catalog, and
+// reports satellites per second. The conversion to ECI is timed the same way through tle2eci()
+// and the catalog. The catalog is checked against sgp4() / tle2eci(); sgp4() itself runs through
+// Sgp4, and is checked against states from the original sgp4() in convertlib_ut.
+// Usage: sgp4_speed [satellitecount] [loopcount]
+
+#include "support/configCosmos.h"
+#include "support/elapsedtime.h"
+#include "support/convertlib.h"
+
+using namespace Cosmos::Convert;
+
+size_t satellitecount = 5000;
+size_t loopcount = 10;
+
+double separation(const rvector &a, double x, double y, double z)
+{
+    return sqrt((a.col[0] - x) * (a.col[0] - x) + (a.col[1] - y) * (a.col[1] - y) + (a.col[2] - z) * (a.col[2] - z));
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        satellitecount = atoi(argv[1]);
+    }
+    if (argc > 2)
+    {
+        loopcount = atoi(argv[2]);
+    }
+
+    // Low Earth orbit catalog spread across planes, phases, altitudes and epochs
+    double utc = 59000.;
+    vector<tlestruc> tles(satellitecount);
+    for (size_t i=0; i<satellitecount; ++i)
+    {
+        tles[i].utc = utc - (i % 7) * .25;
+        tles[i].snumber = 10000 + i;
+        tles[i].bstar = 1e-5 * (1 + i % 10);
+        tles[i].i = RADOF(20. + (i * 7) % 80);
+        tles[i].raan = RADOF((i * 13) % 360);
+        tles[i].e = .0001 + .0002 * (i % 20);
+        tles[i].ap = RADOF((i * 29) % 360);
+        tles[i].ma = RADOF((i * 37) % 360);
+        tles[i].mm = D2PI * (14.5 + .05 * (i % 30)) / 86400.;
+    }
+
+    vector<Sgp4> satellites(satellitecount);
+    Sgp4Catalog catalog;
+    for (size_t i=0; i<satellitecount; ++i)
+    {
+        satellites[i].Init(tles[i]);
+        catalog.Add(tles[i]);
+    }
+
+    // Check the catalog against sgp4() and tle2eci()
+    // Optimized builds may fuse the catalog's loops differently, so only require agreement to a micron
+    double worst = 0.;
+    double temeworst = 0.;
+    size_t mismatches = 0;
+    double checkutc = utc + .5;
+    catalog.Propagate(checkutc, false);
+    for (size_t i=0; i<satellitecount; ++i)
+    {
+        cartpos reference;
+        sgp4(checkutc, tles[i], reference);
+        double ds = separation(reference.s, catalog.sx[i], catalog.sy[i], catalog.sz[i]);
+        double dv = separation(reference.v, catalog.vx[i], catalog.vy[i], catalog.vz[i]);
+        temeworst = std::max(temeworst, ds);
+        if (ds != 0. || dv != 0.)
+        {
+            ++mismatches;
+        }
+    }
+    catalog.Propagate(checkutc, true);
+    for (size_t i=0; i<satellitecount; ++i)
+    {
+        cartpos reference;
+        tle2eci(checkutc, tles[i], reference);
+        worst = std::max(worst, separation(reference.s, catalog.sx[i], catalog.sy[i], catalog.sz[i]));
+    }
+
+    ElapsedTime et;
+    cartpos pos;
+    double sum = 0.;
+    for (size_t loop=0; loop<loopcount; ++loop)
+    {
+        for (size_t i=0; i<satellitecount; ++i)
+        {
+            sgp4(utc + loop / 1440., tles[i], pos);
+            sum += pos.s.col[0];
+        }
+    }
+    double sgp4time = et.split();
+
+    et.reset();
+    for (size_t loop=0; loop<loopcount; ++loop)
+    {
+        for (size_t i=0; i<satellitecount; ++i)
+        {
+            satellites[i].Propagate(utc + loop / 1440., pos);
+            sum -= pos.s.col[0];
+        }
+    }
+    double objecttime = et.split();
+
+    et.reset();
+    for (size_t loop=0; loop<loopcount; ++loop)
+    {
+        catalog.Propagate(utc + loop / 1440., false);
+        for (size_t i=0; i<satellitecount; ++i)
+        {
+            sum += catalog.sx[i];
+        }
+    }
+    double catalogtime = et.split();
+
+    et.reset();
+    for (size_t loop=0; loop<loopcount; ++loop)
+    {
+        for (size_t i=0; i<satellitecount; ++i)
+        {
+            tle2eci(utc + loop / 1440., tles[i], pos);
+            sum -= pos.s.col[0];
+        }
+    }
+    double tle2ecitime = et.split();
+
+    et.reset();
+    for (size_t loop=0; loop<loopcount; ++loop)
+    {
+        catalog.Propagate(utc + loop / 1440., true);
+        for (size_t i=0; i<satellitecount; ++i)
+        {
+            sum += catalog.sx[i];
+        }
+    }
+    double catalogecitime = et.split();
+
+    size_t count = satellitecount * loopcount;
+    printf("Satellites: %lu Loops: %lu\n", satellitecount, loopcount);
+    printf("TEME sgp4():       %10.0f satellites/sec\n", count / sgp4time);
+    printf("TEME Sgp4:         %10.0f satellites/sec Speedup: %.2f\n", count / objecttime, sgp4time / objecttime);
+    printf("TEME Sgp4Catalog:  %10.0f satellites/sec Speedup: %.2f\n", count / catalogtime, sgp4time / catalogtime);
+    printf("ECI  tle2eci():    %10.0f satellites/sec\n", count / tle2ecitime);
+    printf("ECI  Sgp4Catalog:  %10.0f satellites/sec Speedup: %.2f\n", count / catalogecitime, tle2ecitime / catalogecitime);
+    printf("Largest TEME difference from sgp4(): %.3g m, %lu not bit identical\n", temeworst, mismatches);
+    printf("Largest ECI difference from tle2eci(): %.3g m\n", worst);
+    bool pass = temeworst < 1e-6 && worst < 1e-6;
+    printf("%s\n", pass ? "PASS" : "FAIL");
+    // Printed so the timed loops cannot be optimized away
+    printf("Checksum: %g\n", sum);
+    return pass ? 0 : 1;
+}
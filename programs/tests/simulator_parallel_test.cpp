@@ -0,0 +1,108 @@
+// Determinism check for parallel stepping in Physics::Simulator
+// Runs the same constellation serially and across a thread pool, and confirms that every
+// node ends each step with a bit-identical ECI state.
+// Usage: simulator_parallel_test [nodecount] [threadcount] [runcount]
+
+#include "support/configCosmos.h"
+#include "support/elapsedtime.h"
+#include "physics/simulatorclass.h"
+
+uint16_t nodecount = 32;
+uint16_t threadcount = 4;
+uint32_t runcount = 600;
+double simdt = 1.;
+
+int32_t build_constellation(Physics::Simulator &sim, double utc)
+{
+    int32_t iretn;
+    sim.Init(simdt, "propagate", utc);
+    sim.currentutc = utc;
+    for (uint16_t i=0; i<nodecount; ++i)
+    {
+        // Spread across planes and phases
+        double lat = RADOF(-50. + (100. * i) / nodecount);
+        double lon = RADOF((360. * (i % 8)) / 8. - 180.);
+        iretn = sim.AddNode("node" + std::to_string(i), "U12", Physics::Propagator::PositionIterative, Physics::Propagator::AttitudeLVLH, Physics::Propagator::Thermal, Physics::Propagator::Electrical, utc, lat, lon, 400000. + 2000. * i, RADOF(51.6), 0.);
+        if (iretn < 0)
+        {
+            return iretn;
+        }
+    }
+
+    // LVLH followers of the first node, stepped in a later priority
+    for (uint16_t i=0; i<4; ++i)
+    {
+        cartpos lvlh;
+        lvlh.s.col[0] = 100. * (i + 1);
+        iretn = sim.AddNode("follower" + std::to_string(i), "U12", Physics::Propagator::PositionLvlh, Physics::Propagator::AttitudeLVLH, Physics::Propagator::Thermal, Physics::Propagator::Electrical, sim.cnodes[0]->currentinfo.node.loc.pos.eci, lvlh, qatt(), 1);
+        if (iretn < 0)
+        {
+            return iretn;
+        }
+    }
+    return sim.cnodes.size();
+}
+
+bool same_state(const cartpos &a, const cartpos &b)
+{
+    return memcmp(&a.s, &b.s, sizeof(a.s)) == 0 && memcmp(&a.v, &b.v, sizeof(a.v)) == 0 && memcmp(&a.a, &b.a, sizeof(a.a)) == 0;
+}
+
+int main(int argc, char *argv[])
+{
+    int32_t iretn;
+
+    if (argc > 1)
+    {
+        nodecount = atoi(argv[1]);
+    }
+    if (argc > 2)
+    {
+        threadcount = atoi(argv[2]);
+    }
+    if (argc > 3)
+    {
+        runcount = atoi(argv[3]);
+    }
+
+    double utc = currentmjd();
+    Physics::Simulator serial;
+    Physics::Simulator parallel;
+    if ((iretn = build_constellation(serial, utc)) < 0 || (iretn = build_constellation(parallel, utc)) < 0)
+    {
+        printf("Error building constellation: %s\n", cosmos_error_string(iretn).c_str());
+        exit(iretn);
+    }
+    parallel.SetThreads(threadcount);
+
+    ElapsedTime et;
+    double serialtime = 0.;
+    double paralleltime = 0.;
+    uint32_t mismatches = 0;
+    for (uint32_t step=0; step<runcount; ++step)
+    {
+        et.reset();
+        serial.Propagate();
+        serialtime += et.split();
+        et.reset();
+        parallel.Propagate();
+        paralleltime += et.split();
+
+        for (size_t i=0; i<serial.cnodes.size(); ++i)
+        {
+            if (!same_state(serial.cnodes[i]->currentinfo.node.loc.pos.eci, parallel.cnodes[i]->currentinfo.node.loc.pos.eci))
+            {
+                if (!mismatches)
+                {
+                    printf("Step %u node %s differs\n", step, serial.cnodes[i]->currentinfo.node.name.c_str());
+                }
+                ++mismatches;
+            }
+        }
+    }
+
+    printf("Nodes: %lu Threads: %u Steps: %u\n", serial.cnodes.size(), threadcount, runcount);
+    printf("Serial: %.3f sec Parallel: %.3f sec Speedup: %.2f\n", serialtime, paralleltime, serialtime / paralleltime);
+    printf("%s: %u mismatched node states\n", mismatches ? "FAIL" : "PASS", mismatches);
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,119 @@
+// Benchmark for compiled SOH output
+// Builds the default SOH table, and a table of every simple typed name in the Namespace, then
+// times json_of_table() against json_of_template() on each, confirming both produce the same
+// string. Reports heap allocations per post and nanoseconds per field.
+// Usage: soh_template_speed [loopcount]
+
+#include "support/configCosmos.h"
+#include "support/elapsedtime.h"
+#include "support/jsonlib.h"
+#include <atomic>
+#include <new>
+
+size_t loopcount = 10000;
+
+// Count every heap allocation
+std::atomic<size_t> allocations(0);
+
+void *operator new(size_t size)
+{
+    ++allocations;
+    void *ptr = malloc(size ? size : 1);
+    if (ptr == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void *ptr) noexcept
+{
+    free(ptr);
+}
+
+bool run(cosmosstruc *cinfo, string title, string list)
+{
+    vector<jsonentry*> table;
+    json_table_of_list(table, list, cinfo);
+    jsontemplate jtemplate;
+    json_compile_table(jtemplate, table, cinfo);
+
+    string tablestring;
+    string templatestring;
+    json_of_table(tablestring, table, cinfo);
+    json_of_template(templatestring, jtemplate, cinfo);
+    if (tablestring != templatestring)
+    {
+        printf("%s: FAIL output differs\n%s\n%s\n", title.c_str(), tablestring.c_str(), templatestring.c_str());
+        return false;
+    }
+
+    size_t count = allocations;
+    ElapsedTime et;
+    for (size_t loop=0; loop<loopcount; ++loop)
+    {
+        json_of_table(tablestring, table, cinfo);
+    }
+    double tabletime = et.split();
+    double tableallocs = static_cast<double>(allocations - count) / loopcount;
+
+    count = allocations;
+    et.reset();
+    for (size_t loop=0; loop<loopcount; ++loop)
+    {
+        json_of_template(templatestring, jtemplate, cinfo);
+    }
+    double templatetime = et.split();
+    double templateallocs = static_cast<double>(allocations - count) / loopcount;
+
+    size_t fields = jtemplate.fields.size() * loopcount;
+    printf("%s: %lu fields %lu bytes\n", title.c_str(), jtemplate.fields.size(), templatestring.size());
+    printf("  json_of_table:    %8.1f nsec/field %8.1f allocations/post\n", 1e9 * tabletime / fields, tableallocs);
+    printf("  json_of_template: %8.1f nsec/field %8.1f allocations/post Speedup: %.2f\n", 1e9 * templatetime / fields, templateallocs, tabletime / templatetime);
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        loopcount = atoi(argv[1]);
+    }
+
+    cosmosstruc *cinfo = json_init();
+    if (cinfo == nullptr)
+    {
+        printf("Unable to initialize cosmosstruc\n");
+        exit(1);
+    }
+    json_mapentries(cinfo);
+
+    // Every simple typed name, as in a large device SOH list
+    string scalars;
+    for (const vector<jsonentry> &bucket : cinfo->jmap)
+    {
+        for (const jsonentry &entry : bucket)
+        {
+            switch (entry.type)
+            {
+            case JSON_TYPE_UINT8:
+            case JSON_TYPE_UINT16:
+            case JSON_TYPE_UINT32:
+            case JSON_TYPE_INT16:
+            case JSON_TYPE_INT32:
+            case JSON_TYPE_FLOAT:
+            case JSON_TYPE_DOUBLE:
+                scalars += scalars.empty() ? "{" : ",";
+                scalars += "\"" + entry.name + "\"";
+                break;
+            }
+        }
+    }
+    scalars += "}";
+
+    printf("Loops: %lu\n", loopcount);
+    bool pass = run(cinfo, "Default SOH", json_list_of_soh(cinfo));
+    pass = run(cinfo, "Simple types", scalars) && pass;
+    printf("%s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+// Check and benchmark for update_target() with targetindex::cull set
+// Scatters stationary point and area targets over the Earth, then flies a node in low Earth
+// orbit over them. For the first steps, every target is also updated in full, as before
+// targets were indexed, and every target above the horizon must agree exactly, while every
+// other must be below it. Then times update_target() for the rest of the steps, and reports
+// how many targets each step visited.
+// Usage: target_speed [targetcount] [stepcount] [checkcount]
+
+#include "support/configCosmos.h"
+#include "support/elapsedtime.h"
+#include "support/jsonlib.h"
+#include "support/convertlib.h"
+
+size_t targetcount = 50000;
+size_t stepcount = 500;
+size_t checkcount = 10;
+
+// Node in a circular orbit of 500 km, inclined 51.6 degrees
+void place_node(cosmosstruc *cinfo, double utc)
+{
+    double radius = REARTHM + 500000.;
+    double speed = sqrt(GM / radius);
+    double angle = (utc - 59000.) * 86400. * speed / radius;
+    double inclination = RADOF(51.6);
+    Convert::locstruc &loc = cinfo->node.loc;
+    loc.pos.eci.utc = utc;
+    loc.pos.eci.s = rvector(radius * cos(angle), radius * sin(angle) * cos(inclination), radius * sin(angle) * sin(inclination));
+    loc.pos.eci.v = rvector(-speed * sin(angle), speed * cos(angle) * cos(inclination), speed * cos(angle) * sin(inclination));
+    loc.pos.eci.a = rvector();
+    loc.pos.eci.pass++;
+    Convert::pos_eci(loc);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        targetcount = atol(argv[1]);
+    }
+    if (argc > 2)
+    {
+        stepcount = atol(argv[2]);
+    }
+    if (argc > 3)
+    {
+        checkcount = atol(argv[3]);
+    }
+
+    cosmosstruc *cinfo = json_init();
+    cinfo->target_index.cull = true;
+    double utc = 59000.;
+    place_node(cinfo, utc);
+    if (Convert::pos_extra(utc, cinfo->node.loc) < 0)
+    {
+        printf("COSMOS resources not available\n");
+        exit(1);
+    }
+
+    srand(25);
+    cinfo->target.resize(targetcount);
+    for (size_t i=0; i<targetcount; ++i)
+    {
+        targetstruc &target = cinfo->target[i];
+        target.name = "target" + std::to_string(i);
+        target.loc.pos.geod.utc = utc;
+        target.loc.pos.geod.s.lat = asin(2. * rand() / RAND_MAX - 1.);
+        target.loc.pos.geod.s.lon = D2PI * rand() / RAND_MAX - DPI;
+        target.loc.pos.geod.s.h = 3000. * rand() / RAND_MAX;
+        target.loc.pos.geod.pass++;
+        if (i % 10 == 0)
+        {
+            target.size = gvector(50000. / REARTHM, 50000. / REARTHM, 0.);
+            target.area = DPI * 50000. * 50000.;
+        }
+        Convert::loc_update(target.loc);
+    }
+    vector<targetstruc> full = cinfo->target;
+    printf("Targets: %lu Steps: %lu\n", targetcount, stepcount);
+
+    size_t failures = 0;
+    size_t visited = 0;
+    size_t inview = 0;
+    double elapsed = 0.;
+    double fullelapsed = 0.;
+    for (size_t step=0; step<stepcount; ++step)
+    {
+        utc += 10. / 86400.;
+        place_node(cinfo, utc);
+        ElapsedTime et;
+        update_target(cinfo);
+        if (step)
+        {
+            elapsed += et.split();
+            visited += cinfo->target_index.updated.size();
+        }
+        if (step >= checkcount)
+        {
+            continue;
+        }
+
+        et.reset();
+        for (targetstruc &target : full)
+        {
+            update_target(cinfo->node.loc, target);
+        }
+        fullelapsed += et.split();
+        for (size_t i=0; i<targetcount; ++i)
+        {
+            const targetstruc &target = cinfo->target[i];
+            if (full[i].elto > 0.)
+            {
+                ++inview;
+                if (target.elto != full[i].elto || target.azto != full[i].azto || target.range != full[i].range || target.min != full[i].min || target.elfrom != full[i].elfrom)
+                {
+                    printf("Step %lu target %lu: el %f az %f range %f, not el %f az %f range %f\n", step, i, target.elto, target.azto, target.range, full[i].elto, full[i].azto, full[i].range);
+                    ++failures;
+                }
+            }
+            else if (target.elto > 0.)
+            {
+                printf("Step %lu target %lu: el %f, not below the horizon at %f\n", step, i, target.elto, full[i].elto);
+                ++failures;
+            }
+        }
+    }
+    printf("Visited %.1f targets/step, %.1f above the horizon\n", visited / (stepcount - 1.), inview / static_cast<double>(checkcount));
+    printf("Indexed: %10.0f steps/sec Full: %10.2f steps/sec\n", (stepcount - 1.) / elapsed, checkcount / fullelapsed);
+    json_destroy(cinfo);
+
+    bool pass = !failures;
+    printf("%s: %lu failures\n", pass ? "PASS" : "FAIL", failures);
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,159 @@
+// Benchmark for sending files with Transfer
+// Queues one outgoing file to each of 1, 8 and 64 destination nodes, then serves them the way
+// FileModule does: send_outgoing_lpackets() for each node in turn, with the sender stopping each
+// turn after a few packets. Every DATA packet is checked against the file it came from. Reports
+// DATA packets per second for each count of files.
+// Usage: transfer_speed [filesize] [burst]
+
+#include "support/configCosmos.h"
+#include "support/elapsedtime.h"
+#include "support/jsonlib.h"
+#include "support/transferclass.h"
+
+using namespace Cosmos::Support;
+
+size_t filesize = 1000000;
+size_t burst = 8;
+string agent_name = "bench";
+
+// Byte expected at each offset of the file for each node
+PACKET_BYTE expected(PACKET_NODE_ID_TYPE node_id, size_t offset)
+{
+    return static_cast<PACKET_BYTE>(offset * 131 + (offset >> 9) + node_id * 29);
+}
+
+// Checks DATA packets, and stops each turn after burst packets
+class BenchSender : public Sender
+{
+public:
+    SendRetVal send(PacketComm& packet)
+    {
+        increment_number_of_packets_sent();
+        if (packet.header.type == PacketComm::TypeId::DataFileChunkData)
+        {
+            packet_struct_data data;
+            if (deserialize_data(packet.data, data) < 0)
+            {
+                ++errors;
+            }
+            else
+            {
+                for (size_t i=0; i<data.byte_count; ++i)
+                {
+                    if (data.chunk[i] != expected(packet.header.nodedest, data.chunk_start + i))
+                    {
+                        ++errors;
+                        break;
+                    }
+                }
+                bytes += data.byte_count;
+            }
+            ++datacount;
+        }
+        return ++turncount < burst ? SendRetVal::SUCCESS : SendRetVal::QUIT;
+    }
+
+    size_t turncount = 0;
+    size_t datacount = 0;
+    size_t bytes = 0;
+    size_t errors = 0;
+};
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+    {
+        filesize = atol(argv[1]);
+    }
+    if (argc > 2)
+    {
+        burst = atol(argv[2]);
+    }
+
+    char root[] = "/tmp/transfer_speed_XXXXXX";
+    if (mkdtemp(root) == nullptr)
+    {
+        printf("Unable to make temporary directory: %d\n", -errno);
+        exit(1);
+    }
+    setenv("COSMOSNODES", root, 1);
+
+    bool pass = true;
+    printf("File size: %lu Burst: %lu\n", filesize, burst);
+    for (uint16_t filecount : {1, 8, 64})
+    {
+        cosmosstruc *cinfo = json_init();
+        cinfo->node.name = "bench_source";
+        cinfo->realm.node_ids["bench_source"] = 1;
+        vector<uint8_t> node_ids;
+        vector<PACKET_BYTE> contents(filesize);
+        for (uint16_t i=0; i<filecount; ++i)
+        {
+            string node_name = "bench_dest" + std::to_string(i);
+            node_ids.push_back(10 + i);
+            cinfo->realm.node_ids[node_name] = node_ids.back();
+            for (size_t j=0; j<filesize; ++j)
+            {
+                contents[j] = expected(node_ids.back(), j);
+            }
+            string path = data_base_path(node_name, "outgoing", agent_name, "file");
+            FILE *fp = fopen(path.c_str(), "wb");
+            if (fp == nullptr)
+            {
+                printf("Unable to write %s: %d\n", path.c_str(), -errno);
+                exit(1);
+            }
+            fwrite(contents.data(), 1, filesize, fp);
+            fclose(fp);
+        }
+
+        BenchSender sender;
+        Transfer transfer(&sender);
+        int32_t iretn = transfer.Init(cinfo, false);
+        if (iretn < 0)
+        {
+            printf("Unable to initialize Transfer: %d\n", iretn);
+            exit(1);
+        }
+        for (uint16_t i=0; i<filecount; ++i)
+        {
+            if ((iretn = transfer.outgoing_tx_add("bench_dest" + std::to_string(i), agent_name, "file")) < 0)
+            {
+                printf("Unable to queue file %u: %d\n", i, iretn);
+                exit(1);
+            }
+        }
+
+        ElapsedTime et;
+        size_t expectedbytes = filecount * filesize;
+        size_t lastbytes = 0;
+        do
+        {
+            lastbytes = sender.bytes;
+            for (uint8_t node_id : node_ids)
+            {
+                sender.turncount = 0;
+                transfer.send_outgoing_lpackets(node_id);
+            }
+        } while (sender.bytes < expectedbytes && sender.bytes != lastbytes);
+        double elapsed = et.split();
+
+        bool ok = sender.bytes == expectedbytes && !sender.errors;
+        pass = pass && ok;
+        printf("Files: %2u DATA packets: %8lu %10.0f packets/sec %7.1f MB/sec %s\n", filecount, sender.datacount, sender.datacount / elapsed, sender.bytes / elapsed / 1e6, ok ? "" : "(bad data)");
+
+        for (uint8_t node_id : node_ids)
+        {
+            transfer.close_file_pointers(node_id, 2);
+        }
+        json_destroy(cinfo);
+    }
+
+    string command = "rm -rf " + string(root);
+    if (system(command.c_str()) != 0)
+    {
+        printf("Unable to remove %s\n", root);
+    }
+    printf("%s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
@@ -17,3 +17,62 @@ TEST(AgentTest, Agent_is_successfully_created_without_any_setup) {
     delete agent;
 }
 
+
+static int32_t ut_slow(string &request, string &response, Agent *agent)
+{
+    secondsleep(.5);
+    response = "slow";
+    return 0;
+}
+
+// One worker and a two deep queue: the first request runs, the next two wait past their
+// deadline, and the fourth finds the queue full.
+TEST(AgentTest, Concurrent_requests_past_deadline_or_queue_are_refused) {
+    string testname = "agent_ut1";
+    Agent* agent = new Agent("", testname + "_node", testname + "_agent", 0., AGENTMAXBUFFER, false, 0, NetworkType::UDP, 0);
+    ASSERT_GE(agent->last_error(), 0);
+    ASSERT_EQ(agent->set_request_threads(1), 1);
+    ASSERT_EQ(agent->set_request_queue(2), 2);
+    ASSERT_EQ(agent->add_request("ut_slow", ut_slow, "", "", true, .2), 0);
+
+    ElapsedTime et;
+    while (agent->cinfo->agent0.beat.port == 0 && et.split() < 5.)
+    {
+        secondsleep(.01);
+    }
+    beatstruc beat = agent->cinfo->agent0.beat;
+    ASSERT_NE(beat.port, 0);
+    strcpy(beat.addr, "127.0.0.1");
+    beat.utc = currentmjd();
+
+    vector<string> responses(4);
+    vector<thread> requesters;
+    for (size_t i=0; i<responses.size(); ++i)
+    {
+        requesters.push_back(thread([&, i] { agent->send_request(beat, "ut_slow", responses[i], 5.); }));
+        secondsleep(.05);
+    }
+    for (thread &requester : requesters)
+    {
+        requester.join();
+    }
+    EXPECT_NE(responses[0].find("slow"), string::npos);
+    EXPECT_NE(responses[1].find("[NOK] " + std::to_string(GENERAL_ERROR_TIMEOUT)), string::npos);
+    EXPECT_NE(responses[2].find("[NOK] " + std::to_string(GENERAL_ERROR_TIMEOUT)), string::npos);
+    EXPECT_NE(responses[3].find("[NOK] " + std::to_string(GENERAL_ERROR_BUSY)), string::npos);
+
+    // Only the request that ran has a latency
+    string response;
+    ASSERT_GT(agent->send_request(beat, "request_latency ut_slow", response, 5.), 0);
+    string error;
+    json11::Json latency = json11::Json::parse(response.substr(response.find('\n') + 1), error)["ut_slow"];
+    ASSERT_TRUE(error.empty()) << error;
+    EXPECT_EQ(latency["count"].number_value(), 1.);
+    EXPECT_GE(latency["p50"].number_value(), 500.);
+    EXPECT_LE(latency["p50"].number_value(), latency["p90"].number_value());
+    EXPECT_LE(latency["p90"].number_value(), latency["p99"].number_value());
+    EXPECT_LE(latency["p99"].number_value(), latency["max"].number_value());
+
+    // Workers are joined on shutdown
+    delete agent;
+}
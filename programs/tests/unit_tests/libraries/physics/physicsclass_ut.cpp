@@ -0,0 +1,145 @@
+#include "physics/physicsclass.h"
+#include "gtest/gtest.h"
+
+using namespace Cosmos::Physics;
+
+// Write a degree 100 EGM2008 file with made up coefficients into a resources folder
+static void write_egm2008_file()
+{
+    ASSERT_TRUE(COSMOS_MKDIR("gravity_ut", 00777) == 0 || errno == EEXIST);
+    ASSERT_TRUE(COSMOS_MKDIR("gravity_ut/general", 00777) == 0 || errno == EEXIST);
+    FILE *fp = fopen("gravity_ut/general/egm2008_coef.txt", "w");
+    ASSERT_NE(fp, nullptr);
+    for (uint32_t il=2; il<=100; ++il)
+    {
+        for (uint32_t im=0; im<=il; ++im)
+        {
+            double c = ((il * 31 + im * 17) % 101 - 50.) * 1e-8 / il;
+            double s = im ? ((il * 13 + im * 29) % 97 - 48.) * 1e-8 / il : 0.;
+            if (il == 2 && im == 0)
+            {
+                c = -4.84165143790815e-04;
+            }
+            fprintf(fp, "%u %u %.15e %.15e\n", il, im, c, s);
+        }
+    }
+    fclose(fp);
+    ASSERT_EQ(set_cosmosresources("gravity_ut", false), 0);
+}
+
+static void remove_egm2008_file()
+{
+    remove("gravity_ut/general/egm2008_coef.txt");
+    ::rmdir("gravity_ut/general");
+    ::rmdir("gravity_ut");
+}
+
+struct gravity_case
+{
+    uint32_t degree;
+    double geoc[3];
+    double accel[3];
+};
+
+// Accelerations from the GravityAccel() that kept its coefficients and Legendre terms in statics,
+// run on the file above
+static const gravity_case gravity_cases[] = {
+    {2, {6778137, 0, 0}, {-8.6884366417635643, 5.3555271674535241e-06, 4.3141746626708949e-06}},
+    {2, {-2112000.5, 4520000.25, 4700000.125}, {2.6092959937742508, -5.5842840051059754, -5.8230233571082044}},
+    {2, {1000000, -6500000, -1800000}, {-1.2586390827457277, 8.1811276393938304, 2.2719735673154293}},
+    {2, {26560000, 1234567.5, -3000000}, {-0.55267819409841801, -0.025689685075870446, 0.062437541071149551}},
+    {12, {6778137, 0, 0}, {-8.6884439703108285, 1.0358774349762224e-06, -2.1986122375523957e-06}},
+    {12, {-2112000.5, 4520000.25, 4700000.125}, {2.6093032967091498, -5.5842941527373577, -5.8230132396601242}},
+    {12, {1000000, -6500000, -1800000}, {-1.2586269434655804, 8.1811228286796158, 2.2719686014503822}},
+    {12, {26560000, 1234567.5, -3000000}, {-0.55267820364634446, -0.025689686927798779, 0.062437536951186236}},
+    {40, {6778137, 0, 0}, {-8.6884411123624936, 4.5809461336382563e-06, 4.5201452678564953e-06}},
+    {40, {-2112000.5, 4520000.25, 4700000.125}, {2.6093019743517751, -5.5843103934220082, -5.8230287424702656}},
+    {40, {1000000, -6500000, -1800000}, {-1.2586411518555667, 8.1811194902273527, 2.2719641700416924}},
+    {40, {26560000, 1234567.5, -3000000}, {-0.55267820364634057, -0.025689686927793057, 0.062437536951184022}},
+};
+
+// Up to degree 20 every term matches the old code bit for bit. Beyond that the old code took
+// factorial ratios by division, so only the last bits may differ.
+TEST(PhysicsclassTest, Gravity_model_matches_static_implementation) {
+    write_egm2008_file();
+
+    const GravityModel &shared = GravityShared(GravityEGM2008_NORM);
+    ASSERT_EQ(shared.status, 0);
+    ASSERT_EQ(shared.degree, 100u);
+    for (const gravity_case &test : gravity_cases)
+    {
+        rvector geoc(test.geoc[0], test.geoc[1], test.geoc[2]);
+        GravityModel model(GravityEGM2008_NORM, test.degree);
+        ASSERT_EQ(model.status, 0);
+        Vector truncated = model.Accel(geoc);
+        Vector full = shared.Accel(geoc, test.degree);
+        for (uint16_t i=0; i<3; ++i)
+        {
+            EXPECT_EQ(truncated[i], full[i]);
+            if (test.degree <= 20)
+            {
+                EXPECT_EQ(truncated[i], test.accel[i]);
+            }
+            else
+            {
+                EXPECT_NEAR(truncated[i], test.accel[i], 1e-15 * fabs(test.accel[0]));
+            }
+        }
+    }
+
+    // Batch evaluation matches single evaluation
+    GravityModel model(GravityEGM2008_NORM, 12);
+    vector<rvector> geocs;
+    for (const gravity_case &test : gravity_cases)
+    {
+        geocs.push_back(rvector(test.geoc[0], test.geoc[1], test.geoc[2]));
+    }
+    vector<Vector> accels;
+    ASSERT_EQ(model.Accel(geocs, accels), static_cast<int32_t>(geocs.size()));
+    for (size_t i=0; i<geocs.size(); ++i)
+    {
+        Vector single = model.Accel(geocs[i]);
+        EXPECT_EQ(memcmp(&accels[i], &single, sizeof(single)), 0);
+    }
+
+    // Batch evaluation of the shared model stops at the requested degree
+    ASSERT_EQ(shared.Accel(geocs, accels, 12), static_cast<int32_t>(geocs.size()));
+    for (size_t i=0; i<geocs.size(); ++i)
+    {
+        Vector single = model.Accel(geocs[i]);
+        EXPECT_EQ(memcmp(&accels[i], &single, sizeof(single)), 0);
+    }
+
+    remove_egm2008_file();
+}
+
+// GravityParams and GravityAccel use the one shared instance
+TEST(PhysicsclassTest, Gravity_params_reuses_shared_model) {
+    const GravityModel &shared = GravityShared(GravityEGM2008_NORM);
+    EXPECT_EQ(&shared, &GravityShared(GravityEGM2008_NORM));
+    EXPECT_EQ(GravityParams(GravityEGM2008_NORM), shared.status);
+    EXPECT_EQ(&shared, &GravityShared(GravityEGM2008_NORM));
+
+    posstruc pos;
+    pos.geoc.s = rvector(6778137., 0., 0.);
+    Vector accel = GravityAccel(pos, GravityEGM2008_NORM, 12);
+    Vector expected = shared.Accel(pos.geoc.s, 12);
+    EXPECT_EQ(memcmp(&accel, &expected, sizeof(accel)), 0);
+}
+
+// A model that fails to load is tried again on the next call, rather than kept
+TEST(PhysicsclassTest, Gravity_shared_retries_failed_load) {
+    ASSERT_TRUE(COSMOS_MKDIR("gravity_ut", 00777) == 0 || errno == EEXIST);
+    ASSERT_EQ(set_cosmosresources("gravity_ut", false), 0);
+    const GravityModel &failed = GravityShared(GravityEGM2008);
+    EXPECT_LT(failed.status, 0);
+    EXPECT_LT(GravityParams(GravityEGM2008), 0);
+
+    write_egm2008_file();
+    const GravityModel &loaded = GravityShared(GravityEGM2008);
+    EXPECT_EQ(loaded.status, 0);
+    EXPECT_NE(&loaded, &failed);
+    EXPECT_EQ(&loaded, &GravityShared(GravityEGM2008));
+    EXPECT_EQ(GravityParams(GravityEGM2008), 0);
+    remove_egm2008_file();
+}
@@ -0,0 +1,113 @@
+#include "physics/simulatorclass.h"
+#include "gtest/gtest.h"
+
+using namespace Cosmos::Physics;
+
+// Two nodes with a known position, not propagated
+class CaptureTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        for (uint16_t i=0; i<2; ++i)
+        {
+            nodes.push_back(new State("capnode" + std::to_string(i)));
+            nodes.back()->currentinfo.node.loc.pos.eci.s = rvector(7000000. + i, 1000. * i, -500.);
+        }
+    }
+
+    void TearDown() override
+    {
+        for (State *state : nodes)
+        {
+            delete state;
+        }
+        remove("capture_ut.bin");
+        remove("capture_ut.bin.json");
+    }
+
+    vector<State*> nodes;
+};
+
+// Values captured to a file read back the same after Close and Open
+TEST_F(CaptureTest, Init_append_close_open_round_trip) {
+    Capture capture;
+    ASSERT_EQ(capture.AddField("node.loc.pos.eci"), 1);
+    ASSERT_EQ(capture.AddField("node.loc.pos.eci.s"), 2);
+    ASSERT_EQ(capture.AddField("node.name"), 3);
+    ASSERT_EQ(capture.Init(nodes, 3, "capture_ut.bin"), GENERAL_ERROR_NAME);
+    ASSERT_EQ(capture.Close(), 0);
+    ASSERT_EQ(capture.rows, 0u);
+    ASSERT_TRUE(capture.columns.empty());
+
+    ASSERT_EQ(capture.AddField("node.loc.pos.eci"), 1);
+    ASSERT_EQ(capture.AddField("node.loc.pos.eci.s"), 2);
+    ASSERT_EQ(capture.Init(nodes, 3, "capture_ut.bin"), 0);
+    ASSERT_EQ(capture.rows, 3u);
+    ASSERT_FALSE(capture.ReadOnly());
+    ASSERT_EQ(capture.Append(60000.), 1);
+    nodes[1]->currentinfo.node.loc.pos.eci.s.col[2] = 250.;
+    ASSERT_EQ(capture.Append(60000.5), 2);
+    ASSERT_EQ(capture.Close(), 0);
+    EXPECT_EQ(capture.rows, 0u);
+    EXPECT_EQ(capture.count, 0u);
+    EXPECT_TRUE(capture.nodes.empty());
+    EXPECT_TRUE(capture.columns.empty());
+
+    ASSERT_EQ(capture.Open("capture_ut.bin"), 2);
+    EXPECT_TRUE(capture.ReadOnly());
+    EXPECT_EQ(capture.rows, 3u);
+    ASSERT_EQ(capture.nodes, vector<string>({"capnode0", "capnode1"}));
+    int32_t col = capture.Column("node.loc.pos.eci.s");
+    ASSERT_EQ(col, 1);
+    EXPECT_EQ(capture.Utc(0), 60000.);
+    EXPECT_EQ(capture.Utc(1), 60000.5);
+    EXPECT_EQ(capture.Value<rvector>(col, 0, 0).col[0], 7000000.);
+    EXPECT_EQ(capture.Value<rvector>(col, 0, 1).col[2], -500.);
+    EXPECT_EQ(capture.Value<rvector>(col, 1, 1).col[2], 250.);
+    EXPECT_EQ(capture.Value<cartpos>(capture.Column("node.loc.pos.eci"), 1, 1).s.col[1], 1000.);
+    EXPECT_EQ(capture.Append(60001.), GENERAL_ERROR_BAD_FD);
+    ASSERT_EQ(capture.Close(), 0);
+    EXPECT_FALSE(capture.ReadOnly());
+}
+
+// A capture that has been closed can be used for a new run
+TEST_F(CaptureTest, Closed_capture_propagates_again) {
+    Simulator sim;
+    sim.Init(1., "propagate", 60000.);
+    sim.currentutc = 60000.;
+    sim.cnodes = nodes;
+
+    Capture capture;
+    capture.AddField("node.loc.pos.eci.s");
+    ASSERT_EQ(sim.Propagate(capture, 0), 1);
+    ASSERT_EQ(capture.Close(), 0);
+
+    capture.AddField("node.loc.pos.eci.s");
+    ASSERT_EQ(sim.Propagate(capture, 0), 1);
+    EXPECT_EQ(capture.rows, 1u);
+    EXPECT_EQ(capture.Value<rvector>(0, 0, 1).col[0], 7000001.);
+    sim.cnodes.clear();
+}
+
+// A capture without room for the run, or opened read only, is refused before any step is taken
+TEST_F(CaptureTest, Propagate_refuses_full_and_read_only_captures) {
+    Simulator sim;
+    sim.Init(1., "propagate", 60000.);
+    sim.currentutc = 60000.;
+    sim.cnodes = nodes;
+
+    Capture capture;
+    capture.AddField("node.loc.pos.eci.s");
+    ASSERT_EQ(capture.Init(nodes, 3, "capture_ut.bin"), 0);
+    ASSERT_EQ(capture.Append(sim.currentutc), 1);
+    EXPECT_EQ(sim.Propagate(capture, 2), GENERAL_ERROR_OVERSIZE);
+    EXPECT_EQ(sim.currentutc, 60000.);
+    EXPECT_EQ(capture.count, 1u);
+    ASSERT_EQ(capture.Close(), 0);
+
+    ASSERT_EQ(capture.Open("capture_ut.bin"), 1);
+    EXPECT_EQ(sim.Propagate(capture, 0), GENERAL_ERROR_BAD_FD);
+    EXPECT_EQ(capture.count, 1u);
+    sim.cnodes.clear();
+}
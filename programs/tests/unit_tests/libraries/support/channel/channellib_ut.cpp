@@ -57,6 +57,41 @@ TEST_F(ChannelUTest, Pulling_corrupt_packet_fails)
 
 }
 
+TEST_F(ChannelUTest, Lock_free_channel_keeps_order_and_maximum)
+{
+    SetUp();
+    channel.Update(1, 0, 0, 0, 5);
+    PacketComm packet;
+    packet.data = {0};
+    channel.Push(1, packet);
+    EXPECT_EQ(channel.LockFree(1, true), 0);
+    EXPECT_EQ(channel.Size(1), 1);
+
+    // Overfill, so the oldest are dropped
+    for (uint8_t i=1; i<10; ++i)
+    {
+        packet.data = {i, i, i};
+        EXPECT_EQ(channel.Push(1, std::move(packet)), std::min(i+1, 5));
+    }
+    EXPECT_EQ(channel.Packets(1), 10);
+    EXPECT_EQ(channel.Level(1), 5 * (COSMOS_SIZEOF(PacketComm::Header) + 5));
+
+    for (uint8_t i=5; i<10; ++i)
+    {
+        EXPECT_EQ(channel.Pull(1, packet), 1);
+        EXPECT_EQ(packet.data, vector<uint8_t>({i, i, i}));
+    }
+    EXPECT_EQ(channel.Pull(1, packet), 0);
+    EXPECT_EQ(channel.Level(1), 0);
+
+    packet.data = {10};
+    channel.Push(1, packet);
+    EXPECT_EQ(channel.LockFree(1, false), 1);
+    EXPECT_EQ(channel.channel[1].quu.size(), 1);
+    EXPECT_EQ(channel.Pull(1, packet), 1);
+    EXPECT_EQ(packet.data, vector<uint8_t>({10}));
+}
+
 
 } // End namespace Channel
 } // End namespace Unit
@@ -1,8 +1,223 @@
 #include "support/convertlib.h"
 #include "gtest/gtest.h"
 
-// No tests implemented yet
-TEST(ConvertlibTest, Placeholder)
+using namespace Cosmos::Convert;
+
+// Locations at the same time share one calculation of their extra information
+TEST(ConvertlibTest, PosExtraCacheShared)
+{
+    pos_extra_cache_size(4);
+    pos_extra_cache_clear();
+    locstruc first;
+    locstruc second;
+    pos_clear(first);
+    pos_clear(second);
+    if (pos_extra(59000., first) < 0)
+    {
+        GTEST_SKIP() << "COSMOS resources not available";
+    }
+    size_t hits, misses;
+    pos_extra_cache_stats(hits, misses);
+    EXPECT_EQ(hits, 0u);
+    EXPECT_EQ(misses, 1u);
+
+    EXPECT_EQ(pos_extra(59000., second), 0);
+    pos_extra_cache_stats(hits, misses);
+    EXPECT_EQ(hits, 1u);
+    EXPECT_EQ(misses, 1u);
+    EXPECT_EQ(second.pos.extra.tt, first.pos.extra.tt);
+    EXPECT_EQ(memcmp(&second.pos.extra.j2e, &first.pos.extra.j2e, sizeof(rmatrix)), 0);
+    EXPECT_EQ(memcmp(&second.pos.extra.sun2earth, &first.pos.extra.sun2earth, sizeof(cartpos)), 0);
+    EXPECT_EQ(memcmp(&second.pos.extra.moongeo, &first.pos.extra.moongeo, sizeof(gvector)), 0);
+
+    // Four more epochs push the first one out
+    for (uint16_t i=1; i<=4; ++i)
+    {
+        EXPECT_EQ(pos_extra(59000. + i / 1440., first), 0);
+    }
+    EXPECT_EQ(pos_extra(59000., first), 0);
+    pos_extra_cache_stats(hits, misses);
+    EXPECT_EQ(hits, 1u);
+    EXPECT_EQ(misses, 6u);
+    pos_extra_cache_size(16);
+}
+
+// Invalid times are rejected before the cache is consulted
+TEST(ConvertlibTest, PosExtraCacheBadTime)
+{
+    pos_extra_cache_clear();
+    locstruc loc;
+    pos_clear(loc);
+    EXPECT_EQ(pos_extra(0., loc), CONVERT_ERROR_UTC);
+    size_t hits, misses;
+    pos_extra_cache_stats(hits, misses);
+    EXPECT_EQ(hits, 0u);
+    EXPECT_EQ(misses, 0u);
+}
+
+// Write a small IERS table: leap seconds step from 37 to 38 on the third day, and the fourth is missing
+static string write_iers_table()
+{
+    string filename = "convertlib_ut_iers.txt";
+    FILE *fp = fopen(filename.c_str(), "w");
+    fprintf(fp, "59000 1.0e-6 2.0e-6 -0.2 37\n");
+    fprintf(fp, "59001 2.0e-6 4.0e-6 -0.4 37\n");
+    fprintf(fp, "59002 3.0e-6 6.0e-6 0.5 38\n");
+    fprintf(fp, "59004 5.0e-6 1.0e-5 0.7 38\n");
+    fclose(fp);
+    return filename;
+}
+
+// Values are interpolated between days, and held beyond the ends of the table
+TEST(ConvertlibTest, IersTableLookup)
+{
+    IersTable table;
+    string filename = write_iers_table();
+    EXPECT_EQ(table.Load(filename), 5);
+    remove(filename.c_str());
+
+    EXPECT_DOUBLE_EQ(table.Dut1(59000.), -0.2 / 86400.);
+    EXPECT_DOUBLE_EQ(table.Dut1(59000.25), -0.25 / 86400.);
+    EXPECT_DOUBLE_EQ(table.Dut1(58000.), -0.2 / 86400.);
+    EXPECT_DOUBLE_EQ(table.Dut1(59003.5), 0.6 / 86400.);
+    EXPECT_DOUBLE_EQ(table.Dut1(60000.5), 0.7 / 86400.);
+    cvector pm = table.PolarMotion(59001.5);
+    EXPECT_DOUBLE_EQ(pm.x, 2.5e-6);
+    EXPECT_DOUBLE_EQ(pm.y, 5.0e-6);
+    EXPECT_EQ(pm.z, 0.);
+
+    EXPECT_EQ(table.LeapSeconds(59001.999), 37);
+    EXPECT_EQ(table.LeapSeconds(59002.), 38);
+    EXPECT_EQ(table.LeapSeconds(50000.), 37);
+    EXPECT_DOUBLE_EQ(table.Utc2Tt(59002.5), 59002.5 + 70.184 / 86400.);
+    EXPECT_DOUBLE_EQ(table.Tt2Utc(59002.5), 59002.5 - 70.184 / 86400.);
+    EXPECT_DOUBLE_EQ(table.Utc2Ut1(59000.25), 59000.25 - 0.25 / 86400.);
+}
+
+// Batch conversions give the same answers as one at a time
+TEST(ConvertlibTest, IersTableBatch)
+{
+    IersTable table;
+    string filename = write_iers_table();
+    table.Load(filename);
+    remove(filename.c_str());
+
+    vector<double> mjd;
+    for (double utc=58999.; utc<59006.; utc+=.1)
+    {
+        mjd.push_back(utc);
+    }
+    vector<double> tt(mjd.size()), tdb(mjd.size()), ut1(mjd.size());
+    table.Utc2Tt(mjd.data(), mjd.size(), tt.data());
+    table.Utc2Tdb(mjd.data(), mjd.size(), tdb.data());
+    table.Utc2Ut1(mjd.data(), mjd.size(), ut1.data());
+    for (size_t i=0; i<mjd.size(); ++i)
+    {
+        EXPECT_EQ(tt[i], table.Utc2Tt(mjd[i]));
+        EXPECT_EQ(tdb[i], table.Utc2Tdb(mjd[i]));
+        EXPECT_EQ(ut1[i], table.Utc2Ut1(mjd[i]));
+    }
+}
+
+// A missing table is an error, not an empty table
+TEST(ConvertlibTest, IersTableMissing)
+{
+    IersTable table;
+    EXPECT_LT(table.Load("convertlib_ut_no_such_file.txt"), 0);
+    EXPECT_EQ(table.Size(), 0u);
+    EXPECT_EQ(table.Dut1(59000.), 0.);
+    EXPECT_EQ(table.LeapSeconds(59000.), 0);
+}
+
+// Write Two Line Elements for the SGP4 checks
+static string write_tle_lines()
 {
-    EXPECT_EQ(1, 1);
+    string filename = "convertlib_ut_tle.txt";
+    FILE *fp = fopen(filename.c_str(), "w");
+    fprintf(fp, "SGP4 TEST\n");
+    fprintf(fp, "1 88888U          80275.98708465  .00073094  13844-3  66816-4 0    87\n");
+    fprintf(fp, "2 88888  72.8435 115.9689 0086731  52.6988 110.5714 16.05824518  1058\n");
+    fprintf(fp, "1 25544U 98067A   08264.51782528 -.00002182  00000-0 -11606-4 0  2927\n");
+    fprintf(fp, "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.72125391563537\n");
+    fprintf(fp, "1 06251U 62025E   06176.82412014  .00008885  00000-0  12808-3 0  3985\n");
+    fprintf(fp, "2 06251  58.0579  54.0425 0030035 139.1568 221.1854 15.56387291  6774\n");
+    fclose(fp);
+    return filename;
+}
+
+// TEME states from sgp4() as it was before Sgp4 held its terms, five times for each element set
+struct sgp4_reference
+{
+    double minutes;
+    double s[3];
+    double v[3];
+};
+static const sgp4_reference sgp4_references[] =
+{
+        // 88888, the SGP4 verification case of Spacetrack Report #3
+        {0.0, {2328971.4332216987, -5995222.7119420823, 1719971.1975287423}, {2912.0731664374234, -983.41561902551518, -7090.819192348119}},
+        {360.0, {2456108.6250453531, -6071940.5889211651, 1222895.9388898204}, {2679.3899034177402, -448.28853762319847, -7228.7949070733148}},
+        {720.0, {2567563.7323578126, -6112505.7284530653, 713962.07722351968}, {2440.2456229175659, 98.111158766866438, -7319.9618004333006}},
+        {1440.0, {2742555.1970467912, -6079671.7786195446, -326391.54696230078}, {1948.4976029299398, 1211.0745185753415, -7356.1953571402737}},
+        {4320.0, {2819167.8455344713, -4342859.6280944496, -4249098.4347208953}, {8.8619575387615548, 5366.1709840013755, -5489.8409870887435}},
+        // 25544
+        {0.0, {4083903.7428706498, -993632.31097033445, 5243605.3080590116}, {2512.8380824262445, 7259.8907993000385, -583.77871930710944}},
+        {360.0, {2748402.4043862694, -3564893.5230313917, 4992449.8723571496}, {4342.8634117180236, 6063.0470618321706, 1927.7723159402017}},
+        {720.0, {832513.58534423099, -5440638.3814627305, 3865864.7464627582}, {5335.3560680282535, 3745.0473916531091, 4100.7717659769742}},
+        {1440.0, {-3199120.308773831, -5925840.7490378562, -104283.92185203463}, {4160.9014251603421, -2340.8674325684833, 6034.2416777212702}},
+        {4320.0, {4805493.7466108995, 4530666.0570052192, 1272977.3114821787}, {-2509.549780384436, 4323.314165196025, -5862.40618083557}},
+        // 06251
+        {0.0, {3988311.5122592216, 5498968.2693583118, 900.48841617045025}, {-3290.0337133656253, 2357.6536344086412, 6496.6255101937068}},
+        {360.0, {4993627.9926762553, 2890550.6030467167, -3600402.5854527089}, {347.33353912950173, 5707.0333459694821, 5070.7012250111811}},
+        {720.0, {3692601.4642860633, -976242.94656042336, -5623366.2339312136}, {3897.2584555922431, 6415.5569601687057, 1429.1126507009333}},
+        {1440.0, {-2777147.5958942077, -5663162.088673424, -2462549.7797886785}, {4915.4947567876461, 123.32917507244035, -5896.4968749148629}},
+        {4320.0, {946926.43730608677, -3781661.6748766, -5557693.4718698096}, {6254.4012164800242, 4057.8400139519495, -1722.4146682994503}}
+};
+
+// sgp4(), Sgp4 and Sgp4Catalog reproduce the states of the original sgp4()
+TEST(ConvertlibTest, Sgp4Reference)
+{
+    vector<tlestruc> lines;
+    string filename = write_tle_lines();
+    EXPECT_EQ(load_lines(filename, lines), 3);
+    remove(filename.c_str());
+    ASSERT_EQ(lines.size() * 5, sizeof(sgp4_references) / sizeof(sgp4_reference));
+
+    Sgp4Catalog catalog;
+    for (const tlestruc &tle : lines)
+    {
+        EXPECT_GE(catalog.Add(tle), 0);
+    }
+    for (size_t i=0; i<lines.size(); ++i)
+    {
+        Sgp4 sat(lines[i]);
+        for (size_t j=0; j<5; ++j)
+        {
+            const sgp4_reference &ref = sgp4_references[i * 5 + j];
+            double utc = lines[i].utc + ref.minutes / 1440.;
+            cartpos legacy, teme;
+            EXPECT_EQ(sgp4(utc, lines[i], legacy), 0);
+            EXPECT_EQ(sat.Propagate(utc, teme), 0);
+            for (uint16_t k=0; k<3; ++k)
+            {
+                EXPECT_NEAR(legacy.s.col[k], ref.s[k], 1e-6) << lines[i].snumber << " at " << ref.minutes << " minutes";
+                EXPECT_NEAR(legacy.v.col[k], ref.v[k], 1e-9) << lines[i].snumber << " at " << ref.minutes << " minutes";
+                EXPECT_NEAR(teme.s.col[k], ref.s[k], 1e-6) << lines[i].snumber << " at " << ref.minutes << " minutes";
+                EXPECT_NEAR(teme.v.col[k], ref.v[k], 1e-9) << lines[i].snumber << " at " << ref.minutes << " minutes";
+            }
+
+            // The catalog puts every satellite at the same time
+            EXPECT_EQ(catalog.Propagate(utc, false), 3);
+            for (size_t c=0; c<lines.size(); ++c)
+            {
+                Sgp4(lines[c]).Propagate(utc, teme);
+                EXPECT_NEAR(catalog.sx[c], teme.s.col[0], 1e-6);
+                EXPECT_NEAR(catalog.sy[c], teme.s.col[1], 1e-6);
+                EXPECT_NEAR(catalog.sz[c], teme.s.col[2], 1e-6);
+                EXPECT_NEAR(catalog.vx[c], teme.v.col[0], 1e-9);
+                EXPECT_NEAR(catalog.vy[c], teme.v.col[1], 1e-9);
+                EXPECT_NEAR(catalog.vz[c], teme.v.col[2], 1e-9);
+            }
+        }
+    }
 }
@@ -0,0 +1,155 @@
+#include "support/geomag.h"
+#include "gtest/gtest.h"
+#include <thread>
+
+using namespace Cosmos::Convert;
+
+// Write a full degree and order 12 WMM file with made up coefficients
+static string write_wmm_file()
+{
+    string filename = "geomag_ut_wmm.cof";
+    FILE *fp = fopen(filename.c_str(), "w");
+    fprintf(fp, "    2020.0            WMM-2020        12/10/2019\n");
+    for (int n=1; n<=12; ++n)
+    {
+        for (int m=0; m<=n; ++m)
+        {
+            double g = 3000. / (n * n) * sin(n * 7 + m * 3);
+            double h = m ? 3000. / (n * n) * cos(n * 5 + m * 11) : 0.;
+            double dg = 10. / n * sin(n + m);
+            double dh = m ? 10. / n * cos(n * m) : 0.;
+            if (n == 1)
+            {
+                g = m ? -1450.9 : -29404.8;
+                h = m ? 4652.5 : 0.;
+            }
+            fprintf(fp, "%3d%3d%12.1f%12.1f%11.1f%11.1f\n", n, m, g, h, dg, dh);
+        }
+    }
+    fprintf(fp, "999999999999999999999999999999999999999999999999\n");
+    fprintf(fp, "999999999999999999999999999999999999999999999999\n");
+    fclose(fp);
+    return filename;
+}
+
+struct geomag_case
+{
+    double year;
+    double lat;
+    double lon;
+    double h;
+    double b[3];
+};
+
+// Field of the file above from the single precision geomag_front() that GeomagModel replaced
+static const geomag_case geomag_cases[] =
+{
+    {2020.5, -80.0, -170.0, 35786000.0, {1.62812093e-08, 1.69532353e-08, -2.01550861e-07}},
+    {2020.5, -45.0, -170.0, 400000.0, {1.75022469e-05, 4.51515643e-06, -3.49882066e-05}},
+    {2020.5, -10.0, -170.0, 0.0, {2.78800326e-05, 4.96019447e-06, -1.00979942e-05}},
+    {2020.5, -10.0, 179.0, 35786000.0, {9.84899344e-08, 1.54261901e-08, -4.55854128e-08}},
+    {2020.5, 0.0, 179.0, 400000.0, {2.34907784e-05, 3.30926309e-06, -3.40975112e-06}},
+    {2020.5, 20.0, 179.0, 0.0, {2.64442988e-05, -1.26448807e-08, 1.50660399e-05}},
+    {2020.5, 60.0, 135.0, 35786000.0, {6.30485459e-08, 6.84674761e-09, 1.60044138e-07}},
+    {2020.5, 85.0, 135.0, 400000.0, {6.40026383e-06, 7.52543428e-07, 4.60611263e-05}},
+    {2023.25, -80.0, 135.0, 0.0, {1.21707637e-06, 3.25271776e-06, -6.10403004e-05}},
+    {2023.25, -45.0, 45.0, 35786000.0, {6.65140405e-08, -1.44075036e-08, -1.56311231e-07}},
+    {2023.25, -10.0, 45.0, 400000.0, {2.46933469e-05, -3.22044366e-06, -1.32770811e-05}},
+    {2023.25, 0.0, 45.0, 0.0, {3.06832917e-05, -3.78149525e-06, -5.37695041e-06}},
+    {2023.25, 20.0, 0.0, 35786000.0, {9.39469373e-08, -1.64911302e-08, 7.86978731e-08}},
+    {2023.25, 60.0, 0.0, 400000.0, {1.01195474e-05, -4.14047418e-06, 4.34828107e-05}},
+    {2023.25, 85.0, 0.0, 0.0, {-6.27061695e-07, -4.7054391e-06, 5.69055373e-05}},
+};
+
+static gvector case_position(const geomag_case &test)
+{
+    gvector pos;
+    pos.lat = RADOF(test.lat);
+    pos.lon = RADOF(test.lon);
+    pos.h = test.h;
+    return pos;
+}
+
+// The double precision model agrees with the single precision one to within its precision
+TEST(GeomagTest, MatchesSinglePrecision)
+{
+    GeomagModel model;
+    string filename = write_wmm_file();
+    EXPECT_EQ(model.Load(filename), 90);
+    remove(filename.c_str());
+    EXPECT_EQ(model.Epoch(), 2020.);
+
+    for (const geomag_case &test : geomag_cases)
+    {
+        rvector comp;
+        EXPECT_EQ(model.Field(case_position(test), test.year, comp), 0);
+        double magnitude = sqrt(test.b[0] * test.b[0] + test.b[1] * test.b[1] + test.b[2] * test.b[2]);
+        for (uint16_t i=0; i<3; ++i)
+        {
+            EXPECT_NEAR(comp.col[i], test.b[i], 2e-6 * magnitude) << test.year << " " << test.lat << " " << test.lon << " " << test.h;
+        }
+    }
+}
+
+// Batches give the same answers as one at a time, from any number of threads
+TEST(GeomagTest, BatchAndThreads)
+{
+    GeomagModel model;
+    string filename = write_wmm_file();
+    model.Load(filename);
+    remove(filename.c_str());
+
+    vector<gvector> pos;
+    for (const geomag_case &test : geomag_cases)
+    {
+        pos.push_back(case_position(test));
+    }
+    vector<rvector> single(pos.size());
+    for (size_t i=0; i<pos.size(); ++i)
+    {
+        model.Field(pos[i], 2022., single[i]);
+    }
+
+    vector<vector<rvector>> batches(4, vector<rvector>(pos.size()));
+    vector<std::thread> threads;
+    for (size_t t=0; t<batches.size(); ++t)
+    {
+        threads.push_back(std::thread([&, t]()
+        {
+            // Alternate times, so each thread adjusts its coefficients again, ending on 2022
+            for (uint16_t loop=0; loop<100; ++loop)
+            {
+                model.Field(pos.data(), pos.size(), loop % 2 ? 2022. : 2021. + t, batches[t].data());
+            }
+        }));
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    for (const vector<rvector> &batch : batches)
+    {
+        for (size_t i=0; i<pos.size(); ++i)
+        {
+            EXPECT_EQ(memcmp(&batch[i], &single[i], sizeof(rvector)), 0);
+        }
+    }
+}
+
+// Times outside the model, and models that did not load, are errors
+TEST(GeomagTest, Errors)
+{
+    GeomagModel model;
+    rvector comp;
+    gvector pos;
+    EXPECT_EQ(model.Load("geomag_ut_no_such_file.cof"), GEOMAG_ERROR_NOTFOUND);
+    EXPECT_FALSE(model.IsLoaded());
+    EXPECT_EQ(model.Field(pos, 2020.5, comp), GEOMAG_ERROR_NOTFOUND);
+
+    string filename = write_wmm_file();
+    model.Load(filename);
+    remove(filename.c_str());
+    EXPECT_EQ(model.Field(pos, 2019.9, comp), GEOMAG_ERROR_OUTOFRANGE);
+    EXPECT_EQ(model.Field(pos, 2035.1, comp), GEOMAG_ERROR_OUTOFRANGE);
+    EXPECT_EQ(model.Field(pos, 2035., comp), 0);
+}
@@ -39,3 +39,142 @@ TEST(DatalibTest, Folder_compress_and_move_returns_error) {
     ASSERT_EQ(result, GENERAL_ERROR_INPUT);
     remove(oldpath.c_str());
 }
+
+// Removes the node tree written by the log_write tests
+class DatalibLogTest : public ::testing::Test
+{
+protected:
+    void TearDown() override
+    {
+        log_flush("");
+        data_execute("rm -r testnodes/lognode");
+        ::rmdir("testnodes");
+    }
+};
+
+// Buffered records are all in the file after a flush, and a new UTC rolls to a new file
+TEST_F(DatalibLogTest, Log_write_buffers_records_and_rolls_on_new_utc) {
+    ASSERT_EQ(setenv("COSMOSNODES", "testnodes", 1), 0);
+    ASSERT_TRUE(COSMOS_MKDIR("testnodes", 00777) == 0 || errno == EEXIST);
+    ASSERT_TRUE(COSMOS_MKDIR("testnodes/lognode", 00777) == 0 || errno == EEXIST);
+
+    string path1 = log_write("lognode", "soh", 60000., "", "telemetry", "first");
+    log_write("lognode", "soh", 60000., "", "telemetry", "second");
+    string path2 = log_write("lognode", "soh", 60000.5, "", "telemetry", "third");
+    ASSERT_FALSE(path1.empty());
+    ASSERT_NE(path1, path2);
+    ASSERT_EQ(log_flush(path2), 0);
+
+    char line[20];
+    FILE *file = fopen(path1.c_str(), "r");
+    ASSERT_NE(file, nullptr);
+    ASSERT_NE(fgets(line, sizeof(line), file), nullptr);
+    ASSERT_STREQ(line, "first\n");
+    ASSERT_NE(fgets(line, sizeof(line), file), nullptr);
+    ASSERT_STREQ(line, "second\n");
+    fclose(file);
+    file = fopen(path2.c_str(), "r");
+    ASSERT_NE(file, nullptr);
+    ASSERT_NE(fgets(line, sizeof(line), file), nullptr);
+    ASSERT_STREQ(line, "third\n");
+    fclose(file);
+    remove(path1.c_str());
+    remove(path2.c_str());
+}
+
+// A file moved away while its stream holds it open, as another process's log_move_file would, is
+// opened again at its path, and no records are lost
+TEST_F(DatalibLogTest, Log_write_reopens_file_moved_by_another_process) {
+    ASSERT_EQ(setenv("COSMOSNODES", "testnodes", 1), 0);
+    ASSERT_TRUE(COSMOS_MKDIR("testnodes", 00777) == 0 || errno == EEXIST);
+    ASSERT_TRUE(COSMOS_MKDIR("testnodes/lognode", 00777) == 0 || errno == EEXIST);
+
+    string path = log_write("lognode", "soh", 60001., "", "telemetry", "first");
+    log_write("lognode", "soh", 60001., "", "telemetry", "second");
+    ASSERT_FALSE(path.empty());
+    // Written out, but the stream keeps the file open
+    ASSERT_EQ(log_flush(""), 0);
+    string moved = path + ".moved";
+    ASSERT_EQ(rename(path.c_str(), moved.c_str()), 0);
+
+    ASSERT_EQ(log_write("lognode", "soh", 60001., "", "telemetry", "third"), path);
+    log_write("lognode", "soh", 60001., "", "telemetry", "fourth");
+    ASSERT_EQ(log_flush(""), 0);
+
+    char line[20];
+    FILE *file = fopen(moved.c_str(), "r");
+    ASSERT_NE(file, nullptr);
+    ASSERT_NE(fgets(line, sizeof(line), file), nullptr);
+    EXPECT_STREQ(line, "first\n");
+    ASSERT_NE(fgets(line, sizeof(line), file), nullptr);
+    EXPECT_STREQ(line, "second\n");
+    EXPECT_EQ(fgets(line, sizeof(line), file), nullptr);
+    fclose(file);
+    file = fopen(path.c_str(), "r");
+    ASSERT_NE(file, nullptr);
+    ASSERT_NE(fgets(line, sizeof(line), file), nullptr);
+    EXPECT_STREQ(line, "third\n");
+    ASSERT_NE(fgets(line, sizeof(line), file), nullptr);
+    EXPECT_STREQ(line, "fourth\n");
+    fclose(file);
+}
+
+// Removes the node tree written by the archive reader tests
+class DatalibArchiveTest : public ::testing::Test
+{
+protected:
+    void TearDown() override
+    {
+        data_execute("rm -r testnodes/arcnode");
+        ::rmdir("testnodes");
+    }
+};
+
+// Archive records are streamed in time order across plain and gzip files, starting with the file covering the start
+TEST_F(DatalibArchiveTest, Archive_reader_streams_plain_and_gzip_files_in_range) {
+    ASSERT_EQ(setenv("COSMOSNODES", "testnodes", 1), 0);
+    ASSERT_TRUE(COSMOS_MKDIR("testnodes", 00777) == 0 || errno == EEXIST);
+    ASSERT_TRUE(COSMOS_MKDIR("testnodes/arcnode", 00777) == 0 || errno == EEXIST);
+
+    vector<string> paths;
+    double utcs[3] = {60000.25, 60000.75, 60001.5};
+    const char *records[3] = {"a1\na2\n", "b1\n", "c1\n"};
+    for (uint16_t i=0; i<3; ++i)
+    {
+        string path = data_archive_path("arcnode", "soh", utcs[i]) + "/" + data_name(utcs[i], "telemetry", "arcnode", "soh");
+        if (i == 1)
+        {
+            path += ".gz";
+            gzFile gzout = gzopen(path.c_str(), "wb");
+            ASSERT_NE(gzout, nullptr);
+            gzputs(gzout, records[i]);
+            gzclose(gzout);
+        }
+        else
+        {
+            FILE *file = fopen(path.c_str(), "w");
+            ASSERT_NE(file, nullptr);
+            fputs(records[i], file);
+            fclose(file);
+        }
+        paths.push_back(path);
+    }
+
+    vector<string> result;
+    ASSERT_EQ(data_load_archive("arcnode", "soh", 60000., 60002., "telemetry", result), 0);
+    ASSERT_EQ(result, vector<string>({"a1", "a2", "b1", "c1"}));
+    ASSERT_EQ(data_load_archive("arcnode", "soh", 60000.8, 60001.2, "telemetry", result), 0);
+    ASSERT_EQ(result, vector<string>({"b1"}));
+
+    DataArchiveReader reader;
+    ASSERT_EQ(reader.Open("arcnode", "soh", 60000., 60002., "telemetry"), 0);
+    ASSERT_EQ(reader.Read(result, 3), 3);
+    ASSERT_EQ(reader.Read(result, 3), 1);
+    ASSERT_EQ(result[0], "c1");
+    ASSERT_EQ(reader.Read(result, 3), 0);
+
+    for (string path : paths)
+    {
+        remove(path.c_str());
+    }
+}
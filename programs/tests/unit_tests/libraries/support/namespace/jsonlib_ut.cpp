@@ -1,8 +1,59 @@
 #include "support/jsonlib.h"
 #include "gtest/gtest.h"
 
-// No tests implemented yet
-TEST(JsonlibTest, Placeholder)
+// Compiled equations give the same answers as parsing them each time
+TEST(JsonlibTest, EquationCompile)
 {
-    EXPECT_EQ(1, 1);
+    cosmosstruc *cinfo = json_init();
+    ASSERT_NE(cinfo, nullptr);
+    cinfo->node.utc = 59000.5;
+    cinfo->node.phys.battlev = 12.f;
+    cinfo->node.flags = 6;
+
+    for (string equation : {"(1+2)", "(\"node_utc\">59000.)", "((\"node_battlev\"*2)-(3/4))", "(!0)", "(~\"node_flags\")",
+                            "((\"node_flags\"@4)=4)", "(((1+2)*(3+4))^((5-6)%(7+8)))", "((\"node_utc\">1.)&((\"node_battlev\"<11.)|(\"node_flags\"#1)))"})
+    {
+        jsonprogram program;
+        const char *cp = equation.c_str();
+        ASSERT_GT(json_equation_compile(cp, cinfo, program), 0) << equation;
+        EXPECT_EQ(cp, equation.c_str() + equation.size()) << equation;
+        EXPECT_LE(program.depth, JSON_MAX_EQUATION_STACK);
+        cp = equation.c_str();
+        EXPECT_EQ(json_equation(program, cinfo), json_equation(cp, cinfo)) << equation;
+    }
+
+    // Names are read when calculated, not when compiled
+    jsonprogram program;
+    const char *cp = "(\"node_battlev\">13.)";
+    json_equation_compile(cp, cinfo, program);
+    EXPECT_EQ(json_equation(program, cinfo), 0.);
+    cinfo->node.phys.battlev = 14.f;
+    EXPECT_EQ(json_equation(program, cinfo), 1.);
+    json_destroy(cinfo);
+}
+
+// Bad equations do not compile, and calculate to NAN
+TEST(JsonlibTest, EquationCompileBad)
+{
+    cosmosstruc *cinfo = json_init();
+    ASSERT_NE(cinfo, nullptr);
+    for (string equation : {"", "1+2", "(1+2", "(1?2)", "(\"no_such_name\">1)"})
+    {
+        jsonprogram program;
+        const char *cp = equation.c_str();
+        EXPECT_LT(json_equation_compile(cp, cinfo, program), 0) << equation;
+        EXPECT_TRUE(program.steps.empty());
+        EXPECT_TRUE(std::isnan(json_equation(program, cinfo)));
+    }
+
+    // Nesting deeper than the stack
+    string equation = "1";
+    for (uint16_t i=0; i<JSON_MAX_EQUATION_STACK; ++i)
+    {
+        equation = "(1+" + equation + ")";
+    }
+    jsonprogram program;
+    const char *cp = equation.c_str();
+    EXPECT_EQ(json_equation_compile(cp, cinfo, program), JSON_ERROR_INDEX_SIZE);
+    json_destroy(cinfo);
 }
@@ -101,15 +101,143 @@ TEST(TransferlibTest, add_chunk)
     compare_tx_progress(tx.file_info, mfile_info, __LINE__);
     EXPECT_EQ(tx.total_bytes, sum_fp(mfile_info));
 
-    // Add a multi-chunk overlapping chunk
+    // Add a multi-chunk overlapping chunk, which joins the chunks it overlaps
     tp = {300, 400};
     ret = add_chunk(tx, tp);
-    mfile_info = {{0, 400}, {350, 550}, {600, 800}, {900, 999}};
+    mfile_info = {{0, 550}, {600, 800}, {900, 999}};
     EXPECT_EQ(ret, true);
     compare_tx_progress(tx.file_info, mfile_info, __LINE__);
     EXPECT_EQ(tx.total_bytes, sum_fp(mfile_info));
 }
 
+TEST(TransferlibTest, add_chunk_out_of_order)
+{
+    // Packets of 100 bytes, arriving in a scrambled order with some repeated
+    tx_progress tx;
+    tx.file_size = 100000;
+    tx.total_bytes = 0;
+    tx.file_info.clear();
+    vector<bool> received(1000, false);
+    size_t count = 0;
+    for (size_t i=0; i<3000; ++i)
+    {
+        size_t packet = (i * 7919) % 1000;
+        // Leave every 97th packet missing
+        if (packet % 97 == 0)
+        {
+            continue;
+        }
+        file_progress tp = {static_cast<PACKET_FILE_SIZE_TYPE>(packet * 100), static_cast<PACKET_FILE_SIZE_TYPE>(packet * 100 + 99)};
+        EXPECT_EQ(add_chunk(tx, tp), !received[packet]);
+        if (!received[packet])
+        {
+            received[packet] = true;
+            ++count;
+        }
+        EXPECT_EQ(tx.total_bytes, count * 100);
+    }
+
+    // Chunks are in order, and joined wherever they meet
+    vector<file_progress> mfile_info;
+    for (size_t packet=0; packet<1000; ++packet)
+    {
+        if (!received[packet])
+        {
+            continue;
+        }
+        if (!mfile_info.empty() && mfile_info.back().chunk_end + 1 == packet * 100)
+        {
+            mfile_info.back().chunk_end = packet * 100 + 99;
+        }
+        else
+        {
+            mfile_info.push_back({static_cast<PACKET_FILE_SIZE_TYPE>(packet * 100), static_cast<PACKET_FILE_SIZE_TYPE>(packet * 100 + 99)});
+        }
+    }
+    compare_tx_progress(tx.file_info, mfile_info, __LINE__);
+    EXPECT_EQ(tx.total_bytes, sum_fp(mfile_info));
+
+    // Missing packets are the holes
+    tx.sentmeta = true;
+    vector<file_progress> missing = find_chunks_missing(tx);
+    EXPECT_EQ(missing.size(), 11u);
+    for (const file_progress& hole : missing)
+    {
+        EXPECT_EQ(hole.chunk_start % 9700, 0u);
+        EXPECT_EQ(hole.chunk_end, hole.chunk_start + 99);
+    }
+    EXPECT_EQ(tx.complete, false);
+}
+
+TEST(TransferlibTest, add_chunk_crc)
+{
+    vector<PACKET_BYTE> contents(100000);
+    for (size_t i=0; i<contents.size(); ++i)
+    {
+        contents[i] = static_cast<PACKET_BYTE>(i * 131 + (i >> 9));
+    }
+
+    // Packets of 100 bytes, some overlapping the next, arriving in a scrambled order with some repeated
+    for (string type : {"ccitt-false", "hdlc", "maxim"})
+    {
+        CRC16 calc_crc;
+        calc_crc.set(type);
+        tx_progress tx;
+        tx.file_size = contents.size();
+        for (size_t i=0; i<3000; ++i)
+        {
+            size_t packet = (i * 7919) % 1000;
+            file_progress tp = {static_cast<PACKET_FILE_SIZE_TYPE>(packet * 100), static_cast<PACKET_FILE_SIZE_TYPE>(std::min(packet * 100 + 99 + (packet % 3) * 20, contents.size() - 1))};
+            add_chunk_crc(tx, tp, &contents[tp.chunk_start], calc_crc);
+            for (size_t j=1; j<tx.data_crc.size(); ++j)
+            {
+                EXPECT_GT(tx.data_crc[j].chunk_start, tx.data_crc[j-1].chunk_end + 1);
+            }
+        }
+
+        // One run, with the CRC of the whole file
+        ASSERT_EQ(tx.data_crc.size(), 1u) << type;
+        EXPECT_EQ(tx.data_crc[0].chunk_start, 0u);
+        EXPECT_EQ(tx.data_crc[0].chunk_end, contents.size() - 1);
+        EXPECT_EQ(tx.data_crc[0].crc, calc_crc.extend(calc_crc.calc(nullptr, 0), contents.data(), contents.size())) << type;
+        EXPECT_EQ(calc_file_crc(tx, calc_crc), tx.data_crc[0].crc);
+        EXPECT_EQ(calc_crc.combine(calc_crc.calc(contents.data(), 1000), calc_crc.calc(&contents[1000], 3000), 3000), calc_crc.calc(contents.data(), 4000)) << type;
+    }
+}
+
+TEST(TransferlibTest, calc_file_crc_resumed)
+{
+    vector<PACKET_BYTE> contents(100000);
+    for (size_t i=0; i<contents.size(); ++i)
+    {
+        contents[i] = static_cast<PACKET_BYTE>(i * 131 + (i >> 9));
+    }
+    tx_progress tx;
+    tx.temppath = "transferlib_ut_resumed";
+    tx.file_size = contents.size();
+    FILE* fp = fopen((tx.temppath + ".file").c_str(), "wb");
+    ASSERT_NE(fp, nullptr);
+    fwrite(contents.data(), 1, contents.size(), fp);
+    fclose(fp);
+
+    // Earlier session wrote the start, middle and end, this session the rest
+    CRC16 calc_crc;
+    file_progress second = {20000, 49999};
+    file_progress fourth = {60000, 89999};
+    add_chunk_crc(tx, second, &contents[second.chunk_start], calc_crc);
+    add_chunk_crc(tx, fourth, &contents[fourth.chunk_start], calc_crc);
+    EXPECT_EQ(tx.data_crc.size(), 2u);
+    EXPECT_EQ(calc_file_crc(tx, calc_crc), calc_crc.calc_file(tx.temppath + ".file"));
+
+    // Runs from this session are taken from the bytes as they arrived, not read back from the disk
+    contents[30000] ^= 1;
+    tx.data_crc.clear();
+    add_chunk_crc(tx, second, &contents[second.chunk_start], calc_crc);
+    add_chunk_crc(tx, fourth, &contents[fourth.chunk_start], calc_crc);
+    EXPECT_NE(calc_file_crc(tx, calc_crc), calc_crc.calc_file(tx.temppath + ".file"));
+    remove((tx.temppath + ".file").c_str());
+}
+
 TEST(TransferlibTest, add_chunk_with_start)
 {
     // Keep mock file_info here